@@ -36,6 +36,11 @@
 #include "gstaudiopack.h"
 #include "audio-quantize.h"
 
+/* number of independent random generators used for dither generation. The
+ * generators are stepped in lock-step so that the compiler can keep the
+ * state of all lanes in one vector register. */
+#define N_RANDOM_LANES 8
+
 typedef void (*QuantizeFunc) (GstAudioQuantize * quant, const gpointer src,
     gpointer dst, gint count);
 
@@ -63,18 +68,12 @@ struct _GstAudioQuantize
   /* noise shaping coefficients */
   gpointer coeffs;
   gint n_coeffs;
+  /* per-lane state of the random generators */
+  guint32 random_state[N_RANDOM_LANES];
 
   QuantizeFunc quantize;
 };
 
-#define ADDSS(res,val) \
-        if (val > 0 && res > 0 && G_MAXINT32 - res <= val){             \
-          res = G_MAXINT32;                                             \
-        } else if (val < 0 && res < 0 && G_MININT32 - res >= val){      \
-          res = G_MININT32;                                             \
-        } else                                                          \
-          res += val;
-
 static void
 gst_audio_quantize_quantize_memcpy (GstAudioQuantize * quant,
     const gpointer src, gpointer dst, gint samples)
@@ -92,34 +91,59 @@ gst_audio_quantize_quantize_int_none_none (GstAudioQuantize * quant,
       samples * quant->stride);
 }
 
-/* This is the base function, implementing a linear congruential generator
- * and returning a pseudo random number between 0 and 2^32 - 1.
- */
-static inline guint32
-gst_fast_random_uint32 (void)
+/* Step all random generator lanes in @state once and store the results in
+ * @r. This is a plain xorshift32 generator per lane, which has no
+ * cross-lane dependencies and thus vectorizes nicely. */
+static inline void
+gst_audio_quantize_random_step (guint32 * state, guint32 * r)
 {
-  static guint32 state = 0xdeadbeef;
-  return (state = state * 1103515245 + 12345);
+  gint l;
+
+  for (l = 0; l < N_RANDOM_LANES; l++) {
+    guint32 x = state[l];
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state[l] = r[l] = x;
+  }
 }
 
-static inline gint32
-gst_fast_random_int32 (void)
+/* Fill @d with @len random values between -dither <= value < dither,
+ * offset with @bias. Assumes dither == 2^n. When @tpdf is set, the sum of
+ * two such values is used for a triangular distribution. */
+static void
+gst_audio_quantize_random_fill (GstAudioQuantize * quant, gint32 * d,
+    gint len, gint32 dither, guint32 bias, gboolean tpdf)
 {
-  return (gint32) gst_fast_random_uint32 ();
+  guint32 r1[N_RANDOM_LANES], r2[N_RANDOM_LANES];
+  guint32 *state = quant->random_state;
+  guint32 dmask = (dither << 1) - 1;
+  gint i, l, n;
+
+  for (i = 0; i < len; i += N_RANDOM_LANES) {
+    n = MIN (N_RANDOM_LANES, len - i);
+
+    gst_audio_quantize_random_step (state, r1);
+    if (tpdf) {
+      gst_audio_quantize_random_step (state, r2);
+      for (l = 0; l < N_RANDOM_LANES; l++)
+        r1[l] = bias - 2 * dither + (r1[l] & dmask) + (r2[l] & dmask);
+    } else {
+      for (l = 0; l < N_RANDOM_LANES; l++)
+        r1[l] = bias - dither + (r1[l] & dmask);
+    }
+    for (l = 0; l < n; l++)
+      d[i + l] = r1[l];
+  }
 }
 
-/* Assuming dither == 2^n,
- * returns one of 2^(n+1) possible random values:
- * -dither <= retval < dither */
-#define RANDOM_INT_DITHER(dither)                                       \
-  (- dither + (gst_fast_random_int32 () & ((dither << 1) - 1)))
-
 static void
 setup_dither_buf (GstAudioQuantize * quant, gint samples)
 {
   gboolean need_init = FALSE;
   gint stride = quant->stride;
-  gint i, len = samples * stride;
+  gint i, c, len = samples * stride;
   guint shift = quant->shift;
   guint32 bias;
   gint32 dither, *d;
@@ -135,22 +159,18 @@ setup_dither_buf (GstAudioQuantize * quant, gint samples)
 
   switch (quant->dither) {
     case GST_AUDIO_DITHER_NONE:
-      if (need_init) {
-        for (i = 0; i < len; i++)
-          d[i] = 0;
-      }
+      if (need_init)
+        memset (d, 0, len * sizeof (gint32));
       break;
 
     case GST_AUDIO_DITHER_RPDF:
       dither = 1 << (shift);
-      for (i = 0; i < len; i++)
-        d[i] = bias + RANDOM_INT_DITHER (dither);
+      gst_audio_quantize_random_fill (quant, d, len, dither, bias, FALSE);
       break;
 
     case GST_AUDIO_DITHER_TPDF:
       dither = 1 << (shift - 1);
-      for (i = 0; i < len; i++)
-        d[i] = bias + RANDOM_INT_DITHER (dither) + RANDOM_INT_DITHER (dither);
+      gst_audio_quantize_random_fill (quant, d, len, dither, bias, TRUE);
       break;
 
     case GST_AUDIO_DITHER_TPDF_HF:
@@ -158,10 +178,15 @@ setup_dither_buf (GstAudioQuantize * quant, gint samples)
       gint32 tmp, *last_random = quant->last_random;
 
       dither = 1 << (shift - 1);
-      for (i = 0; i < len; i++) {
-        tmp = RANDOM_INT_DITHER (dither);
-        d[i] = bias + tmp - last_random[i % stride];
-        last_random[i % stride] = tmp;
+      /* generate the plain RPDF values first, then take the difference
+       * with the previous value of the same channel */
+      gst_audio_quantize_random_fill (quant, d, len, dither, 0, FALSE);
+      for (i = 0; i < len; i += stride) {
+        for (c = 0; c < stride; c++) {
+          tmp = d[i + c];
+          d[i + c] = bias + tmp - last_random[c];
+          last_random[c] = tmp;
+        }
       }
       break;
     }
@@ -192,12 +217,17 @@ setup_error_buf (GstAudioQuantize * quant, gint samples, gint extra)
   }
 }
 
+/* Saturating add of @val to @res, written without branches so that the
+ * loops below can be vectorized */
+#define ADDSS(res,val) \
+        res = CLAMP ((gint64) res + (val), G_MININT32, G_MAXINT32)
+
 static void
 gst_audio_quantize_quantize_int_dither_feedback (GstAudioQuantize * quant,
     const gpointer src, gpointer dst, gint samples)
 {
   guint32 mask;
-  gint i, len, stride;
+  gint i, c, len, stride;
   const gint32 *s = src;
   gint32 *dith, *d = dst, v, o, *e, err;
 
@@ -210,18 +240,23 @@ gst_audio_quantize_quantize_int_dither_feedback (GstAudioQuantize * quant,
   e = quant->error_buf;
   mask = ~quant->mask;
 
-  for (i = 0; i < len; i++) {
-    o = v = s[i];
-    /* add dither */
-    err = dith[i];
-    /* remove error */
-    err -= e[i];
-    ADDSS (v, err);
-    v &= mask;
-    /* store new error */
-    e[i + stride] = e[i] + (v - o);
-    /* store result */
-    d[i] = v;
+  /* the error of a channel only depends on the previous error of the same
+   * channel, so the inner loop over the channels of one frame has no
+   * dependencies */
+  for (i = 0; i < len; i += stride) {
+    for (c = 0; c < stride; c++) {
+      o = v = s[i + c];
+      /* add dither */
+      err = dith[i + c];
+      /* remove error */
+      err -= e[i + c];
+      ADDSS (v, err);
+      v &= mask;
+      /* store new error */
+      e[i + c + stride] = e[i + c] + (v - o);
+      /* store result */
+      d[i + c] = v;
+    }
   }
   memmove (e, &e[len], sizeof (gint32) * stride);
 }
@@ -237,9 +272,9 @@ gst_audio_quantize_quantize_int_dither_noise_shape (GstAudioQuantize * quant,
     const gpointer src, gpointer dst, gint samples)
 {
   guint32 mask;
-  gint i, j, k, len, stride, nc;
+  gint i, j, c, len, stride, nc;
   const gint32 *s = src;
-  gint32 *c, *dith, *d = dst, v, o, *e, err;
+  gint32 *coeffs, *dith, *d = dst, v, o, *e, *ef, *err;
 
   nc = quant->n_coeffs;
 
@@ -250,27 +285,35 @@ gst_audio_quantize_quantize_int_dither_noise_shape (GstAudioQuantize * quant,
   len = samples * stride;
   dith = quant->dither_buf;
   e = quant->error_buf;
-  c = quant->coeffs;
+  coeffs = quant->coeffs;
   mask = ~quant->mask;
-
-  for (i = 0; i < len; i++) {
-    v = s[i];
-    /* combine and remove error */
-    err = 0;
-    for (j = 0, k = i; j < nc; j++, k += stride)
-      err -= e[k] * c[j];
-    err = (err + SROUND) >> (SREDUCE);
-    ADDSS (v, err);
-    o = v;
-    /* add dither */
-    err = dith[i];
-    ADDSS (v, err);
-    /* quantize */
-    v &= mask;
-    /* store new error with reduced precision */
-    e[k] = (v - o + RROUND) >> REDUCE;
-    /* store result */
-    d[i] = v;
+  err = g_alloca (stride * sizeof (gint32));
+
+  for (i = 0; i < len; i += stride) {
+    /* combine the past errors of all channels of this frame. The filter is
+     * applied one tap at a time over all channels, which keeps the memory
+     * access contiguous */
+    ef = &e[i];
+    memset (err, 0, stride * sizeof (gint32));
+    for (j = 0; j < nc; j++, ef += stride) {
+      for (c = 0; c < stride; c++)
+        err[c] -= ef[c] * coeffs[j];
+    }
+    /* ef now points to the error slot of the current frame */
+    for (c = 0; c < stride; c++) {
+      v = s[i + c];
+      /* remove error */
+      ADDSS (v, (err[c] + SROUND) >> (SREDUCE));
+      o = v;
+      /* add dither */
+      ADDSS (v, dith[i + c]);
+      /* quantize */
+      v &= mask;
+      /* store new error with reduced precision */
+      ef[c] = (v - o + RROUND) >> REDUCE;
+      /* store result */
+      d[i + c] = v;
+    }
   }
   memmove (e, &e[len], sizeof (gint32) * stride * nc);
 }
@@ -366,9 +409,24 @@ gst_audio_quantize_setup_noise_shaping (GstAudioQuantize * quant)
   return;
 }
 
+static void
+gst_audio_quantize_setup_random (GstAudioQuantize * quant)
+{
+  guint32 seed = 0xdeadbeef;
+  gint l;
+
+  /* give every lane a different, non-zero seed */
+  for (l = 0; l < N_RANDOM_LANES; l++) {
+    seed = seed * 1103515245 + 12345;
+    quant->random_state[l] = seed | 1;
+  }
+}
+
 static void
 gst_audio_quantize_setup_dither (GstAudioQuantize * quant)
 {
+  gst_audio_quantize_setup_random (quant);
+
   switch (quant->dither) {
     case GST_AUDIO_DITHER_TPDF_HF:
       quant->last_random = g_new0 (gint32, quant->stride);
@@ -499,6 +557,8 @@ gst_audio_quantize_reset (GstAudioQuantize * quant)
   g_free (quant->error_buf);
   quant->error_buf = NULL;
   quant->error_size = 0;
+
+  gst_audio_quantize_setup_random (quant);
 }
 
 /**
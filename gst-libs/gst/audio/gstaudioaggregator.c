@@ -82,6 +82,7 @@
 #endif
 
 #include "gstaudioaggregator.h"
+#include "gstaudioutilsprivate.h"
 
 #include <string.h>
 
@@ -124,6 +125,9 @@ struct _GstAudioAggregatorPadPrivate
   guint64 dropped;              /* Number of sampels dropped since the element came out of READY */
 
   gboolean qos_messages;        /* Property to decide to send QoS messages or not */
+
+  GstBuffer *pending_input;     /* input buffer converted ahead of time by the */
+  GstBuffer *pending_converted; /* conversion threads and the result */
 };
 
 
@@ -143,6 +147,8 @@ gst_audio_aggregator_pad_finalize (GObject * object)
   GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) object;
 
   gst_buffer_replace (&pad->priv->buffer, NULL);
+  gst_clear_buffer (&pad->priv->pending_input);
+  gst_clear_buffer (&pad->priv->pending_converted);
 
   G_OBJECT_CLASS (gst_audio_aggregator_pad_parent_class)->finalize (object);
 }
@@ -242,6 +248,8 @@ gst_audio_aggregator_pad_flush_pad (GstAggregatorPad * aggpad,
   pad->priv->output_offset = pad->priv->next_offset = -1;
   pad->priv->discont_time = GST_CLOCK_TIME_NONE;
   gst_buffer_replace (&pad->priv->buffer, NULL);
+  gst_clear_buffer (&pad->priv->pending_input);
+  gst_clear_buffer (&pad->priv->pending_converted);
   gst_audio_aggregator_pad_reset_qos (pad);
   GST_OBJECT_UNLOCK (aggpad);
 
@@ -483,8 +491,32 @@ struct _GstAudioAggregatorPrivate
   /* Only access from src thread */
   /* Messages to post after releasing locks */
   GQueue messages;
+
+  /* Protected by object lock */
+  guint max_threads;
+  gboolean detect_silence;
+
+  /* Only access from the aggregate thread */
+  GstAudioParallelizedTaskRunner *runner;
+  GArray *mix_jobs;
 };
 
+/* A pad buffer to mix into the current output buffer */
+typedef struct
+{
+  GstAudioAggregatorPad *pad;
+  GstBuffer *inbuf;
+  guint in_offset;
+  guint out_start;
+  guint overlap;
+  gint filled;                  /* ATOMIC */
+} GstAudioAggregatorMixJob;
+
+/* Don't bother with threads for mixing a handful of pads or tiny output
+ * buffers, the synchronization costs more than it saves */
+#define MIN_PARALLEL_MIX_JOBS 4
+#define MIN_PARALLEL_MIX_FRAMES 64
+
 #define GST_AUDIO_AGGREGATOR_LOCK(self)   g_mutex_lock (&(self)->priv->mutex);
 #define GST_AUDIO_AGGREGATOR_UNLOCK(self) g_mutex_unlock (&(self)->priv->mutex);
 
@@ -529,6 +561,8 @@ static GstSample *gst_audio_aggregator_peek_next_sample (GstAggregator * agg,
 #define DEFAULT_DISCONT_WAIT (1 * GST_SECOND)
 #define DEFAULT_OUTPUT_BUFFER_DURATION_N (1)
 #define DEFAULT_OUTPUT_BUFFER_DURATION_D (100)
+#define DEFAULT_MAX_THREADS (1)
+#define DEFAULT_DETECT_SILENCE (FALSE)
 
 enum
 {
@@ -537,6 +571,8 @@ enum
   PROP_ALIGNMENT_THRESHOLD,
   PROP_DISCONT_WAIT,
   PROP_OUTPUT_BUFFER_DURATION_FRACTION,
+  PROP_MAX_THREADS,
+  PROP_DETECT_SILENCE,
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GstAudioAggregator, gst_audio_aggregator,
@@ -554,6 +590,78 @@ gst_audio_aggregator_convert_buffer (GstAudioAggregator * aagg, GstPad * pad,
   return klass->convert_buffer (aaggpad, in_info, out_info, buffer);
 }
 
+/* Returns %TRUE if @buffer only contains digital silence */
+static gboolean
+gst_audio_aggregator_buffer_is_silent (const GstAudioInfo * info,
+    GstBuffer * buffer)
+{
+  GstMapInfo map;
+  guint8 silence[8];
+  gsize bps = GST_AUDIO_INFO_WIDTH (info) / 8;
+  gboolean ret = FALSE;
+
+  if (bps == 0 || bps > sizeof (silence))
+    return FALSE;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    return FALSE;
+
+  /* all samples are silent if the first one is and the data repeats every
+   * sample, which lets memcmp() do the heavy lifting */
+  if (map.size >= bps) {
+    gst_audio_format_info_fill_silence (info->finfo, silence, bps);
+    ret = memcmp (map.data, silence, bps) == 0
+        && memcmp (map.data, map.data + bps, map.size - bps) == 0;
+  }
+
+  gst_buffer_unmap (buffer, &map);
+
+  return ret;
+}
+
+/* Called with the pad object lock.
+ *
+ * Returns the buffer to mix for @input_buffer. GAP buffers, and with
+ * @detect_silence buffers that only contain silence, are skipped while
+ * mixing. Instead of converting them, an empty GAP buffer covering the same
+ * time is returned. */
+static GstBuffer *
+gst_audio_aggregator_pad_prepare_buffer (GstAudioAggregator * aagg,
+    GstAudioAggregatorPad * pad, GstAudioInfo * out_info,
+    GstBuffer * input_buffer, gboolean detect_silence)
+{
+  gboolean gap = GST_BUFFER_FLAG_IS_SET (input_buffer, GST_BUFFER_FLAG_GAP);
+
+  if (!gap && detect_silence
+      && gst_audio_aggregator_buffer_is_silent (&pad->info, input_buffer)) {
+    GST_LOG_OBJECT (pad, "skipping silent buffer %" GST_PTR_FORMAT,
+        input_buffer);
+    gap = TRUE;
+  }
+
+  if (gap) {
+    GstBuffer *buffer = gst_buffer_new ();
+    guint64 frames =
+        gst_buffer_get_size (input_buffer) / GST_AUDIO_INFO_BPF (&pad->info);
+
+    gst_buffer_copy_into (buffer, input_buffer,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
+    /* the size in frames is recalculated from the duration */
+    if (frames > 0)
+      GST_BUFFER_DURATION (buffer) = gst_util_uint64_scale_ceil (frames,
+          GST_SECOND, GST_AUDIO_INFO_RATE (&pad->info));
+
+    return buffer;
+  }
+
+  if (GST_AUDIO_AGGREGATOR_PAD_GET_CLASS (pad)->convert_buffer)
+    return gst_audio_aggregator_convert_buffer (aagg, GST_PAD (pad),
+        &pad->info, out_info, input_buffer);
+
+  return gst_buffer_ref (input_buffer);
+}
+
 static void
 gst_audio_aggregator_translate_output_buffer_duration (GstAudioAggregator *
     aagg, GstClockTime duration)
@@ -698,6 +806,44 @@ gst_audio_aggregator_class_init (GstAudioAggregatorClass * klass)
           "creating a discontinuity", 0,
           G_MAXUINT64 - 1, DEFAULT_DISCONT_WAIT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioAggregator:max-threads:
+   *
+   * Maximum number of threads to use for converting and mixing the input
+   * buffers of the sink pads, 0 uses one thread per CPU core.
+   *
+   * When using more than one thread, the output buffer is split into
+   * ranges of frames that are mixed in parallel, so
+   * #GstAudioAggregatorClass.aggregate_one_buffer can be called
+   * concurrently for different output ranges and must not hold locks
+   * while mixing.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_THREADS,
+      g_param_spec_uint ("max-threads", "Maximum Threads",
+          "Maximum number of threads to use for mixing (0 = auto)", 0,
+          G_MAXINT, DEFAULT_MAX_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioAggregator:detect-silence:
+   *
+   * Check input buffers for digital silence and skip them like GAP buffers.
+   * Neither conversion nor mixing is done for them, and if all inputs are
+   * silent the output buffer is flagged as GAP.
+   *
+   * Checking the buffers has a small cost, so this is only worth enabling if
+   * many of the inputs are expected to be silent, e.g. muted participants of
+   * a conference.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DETECT_SILENCE,
+      g_param_spec_boolean ("detect-silence", "Detect Silence",
+          "Skip input buffers that only contain silence like GAP buffers",
+          DEFAULT_DETECT_SILENCE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -709,6 +855,10 @@ gst_audio_aggregator_init (GstAudioAggregator * aagg)
 
   aagg->priv->alignment_threshold = DEFAULT_ALIGNMENT_THRESHOLD;
   aagg->priv->discont_wait = DEFAULT_DISCONT_WAIT;
+  aagg->priv->max_threads = DEFAULT_MAX_THREADS;
+  aagg->priv->detect_silence = DEFAULT_DETECT_SILENCE;
+  aagg->priv->mix_jobs =
+      g_array_new (FALSE, FALSE, sizeof (GstAudioAggregatorMixJob));
 
   gst_audio_aggregator_translate_output_buffer_duration (aagg,
       DEFAULT_OUTPUT_BUFFER_DURATION);
@@ -730,6 +880,9 @@ gst_audio_aggregator_dispose (GObject * object)
   gst_caps_replace (&aagg->current_caps, NULL);
 
   gst_clear_structure (&aagg->priv->selected_samples_info);
+  g_clear_pointer (&aagg->priv->runner,
+      __gst_audio_parallelized_task_runner_free);
+  g_clear_pointer (&aagg->priv->mix_jobs, g_array_unref);
 
   g_mutex_clear (&aagg->priv->mutex);
 
@@ -763,6 +916,16 @@ gst_audio_aggregator_set_property (GObject * object, guint prop_id,
       g_object_notify (object, "output-buffer-duration");
       gst_audio_aggregator_recalculate_latency (aagg);
       break;
+    case PROP_MAX_THREADS:
+      GST_OBJECT_LOCK (aagg);
+      aagg->priv->max_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
+    case PROP_DETECT_SILENCE:
+      GST_OBJECT_LOCK (aagg);
+      aagg->priv->detect_silence = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -791,6 +954,16 @@ gst_audio_aggregator_get_property (GObject * object, guint prop_id,
       gst_value_set_fraction (value, aagg->priv->output_buffer_duration_n,
           aagg->priv->output_buffer_duration_d);
       break;
+    case PROP_MAX_THREADS:
+      GST_OBJECT_LOCK (aagg);
+      g_value_set_uint (value, aagg->priv->max_threads);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
+    case PROP_DETECT_SILENCE:
+      GST_OBJECT_LOCK (aagg);
+      g_value_set_boolean (value, aagg->priv->detect_silence);
+      GST_OBJECT_UNLOCK (aagg);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1145,8 +1318,10 @@ gst_audio_aggregator_update_converters (GstAudioAggregator * aagg,
       klass->update_conversion_info (aaggpad);
 
     /* If we currently were mixing a buffer, we need to convert it to the new
-     * format */
-    if (aaggpad->priv->buffer) {
+     * format. GAP buffers are skipped anyway */
+    if (aaggpad->priv->buffer
+        && !GST_BUFFER_FLAG_IS_SET (aaggpad->priv->buffer,
+            GST_BUFFER_FLAG_GAP)) {
       GstBuffer *new_converted_buffer =
           gst_audio_aggregator_convert_buffer (aagg, GST_PAD (aaggpad),
           old_info, new_info, aaggpad->priv->buffer);
@@ -1604,6 +1779,11 @@ gst_audio_aggregator_stop (GstAggregator * agg)
 
   gst_audio_aggregator_reset (aagg);
 
+  GST_AUDIO_AGGREGATOR_LOCK (aagg);
+  g_clear_pointer (&aagg->priv->runner,
+      __gst_audio_parallelized_task_runner_free);
+  GST_AUDIO_AGGREGATOR_UNLOCK (aagg);
+
   return TRUE;
 }
 
@@ -1961,18 +2141,18 @@ done:
   return TRUE;
 }
 
-/* Called with pad object lock held */
-
+/* Called with pad object lock held.
+ *
+ * Prepares mixing the current buffer of @pad into the output buffer. Returns
+ * FALSE if the buffer is a GAP buffer, which was skipped and can be
+ * dropped. */
 static gboolean
-gst_audio_aggregator_mix_buffer (GstAudioAggregator * aagg,
-    GstAudioAggregatorPad * pad, GstBuffer * inbuf, GstBuffer * outbuf,
-    guint blocksize)
+gst_audio_aggregator_prepare_mix (GstAudioAggregator * aagg,
+    GstAudioAggregatorPad * pad, guint blocksize,
+    GstAudioAggregatorMixJob * job)
 {
   guint overlap;
   guint out_start;
-  gboolean filled;
-  guint in_offset;
-  gboolean pad_changed = FALSE;
 
   /* Overlap => mix */
   if (aagg->priv->offset < pad->priv->output_offset)
@@ -1984,7 +2164,7 @@ gst_audio_aggregator_mix_buffer (GstAudioAggregator * aagg,
   if (overlap > blocksize - out_start)
     overlap = blocksize - out_start;
 
-  if (GST_BUFFER_FLAG_IS_SET (inbuf, GST_BUFFER_FLAG_GAP)) {
+  if (GST_BUFFER_FLAG_IS_SET (pad->priv->buffer, GST_BUFFER_FLAG_GAP)) {
     /* skip gap buffer */
     GST_LOG_OBJECT (pad, "skipping GAP buffer");
     pad->priv->output_offset += pad->priv->size - pad->priv->position;
@@ -1994,29 +2174,35 @@ gst_audio_aggregator_mix_buffer (GstAudioAggregator * aagg,
     return FALSE;
   }
 
-  gst_buffer_ref (inbuf);
-  in_offset = pad->priv->position;
-  GST_OBJECT_UNLOCK (pad);
-  GST_OBJECT_UNLOCK (aagg);
-
-  filled = GST_AUDIO_AGGREGATOR_GET_CLASS (aagg)->aggregate_one_buffer (aagg,
-      pad, inbuf, in_offset, outbuf, out_start, overlap);
+  job->pad = gst_object_ref (pad);
+  job->inbuf = gst_buffer_ref (pad->priv->buffer);
+  job->in_offset = pad->priv->position;
+  job->out_start = out_start;
+  job->overlap = overlap;
+  job->filled = FALSE;
 
-  GST_OBJECT_LOCK (aagg);
-  GST_OBJECT_LOCK (pad);
+  return TRUE;
+}
 
-  pad_changed = (inbuf != pad->priv->buffer);
-  gst_buffer_unref (inbuf);
+/* Called with pad object lock held.
+ *
+ * Updates the position of the pad after its buffer was mixed. Returns FALSE
+ * if the buffer is completely used and can be dropped */
+static gboolean
+gst_audio_aggregator_finish_mix (GstAudioAggregator * aagg,
+    GstAudioAggregatorMixJob * job, GstBuffer * outbuf)
+{
+  GstAudioAggregatorPad *pad = job->pad;
 
-  if (filled)
+  if (g_atomic_int_get (&job->filled))
     GST_BUFFER_FLAG_UNSET (outbuf, GST_BUFFER_FLAG_GAP);
 
-  if (pad_changed)
+  if (job->inbuf != pad->priv->buffer)
     return FALSE;
 
-  pad->priv->processed += overlap;
-  pad->priv->position += overlap;
-  pad->priv->output_offset += overlap;
+  pad->priv->processed += job->overlap;
+  pad->priv->position += job->overlap;
+  pad->priv->output_offset += job->overlap;
 
   if (pad->priv->position == pad->priv->size) {
     /* Buffer done, drop it */
@@ -2028,6 +2214,198 @@ gst_audio_aggregator_mix_buffer (GstAudioAggregator * aagg,
   return TRUE;
 }
 
+typedef struct
+{
+  GstAudioAggregator *aagg;
+  GstBuffer *outbuf;
+  GstAudioAggregatorMixJob *jobs;
+  guint n_jobs;
+  /* range of output frames handled by this task */
+  guint start, end;
+} GstAudioAggregatorMixTask;
+
+static void
+gst_audio_aggregator_mix_task (gpointer user_data)
+{
+  GstAudioAggregatorMixTask *task = user_data;
+  GstAudioAggregatorClass *klass = GST_AUDIO_AGGREGATOR_GET_CLASS (task->aagg);
+  guint i;
+
+  for (i = 0; i < task->n_jobs; i++) {
+    GstAudioAggregatorMixJob *job = &task->jobs[i];
+    guint start = MAX (job->out_start, task->start);
+    guint end = MIN (job->out_start + job->overlap, task->end);
+
+    if (start >= end)
+      continue;
+
+    if (klass->aggregate_one_buffer (task->aagg, job->pad, job->inbuf,
+            job->in_offset + (start - job->out_start), task->outbuf, start,
+            end - start))
+      g_atomic_int_set (&job->filled, TRUE);
+  }
+}
+
+/* Called without any locks but the aagg lock.
+ *
+ * Mixes all prepared jobs into @outbuf. With multiple threads, every thread
+ * handles all pads for a separate range of the output buffer so that no
+ * synchronization is needed between them */
+static void
+gst_audio_aggregator_run_mix_jobs (GstAudioAggregator * aagg,
+    GstBuffer * outbuf, guint blocksize)
+{
+  GArray *jobs = aagg->priv->mix_jobs;
+  GstAudioAggregatorMixTask *tasks;
+  gpointer *tasks_p;
+  guint i, n_tasks = 1;
+
+  if (jobs->len == 0)
+    return;
+
+  if (aagg->priv->runner && jobs->len >= MIN_PARALLEL_MIX_JOBS) {
+    n_tasks =
+        __gst_audio_parallelized_task_runner_get_n_threads (aagg->priv->runner);
+    n_tasks = CLAMP (blocksize / MIN_PARALLEL_MIX_FRAMES, 1, n_tasks);
+  }
+
+  tasks = g_newa (GstAudioAggregatorMixTask, n_tasks);
+  tasks_p = g_newa (gpointer, n_tasks);
+  for (i = 0; i < n_tasks; i++) {
+    tasks[i].aagg = aagg;
+    tasks[i].outbuf = outbuf;
+    tasks[i].jobs = (GstAudioAggregatorMixJob *) jobs->data;
+    tasks[i].n_jobs = jobs->len;
+    tasks[i].start = (guint64) blocksize * i / n_tasks;
+    tasks[i].end = (guint64) blocksize * (i + 1) / n_tasks;
+    tasks_p[i] = &tasks[i];
+  }
+
+  if (n_tasks == 1)
+    gst_audio_aggregator_mix_task (tasks_p[0]);
+  else
+    __gst_audio_parallelized_task_runner_run (aagg->priv->runner,
+        gst_audio_aggregator_mix_task, tasks_p, n_tasks);
+}
+
+typedef struct
+{
+  GstAudioAggregator *aagg;
+  GPtrArray *pads;
+  guint index, n_tasks;
+  gboolean detect_silence;
+} GstAudioAggregatorConvertTask;
+
+static void
+gst_audio_aggregator_convert_task (gpointer user_data)
+{
+  GstAudioAggregatorConvertTask *task = user_data;
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR (task->aagg)->srcpad);
+  guint i;
+
+  for (i = task->index; i < task->pads->len; i += task->n_tasks) {
+    GstAudioAggregatorPad *pad = g_ptr_array_index (task->pads, i);
+
+    GST_OBJECT_LOCK (pad);
+    if (pad->priv->pending_input && !pad->priv->pending_converted)
+      pad->priv->pending_converted =
+          gst_audio_aggregator_pad_prepare_buffer (task->aagg, pad,
+          &srcpad->info, pad->priv->pending_input, task->detect_silence);
+    GST_OBJECT_UNLOCK (pad);
+  }
+}
+
+/* Called with the object lock and the aagg lock.
+ *
+ * Converts the next input buffer of all pads that need a new buffer on
+ * multiple threads. The results are picked up by the aggregate function. */
+static void
+gst_audio_aggregator_convert_parallel (GstAudioAggregator * aagg)
+{
+  GstAudioAggregatorConvertTask *tasks;
+  gpointer *tasks_p;
+  GPtrArray *pads;
+  GList *iter;
+  guint i, n_tasks;
+
+  pads = g_ptr_array_new_with_free_func (gst_object_unref);
+
+  for (iter = GST_ELEMENT (aagg)->sinkpads; iter; iter = iter->next) {
+    GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) iter->data;
+    GstBuffer *input_buffer;
+    gboolean need_buffer;
+
+    if (!GST_AUDIO_AGGREGATOR_PAD_GET_CLASS (pad)->convert_buffer)
+      continue;
+
+    GST_OBJECT_LOCK (pad);
+    need_buffer = pad->priv->buffer == NULL && pad->priv->pending_input == NULL
+        && GST_AUDIO_INFO_IS_VALID (&pad->info);
+    GST_OBJECT_UNLOCK (pad);
+
+    if (!need_buffer)
+      continue;
+
+    input_buffer = gst_aggregator_pad_peek_buffer (GST_AGGREGATOR_PAD (pad));
+    if (!input_buffer)
+      continue;
+
+    GST_OBJECT_LOCK (pad);
+    pad->priv->pending_input = input_buffer;
+    GST_OBJECT_UNLOCK (pad);
+
+    g_ptr_array_add (pads, gst_object_ref (pad));
+  }
+
+  if (pads->len > 1) {
+    n_tasks =
+        __gst_audio_parallelized_task_runner_get_n_threads (aagg->priv->runner);
+    n_tasks = MIN (n_tasks, pads->len);
+
+    tasks = g_newa (GstAudioAggregatorConvertTask, n_tasks);
+    tasks_p = g_newa (gpointer, n_tasks);
+    for (i = 0; i < n_tasks; i++) {
+      tasks[i].aagg = aagg;
+      tasks[i].pads = pads;
+      tasks[i].index = i;
+      tasks[i].n_tasks = n_tasks;
+      tasks[i].detect_silence = aagg->priv->detect_silence;
+      tasks_p[i] = &tasks[i];
+    }
+
+    __gst_audio_parallelized_task_runner_run (aagg->priv->runner,
+        gst_audio_aggregator_convert_task, tasks_p, n_tasks);
+  }
+
+  g_ptr_array_unref (pads);
+}
+
+/* Called with the aagg lock */
+static void
+gst_audio_aggregator_update_runner (GstAudioAggregator * aagg)
+{
+  guint n_threads;
+
+  GST_OBJECT_LOCK (aagg);
+  n_threads = aagg->priv->max_threads;
+  GST_OBJECT_UNLOCK (aagg);
+
+  if (n_threads == 0 || n_threads > g_get_num_processors ())
+    n_threads = g_get_num_processors ();
+
+  if (aagg->priv->runner &&
+      __gst_audio_parallelized_task_runner_get_n_threads (aagg->priv->runner)
+      != n_threads)
+    g_clear_pointer (&aagg->priv->runner,
+        __gst_audio_parallelized_task_runner_free);
+
+  if (!aagg->priv->runner && n_threads > 1) {
+    GST_DEBUG_OBJECT (aagg, "Mixing with %u threads", n_threads);
+    aagg->priv->runner = __gst_audio_parallelized_task_runner_new (n_threads);
+  }
+}
+
 static GstBuffer *
 gst_audio_aggregator_create_output_buffer (GstAudioAggregator * aagg,
     guint num_frames)
@@ -2139,6 +2517,7 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
   GstElement *element;
   GstAudioAggregator *aagg;
   GList *iter;
+  guint i;
   GstFlowReturn ret;
   GstBuffer *outbuf = NULL;
   gint64 next_offset;
@@ -2158,6 +2537,7 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
   gst_element_foreach_sink_pad (element, sync_pad_values, NULL);
 
   GST_AUDIO_AGGREGATOR_LOCK (aagg);
+  gst_audio_aggregator_update_runner (aagg);
   GST_OBJECT_LOCK (agg);
 
   if (aagg->priv->samples_per_buffer == 0) {
@@ -2265,6 +2645,9 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
       " with timestamp %" GST_TIME_FORMAT, blocksize,
       aagg->priv->offset, GST_TIME_ARGS (agg_segment->position));
 
+  if (aagg->priv->runner)
+    gst_audio_aggregator_convert_parallel (aagg);
+
   for (iter = element->sinkpads; iter; iter = iter->next) {
     GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) iter->data;
     GstAggregatorPad *aggpad = (GstAggregatorPad *) iter->data;
@@ -2299,12 +2682,15 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
 
     /* New buffer? */
     if (!pad->priv->buffer) {
-      if (GST_AUDIO_AGGREGATOR_PAD_GET_CLASS (pad)->convert_buffer)
-        pad->priv->buffer =
-            gst_audio_aggregator_convert_buffer
-            (aagg, GST_PAD (pad), &pad->info, &srcpad->info, input_buffer);
+      if (pad->priv->pending_converted
+          && pad->priv->pending_input == input_buffer)
+        pad->priv->buffer = g_steal_pointer (&pad->priv->pending_converted);
       else
-        pad->priv->buffer = gst_buffer_ref (input_buffer);
+        pad->priv->buffer =
+            gst_audio_aggregator_pad_prepare_buffer (aagg, pad, &srcpad->info,
+            input_buffer, aagg->priv->detect_silence);
+      gst_clear_buffer (&pad->priv->pending_input);
+      gst_clear_buffer (&pad->priv->pending_converted);
 
       if (!gst_audio_aggregator_fill_buffer (aagg, pad)) {
         gst_buffer_replace (&pad->priv->buffer, NULL);
@@ -2377,6 +2763,7 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
   }
 
   GST_OBJECT_LOCK (agg);
+  g_array_set_size (aagg->priv->mix_jobs, 0);
   for (iter = element->sinkpads; iter; iter = iter->next) {
     GstAudioAggregatorPad *pad = (GstAudioAggregatorPad *) iter->data;
     GstAggregatorPad *aggpad = (GstAggregatorPad *) iter->data;
@@ -2385,29 +2772,52 @@ gst_audio_aggregator_aggregate (GstAggregator * agg, gboolean timeout)
 
     if (pad->priv->buffer && pad->priv->output_offset >= aagg->priv->offset
         && pad->priv->output_offset < aagg->priv->offset + blocksize) {
-      gboolean drop_buf;
+      GstAudioAggregatorMixJob job;
 
       GST_LOG_OBJECT (aggpad, "Mixing buffer for current offset");
-      drop_buf = !gst_audio_aggregator_mix_buffer (aagg, pad, pad->priv->buffer,
-          outbuf, blocksize);
-      if (pad->priv->output_offset >= next_offset) {
-        GST_LOG_OBJECT (pad,
-            "Pad is at or after current offset: %" G_GUINT64_FORMAT " >= %"
-            G_GINT64_FORMAT, pad->priv->output_offset, next_offset);
-      } else {
-        is_done = FALSE;
-      }
-      if (drop_buf) {
+      if (!gst_audio_aggregator_prepare_mix (aagg, pad, blocksize, &job)) {
+        if (pad->priv->output_offset < next_offset)
+          is_done = FALSE;
         GST_OBJECT_UNLOCK (pad);
         gst_aggregator_pad_drop_buffer (aggpad);
         continue;
       }
+      g_array_append_val (aagg->priv->mix_jobs, job);
     }
 
     GST_OBJECT_UNLOCK (pad);
   }
   GST_OBJECT_UNLOCK (agg);
 
+  gst_audio_aggregator_run_mix_jobs (aagg, outbuf, blocksize);
+
+  GST_OBJECT_LOCK (agg);
+  for (i = 0; i < aagg->priv->mix_jobs->len; i++) {
+    GstAudioAggregatorMixJob *job =
+        &g_array_index (aagg->priv->mix_jobs, GstAudioAggregatorMixJob, i);
+    GstAudioAggregatorPad *pad = job->pad;
+    gboolean drop_buf;
+
+    GST_OBJECT_LOCK (pad);
+    drop_buf = !gst_audio_aggregator_finish_mix (aagg, job, outbuf);
+    if (pad->priv->output_offset >= next_offset) {
+      GST_LOG_OBJECT (pad,
+          "Pad is at or after current offset: %" G_GUINT64_FORMAT " >= %"
+          G_GINT64_FORMAT, pad->priv->output_offset, next_offset);
+    } else {
+      is_done = FALSE;
+    }
+    GST_OBJECT_UNLOCK (pad);
+
+    if (drop_buf)
+      gst_aggregator_pad_drop_buffer (GST_AGGREGATOR_PAD (pad));
+
+    gst_buffer_unref (job->inbuf);
+    gst_object_unref (job->pad);
+  }
+  g_array_set_size (aagg->priv->mix_jobs, 0);
+  GST_OBJECT_UNLOCK (agg);
+
   if (dropped) {
     /* We dropped a buffer, retry */
     GST_LOG_OBJECT (aagg, "A pad dropped a buffer, wait for the next one");
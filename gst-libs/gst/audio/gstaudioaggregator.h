@@ -193,7 +193,11 @@ struct _GstAudioAggregator
  * @aggregate_one_buffer: Aggregates one input buffer to the output
  *  buffer.  The in_offset and out_offset are in "frames", which is
  *  the size of a sample times the number of channels. Returns TRUE if
- *  any non-silence was added to the buffer
+ *  any non-silence was added to the buffer.  When
+ *  #GstAudioAggregator:max-threads is larger than 1 this can be called
+ *  concurrently from several threads, for different pads and for
+ *  non-overlapping ranges of the same output buffer, so implementations
+ *  must not modify shared state without their own locking.
  *
  * Since: 1.14
  */
@@ -143,7 +143,9 @@ enum
   PROP_LATENCY,
   PROP_TOLERANCE,
   PROP_PLC,
-  PROP_MAX_ERRORS
+  PROP_MAX_ERRORS,
+  PROP_STATS,
+  PROP_BATCH_SIZE
 };
 
 #define DEFAULT_LATENCY    0
@@ -152,6 +154,7 @@ enum
 #define DEFAULT_DRAINABLE  TRUE
 #define DEFAULT_NEEDS_FORMAT  FALSE
 #define DEFAULT_MAX_ERRORS GST_AUDIO_DECODER_MAX_ERRORS
+#define DEFAULT_BATCH_SIZE 1
 
 typedef struct _GstAudioDecoderContext
 {
@@ -183,6 +186,10 @@ typedef struct _GstAudioDecoderContext
 
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* output buffer pool, configured and activated on first use */
+  GstBufferPool *pool;
+  guint pool_size, pool_min, pool_max;
 } GstAudioDecoderContext;
 
 struct _GstAudioDecoderPrivate
@@ -204,6 +211,8 @@ struct _GstAudioDecoderPrivate
   GQueue frames;
   /* collected output data */
   GstAdapter *adapter_out;
+  /* decoded buffers waiting to be pushed as a list */
+  GstBufferList *batch;
   /* ts and duration for output data collected above */
   GstClockTime out_ts, out_dur;
   /* mark outgoing discont */
@@ -237,6 +246,16 @@ struct _GstAudioDecoderPrivate
   /* max errors */
   gint max_errors;
 
+  /* per-frame statistics (with LOCK) */
+  guint64 frames_handled;
+  GstClockTime frame_time_min;
+  GstClockTime frame_time_max;
+  GstClockTime frame_time_total;
+  guint64 pooled_buffers;
+  guint64 allocated_buffers;
+  /* time spent pushing downstream, excluded from the frame time */
+  GstClockTime push_time;
+
   /* upstream stream tags (global tags are passed through as-is) */
   GstTagList *upstream_tags;
 
@@ -266,6 +285,7 @@ struct _GstAudioDecoderPrivate
   gboolean plc;
   gboolean drainable;
   gboolean needs_format;
+  guint batch_size;
 
   /* pending serialized sink events, will be sent from finish_frame() */
   GList *pending_events;
@@ -302,6 +322,9 @@ static gboolean gst_audio_decoder_sink_setcaps (GstAudioDecoder * dec,
     GstCaps * caps);
 static GstFlowReturn gst_audio_decoder_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buf);
+static GstFlowReturn gst_audio_decoder_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
+static GstFlowReturn gst_audio_decoder_push_batch (GstAudioDecoder * dec);
 static gboolean gst_audio_decoder_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 static gboolean gst_audio_decoder_sink_query (GstPad * pad, GstObject * parent,
@@ -429,6 +452,49 @@ gst_audio_decoder_class_init (GstAudioDecoderClass * klass)
           -1, G_MAXINT, DEFAULT_MAX_ERRORS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioDecoder:stats:
+   *
+   * Various decoder statistics. This property returns a #GstStructure
+   * with name "application/x-gst-audio-decoder-stats" and the following
+   * fields:
+   *
+   * - "frames" G_TYPE_UINT64: number of frames handed to the subclass
+   * - "frame-time-min" G_TYPE_UINT64: shortest time spent decoding a frame
+   * - "frame-time-max" G_TYPE_UINT64: longest time spent decoding a frame
+   * - "frame-time-average" G_TYPE_UINT64: average time spent decoding a frame
+   * - "pooled-buffers" G_TYPE_UINT64: output buffers taken from the pool
+   * - "allocated-buffers" G_TYPE_UINT64: output buffers allocated outside
+   *   of the pool
+   *
+   * Frame times are in nanoseconds and do not include the time spent
+   * pushing the decoded data downstream.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Decoder Statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioDecoder:batch-size:
+   *
+   * Number of decoded buffers to collect and push downstream together as
+   * a #GstBufferList. Each buffer keeps its own timestamps. Collected
+   * buffers are pushed before any serialized event and at the end of each
+   * incoming buffer list, but otherwise held until the batch is complete,
+   * which adds up to @batch-size - 1 frames of latency. Meant for
+   * non-live decoding of many small frames.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_SIZE,
+      g_param_spec_uint ("batch-size", "Batch Size",
+          "Number of decoded buffers to push downstream as one buffer list",
+          1, G_MAXUINT, DEFAULT_BATCH_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   audiodecoder_class->sink_event =
       GST_DEBUG_FUNCPTR (gst_audio_decoder_sink_eventfunc);
   audiodecoder_class->src_event =
@@ -468,6 +534,8 @@ gst_audio_decoder_init (GstAudioDecoder * dec, GstAudioDecoderClass * klass)
       GST_DEBUG_FUNCPTR (gst_audio_decoder_sink_event));
   gst_pad_set_chain_function (dec->sinkpad,
       GST_DEBUG_FUNCPTR (gst_audio_decoder_chain));
+  gst_pad_set_chain_list_function (dec->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_audio_decoder_chain_list));
   gst_pad_set_query_function (dec->sinkpad,
       GST_DEBUG_FUNCPTR (gst_audio_decoder_sink_query));
   gst_element_add_pad (GST_ELEMENT (dec), dec->sinkpad);
@@ -499,6 +567,7 @@ gst_audio_decoder_init (GstAudioDecoder * dec, GstAudioDecoderClass * klass)
   dec->priv->drainable = DEFAULT_DRAINABLE;
   dec->priv->needs_format = DEFAULT_NEEDS_FORMAT;
   dec->priv->max_errors = GST_AUDIO_DECODER_MAX_ERRORS;
+  dec->priv->batch_size = DEFAULT_BATCH_SIZE;
 
   /* init state */
   dec->priv->ctx.min_latency = 0;
@@ -519,7 +588,14 @@ gst_audio_decoder_reset (GstAudioDecoder * dec, gboolean full)
     GST_OBJECT_LOCK (dec);
     dec->priv->bytes_in = 0;
     dec->priv->samples_out = 0;
+    dec->priv->frames_handled = 0;
+    dec->priv->frame_time_min = GST_CLOCK_TIME_NONE;
+    dec->priv->frame_time_max = 0;
+    dec->priv->frame_time_total = 0;
+    dec->priv->pooled_buffers = 0;
+    dec->priv->allocated_buffers = 0;
     GST_OBJECT_UNLOCK (dec);
+    dec->priv->push_time = 0;
     dec->priv->agg = -1;
     dec->priv->error_count = 0;
     gst_audio_decoder_clear_queues (dec);
@@ -545,6 +621,10 @@ gst_audio_decoder_reset (GstAudioDecoder * dec, gboolean full)
 
     if (dec->priv->ctx.allocator)
       gst_object_unref (dec->priv->ctx.allocator);
+    if (dec->priv->ctx.pool) {
+      gst_buffer_pool_set_active (dec->priv->ctx.pool, FALSE);
+      gst_object_unref (dec->priv->ctx.pool);
+    }
 
     GST_OBJECT_LOCK (dec);
     dec->priv->decode_flags_override = FALSE;
@@ -626,6 +706,13 @@ gst_audio_decoder_create_merged_tags_event (GstAudioDecoder * dec)
 static gboolean
 gst_audio_decoder_push_event (GstAudioDecoder * dec, GstEvent * event)
 {
+  /* keep serialized events behind the data decoded before them */
+  if (GST_EVENT_IS_SERIALIZED (event)) {
+    GST_AUDIO_DECODER_STREAM_LOCK (dec);
+    gst_audio_decoder_push_batch (dec);
+    GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
+  }
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_SEGMENT:{
       GstSegment seg;
@@ -658,6 +745,8 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
   GstQuery *query = NULL;
   GstAllocator *allocator;
   GstAllocationParams params;
+  GstBufferPool *pool;
+  guint size, min, max;
 
   g_return_val_if_fail (GST_IS_AUDIO_DECODER (dec), FALSE);
   g_return_val_if_fail (GST_AUDIO_INFO_IS_VALID (&dec->priv->ctx.info), FALSE);
@@ -692,6 +781,9 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
     }
   }
 
+  /* data decoded in the previous format goes out first */
+  gst_audio_decoder_push_batch (dec);
+
   prevcaps = gst_pad_get_current_caps (dec->srcpad);
   if (!prevcaps || !gst_caps_is_equal (prevcaps, caps))
     res = gst_pad_set_caps (dec->srcpad, caps);
@@ -730,6 +822,22 @@ gst_audio_decoder_negotiate_default (GstAudioDecoder * dec)
   dec->priv->ctx.allocator = allocator;
   dec->priv->ctx.params = params;
 
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+  }
+
+  if (dec->priv->ctx.pool) {
+    gst_buffer_pool_set_active (dec->priv->ctx.pool, FALSE);
+    gst_object_unref (dec->priv->ctx.pool);
+  }
+  dec->priv->ctx.pool = pool;
+  dec->priv->ctx.pool_size = size;
+  dec->priv->ctx.pool_min = min;
+  dec->priv->ctx.pool_max = max;
+
 done:
 
   if (query)
@@ -964,7 +1072,7 @@ gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
   GstAudioDecoderPrivate *priv;
   GstAudioDecoderContext *ctx;
   GstFlowReturn ret = GST_FLOW_OK;
-  GstClockTime ts;
+  GstClockTime ts, start;
 
   klass = GST_AUDIO_DECODER_GET_CLASS (dec);
   priv = dec->priv;
@@ -1037,12 +1145,48 @@ gst_audio_decoder_push_forward (GstAudioDecoder * dec, GstBuffer * buf)
       GST_TIME_ARGS (GST_BUFFER_PTS (buf)),
       GST_TIME_ARGS (GST_BUFFER_DURATION (buf)));
 
+  if (priv->batch_size > 1 || priv->batch) {
+    if (!priv->batch)
+      priv->batch = gst_buffer_list_new_sized (priv->batch_size);
+    gst_buffer_list_add (priv->batch, buf);
+    if (gst_buffer_list_length (priv->batch) >= priv->batch_size)
+      ret = gst_audio_decoder_push_batch (dec);
+    goto exit;
+  }
+
+  start = gst_util_get_timestamp ();
   ret = gst_pad_push (dec->srcpad, buf);
+  priv->push_time += gst_util_get_timestamp () - start;
 
 exit:
   return ret;
 }
 
+/* call with STREAM_LOCK */
+static GstFlowReturn
+gst_audio_decoder_push_batch (GstAudioDecoder * dec)
+{
+  GstAudioDecoderPrivate *priv = dec->priv;
+  GstBufferList *list;
+  GstClockTime start;
+  GstFlowReturn ret;
+
+  if (!priv->batch)
+    return GST_FLOW_OK;
+
+  list = priv->batch;
+  priv->batch = NULL;
+
+  GST_LOG_OBJECT (dec, "pushing batch of %u buffers",
+      gst_buffer_list_length (list));
+
+  start = gst_util_get_timestamp ();
+  ret = gst_pad_push_list (dec->srcpad, list);
+  priv->push_time += gst_util_get_timestamp () - start;
+
+  return ret;
+}
+
 /* mini aggregator combining output buffers into fewer larger ones,
  * if so allowed/configured */
 static GstFlowReturn
@@ -1598,6 +1742,9 @@ static GstFlowReturn
 gst_audio_decoder_handle_frame (GstAudioDecoder * dec,
     GstAudioDecoderClass * klass, GstBuffer * buffer)
 {
+  GstClockTime start, push_time, elapsed;
+  GstFlowReturn ret;
+
   /* Skip decoding and send a GAP instead if
    * GST_SEGMENT_FLAG_TRICKMODE_NO_AUDIO is set and we have timestamps
    * FIXME: We only do this for forward playback atm, because reverse
@@ -1632,9 +1779,28 @@ gst_audio_decoder_handle_frame (GstAudioDecoder * dec,
     GST_OBJECT_UNLOCK (dec);
   } else {
     GST_LOG_OBJECT (dec, "providing subclass with NULL frame");
+    return klass->handle_frame (dec, buffer);
   }
 
-  return klass->handle_frame (dec, buffer);
+  start = gst_util_get_timestamp ();
+  push_time = dec->priv->push_time;
+
+  ret = klass->handle_frame (dec, buffer);
+
+  elapsed = gst_util_get_timestamp () - start;
+  elapsed -= MIN (elapsed, dec->priv->push_time - push_time);
+
+  GST_OBJECT_LOCK (dec);
+  dec->priv->frames_handled++;
+  dec->priv->frame_time_total += elapsed;
+  if (!GST_CLOCK_TIME_IS_VALID (dec->priv->frame_time_min) ||
+      elapsed < dec->priv->frame_time_min)
+    dec->priv->frame_time_min = elapsed;
+  if (elapsed > dec->priv->frame_time_max)
+    dec->priv->frame_time_max = elapsed;
+  GST_OBJECT_UNLOCK (dec);
+
+  return ret;
 }
 
 /* maybe subclass configurable instead, but this allows for a whole lot of
@@ -1830,6 +1996,7 @@ gst_audio_decoder_flush (GstAudioDecoder * dec, gboolean hard)
 static GstFlowReturn
 gst_audio_decoder_chain_forward (GstAudioDecoder * dec, GstBuffer * buffer)
 {
+  GstAudioDecoderClass *klass = GST_AUDIO_DECODER_GET_CLASS (dec);
   GstFlowReturn ret = GST_FLOW_OK;
 
   /* discard silly case, though maybe ts may be of value ?? */
@@ -1839,11 +2006,25 @@ gst_audio_decoder_chain_forward (GstAudioDecoder * dec, GstBuffer * buffer)
     goto exit;
   }
 
+  /* new stuff, so we can push subclass again */
+  dec->priv->drained = FALSE;
+
+  /* packetized input is handed over as is if nothing is pending,
+   * which is what taking it back out of the adapter would give */
+  if (klass->parse == NULL
+      && gst_adapter_available (dec->priv->adapter) == 0) {
+    buffer = gst_buffer_make_writable (buffer);
+    dec->priv->prev_ts = GST_BUFFER_PTS (buffer);
+    dec->priv->prev_distance = 0;
+    dec->priv->ctx.eos = FALSE;
+    dec->priv->force = FALSE;
+    ret = gst_audio_decoder_handle_frame (dec, klass, buffer);
+    goto exit;
+  }
+
   /* grab buffer */
   gst_adapter_push (dec->priv->adapter, buffer);
   buffer = NULL;
-  /* new stuff, so we can push subclass again */
-  dec->priv->drained = FALSE;
 
   /* hand to subclass */
   ret = gst_audio_decoder_push_buffers (dec, FALSE);
@@ -1867,6 +2048,10 @@ gst_audio_decoder_clear_queues (GstAudioDecoder * dec)
   g_list_foreach (priv->decode, (GFunc) gst_mini_object_unref, NULL);
   g_list_free (priv->decode);
   priv->decode = NULL;
+  if (priv->batch) {
+    gst_buffer_list_unref (priv->batch);
+    priv->batch = NULL;
+  }
 }
 
 /*
@@ -2124,6 +2309,37 @@ not_negotiated:
   }
 }
 
+static GstFlowReturn
+gst_audio_decoder_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstAudioDecoder *dec;
+  GstFlowReturn ret = GST_FLOW_OK, batch_ret;
+  guint i, len;
+
+  dec = GST_AUDIO_DECODER (parent);
+
+  len = gst_buffer_list_length (list);
+  GST_LOG_OBJECT (dec, "received buffer list of length %u", len);
+
+  GST_AUDIO_DECODER_STREAM_LOCK (dec);
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++) {
+    ret = gst_audio_decoder_chain (pad, parent,
+        gst_buffer_ref (gst_buffer_list_get (list, i)));
+  }
+
+  /* what the list decoded to goes out together, without waiting for a
+   * complete batch */
+  batch_ret = gst_audio_decoder_push_batch (dec);
+  if (ret == GST_FLOW_OK)
+    ret = batch_ret;
+  GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
+
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
 /* perform upstream byte <-> time conversion (duration, seeking)
  * if subclass allows and if enough data for moderately decent conversion */
 static inline gboolean
@@ -2728,6 +2944,9 @@ gst_audio_decoder_decide_allocation_default (GstAudioDecoder * dec,
   GstAllocator *allocator = NULL;
   GstAllocationParams params;
   gboolean update_allocator;
+  GstBufferPool *pool = NULL;
+  guint size, min, max;
+  gboolean update_pool;
 
   /* we got configuration from our peer or the decide_allocation method,
    * parse them */
@@ -2741,6 +2960,20 @@ gst_audio_decoder_decide_allocation_default (GstAudioDecoder * dec,
     update_allocator = FALSE;
   }
 
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    update_pool = TRUE;
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+    update_pool = FALSE;
+  }
+
+  /* the size of the decoded frames is only known once the subclass asks
+   * for an output buffer, so the pool is configured on first use */
+  if (pool == NULL)
+    pool = gst_buffer_pool_new ();
+
   if (update_allocator)
     gst_query_set_nth_allocation_param (query, 0, allocator, &params);
   else
@@ -2748,6 +2981,12 @@ gst_audio_decoder_decide_allocation_default (GstAudioDecoder * dec,
   if (allocator)
     gst_object_unref (allocator);
 
+  if (update_pool)
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+  gst_object_unref (pool);
+
   return TRUE;
 }
 
@@ -3117,6 +3356,28 @@ gst_audio_decoder_start (GstAudioDecoder * dec)
   return ret;
 }
 
+static GstStructure *
+gst_audio_decoder_create_stats (GstAudioDecoder * dec)
+{
+  GstAudioDecoderPrivate *priv = dec->priv;
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (dec);
+  s = gst_structure_new ("application/x-gst-audio-decoder-stats",
+      "frames", G_TYPE_UINT64, priv->frames_handled,
+      "frame-time-min", G_TYPE_UINT64,
+      GST_CLOCK_TIME_IS_VALID (priv->frame_time_min) ?
+      priv->frame_time_min : (GstClockTime) 0,
+      "frame-time-max", G_TYPE_UINT64, priv->frame_time_max,
+      "frame-time-average", G_TYPE_UINT64, priv->frames_handled ?
+      priv->frame_time_total / priv->frames_handled : (GstClockTime) 0,
+      "pooled-buffers", G_TYPE_UINT64, priv->pooled_buffers,
+      "allocated-buffers", G_TYPE_UINT64, priv->allocated_buffers, NULL);
+  GST_OBJECT_UNLOCK (dec);
+
+  return s;
+}
+
 static void
 gst_audio_decoder_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -3138,6 +3399,12 @@ gst_audio_decoder_get_property (GObject * object, guint prop_id,
     case PROP_MAX_ERRORS:
       g_value_set_int (value, gst_audio_decoder_get_max_errors (dec));
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_audio_decoder_create_stats (dec));
+      break;
+    case PROP_BATCH_SIZE:
+      g_value_set_uint (value, dec->priv->batch_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3165,6 +3432,9 @@ gst_audio_decoder_set_property (GObject * object, guint prop_id,
     case PROP_MAX_ERRORS:
       gst_audio_decoder_set_max_errors (dec, g_value_get_int (value));
       break;
+    case PROP_BATCH_SIZE:
+      dec->priv->batch_size = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3741,6 +4011,59 @@ gst_audio_decoder_merge_tags (GstAudioDecoder * dec,
   GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
 }
 
+/* call with STREAM_LOCK */
+static GstBuffer *
+gst_audio_decoder_acquire_pooled_buffer (GstAudioDecoder * dec, gsize size)
+{
+  GstAudioDecoderContext *ctx = &dec->priv->ctx;
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buffer = NULL;
+
+  /* a frame bigger than all before. Buffers of the active pool may still
+   * be in use downstream and the pool may belong to downstream, so leave it
+   * alone and continue with a new pool sized for the bigger frames */
+  if (size > ctx->pool_size && gst_buffer_pool_is_active (ctx->pool)) {
+    GST_DEBUG_OBJECT (dec, "requested size %" G_GSIZE_FORMAT
+        " exceeds pool size %u, replacing pool", size, ctx->pool_size);
+    gst_object_unref (ctx->pool);
+    ctx->pool = gst_buffer_pool_new ();
+  }
+
+  if (!gst_buffer_pool_is_active (ctx->pool)) {
+    GstStructure *config;
+
+    /* size the pool after the biggest frame so far, unless downstream
+     * asked for bigger buffers already */
+    ctx->pool_size = MAX (ctx->pool_size, size);
+    config = gst_buffer_pool_get_config (ctx->pool);
+    gst_buffer_pool_config_set_params (config, ctx->allocation_caps,
+        ctx->pool_size, ctx->pool_min, ctx->pool_max);
+    gst_buffer_pool_config_set_allocator (config, ctx->allocator,
+        &ctx->params);
+
+    if (!gst_buffer_pool_set_config (ctx->pool, config) ||
+        !gst_buffer_pool_set_active (ctx->pool, TRUE)) {
+      GST_INFO_OBJECT (dec, "failed to activate buffer pool, not using it");
+      gst_object_unref (ctx->pool);
+      ctx->pool = NULL;
+      return NULL;
+    }
+    GST_DEBUG_OBJECT (dec, "activated buffer pool with size %u",
+        ctx->pool_size);
+  }
+
+  /* never block the streaming thread on downstream holding on to buffers */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  if (gst_buffer_pool_acquire_buffer (ctx->pool, &buffer,
+          &params) != GST_FLOW_OK)
+    return NULL;
+
+  if (size < ctx->pool_size)
+    gst_buffer_set_size (buffer, size);
+
+  return buffer;
+}
+
 /**
  * gst_audio_decoder_allocate_output_buffer:
  * @dec: a #GstAudioDecoder
@@ -3749,6 +4072,10 @@ gst_audio_decoder_merge_tags (GstAudioDecoder * dec,
  * Helper function that allocates a buffer to hold an audio frame
  * for @dec's current output format.
  *
+ * Buffers are taken from the #GstBufferPool negotiated with downstream.
+ * The pool is sized after the biggest requested buffer so far, when a
+ * bigger buffer is requested a new pool is used from then on.
+ *
  * Returns: (transfer full): allocated buffer
  */
 GstBuffer *
@@ -3774,6 +4101,17 @@ gst_audio_decoder_allocate_output_buffer (GstAudioDecoder * dec, gsize size)
     }
   }
 
+  if (dec->priv->ctx.pool) {
+    buffer = gst_audio_decoder_acquire_pooled_buffer (dec, size);
+    if (buffer) {
+      GST_OBJECT_LOCK (dec);
+      dec->priv->pooled_buffers++;
+      GST_OBJECT_UNLOCK (dec);
+      GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
+      return buffer;
+    }
+  }
+
   buffer =
       gst_buffer_new_allocate (dec->priv->ctx.allocator, size,
       &dec->priv->ctx.params);
@@ -3782,11 +4120,17 @@ gst_audio_decoder_allocate_output_buffer (GstAudioDecoder * dec, gsize size)
     goto fallback;
   }
 
+  GST_OBJECT_LOCK (dec);
+  dec->priv->allocated_buffers++;
+  GST_OBJECT_UNLOCK (dec);
   GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
 
   return buffer;
 fallback:
   buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  GST_OBJECT_LOCK (dec);
+  dec->priv->allocated_buffers++;
+  GST_OBJECT_UNLOCK (dec);
   GST_AUDIO_DECODER_STREAM_UNLOCK (dec);
 
   return buffer;
@@ -143,7 +143,8 @@ enum
   PROP_PERFECT_TS,
   PROP_GRANULE,
   PROP_HARD_RESYNC,
-  PROP_TOLERANCE
+  PROP_TOLERANCE,
+  PROP_STATS
 };
 
 #define DEFAULT_PERFECT_TS   FALSE
@@ -177,6 +178,10 @@ typedef struct _GstAudioEncoderContext
 
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* output buffer pool, configured and activated on first use */
+  GstBufferPool *pool;
+  guint pool_size, pool_min, pool_max;
 } GstAudioEncoderContext;
 
 struct _GstAudioEncoderPrivate
@@ -217,6 +222,16 @@ struct _GstAudioEncoderPrivate
   /* global bytes sent out */
   guint64 bytes_out;
 
+  /* per-frame statistics (with LOCK) */
+  guint64 frames_handled;
+  GstClockTime frame_time_min;
+  GstClockTime frame_time_max;
+  GstClockTime frame_time_total;
+  guint64 pooled_buffers;
+  guint64 allocated_buffers;
+  /* time spent pushing downstream, excluded from the frame time */
+  GstClockTime push_time;
+
   /* context storage */
   GstAudioEncoderContext ctx;
 
@@ -383,6 +398,31 @@ gst_audio_encoder_class_init (GstAudioEncoderClass * klass)
           0, G_MAXINT64, DEFAULT_TOLERANCE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioEncoder:stats:
+   *
+   * Various encoder statistics. This property returns a #GstStructure
+   * with name "application/x-gst-audio-encoder-stats" and the following
+   * fields:
+   *
+   * - "frames" G_TYPE_UINT64: number of frames handed to the subclass
+   * - "frame-time-min" G_TYPE_UINT64: shortest time spent encoding a frame
+   * - "frame-time-max" G_TYPE_UINT64: longest time spent encoding a frame
+   * - "frame-time-average" G_TYPE_UINT64: average time spent encoding a frame
+   * - "pooled-buffers" G_TYPE_UINT64: output buffers taken from the pool
+   * - "allocated-buffers" G_TYPE_UINT64: output buffers allocated outside
+   *   of the pool
+   *
+   * Frame times are in nanoseconds and do not include the time spent
+   * pushing the encoded data downstream.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Encoder Statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_audio_encoder_change_state);
 
@@ -469,7 +509,14 @@ gst_audio_encoder_reset (GstAudioEncoder * enc, gboolean full)
     GST_OBJECT_LOCK (enc);
     enc->priv->samples_in = 0;
     enc->priv->bytes_out = 0;
+    enc->priv->frames_handled = 0;
+    enc->priv->frame_time_min = GST_CLOCK_TIME_NONE;
+    enc->priv->frame_time_max = 0;
+    enc->priv->frame_time_total = 0;
+    enc->priv->pooled_buffers = 0;
+    enc->priv->allocated_buffers = 0;
     GST_OBJECT_UNLOCK (enc);
+    enc->priv->push_time = 0;
 
     g_list_foreach (enc->priv->ctx.headers, (GFunc) gst_buffer_unref, NULL);
     g_list_free (enc->priv->ctx.headers);
@@ -479,6 +526,11 @@ gst_audio_encoder_reset (GstAudioEncoder * enc, gboolean full)
     if (enc->priv->ctx.allocator)
       gst_object_unref (enc->priv->ctx.allocator);
     enc->priv->ctx.allocator = NULL;
+    if (enc->priv->ctx.pool) {
+      gst_buffer_pool_set_active (enc->priv->ctx.pool, FALSE);
+      gst_object_unref (enc->priv->ctx.pool);
+    }
+    enc->priv->ctx.pool = NULL;
 
     GST_OBJECT_LOCK (enc);
     gst_caps_replace (&enc->priv->ctx.input_caps, NULL);
@@ -758,6 +810,7 @@ gst_audio_encoder_finish_frame (GstAudioEncoder * enc, GstBuffer * buf,
   GstFlowReturn ret = GST_FLOW_OK;
   gboolean needs_reconfigure = FALSE;
   GstBuffer *inbuf = NULL;
+  GstClockTime start;
 
   klass = GST_AUDIO_ENCODER_GET_CLASS (enc);
   priv = enc->priv;
@@ -1011,7 +1064,9 @@ gst_audio_encoder_finish_frame (GstAudioEncoder * enc, GstBuffer * buf,
         GST_TIME_ARGS (GST_BUFFER_PTS (buf)),
         GST_TIME_ARGS (GST_BUFFER_DURATION (buf)));
 
+    start = gst_util_get_timestamp ();
     ret = gst_pad_push (enc->srcpad, buf);
+    priv->push_time += gst_util_get_timestamp () - start;
     GST_LOG_OBJECT (enc, "buffer pushed: %s", gst_flow_get_name (ret));
   } else {
     /* merely advance samples, most work for that already done above */
@@ -1049,7 +1104,35 @@ overflow:
   }
 }
 
- /* adapter tracking idea:
+static GstFlowReturn
+gst_audio_encoder_handle_frame (GstAudioEncoder * enc,
+    GstAudioEncoderClass * klass, GstBuffer * buffer)
+{
+  GstClockTime start, push_time, elapsed;
+  GstFlowReturn ret;
+
+  start = gst_util_get_timestamp ();
+  push_time = enc->priv->push_time;
+
+  ret = klass->handle_frame (enc, buffer);
+
+  elapsed = gst_util_get_timestamp () - start;
+  elapsed -= MIN (elapsed, enc->priv->push_time - push_time);
+
+  GST_OBJECT_LOCK (enc);
+  enc->priv->frames_handled++;
+  enc->priv->frame_time_total += elapsed;
+  if (!GST_CLOCK_TIME_IS_VALID (enc->priv->frame_time_min) ||
+      elapsed < enc->priv->frame_time_min)
+    enc->priv->frame_time_min = elapsed;
+  if (elapsed > enc->priv->frame_time_max)
+    enc->priv->frame_time_max = elapsed;
+  GST_OBJECT_UNLOCK (enc);
+
+  return ret;
+}
+
+/* adapter tracking idea:
   * - start of adapter corresponds with what has already been encoded
   * (i.e. really returned by encoder subclass)
   * - start + offset is what needs to be fed to subclass next */
@@ -1061,6 +1144,7 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
   GstAudioEncoderContext *ctx;
   gint av, need;
   GstBuffer *buf;
+  gboolean mapped;
   GstFlowReturn ret = GST_FLOW_OK;
 
   klass = GST_AUDIO_ENCODER_GET_CLASS (enc);
@@ -1111,13 +1195,23 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
     }
 
     priv->got_data = FALSE;
+    mapped = FALSE;
     if (G_LIKELY (need)) {
       const guint8 *data;
 
-      data = gst_adapter_map (priv->adapter, priv->offset + need);
-      buf =
-          gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-          (gpointer) data, priv->offset + need, priv->offset, need, NULL, NULL);
+      /* samples at the head of a single input buffer are shared as they
+       * are, no need to map and wrap them */
+      if (priv->offset == 0 && gst_adapter_available_fast (priv->adapter)
+          >= need) {
+        buf = gst_adapter_get_buffer (priv->adapter, need);
+      } else {
+        data = gst_adapter_map (priv->adapter, priv->offset + need);
+        buf =
+            gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+            (gpointer) data, priv->offset + need, priv->offset, need, NULL,
+            NULL);
+        mapped = TRUE;
+      }
     } else if (!priv->drainable) {
       GST_DEBUG_OBJECT (enc, "non-drainable and no more data");
       goto finish;
@@ -1138,13 +1232,16 @@ gst_audio_encoder_push_buffers (GstAudioEncoder * enc, gboolean force)
     if (G_UNLIKELY (priv->force && priv->hard_min && buf)) {
       GST_DEBUG_OBJECT (enc, "bypassing subclass with leftover");
       ret = gst_audio_encoder_finish_frame (enc, NULL, -1);
+    } else if (buf) {
+      ret = gst_audio_encoder_handle_frame (enc, klass, buf);
     } else {
       ret = klass->handle_frame (enc, buf);
     }
 
     if (G_LIKELY (buf)) {
       gst_buffer_unref (buf);
-      gst_adapter_unmap (priv->adapter);
+      if (mapped)
+        gst_adapter_unmap (priv->adapter);
     }
 
   finish:
@@ -1858,6 +1955,9 @@ gst_audio_encoder_decide_allocation_default (GstAudioEncoder * enc,
   GstAllocator *allocator = NULL;
   GstAllocationParams params;
   gboolean update_allocator;
+  GstBufferPool *pool = NULL;
+  guint size, min, max;
+  gboolean update_pool;
 
   /* we got configuration from our peer or the decide_allocation method,
    * parse them */
@@ -1871,6 +1971,20 @@ gst_audio_encoder_decide_allocation_default (GstAudioEncoder * enc,
     update_allocator = FALSE;
   }
 
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    update_pool = TRUE;
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+    update_pool = FALSE;
+  }
+
+  /* the size of the encoded frames is only known once the subclass asks
+   * for an output buffer, so the pool is configured on first use */
+  if (pool == NULL)
+    pool = gst_buffer_pool_new ();
+
   if (update_allocator)
     gst_query_set_nth_allocation_param (query, 0, allocator, &params);
   else
@@ -1878,6 +1992,12 @@ gst_audio_encoder_decide_allocation_default (GstAudioEncoder * enc,
   if (allocator)
     gst_object_unref (allocator);
 
+  if (update_pool)
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+  gst_object_unref (pool);
+
   return TRUE;
 }
 
@@ -2063,6 +2183,28 @@ gst_audio_encoder_set_property (GObject * object, guint prop_id,
   }
 }
 
+static GstStructure *
+gst_audio_encoder_create_stats (GstAudioEncoder * enc)
+{
+  GstAudioEncoderPrivate *priv = enc->priv;
+  GstStructure *s;
+
+  GST_OBJECT_LOCK (enc);
+  s = gst_structure_new ("application/x-gst-audio-encoder-stats",
+      "frames", G_TYPE_UINT64, priv->frames_handled,
+      "frame-time-min", G_TYPE_UINT64,
+      GST_CLOCK_TIME_IS_VALID (priv->frame_time_min) ?
+      priv->frame_time_min : (GstClockTime) 0,
+      "frame-time-max", G_TYPE_UINT64, priv->frame_time_max,
+      "frame-time-average", G_TYPE_UINT64, priv->frames_handled ?
+      priv->frame_time_total / priv->frames_handled : (GstClockTime) 0,
+      "pooled-buffers", G_TYPE_UINT64, priv->pooled_buffers,
+      "allocated-buffers", G_TYPE_UINT64, priv->allocated_buffers, NULL);
+  GST_OBJECT_UNLOCK (enc);
+
+  return s;
+}
+
 static void
 gst_audio_encoder_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec)
@@ -2084,6 +2226,9 @@ gst_audio_encoder_get_property (GObject * object, guint prop_id,
     case PROP_TOLERANCE:
       g_value_set_int64 (value, enc->priv->tolerance);
       break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_audio_encoder_create_stats (enc));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2719,6 +2864,8 @@ gst_audio_encoder_negotiate_default (GstAudioEncoder * enc)
   GstQuery *query = NULL;
   GstAllocator *allocator;
   GstAllocationParams params;
+  GstBufferPool *pool;
+  guint size, min, max;
   GstCaps *caps, *prevcaps;
 
   g_return_val_if_fail (GST_IS_AUDIO_ENCODER (enc), FALSE);
@@ -2791,6 +2938,22 @@ gst_audio_encoder_negotiate_default (GstAudioEncoder * enc)
   enc->priv->ctx.allocator = allocator;
   enc->priv->ctx.params = params;
 
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+  } else {
+    pool = NULL;
+    size = min = max = 0;
+  }
+
+  if (enc->priv->ctx.pool) {
+    gst_buffer_pool_set_active (enc->priv->ctx.pool, FALSE);
+    gst_object_unref (enc->priv->ctx.pool);
+  }
+  enc->priv->ctx.pool = pool;
+  enc->priv->ctx.pool_size = size;
+  enc->priv->ctx.pool_min = min;
+  enc->priv->ctx.pool_max = max;
+
 done:
   if (query)
     gst_query_unref (query);
@@ -2895,6 +3058,59 @@ refuse_caps:
   }
 }
 
+/* call with STREAM_LOCK */
+static GstBuffer *
+gst_audio_encoder_acquire_pooled_buffer (GstAudioEncoder * enc, gsize size)
+{
+  GstAudioEncoderContext *ctx = &enc->priv->ctx;
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buffer = NULL;
+
+  /* a frame bigger than all before. Buffers of the active pool may still
+   * be in use downstream and the pool may belong to downstream, so leave it
+   * alone and continue with a new pool sized for the bigger frames */
+  if (size > ctx->pool_size && gst_buffer_pool_is_active (ctx->pool)) {
+    GST_DEBUG_OBJECT (enc, "requested size %" G_GSIZE_FORMAT
+        " exceeds pool size %u, replacing pool", size, ctx->pool_size);
+    gst_object_unref (ctx->pool);
+    ctx->pool = gst_buffer_pool_new ();
+  }
+
+  if (!gst_buffer_pool_is_active (ctx->pool)) {
+    GstStructure *config;
+
+    /* size the pool after the biggest frame so far, unless downstream
+     * asked for bigger buffers already */
+    ctx->pool_size = MAX (ctx->pool_size, size);
+    config = gst_buffer_pool_get_config (ctx->pool);
+    gst_buffer_pool_config_set_params (config, ctx->allocation_caps,
+        ctx->pool_size, ctx->pool_min, ctx->pool_max);
+    gst_buffer_pool_config_set_allocator (config, ctx->allocator,
+        &ctx->params);
+
+    if (!gst_buffer_pool_set_config (ctx->pool, config) ||
+        !gst_buffer_pool_set_active (ctx->pool, TRUE)) {
+      GST_INFO_OBJECT (enc, "failed to activate buffer pool, not using it");
+      gst_object_unref (ctx->pool);
+      ctx->pool = NULL;
+      return NULL;
+    }
+    GST_DEBUG_OBJECT (enc, "activated buffer pool with size %u",
+        ctx->pool_size);
+  }
+
+  /* never block the streaming thread on downstream holding on to buffers */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  if (gst_buffer_pool_acquire_buffer (ctx->pool, &buffer,
+          &params) != GST_FLOW_OK)
+    return NULL;
+
+  if (size < ctx->pool_size)
+    gst_buffer_set_size (buffer, size);
+
+  return buffer;
+}
+
 /**
  * gst_audio_encoder_allocate_output_buffer:
  * @enc: a #GstAudioEncoder
@@ -2903,6 +3119,10 @@ refuse_caps:
  * Helper function that allocates a buffer to hold an encoded audio frame
  * for @enc's current output format.
  *
+ * Buffers are taken from the #GstBufferPool negotiated with downstream.
+ * The pool is sized after the biggest requested buffer so far, when a
+ * bigger buffer is requested a new pool is used from then on.
+ *
  * Returns: (transfer full): allocated buffer
  */
 GstBuffer *
@@ -2927,6 +3147,17 @@ gst_audio_encoder_allocate_output_buffer (GstAudioEncoder * enc, gsize size)
     }
   }
 
+  if (enc->priv->ctx.pool) {
+    buffer = gst_audio_encoder_acquire_pooled_buffer (enc, size);
+    if (buffer) {
+      GST_OBJECT_LOCK (enc);
+      enc->priv->pooled_buffers++;
+      GST_OBJECT_UNLOCK (enc);
+      GST_AUDIO_ENCODER_STREAM_UNLOCK (enc);
+      return buffer;
+    }
+  }
+
   buffer =
       gst_buffer_new_allocate (enc->priv->ctx.allocator, size,
       &enc->priv->ctx.params);
@@ -2935,12 +3166,18 @@ gst_audio_encoder_allocate_output_buffer (GstAudioEncoder * enc, gsize size)
     goto fallback;
   }
 
+  GST_OBJECT_LOCK (enc);
+  enc->priv->allocated_buffers++;
+  GST_OBJECT_UNLOCK (enc);
   GST_AUDIO_ENCODER_STREAM_UNLOCK (enc);
 
   return buffer;
 
 fallback:
   buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  GST_OBJECT_LOCK (enc);
+  enc->priv->allocated_buffers++;
+  GST_OBJECT_UNLOCK (enc);
   GST_AUDIO_ENCODER_STREAM_UNLOCK (enc);
 
   return buffer;
@@ -48,13 +48,34 @@ GST_DEBUG_CATEGORY_STATIC (gst_audio_ring_buffer_debug);
 static void gst_audio_ring_buffer_dispose (GObject * object);
 static void gst_audio_ring_buffer_finalize (GObject * object);
 
+/* number of buckets in the wake-up latency histogram, bucket i counts
+ * latencies below 2^i microseconds, the last bucket counts everything
+ * else */
+#define N_LATENCY_BUCKETS 16
+
+typedef struct
+{
+  /* ATOMIC */
+  gint stats_enabled;
+  gint underruns;
+  gint overruns;
+
+  /* with LOCK */
+  gint64 signal_time;
+  guint wakeups;
+  guint latency[N_LATENCY_BUCKETS];
+} GstAudioRingBufferPrivate;
+
+#define GET_PRIV(buf) \
+    ((GstAudioRingBufferPrivate *) gst_audio_ring_buffer_get_instance_private (buf))
+
 static gboolean gst_audio_ring_buffer_pause_unlocked (GstAudioRingBuffer * buf);
 static void default_clear_all (GstAudioRingBuffer * buf);
 static guint default_commit (GstAudioRingBuffer * buf, guint64 * sample,
     guint8 * data, gint in_samples, gint out_samples, gint * accum);
 
 /* ringbuffer abstract base class */
-G_DEFINE_ABSTRACT_TYPE (GstAudioRingBuffer, gst_audio_ring_buffer,
+G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GstAudioRingBuffer, gst_audio_ring_buffer,
     GST_TYPE_OBJECT);
 
 static void
@@ -1335,8 +1356,32 @@ gst_audio_ring_buffer_clear_all (GstAudioRingBuffer * buf)
 }
 
 
+/* called with LOCK after being woken up by gst_audio_ring_buffer_advance() */
+static void
+record_wakeup (GstAudioRingBuffer * buf)
+{
+  GstAudioRingBufferPrivate *priv = GET_PRIV (buf);
+  gint64 latency;
+  gint bucket = 0;
+
+  if (!g_atomic_int_get (&priv->stats_enabled) || priv->signal_time == 0)
+    return;
+
+  latency = g_get_monotonic_time () - priv->signal_time;
+  priv->signal_time = 0;
+
+  while (bucket < N_LATENCY_BUCKETS - 1 && latency >= (G_GINT64_CONSTANT (1)
+          << bucket))
+    bucket++;
+
+  priv->wakeups++;
+  priv->latency[bucket]++;
+}
+
+/* wait until segdone is different from @segdone, the value the caller based
+ * its decision to wait on */
 static gboolean
-wait_segment (GstAudioRingBuffer * buf)
+wait_segment (GstAudioRingBuffer * buf, gint segdone)
 {
   gint segments;
   gboolean wait = TRUE;
@@ -1369,15 +1414,26 @@ wait_segment (GstAudioRingBuffer * buf)
 
   if (G_LIKELY (wait)) {
     if (g_atomic_int_compare_and_exchange (&buf->waiting, 0, 1)) {
-      GST_DEBUG_OBJECT (buf, "waiting..");
-      GST_AUDIO_RING_BUFFER_WAIT (buf);
+      /* segdone might have changed between the check of the caller and
+       * setting the waiting flag. gst_audio_ring_buffer_advance() then did
+       * not see the flag and won't signal us, so we would sleep for a
+       * complete extra segment. Both the flag and segdone are updated with
+       * full barriers so checking again here is enough. */
+      if (G_UNLIKELY (g_atomic_int_get (&buf->segdone) != segdone)) {
+        g_atomic_int_compare_and_exchange (&buf->waiting, 1, 0);
+      } else {
+        GST_DEBUG_OBJECT (buf, "waiting..");
+        GST_AUDIO_RING_BUFFER_WAIT (buf);
 
-      if (G_UNLIKELY (buf->flushing))
-        goto flushing;
+        record_wakeup (buf);
 
-      if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
-              GST_AUDIO_RING_BUFFER_STATE_STARTED))
-        goto not_started;
+        if (G_UNLIKELY (buf->flushing))
+          goto flushing;
+
+        if (G_UNLIKELY (g_atomic_int_get (&buf->state) !=
+                GST_AUDIO_RING_BUFFER_STATE_STARTED))
+          goto not_started;
+      }
     }
   }
   GST_OBJECT_UNLOCK (buf);
@@ -1584,6 +1640,11 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
 
       /* segment too far ahead, writer too slow, we need to drop, hopefully UNLIKELY */
       if (G_UNLIKELY (diff < 0)) {
+        GstAudioRingBufferPrivate *priv = GET_PRIV (buf);
+
+        if (g_atomic_int_get (&priv->stats_enabled))
+          g_atomic_int_inc (&priv->underruns);
+
         /* we need to drop one segment at a time, pretend we wrote a segment. */
         skip = TRUE;
         break;
@@ -1597,7 +1658,7 @@ default_commit (GstAudioRingBuffer * buf, guint64 * sample,
       }
 
       /* else we need to wait for the segment to become writable. */
-      if (!wait_segment (buf))
+      if (!wait_segment (buf, segdone + buf->segbase))
         goto not_started;
     }
 
@@ -1801,6 +1862,11 @@ gst_audio_ring_buffer_read (GstAudioRingBuffer * buf, guint64 sample,
 
       /* segment too far ahead, reader too slow */
       if (G_UNLIKELY (diff >= segtotal)) {
+        GstAudioRingBufferPrivate *priv = GET_PRIV (buf);
+
+        if (g_atomic_int_get (&priv->stats_enabled))
+          g_atomic_int_inc (&priv->overruns);
+
         /* pretend we read an empty segment. */
         sampleslen = MIN (sps, to_read);
         memcpy (data, buf->empty_seg, sampleslen * bpf);
@@ -1813,7 +1879,7 @@ gst_audio_ring_buffer_read (GstAudioRingBuffer * buf, guint64 sample,
         break;
 
       /* else we need to wait for the segment to become readable. */
-      if (!wait_segment (buf))
+      if (!wait_segment (buf, segdone + buf->segbase))
         goto not_started;
     }
 
@@ -1940,8 +2006,12 @@ gst_audio_ring_buffer_advance (GstAudioRingBuffer * buf, guint advance)
    * we grab the lock as well to make sure the waiter is actually
    * waiting for the signal */
   if (g_atomic_int_compare_and_exchange (&buf->waiting, 1, 0)) {
+    GstAudioRingBufferPrivate *priv = GET_PRIV (buf);
+
     GST_OBJECT_LOCK (buf);
     GST_DEBUG_OBJECT (buf, "signal waiter");
+    if (g_atomic_int_get (&priv->stats_enabled))
+      priv->signal_time = g_get_monotonic_time ();
     GST_AUDIO_RING_BUFFER_SIGNAL (buf);
     GST_OBJECT_UNLOCK (buf);
   }
@@ -2001,6 +2071,101 @@ gst_audio_ring_buffer_may_start (GstAudioRingBuffer * buf, gboolean allowed)
   g_atomic_int_set (&buf->may_start, allowed);
 }
 
+/**
+ * gst_audio_ring_buffer_set_stats_enabled:
+ * @buf: the #GstAudioRingBuffer
+ * @enabled: whether to collect statistics
+ *
+ * Enable or disable the collection of statistics about the segment handoff
+ * between the reader and the writer of the ringbuffer. Enabling the
+ * statistics resets all counters. See gst_audio_ring_buffer_get_stats().
+ *
+ * MT safe.
+ *
+ * Since: 1.20
+ */
+void
+gst_audio_ring_buffer_set_stats_enabled (GstAudioRingBuffer * buf,
+    gboolean enabled)
+{
+  GstAudioRingBufferPrivate *priv;
+
+  g_return_if_fail (GST_IS_AUDIO_RING_BUFFER (buf));
+
+  priv = GET_PRIV (buf);
+
+  GST_OBJECT_LOCK (buf);
+  if (enabled && !g_atomic_int_get (&priv->stats_enabled)) {
+    g_atomic_int_set (&priv->underruns, 0);
+    g_atomic_int_set (&priv->overruns, 0);
+    priv->signal_time = 0;
+    priv->wakeups = 0;
+    memset (priv->latency, 0, sizeof (priv->latency));
+  }
+  g_atomic_int_set (&priv->stats_enabled, enabled);
+  GST_OBJECT_UNLOCK (buf);
+}
+
+/**
+ * gst_audio_ring_buffer_get_stats:
+ * @buf: the #GstAudioRingBuffer
+ *
+ * Get the statistics collected since the last call to
+ * gst_audio_ring_buffer_set_stats_enabled() with %TRUE. The returned
+ * structure contains the following fields:
+ *
+ * * "underruns" (guint): number of segments the writer was too late for
+ * * "overruns" (guint): number of segments the reader was too late for
+ * * "wakeups" (guint): number of times a waiting reader or writer was
+ *   woken up because a segment was processed by the device
+ * * "wakeup-latency" (#GstValueArray of guint): histogram of the time
+ *   between the device processing a segment and the waiting thread running
+ *   again. Entry i counts wake-ups that took less than 2^i microseconds,
+ *   the last entry counts all longer wake-ups.
+ *
+ * Returns: (transfer full) (nullable): a #GstStructure with the statistics
+ *     or %NULL when statistics are not enabled.
+ *
+ * MT safe.
+ *
+ * Since: 1.20
+ */
+GstStructure *
+gst_audio_ring_buffer_get_stats (GstAudioRingBuffer * buf)
+{
+  GstAudioRingBufferPrivate *priv;
+  GstStructure *s;
+  GValue histogram = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  gint i;
+
+  g_return_val_if_fail (GST_IS_AUDIO_RING_BUFFER (buf), NULL);
+
+  priv = GET_PRIV (buf);
+
+  if (!g_atomic_int_get (&priv->stats_enabled))
+    return NULL;
+
+  g_value_init (&histogram, GST_TYPE_ARRAY);
+  g_value_init (&v, G_TYPE_UINT);
+
+  GST_OBJECT_LOCK (buf);
+  for (i = 0; i < N_LATENCY_BUCKETS; i++) {
+    g_value_set_uint (&v, priv->latency[i]);
+    gst_value_array_append_value (&histogram, &v);
+  }
+  s = gst_structure_new ("application/x-gst-audio-ring-buffer-stats",
+      "underruns", G_TYPE_UINT, g_atomic_int_get (&priv->underruns),
+      "overruns", G_TYPE_UINT, g_atomic_int_get (&priv->overruns),
+      "wakeups", G_TYPE_UINT, priv->wakeups, NULL);
+  GST_OBJECT_UNLOCK (buf);
+
+  gst_structure_take_value (s, "wakeup-latency", &histogram);
+  g_value_unset (&v);
+
+  return s;
+}
+
 /* GST_AUDIO_CHANNEL_POSITION_NONE is used for position-less
  * mutually exclusive channels. In this case we should not attempt
  * to do any reordering.
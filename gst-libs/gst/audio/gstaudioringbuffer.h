@@ -407,6 +407,14 @@ void            gst_audio_ring_buffer_advance         (GstAudioRingBuffer *buf,
 GST_AUDIO_API
 void            gst_audio_ring_buffer_may_start       (GstAudioRingBuffer *buf, gboolean allowed);
 
+/* statistics */
+
+GST_AUDIO_API
+void            gst_audio_ring_buffer_set_stats_enabled (GstAudioRingBuffer *buf, gboolean enabled);
+
+GST_AUDIO_API
+GstStructure *  gst_audio_ring_buffer_get_stats       (GstAudioRingBuffer *buf);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstAudioRingBuffer, gst_object_unref)
 
 G_END_DECLS
@@ -36,8 +36,17 @@
  *
  * See gst_audio_stream_align_new() for a description of its parameters and
  * gst_audio_stream_align_process() for the details of the processing.
+ *
+ * Since 1.20 it also keeps track of the drift between the incoming
+ * timestamps and the perfect timestamps it produces, see
+ * gst_audio_stream_align_get_stats() and
+ * gst_audio_stream_align_set_drift_window().
  */
 
+/* upper bound for the drift estimation window, keeps the struct flat so
+ * copies stay plain struct assignments */
+#define MAX_DRIFT_WINDOW 64
+
 G_DEFINE_BOXED_TYPE (GstAudioStreamAlign, gst_audio_stream_align,
     (GBoxedCopyFunc) gst_audio_stream_align_copy,
     (GBoxedFreeFunc) gst_audio_stream_align_free);
@@ -55,8 +64,38 @@ struct _GstAudioStreamAlign
 
   /* Last time we noticed a discont */
   GstClockTime discont_time;
+
+  /* alignment threshold in samples at the current rate */
+  guint64 max_sample_diff;
+
+  /* drift tracking */
+  guint64 n_disconts;
+  GstClockTimeDiff drift;
+  GstClockTime max_drift;
+  guint drift_window;
+  guint drift_count;
+  guint drift_pos;
+  GstClockTimeDiff drift_sum;
+  GstClockTimeDiff drift_history[MAX_DRIFT_WINDOW];
 };
 
+static void
+gst_audio_stream_align_update_max_sample_diff (GstAudioStreamAlign * align)
+{
+  align->max_sample_diff =
+      gst_util_uint64_scale_int (align->alignment_threshold,
+      ABS (align->rate), GST_SECOND);
+}
+
+static void
+gst_audio_stream_align_reset_drift (GstAudioStreamAlign * align)
+{
+  align->drift = 0;
+  align->drift_count = 0;
+  align->drift_pos = 0;
+  align->drift_sum = 0;
+}
+
 /**
  * gst_audio_stream_align_new:
  * @rate: a sample rate
@@ -96,6 +135,7 @@ gst_audio_stream_align_new (gint rate, GstClockTime alignment_threshold,
 
   align->timestamp_at_discont = GST_CLOCK_TIME_NONE;
   align->samples_since_discont = 0;
+  gst_audio_stream_align_update_max_sample_diff (align);
   gst_audio_stream_align_mark_discont (align);
 
   return align;
@@ -160,6 +200,7 @@ gst_audio_stream_align_set_rate (GstAudioStreamAlign * align, gint rate)
     return;
 
   align->rate = rate;
+  gst_audio_stream_align_update_max_sample_diff (align);
   gst_audio_stream_align_mark_discont (align);
 }
 
@@ -198,6 +239,7 @@ gst_audio_stream_align_set_alignment_threshold (GstAudioStreamAlign *
   g_return_if_fail (GST_CLOCK_TIME_IS_VALID (alignment_threshold));
 
   align->alignment_threshold = alignment_threshold;
+  gst_audio_stream_align_update_max_sample_diff (align);
 }
 
 /**
@@ -271,6 +313,7 @@ gst_audio_stream_align_mark_discont (GstAudioStreamAlign * align)
 
   align->next_offset = -1;
   align->discont_time = GST_CLOCK_TIME_NONE;
+  gst_audio_stream_align_reset_drift (align);
 }
 
 /**
@@ -313,6 +356,34 @@ gst_audio_stream_align_get_samples_since_discont (const GstAudioStreamAlign *
   return align->samples_since_discont;
 }
 
+static void
+gst_audio_stream_align_track_drift (GstAudioStreamAlign * align,
+    guint64 offset, guint64 diff)
+{
+  GstClockTime abs_drift;
+
+  abs_drift = gst_util_uint64_scale_int (diff, GST_SECOND, ABS (align->rate));
+  /* positive drift means the timestamps are later than expected */
+  if (offset > align->next_offset)
+    align->drift = abs_drift;
+  else
+    align->drift = -(GstClockTimeDiff) abs_drift;
+
+  if (abs_drift > align->max_drift)
+    align->max_drift = abs_drift;
+
+  if (align->drift_window == 0)
+    return;
+
+  if (align->drift_count == align->drift_window)
+    align->drift_sum -= align->drift_history[align->drift_pos];
+  else
+    align->drift_count++;
+  align->drift_history[align->drift_pos] = align->drift;
+  align->drift_sum += align->drift;
+  align->drift_pos = (align->drift_pos + 1) % align->drift_window;
+}
+
 /**
  * gst_audio_stream_align_process:
  * @align: a #GstAudioStreamAlign
@@ -345,6 +416,7 @@ gst_audio_stream_align_get_samples_since_discont (const GstAudioStreamAlign *
  * Since: 1.14
  */
 #define ABSDIFF(a, b) ((a) > (b) ? (a) - (b) : (b) - (a))
+
 gboolean
 gst_audio_stream_align_process (GstAudioStreamAlign * align,
     gboolean discont, GstClockTime timestamp, guint n_samples,
@@ -369,21 +441,16 @@ gst_audio_stream_align_process (GstAudioStreamAlign * align,
   if (align->next_offset == (guint64) - 1 || discont) {
     discont = TRUE;
   } else {
-    guint64 diff, max_sample_diff;
+    guint64 offset, diff;
 
     /* Check discont */
-    if (align->rate > 0) {
-      diff = ABSDIFF (start_offset, align->next_offset);
-    } else {
-      diff = ABSDIFF (end_offset, align->next_offset);
-    }
+    offset = align->rate > 0 ? start_offset : end_offset;
+    diff = ABSDIFF (offset, align->next_offset);
 
-    max_sample_diff =
-        gst_util_uint64_scale_int (align->alignment_threshold,
-        ABS (align->rate), GST_SECOND);
+    gst_audio_stream_align_track_drift (align, offset, diff);
 
     /* Discont! */
-    if (G_UNLIKELY (diff >= max_sample_diff)) {
+    if (G_UNLIKELY (diff >= align->max_sample_diff)) {
       if (align->discont_wait > 0) {
         if (align->discont_time == GST_CLOCK_TIME_NONE) {
           align->discont_time = align->rate > 0 ? start_time : end_time;
@@ -407,10 +474,13 @@ gst_audio_stream_align_process (GstAudioStreamAlign * align,
 
   if (discont) {
     /* Have discont, need resync and use the capture timestamps */
-    if (align->next_offset != (guint64) - 1)
+    if (align->next_offset != (guint64) - 1) {
       GST_INFO ("Have discont. Expected %"
           G_GUINT64_FORMAT ", got %" G_GUINT64_FORMAT,
           align->next_offset, start_offset);
+      align->n_disconts++;
+    }
+    gst_audio_stream_align_reset_drift (align);
     align->next_offset = align->rate > 0 ? end_offset : start_offset;
     align->timestamp_at_discont = start_time;
     align->samples_since_discont = 0;
@@ -463,3 +533,128 @@ gst_audio_stream_align_process (GstAudioStreamAlign * align,
 }
 
 #undef ABSDIFF
+
+/**
+ * gst_audio_stream_align_set_drift_window:
+ * @align: a #GstAudioStreamAlign
+ * @window: number of buffers to average the drift over, or 0 to disable
+ *
+ * Enables a drift estimator that averages the drift of the last @window
+ * processed buffers, see gst_audio_stream_align_get_drift_estimate(). At
+ * most 64 buffers are taken into account. Changing the window restarts the
+ * estimation.
+ *
+ * Since: 1.20
+ */
+void
+gst_audio_stream_align_set_drift_window (GstAudioStreamAlign * align,
+    guint window)
+{
+  g_return_if_fail (align != NULL);
+
+  align->drift_window = MIN (window, MAX_DRIFT_WINDOW);
+  align->drift_count = 0;
+  align->drift_pos = 0;
+  align->drift_sum = 0;
+}
+
+/**
+ * gst_audio_stream_align_get_drift_window:
+ * @align: a #GstAudioStreamAlign
+ *
+ * Gets the currently configured drift estimation window.
+ *
+ * Returns: The drift estimation window in buffers, 0 if disabled
+ *
+ * Since: 1.20
+ */
+guint
+gst_audio_stream_align_get_drift_window (const GstAudioStreamAlign * align)
+{
+  g_return_val_if_fail (align != NULL, 0);
+
+  return align->drift_window;
+}
+
+/**
+ * gst_audio_stream_align_get_drift:
+ * @align: a #GstAudioStreamAlign
+ *
+ * Gets the drift accumulated since the last discontinuity, i.e. the
+ * difference between the timestamp of the last processed data and the
+ * perfect timestamp calculated from the sample count. Positive values mean
+ * that the incoming timestamps are later than the produced ones.
+ *
+ * Returns: The drift of the last processed data in nanoseconds
+ *
+ * Since: 1.20
+ */
+GstClockTimeDiff
+gst_audio_stream_align_get_drift (const GstAudioStreamAlign * align)
+{
+  g_return_val_if_fail (align != NULL, 0);
+
+  return align->drift;
+}
+
+/**
+ * gst_audio_stream_align_get_drift_estimate:
+ * @align: a #GstAudioStreamAlign
+ *
+ * Gets the drift averaged over the window configured with
+ * gst_audio_stream_align_set_drift_window(). Unlike the raw drift this
+ * is not affected much by timestamp jitter, and can be used to gradually
+ * correct for drift before it reaches the alignment threshold.
+ *
+ * Returns: The averaged drift in nanoseconds, or the drift of the last
+ *     processed data if no window is configured
+ *
+ * Since: 1.20
+ */
+GstClockTimeDiff
+gst_audio_stream_align_get_drift_estimate (const GstAudioStreamAlign * align)
+{
+  g_return_val_if_fail (align != NULL, 0);
+
+  if (align->drift_window == 0 || align->drift_count == 0)
+    return align->drift;
+
+  return align->drift_sum / (GstClockTimeDiff) align->drift_count;
+}
+
+/**
+ * gst_audio_stream_align_get_stats:
+ * @align: a #GstAudioStreamAlign
+ *
+ * Returns statistics about the alignment decisions taken so far as a
+ * #GstStructure named "application/x-gst-audio-stream-align-stats" with
+ * the following fields:
+ *
+ * - "disconts" G_TYPE_UINT64: number of discontinuities detected, not
+ *   counting the initial synchronisation
+ * - "drift" G_TYPE_INT64: drift since the last discontinuity in nanoseconds
+ * - "drift-estimate" G_TYPE_INT64: windowed drift estimate in nanoseconds
+ * - "max-drift" G_TYPE_UINT64: largest absolute drift seen in nanoseconds
+ * - "time-since-discont" G_TYPE_UINT64: duration of the data processed
+ *   since the last discontinuity in nanoseconds
+ *
+ * Returns: (transfer full): a new #GstStructure, free with
+ *     gst_structure_free()
+ *
+ * Since: 1.20
+ */
+GstStructure *
+gst_audio_stream_align_get_stats (const GstAudioStreamAlign * align)
+{
+  g_return_val_if_fail (align != NULL, NULL);
+
+  return gst_structure_new ("application/x-gst-audio-stream-align-stats",
+      "disconts", G_TYPE_UINT64, align->n_disconts,
+      "drift", G_TYPE_INT64, align->drift,
+      "drift-estimate", G_TYPE_INT64,
+      gst_audio_stream_align_get_drift_estimate (align),
+      "max-drift", G_TYPE_UINT64, align->max_drift,
+      "time-since-discont", G_TYPE_UINT64,
+      gst_util_uint64_scale_int (align->samples_since_discont, GST_SECOND,
+          ABS (align->rate)), NULL);
+}
@@ -87,6 +87,21 @@ gboolean                gst_audio_stream_align_process                   (GstAud
                                                                           GstClockTime *out_duration,
                                                                           guint64 *out_sample_position);
 
+GST_AUDIO_API
+void                    gst_audio_stream_align_set_drift_window          (GstAudioStreamAlign * align,
+                                                                          guint window);
+GST_AUDIO_API
+guint                   gst_audio_stream_align_get_drift_window          (const GstAudioStreamAlign * align);
+
+GST_AUDIO_API
+GstClockTimeDiff        gst_audio_stream_align_get_drift                 (const GstAudioStreamAlign * align);
+
+GST_AUDIO_API
+GstClockTimeDiff        gst_audio_stream_align_get_drift_estimate        (const GstAudioStreamAlign * align);
+
+GST_AUDIO_API
+GstStructure *          gst_audio_stream_align_get_stats                 (const GstAudioStreamAlign * align);
+
 G_END_DECLS
 
 #endif /* __GST_AUDIO_STREAM_ALIGN_H__ */
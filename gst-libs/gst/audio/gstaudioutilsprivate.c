@@ -24,6 +24,7 @@
 #endif
 
 #include <gst/audio/audio.h>
+#include <gst/base/gstqueuearray.h>
 #ifdef G_OS_WIN32
 #include <windows.h>
 #endif
@@ -333,3 +334,145 @@ __gst_audio_restore_thread_priority (gpointer handle)
   return TRUE;
 #endif
 }
+
+/*
+ * Simple helper to run the same function with different data on multiple
+ * threads of a shared task pool and wait for all of them to finish. One of
+ * the tasks is always run from the calling thread.
+ */
+typedef struct
+{
+  GstAudioParallelizedTaskFunc func;
+  gpointer user_data;
+} GstAudioParallelizedWorkItem;
+
+struct _GstAudioParallelizedTaskRunner
+{
+  GstTaskPool *pool;
+  guint n_threads;
+
+  GstQueueArray *tasks;
+  GstQueueArray *work_items;
+
+  GMutex lock;
+};
+
+static void
+__gst_audio_parallelized_task_thread_func (gpointer data)
+{
+  GstAudioParallelizedTaskRunner *runner = data;
+  GstAudioParallelizedWorkItem *item, work_item;
+
+  g_mutex_lock (&runner->lock);
+  item = gst_queue_array_pop_head_struct (runner->work_items);
+  g_assert (item != NULL);
+  work_item = *item;
+  g_mutex_unlock (&runner->lock);
+
+  work_item.func (work_item.user_data);
+}
+
+static void
+__gst_audio_parallelized_task_runner_join (GstAudioParallelizedTaskRunner *
+    self)
+{
+  gboolean joined = FALSE;
+
+  while (!joined) {
+    g_mutex_lock (&self->lock);
+    if (!(joined = gst_queue_array_is_empty (self->tasks))) {
+      gpointer task = gst_queue_array_pop_head (self->tasks);
+      g_mutex_unlock (&self->lock);
+      gst_task_pool_join (self->pool, task);
+    } else {
+      g_mutex_unlock (&self->lock);
+    }
+  }
+}
+
+GstAudioParallelizedTaskRunner *
+__gst_audio_parallelized_task_runner_new (guint n_threads)
+{
+  GstAudioParallelizedTaskRunner *self;
+
+  if (n_threads == 0 || n_threads > g_get_num_processors ())
+    n_threads = g_get_num_processors ();
+
+  self = g_new0 (GstAudioParallelizedTaskRunner, 1);
+
+  self->pool = gst_shared_task_pool_new ();
+  gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL (self->pool),
+      n_threads);
+  gst_task_pool_prepare (self->pool, NULL);
+
+  self->tasks = gst_queue_array_new (n_threads);
+  self->work_items = gst_queue_array_new_for_struct (sizeof
+      (GstAudioParallelizedWorkItem), n_threads);
+  self->n_threads = n_threads;
+
+  g_mutex_init (&self->lock);
+
+  return self;
+}
+
+void
+__gst_audio_parallelized_task_runner_free (GstAudioParallelizedTaskRunner *
+    self)
+{
+  __gst_audio_parallelized_task_runner_join (self);
+
+  gst_queue_array_free (self->work_items);
+  gst_queue_array_free (self->tasks);
+  gst_task_pool_cleanup (self->pool);
+  gst_object_unref (self->pool);
+  g_mutex_clear (&self->lock);
+  g_free (self);
+}
+
+guint
+__gst_audio_parallelized_task_runner_get_n_threads
+    (GstAudioParallelizedTaskRunner * self)
+{
+  return self->n_threads;
+}
+
+/*
+ * Calls @func once for each of the @n_tasks entries of @task_data and
+ * returns after all calls finished.
+ */
+void
+__gst_audio_parallelized_task_runner_run (GstAudioParallelizedTaskRunner *
+    self, GstAudioParallelizedTaskFunc func, gpointer * task_data,
+    guint n_tasks)
+{
+  guint i;
+
+  if (n_tasks == 0)
+    return;
+
+  if (n_tasks > 1) {
+    g_mutex_lock (&self->lock);
+    for (i = 1; i < n_tasks; i++) {
+      GstAudioParallelizedWorkItem work_item;
+      gpointer task;
+
+      work_item.func = func;
+      work_item.user_data = task_data[i];
+      gst_queue_array_push_tail_struct (self->work_items, &work_item);
+
+      task =
+          gst_task_pool_push (self->pool,
+          __gst_audio_parallelized_task_thread_func, self, NULL);
+
+      /* The return value of push() is unfortunately nullable, and we can't
+       * deal with that */
+      g_assert (task != NULL);
+      gst_queue_array_push_tail (self->tasks, task);
+    }
+    g_mutex_unlock (&self->lock);
+  }
+
+  func (task_data[0]);
+
+  __gst_audio_parallelized_task_runner_join (self);
+}
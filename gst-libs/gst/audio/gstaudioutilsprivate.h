@@ -48,6 +48,27 @@ gboolean __gst_audio_set_thread_priority   (gpointer * handle);
 G_GNUC_INTERNAL
 gboolean __gst_audio_restore_thread_priority (gpointer handle);
 
+/* Parallel processing helper */
+typedef void (*GstAudioParallelizedTaskFunc) (gpointer user_data);
+
+typedef struct _GstAudioParallelizedTaskRunner GstAudioParallelizedTaskRunner;
+
+G_GNUC_INTERNAL
+GstAudioParallelizedTaskRunner *
+         __gst_audio_parallelized_task_runner_new  (guint n_threads);
+
+G_GNUC_INTERNAL
+void     __gst_audio_parallelized_task_runner_free (GstAudioParallelizedTaskRunner * self);
+
+G_GNUC_INTERNAL
+guint    __gst_audio_parallelized_task_runner_get_n_threads (GstAudioParallelizedTaskRunner * self);
+
+G_GNUC_INTERNAL
+void     __gst_audio_parallelized_task_runner_run  (GstAudioParallelizedTaskRunner * self,
+                                                    GstAudioParallelizedTaskFunc func,
+                                                    gpointer * task_data,
+                                                    guint n_tasks);
+
 G_END_DECLS
 
 #endif
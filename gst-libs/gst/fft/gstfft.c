@@ -32,6 +32,7 @@
 #include <glib.h>
 
 #include "gstfft.h"
+#include "gstfftprivate.h"
 #include "kiss_fft_s16.h"
 
 /**
@@ -56,3 +57,95 @@ gst_fft_next_fast_length (gint n)
   /* The real FFT needs an even length so calculate that */
   return 2 * kiss_fft_s16_next_fast_size (half);
 }
+
+/* The twiddle factors of a configuration only depend on the length and the
+ * direction, so one configuration per type, length and direction is kept
+ * around for the lifetime of the process. New instances copy it instead of
+ * calculating all factors again. The number of cached configurations is
+ * limited so that applications using lots of different lengths don't keep
+ * growing the cache. */
+#define MAX_CACHED_PLANS 64
+
+typedef struct
+{
+  GstFFTPlanCreateFunc create;
+  gint len;
+  gboolean inverse;
+  gpointer plan;
+} GstFFTCachedPlan;
+
+G_LOCK_DEFINE_STATIC (plan_cache);
+static GstFFTCachedPlan plan_cache[MAX_CACHED_PLANS];
+static guint n_cached_plans;
+
+/* Returns the cached configuration created by @create for @len and @inverse,
+ * creating it if necessary. The configuration must not be modified and stays
+ * valid forever. Returns %NULL if the cache is full. */
+gpointer
+__gst_fft_plan_cache_get (GstFFTPlanCreateFunc create, gint len,
+    gboolean inverse)
+{
+  gpointer plan = NULL;
+  guint i;
+
+  inverse = ! !inverse;
+
+  G_LOCK (plan_cache);
+  for (i = 0; i < n_cached_plans; i++) {
+    GstFFTCachedPlan *cached = &plan_cache[i];
+
+    if (cached->create == create && cached->len == len
+        && cached->inverse == inverse) {
+      plan = cached->plan;
+      break;
+    }
+  }
+
+  if (!plan && n_cached_plans < MAX_CACHED_PLANS) {
+    plan = create (len, inverse);
+    if (plan) {
+      plan_cache[n_cached_plans].create = create;
+      plan_cache[n_cached_plans].len = len;
+      plan_cache[n_cached_plans].inverse = inverse;
+      plan_cache[n_cached_plans].plan = plan;
+      n_cached_plans++;
+    }
+  }
+  G_UNLOCK (plan_cache);
+
+  return plan;
+}
+
+/* Fills @coeffs with the @len coefficients of @window */
+void
+__gst_fft_fill_window (gdouble * coeffs, gint len, GstFFTWindow window)
+{
+  gint i;
+
+  switch (window) {
+    case GST_FFT_WINDOW_RECTANGULAR:
+      for (i = 0; i < len; i++)
+        coeffs[i] = 1.0;
+      break;
+    case GST_FFT_WINDOW_HAMMING:
+      for (i = 0; i < len; i++)
+        coeffs[i] = 0.53836 - 0.46164 * cos (2.0 * G_PI * i / len);
+      break;
+    case GST_FFT_WINDOW_HANN:
+      for (i = 0; i < len; i++)
+        coeffs[i] = 0.5 - 0.5 * cos (2.0 * G_PI * i / len);
+      break;
+    case GST_FFT_WINDOW_BARTLETT:
+      for (i = 0; i < len; i++)
+        coeffs[i] = 1.0 - fabs ((2.0 * i - len) / len);
+      break;
+    case GST_FFT_WINDOW_BLACKMAN:
+      for (i = 0; i < len; i++)
+        coeffs[i] = 0.42 - 0.5 * cos ((2.0 * i) / len) +
+            0.08 * cos ((4.0 * i) / len);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
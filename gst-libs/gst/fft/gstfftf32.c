@@ -27,6 +27,7 @@
 #include "_kiss_fft_guts_f32.h"
 #include "kiss_fftr_f32.h"
 #include "gstfft.h"
+#include "gstfftprivate.h"
 #include "gstfftf32.h"
 
 /**
@@ -44,7 +45,9 @@
  *
  * For the best performance use gst_fft_next_fast_length() to get a
  * number that is entirely a product of 2, 3 and 5 and use this as the
- * @len parameter for gst_fft_f32_new().
+ * @len parameter for gst_fft_f32_new(). Powers of two of at least 16 are
+ * transformed by a separate implementation that uses SSE or NEON where
+ * available and are the fastest lengths.
  *
  * The @len parameter specifies the number of samples in the time domain that
  * will be processed or generated. The number of samples in the frequency domain
@@ -67,8 +70,73 @@ struct _GstFFTF32
   void *cfg;
   gboolean inverse;
   gint len;
+
+  /* vectorized transform for powers of two, used instead of @cfg if set */
+  gpointer simd_plan;
+  gboolean simd_plan_owned;
+  gfloat *simd_scratch;
+
+  /* coefficients of the last used window function */
+  GstFFTWindow window;
+  gdouble *window_coeffs;
+
+  /* deinterleaved input for gst_fft_f32_fft_interleaved() */
+  gfloat *scratch;
+  gsize scratch_size;
 };
 
+static gpointer
+gst_fft_f32_create_plan (gint len, gboolean inverse)
+{
+  return kiss_fftr_f32_alloc (len, (inverse) ? 1 : 0, NULL, NULL);
+}
+
+/* Returns the coefficients of @window, which are calculated only once for
+ * consecutive calls with the same window function */
+static const gdouble *
+gst_fft_f32_get_window (GstFFTF32 * self, GstFFTWindow window)
+{
+  if (self->window_coeffs && self->window == window)
+    return self->window_coeffs;
+
+  if (!self->window_coeffs)
+    self->window_coeffs = g_new (gdouble, self->len);
+  __gst_fft_fill_window (self->window_coeffs, self->len, window);
+  self->window = window;
+
+  return self->window_coeffs;
+}
+
+static inline void
+gst_fft_f32_transform (GstFFTF32 * self, const gfloat * timedata,
+    GstFFTF32Complex * freqdata)
+{
+#ifdef GST_FFT_F32_SIMD
+  if (self->simd_plan) {
+    __gst_fft_f32_simd_fft (self->simd_plan, self->simd_scratch, timedata,
+        freqdata);
+    return;
+  }
+#endif
+
+  kiss_fftr_f32 (self->cfg, timedata, (kiss_fft_f32_cpx *) freqdata);
+}
+
+static inline void
+gst_fft_f32_inverse_transform (GstFFTF32 * self,
+    const GstFFTF32Complex * freqdata, gfloat * timedata)
+{
+#ifdef GST_FFT_F32_SIMD
+  if (self->simd_plan) {
+    __gst_fft_f32_simd_inverse_fft (self->simd_plan, self->simd_scratch,
+        freqdata, timedata);
+    return;
+  }
+#endif
+
+  kiss_fftri_f32 (self->cfg, (const kiss_fft_f32_cpx *) freqdata, timedata);
+}
+
 /**
  * gst_fft_f32_new: (skip)
  * @len: Length of the FFT in the time domain
@@ -77,6 +145,10 @@ struct _GstFFTF32
  * This returns a new #GstFFTF32 instance with the given parameters. It makes
  * sense to keep one instance for several calls for speed reasons.
  *
+ * The precalculated twiddle factors are shared between all instances for the
+ * same @len and direction, so creating another instance for a length that
+ * was used before is cheap.
+ *
  * @len must be even and to get the best performance a product of
  * 2, 3 and 5. To get the next number with this characteristics use
  * gst_fft_next_fast_length().
@@ -88,17 +160,46 @@ gst_fft_f32_new (gint len, gboolean inverse)
 {
   GstFFTF32 *self;
   gsize subsize = 0, memneeded;
+  kiss_fftr_f32_cfg plan;
 
   g_return_val_if_fail (len > 0, NULL);
   g_return_val_if_fail (len % 2 == 0, NULL);
 
+#ifdef GST_FFT_F32_SIMD
+  if (__gst_fft_f32_simd_supports (len)) {
+    memneeded = ALIGN_STRUCT (sizeof (GstFFTF32)) + 2 * len * sizeof (gfloat);
+    self = (GstFFTF32 *) g_malloc0 (memneeded);
+
+    self->simd_scratch =
+        (gfloat *) (((guint8 *) self) + ALIGN_STRUCT (sizeof (GstFFTF32)));
+    self->simd_plan =
+        __gst_fft_plan_cache_get (__gst_fft_f32_simd_plan_new, len, inverse);
+    if (!self->simd_plan) {
+      self->simd_plan = __gst_fft_f32_simd_plan_new (len, inverse);
+      self->simd_plan_owned = TRUE;
+    }
+    g_assert (self->simd_plan);
+
+    self->inverse = inverse;
+    self->len = len;
+
+    return self;
+  }
+#endif
+
   kiss_fftr_f32_alloc (len, (inverse) ? 1 : 0, NULL, &subsize);
   memneeded = ALIGN_STRUCT (sizeof (GstFFTF32)) + subsize;
 
   self = (GstFFTF32 *) g_malloc0 (memneeded);
 
   self->cfg = (((guint8 *) self) + ALIGN_STRUCT (sizeof (GstFFTF32)));
-  self->cfg = kiss_fftr_f32_alloc (len, (inverse) ? 1 : 0, self->cfg, &subsize);
+
+  plan = __gst_fft_plan_cache_get (gst_fft_f32_create_plan, len, inverse);
+  if (plan)
+    self->cfg = kiss_fftr_f32_copy (plan, self->cfg, &subsize);
+  else
+    self->cfg =
+        kiss_fftr_f32_alloc (len, (inverse) ? 1 : 0, self->cfg, &subsize);
   g_assert (self->cfg);
 
   self->inverse = inverse;
@@ -121,6 +222,10 @@ gst_fft_f32_new (gint len, gboolean inverse)
  * @freqdata must be large enough to hold @len/2 + 1 #GstFFTF32Complex frequency
  * domain samples.
  *
+ * @timedata and @freqdata can point to the same memory for an in-place
+ * transform, which then has to be large enough for the frequency domain
+ * samples.
+ *
  */
 void
 gst_fft_f32_fft (GstFFTF32 * self, const gfloat * timedata,
@@ -131,7 +236,7 @@ gst_fft_f32_fft (GstFFTF32 * self, const gfloat * timedata,
   g_return_if_fail (timedata);
   g_return_if_fail (freqdata);
 
-  kiss_fftr_f32 (self->cfg, timedata, (kiss_fft_f32_cpx *) freqdata);
+  gst_fft_f32_transform (self, timedata, freqdata);
 }
 
 /**
@@ -147,6 +252,9 @@ gst_fft_f32_fft (GstFFTF32 * self, const gfloat * timedata,
  *
  * @timedata must be large enough to hold @len time domain samples.
  *
+ * @freqdata and @timedata can point to the same memory for an in-place
+ * transform.
+ *
  */
 void
 gst_fft_f32_inverse_fft (GstFFTF32 * self, const GstFFTF32Complex * freqdata,
@@ -157,7 +265,148 @@ gst_fft_f32_inverse_fft (GstFFTF32 * self, const GstFFTF32Complex * freqdata,
   g_return_if_fail (timedata);
   g_return_if_fail (freqdata);
 
-  kiss_fftri_f32 (self->cfg, (kiss_fft_f32_cpx *) freqdata, timedata);
+  gst_fft_f32_inverse_transform (self, freqdata, timedata);
+}
+
+/**
+ * gst_fft_f32_fft_batch:
+ * @self: #GstFFTF32 instance for this call
+ * @timedata: Buffer of the samples in the time domain
+ * @freqdata: Target buffer for the samples in the frequency domain
+ * @n_transforms: Number of transforms to perform
+ *
+ * This performs the FFT on @n_transforms consecutive blocks of @len samples
+ * in @timedata and puts the results as consecutive blocks of @len/2 + 1
+ * #GstFFTF32Complex frequency domain samples in @freqdata, where @len is
+ * the parameter specified while allocating the #GstFFTF32 instance with
+ * gst_fft_f32_new().
+ *
+ * This gives the same result as calling gst_fft_f32_fft() for every block.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_f32_fft_batch (GstFFTF32 * self, const gfloat * timedata,
+    GstFFTF32Complex * freqdata, guint n_transforms)
+{
+  gsize len, freqlen;
+  guint i;
+
+  g_return_if_fail (self);
+  g_return_if_fail (!self->inverse);
+  g_return_if_fail (timedata || n_transforms == 0);
+  g_return_if_fail (freqdata || n_transforms == 0);
+
+  len = self->len;
+  freqlen = len / 2 + 1;
+
+  for (i = 0; i < n_transforms; i++)
+    gst_fft_f32_transform (self, timedata + i * len, freqdata + i * freqlen);
+}
+
+/**
+ * gst_fft_f32_inverse_fft_batch:
+ * @self: #GstFFTF32 instance for this call
+ * @freqdata: Buffer of the samples in the frequency domain
+ * @timedata: Target buffer for the samples in the time domain
+ * @n_transforms: Number of transforms to perform
+ *
+ * This performs the inverse FFT on @n_transforms consecutive blocks of
+ * @len/2 + 1 samples in @freqdata and puts the results as consecutive blocks
+ * of @len time domain samples in @timedata, where @len is the parameter
+ * specified while allocating the #GstFFTF32 instance with
+ * gst_fft_f32_new().
+ *
+ * This gives the same result as calling gst_fft_f32_inverse_fft() for every
+ * block.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_f32_inverse_fft_batch (GstFFTF32 * self,
+    const GstFFTF32Complex * freqdata, gfloat * timedata, guint n_transforms)
+{
+  gsize len, freqlen;
+  guint i;
+
+  g_return_if_fail (self);
+  g_return_if_fail (self->inverse);
+  g_return_if_fail (timedata || n_transforms == 0);
+  g_return_if_fail (freqdata || n_transforms == 0);
+
+  len = self->len;
+  freqlen = len / 2 + 1;
+
+  for (i = 0; i < n_transforms; i++)
+    gst_fft_f32_inverse_transform (self, freqdata + i * freqlen,
+        timedata + i * len);
+}
+
+/**
+ * gst_fft_f32_fft_interleaved:
+ * @self: #GstFFTF32 instance for this call
+ * @timedata: Buffer of the interleaved samples in the time domain
+ * @channels: Number of channels in @timedata
+ * @window: Window function to apply before the FFT
+ * @freqdata: Target buffer for the samples in the frequency domain
+ *
+ * This applies the window function @window to each of the @channels
+ * interleaved channels in @timedata, performs the FFT on them and puts the
+ * results as consecutive blocks of @len/2 + 1 #GstFFTF32Complex frequency
+ * domain samples in @freqdata, one block per channel.
+ *
+ * @timedata must have @len frames of @channels samples, where @len is the
+ * parameter specified while allocating the #GstFFTF32 instance with
+ * gst_fft_f32_new(). It is not modified.
+ *
+ * This gives the same result as deinterleaving the channels and calling
+ * gst_fft_f32_window() and gst_fft_f32_fft() for each of them.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_f32_fft_interleaved (GstFFTF32 * self, const gfloat * timedata,
+    guint channels, GstFFTWindow window, GstFFTF32Complex * freqdata)
+{
+  const gdouble *coeffs = NULL;
+  gsize len, size, i;
+  guint c;
+
+  g_return_if_fail (self);
+  g_return_if_fail (!self->inverse);
+  g_return_if_fail (timedata || channels == 0);
+  g_return_if_fail (freqdata || channels == 0);
+
+  len = self->len;
+  size = len * channels;
+  if (self->scratch_size < size) {
+    g_free (self->scratch);
+    self->scratch = g_new (gfloat, size);
+    self->scratch_size = size;
+  }
+
+  if (window != GST_FFT_WINDOW_RECTANGULAR)
+    coeffs = gst_fft_f32_get_window (self, window);
+
+  /* deinterleave and window in one pass, reading the input sequentially */
+  if (coeffs) {
+    for (i = 0; i < len; i++) {
+      const gfloat *in = timedata + i * channels;
+      gdouble w = coeffs[i];
+
+      for (c = 0; c < channels; c++)
+        self->scratch[c * len + i] = in[c] * w;
+    }
+  } else {
+    for (i = 0; i < len; i++) {
+      const gfloat *in = timedata + i * channels;
+
+      for (c = 0; c < channels; c++)
+        self->scratch[c * len + i] = in[c];
+    }
+  }
+
+  gst_fft_f32_fft_batch (self, self->scratch, freqdata, channels);
 }
 
 /**
@@ -170,6 +419,12 @@ gst_fft_f32_inverse_fft (GstFFTF32 * self, const GstFFTF32Complex * freqdata,
 void
 gst_fft_f32_free (GstFFTF32 * self)
 {
+#ifdef GST_FFT_F32_SIMD
+  if (self->simd_plan_owned)
+    __gst_fft_f32_simd_plan_free (self->simd_plan);
+#endif
+  g_free (self->window_coeffs);
+  g_free (self->scratch);
   g_free (self);
 }
 
@@ -185,36 +440,18 @@ gst_fft_f32_free (GstFFTF32 * self)
 void
 gst_fft_f32_window (GstFFTF32 * self, gfloat * timedata, GstFFTWindow window)
 {
+  const gdouble *coeffs;
   gint i, len;
 
   g_return_if_fail (self);
   g_return_if_fail (timedata);
 
+  if (window == GST_FFT_WINDOW_RECTANGULAR)
+    return;
+
   len = self->len;
+  coeffs = gst_fft_f32_get_window (self, window);
 
-  switch (window) {
-    case GST_FFT_WINDOW_RECTANGULAR:
-      /* do nothing */
-      break;
-    case GST_FFT_WINDOW_HAMMING:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.53836 - 0.46164 * cos (2.0 * G_PI * i / len));
-      break;
-    case GST_FFT_WINDOW_HANN:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.5 - 0.5 * cos (2.0 * G_PI * i / len));
-      break;
-    case GST_FFT_WINDOW_BARTLETT:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (1.0 - fabs ((2.0 * i - len) / len));
-      break;
-    case GST_FFT_WINDOW_BLACKMAN:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.42 - 0.5 * cos ((2.0 * i) / len) +
-            0.08 * cos ((4.0 * i) / len));
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
-  }
+  for (i = 0; i < len; i++)
+    timedata[i] *= coeffs[i];
 }
@@ -0,0 +1,327 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Vectorized real FFT for power of two lengths.
+ *
+ * A real transform of length len is done as a complex transform of length
+ * n = len / 2 on the even and odd samples, followed by the same split step
+ * KISS FFT uses in kiss_fftr_f32(). The complex transform is a radix-2
+ * Stockham transform on separate real and imaginary arrays. Every stage
+ * reads both halves of its input sequentially and writes its output in
+ * natural order, so no bit reversal is needed and four butterflies are
+ * always done at once with SSE or NEON. Without either it is slower than
+ * KISS FFT and not built.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+#include <math.h>
+
+#include "gstfftprivate.h"
+
+#ifdef GST_FFT_F32_SIMD
+
+#if defined (HAVE_XMMINTRIN_H) && defined (__SSE__)
+#include <xmmintrin.h>
+
+typedef __m128 v4sf;
+
+#define V4SF_LOAD(p) _mm_loadu_ps (p)
+#define V4SF_STORE(p, v) _mm_storeu_ps (p, v)
+#define V4SF_SPLAT(f) _mm_set1_ps (f)
+#define V4SF_ADD(a, b) _mm_add_ps (a, b)
+#define V4SF_SUB(a, b) _mm_sub_ps (a, b)
+#define V4SF_MUL(a, b) _mm_mul_ps (a, b)
+/* a0 b0 a1 b1 and a2 b2 a3 b3 */
+#define V4SF_ZIP_LO(a, b) _mm_unpacklo_ps (a, b)
+#define V4SF_ZIP_HI(a, b) _mm_unpackhi_ps (a, b)
+/* a0 a1 b0 b1 and a2 a3 b2 b3 */
+#define V4SF_HALVES_LO(a, b) _mm_movelh_ps (a, b)
+#define V4SF_HALVES_HI(a, b) _mm_movehl_ps (b, a)
+
+#else
+#include <arm_neon.h>
+
+typedef float32x4_t v4sf;
+
+#define V4SF_LOAD(p) vld1q_f32 (p)
+#define V4SF_STORE(p, v) vst1q_f32 (p, v)
+#define V4SF_SPLAT(f) vdupq_n_f32 (f)
+#define V4SF_ADD(a, b) vaddq_f32 (a, b)
+#define V4SF_SUB(a, b) vsubq_f32 (a, b)
+#define V4SF_MUL(a, b) vmulq_f32 (a, b)
+#define V4SF_ZIP_LO(a, b) (vzipq_f32 (a, b).val[0])
+#define V4SF_ZIP_HI(a, b) (vzipq_f32 (a, b).val[1])
+#define V4SF_HALVES_LO(a, b) vcombine_f32 (vget_low_f32 (a), vget_low_f32 (b))
+#define V4SF_HALVES_HI(a, b) vcombine_f32 (vget_high_f32 (a), vget_high_f32 (b))
+#endif
+
+typedef struct
+{
+  gint len;
+  gint n;
+
+  /* twiddle factors of all stages one after another. The stage with stride
+   * s uses n / (2 * s) factors, except the first two stages, which store
+   * one factor per butterfly (n / 2) so they can be loaded as vectors */
+  gfloat *twiddles_r;
+  gfloat *twiddles_i;
+
+  /* n / 2 factors of the split step, like the super twiddles of KISS FFT */
+  gfloat *super_r;
+  gfloat *super_i;
+} GstFFTF32SimdPlan;
+
+/* Returns %TRUE if the transform of @len samples can be done here */
+gboolean
+__gst_fft_f32_simd_supports (gint len)
+{
+  return len >= 16 && (len & (len - 1)) == 0;
+}
+
+static inline gsize
+twiddles_size (gint n)
+{
+  /* n / 2 + n / 2 + n / 8 + n / 16 + ... + 1 */
+  return n + n / 4 - 1;
+}
+
+/* Creates the plan for the transform of @len samples. It is not modified by
+ * the transforms, so it can be shared between instances */
+gpointer
+__gst_fft_f32_simd_plan_new (gint len, gboolean inverse)
+{
+  GstFFTF32SimdPlan *plan;
+  gint n = len / 2, half = n / 2, s, k;
+  gsize n_twiddles = twiddles_size (n);
+  gdouble sign = inverse ? 1.0 : -1.0;
+  gfloat *wr, *wi;
+
+  g_return_val_if_fail (__gst_fft_f32_simd_supports (len), NULL);
+
+  plan = g_malloc (sizeof (GstFFTF32SimdPlan) +
+      (2 * n_twiddles + 2 * half) * sizeof (gfloat));
+  plan->len = len;
+  plan->n = n;
+  plan->twiddles_r = (gfloat *) (plan + 1);
+  plan->twiddles_i = plan->twiddles_r + n_twiddles;
+  plan->super_r = plan->twiddles_i + n_twiddles;
+  plan->super_i = plan->super_r + half;
+
+  wr = plan->twiddles_r;
+  wi = plan->twiddles_i;
+  for (s = 1; s < n; s *= 2) {
+    gint m = half / s;
+
+    if (s <= 2) {
+      /* one factor per butterfly k, which uses factor k / s */
+      for (k = 0; k < half; k++) {
+        gdouble phase = sign * 2.0 * G_PI * (k / s) * s / n;
+
+        wr[k] = cos (phase);
+        wi[k] = sin (phase);
+      }
+      wr += half;
+      wi += half;
+    } else {
+      for (k = 0; k < m; k++) {
+        gdouble phase = sign * 2.0 * G_PI * k * s / n;
+
+        wr[k] = cos (phase);
+        wi[k] = sin (phase);
+      }
+      wr += m;
+      wi += m;
+    }
+  }
+  g_assert (wr == plan->twiddles_r + n_twiddles);
+
+  for (k = 0; k < half; k++) {
+    gdouble phase = sign * G_PI * ((gdouble) (k + 1) / n + 0.5);
+
+    plan->super_r[k] = cos (phase);
+    plan->super_i[k] = sin (phase);
+  }
+
+  return plan;
+}
+
+void
+__gst_fft_f32_simd_plan_free (gpointer plan)
+{
+  g_free (plan);
+}
+
+/* One radix-2 decimation in frequency stage with stride s = 1 << shift.
+ * Butterfly k combines x[k] and x[k + half] and writes the results to
+ * y[k + s * p] and y[k + s * p + s] with p = k / s */
+static void
+fft_stage (const gfloat * xr, const gfloat * xi, gfloat * yr, gfloat * yi,
+    const gfloat * wr, const gfloat * wi, gint half, gint shift)
+{
+  gint s = 1 << shift;
+  gint k;
+
+  for (k = 0; k < half; k += 4) {
+    v4sf ar = V4SF_LOAD (xr + k), ai = V4SF_LOAD (xi + k);
+    v4sf br = V4SF_LOAD (xr + k + half), bi = V4SF_LOAD (xi + k + half);
+    v4sf sr = V4SF_ADD (ar, br), si = V4SF_ADD (ai, bi);
+    v4sf dr = V4SF_SUB (ar, br), di = V4SF_SUB (ai, bi);
+    v4sf twr, twi, pr, pi;
+
+    if (s <= 2) {
+      twr = V4SF_LOAD (wr + k);
+      twi = V4SF_LOAD (wi + k);
+    } else {
+      twr = V4SF_SPLAT (wr[k >> shift]);
+      twi = V4SF_SPLAT (wi[k >> shift]);
+    }
+
+    pr = V4SF_SUB (V4SF_MUL (dr, twr), V4SF_MUL (di, twi));
+    pi = V4SF_ADD (V4SF_MUL (dr, twi), V4SF_MUL (di, twr));
+
+    if (s == 1) {
+      /* sums go to y[2k], differences to y[2k + 1] */
+      V4SF_STORE (yr + 2 * k, V4SF_ZIP_LO (sr, pr));
+      V4SF_STORE (yr + 2 * k + 4, V4SF_ZIP_HI (sr, pr));
+      V4SF_STORE (yi + 2 * k, V4SF_ZIP_LO (si, pi));
+      V4SF_STORE (yi + 2 * k + 4, V4SF_ZIP_HI (si, pi));
+    } else if (s == 2) {
+      /* pairs of sums and differences alternate */
+      V4SF_STORE (yr + 2 * k, V4SF_HALVES_LO (sr, pr));
+      V4SF_STORE (yr + 2 * k + 4, V4SF_HALVES_HI (sr, pr));
+      V4SF_STORE (yi + 2 * k, V4SF_HALVES_LO (si, pi));
+      V4SF_STORE (yi + 2 * k + 4, V4SF_HALVES_HI (si, pi));
+    } else {
+      /* all four butterflies have the same p */
+      gint o = k + ((k >> shift) << shift);
+
+      V4SF_STORE (yr + o, sr);
+      V4SF_STORE (yi + o, si);
+      V4SF_STORE (yr + o + s, pr);
+      V4SF_STORE (yi + o + s, pi);
+    }
+  }
+}
+
+/* Transforms the n complex values in @xr and @xi, using @yr and @yi as
+ * second buffer. Returns the arrays that contain the result */
+static void
+fft_complex (const GstFFTF32SimdPlan * plan, gfloat * xr, gfloat * xi,
+    gfloat * yr, gfloat * yi, gfloat ** out_r, gfloat ** out_i)
+{
+  const gfloat *wr = plan->twiddles_r, *wi = plan->twiddles_i;
+  gint half = plan->n / 2, shift;
+
+  for (shift = 0; (1 << shift) < plan->n; shift++) {
+    gint n_twiddles = (shift <= 1) ? half : half >> shift;
+    gfloat *tmp;
+
+    fft_stage (xr, xi, yr, yi, wr, wi, half, shift);
+    wr += n_twiddles;
+    wi += n_twiddles;
+
+    tmp = xr;
+    xr = yr;
+    yr = tmp;
+    tmp = xi;
+    xi = yi;
+    yi = tmp;
+  }
+
+  *out_r = xr;
+  *out_i = xi;
+}
+
+/* Forward transform of @plan->len samples in @timedata to
+ * @plan->len / 2 + 1 values in @freqdata. @scratch must have space for
+ * 2 * @plan->len samples. @timedata and @freqdata can be the same */
+void
+__gst_fft_f32_simd_fft (gconstpointer p, gfloat * scratch,
+    const gfloat * timedata, GstFFTF32Complex * freqdata)
+{
+  const GstFFTF32SimdPlan *plan = p;
+  gint n = plan->n, k;
+  gfloat *zr, *zi;
+
+  for (k = 0; k < n; k++) {
+    scratch[k] = timedata[2 * k];
+    scratch[n + k] = timedata[2 * k + 1];
+  }
+
+  fft_complex (plan, scratch, scratch + n, scratch + 2 * n, scratch + 3 * n,
+      &zr, &zi);
+
+  freqdata[0].r = zr[0] + zi[0];
+  freqdata[0].i = 0;
+  freqdata[n].r = zr[0] - zi[0];
+  freqdata[n].i = 0;
+
+  for (k = 1; k <= n / 2; k++) {
+    gfloat f1r = zr[k] + zr[n - k], f1i = zi[k] - zi[n - k];
+    gfloat f2r = zr[k] - zr[n - k], f2i = zi[k] + zi[n - k];
+    gfloat sr = plan->super_r[k - 1], si = plan->super_i[k - 1];
+    gfloat twr = f2r * sr - f2i * si, twi = f2r * si + f2i * sr;
+
+    freqdata[k].r = 0.5f * (f1r + twr);
+    freqdata[k].i = 0.5f * (f1i + twi);
+    freqdata[n - k].r = 0.5f * (f1r - twr);
+    freqdata[n - k].i = 0.5f * (twi - f1i);
+  }
+}
+
+/* Inverse transform of @plan->len / 2 + 1 values in @freqdata to
+ * @plan->len samples in @timedata, see __gst_fft_f32_simd_fft() */
+void
+__gst_fft_f32_simd_inverse_fft (gconstpointer p, gfloat * scratch,
+    const GstFFTF32Complex * freqdata, gfloat * timedata)
+{
+  const GstFFTF32SimdPlan *plan = p;
+  gint n = plan->n, k;
+  gfloat *xr = scratch, *xi = scratch + n;
+  gfloat *zr, *zi;
+
+  xr[0] = freqdata[0].r + freqdata[n].r;
+  xi[0] = freqdata[0].r - freqdata[n].r;
+
+  for (k = 1; k <= n / 2; k++) {
+    gfloat fer = freqdata[k].r + freqdata[n - k].r;
+    gfloat fei = freqdata[k].i - freqdata[n - k].i;
+    gfloat tr = freqdata[k].r - freqdata[n - k].r;
+    gfloat ti = freqdata[k].i + freqdata[n - k].i;
+    gfloat sr = plan->super_r[k - 1], si = plan->super_i[k - 1];
+    gfloat for_ = tr * sr - ti * si, foi = tr * si + ti * sr;
+
+    xr[k] = fer + for_;
+    xi[k] = fei + foi;
+    xr[n - k] = fer - for_;
+    xi[n - k] = foi - fei;
+  }
+
+  fft_complex (plan, xr, xi, scratch + 2 * n, scratch + 3 * n, &zr, &zi);
+
+  for (k = 0; k < n; k++) {
+    timedata[2 * k] = zr[k];
+    timedata[2 * k + 1] = zi[k];
+  }
+}
+
+#endif /* GST_FFT_F32_SIMD */
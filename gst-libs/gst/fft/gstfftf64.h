@@ -63,6 +63,19 @@ GST_FFT_API
 void            gst_fft_f64_inverse_fft (GstFFTF64 *self, const GstFFTF64Complex *freqdata,
                                          gdouble *timedata);
 
+GST_FFT_API
+void            gst_fft_f64_fft_batch (GstFFTF64 *self, const gdouble *timedata,
+                                       GstFFTF64Complex *freqdata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_f64_inverse_fft_batch (GstFFTF64 *self, const GstFFTF64Complex *freqdata,
+                                               gdouble *timedata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_f64_fft_interleaved (GstFFTF64 *self, const gdouble *timedata,
+                                             guint channels, GstFFTWindow window,
+                                             GstFFTF64Complex *freqdata);
+
 GST_FFT_API
 void            gst_fft_f64_window      (GstFFTF64 *self, gdouble *timedata, GstFFTWindow window);
 
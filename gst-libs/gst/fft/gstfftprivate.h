@@ -0,0 +1,64 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_FFT_PRIVATE_H__
+#define __GST_FFT_PRIVATE_H__
+
+#include <glib.h>
+
+#include "gstfft.h"
+#include "gstfftf32.h"
+
+G_BEGIN_DECLS
+
+/* Creates the KISS FFT configuration for @len and @inverse */
+typedef gpointer (*GstFFTPlanCreateFunc) (gint len, gboolean inverse);
+
+G_GNUC_INTERNAL
+gpointer __gst_fft_plan_cache_get (GstFFTPlanCreateFunc create, gint len,
+    gboolean inverse);
+
+G_GNUC_INTERNAL
+void __gst_fft_fill_window (gdouble * coeffs, gint len, GstFFTWindow window);
+
+/* Vectorized backend for #GstFFTF32 on powers of two, see gstfftf32simd.c.
+ * Without SSE or NEON KISS FFT is faster, so it is not built then */
+#if (defined (HAVE_XMMINTRIN_H) && defined (__SSE__)) || defined (__ARM_NEON)
+#define GST_FFT_F32_SIMD 1
+
+G_GNUC_INTERNAL
+gboolean __gst_fft_f32_simd_supports (gint len);
+
+G_GNUC_INTERNAL
+gpointer __gst_fft_f32_simd_plan_new (gint len, gboolean inverse);
+
+G_GNUC_INTERNAL
+void __gst_fft_f32_simd_plan_free (gpointer plan);
+
+G_GNUC_INTERNAL
+void __gst_fft_f32_simd_fft (gconstpointer plan, gfloat * scratch,
+    const gfloat * timedata, GstFFTF32Complex * freqdata);
+
+G_GNUC_INTERNAL
+void __gst_fft_f32_simd_inverse_fft (gconstpointer plan, gfloat * scratch,
+    const GstFFTF32Complex * freqdata, gfloat * timedata);
+#endif
+
+G_END_DECLS
+
+#endif /* __GST_FFT_PRIVATE_H__ */
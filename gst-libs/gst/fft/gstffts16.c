@@ -27,6 +27,7 @@
 #include "_kiss_fft_guts_s16.h"
 #include "kiss_fftr_s16.h"
 #include "gstfft.h"
+#include "gstfftprivate.h"
 #include "gstffts16.h"
 
 /**
@@ -67,8 +68,38 @@ struct _GstFFTS16
   void *cfg;
   gboolean inverse;
   gint len;
+
+  /* coefficients of the last used window function */
+  GstFFTWindow window;
+  gdouble *window_coeffs;
+
+  /* deinterleaved input for gst_fft_s16_fft_interleaved() */
+  gint16 *scratch;
+  gsize scratch_size;
 };
 
+static gpointer
+gst_fft_s16_create_plan (gint len, gboolean inverse)
+{
+  return kiss_fftr_s16_alloc (len, (inverse) ? 1 : 0, NULL, NULL);
+}
+
+/* Returns the coefficients of @window, which are calculated only once for
+ * consecutive calls with the same window function */
+static const gdouble *
+gst_fft_s16_get_window (GstFFTS16 * self, GstFFTWindow window)
+{
+  if (self->window_coeffs && self->window == window)
+    return self->window_coeffs;
+
+  if (!self->window_coeffs)
+    self->window_coeffs = g_new (gdouble, self->len);
+  __gst_fft_fill_window (self->window_coeffs, self->len, window);
+  self->window = window;
+
+  return self->window_coeffs;
+}
+
 /**
  * gst_fft_s16_new: (skip)
  * @len: Length of the FFT in the time domain
@@ -77,6 +108,10 @@ struct _GstFFTS16
  * This returns a new #GstFFTS16 instance with the given parameters. It makes
  * sense to keep one instance for several calls for speed reasons.
  *
+ * The precalculated twiddle factors are shared between all instances for the
+ * same @len and direction, so creating another instance for a length that
+ * was used before is cheap.
+ *
  * @len must be even and to get the best performance a product of
  * 2, 3 and 5. To get the next number with this characteristics use
  * gst_fft_next_fast_length().
@@ -88,6 +123,7 @@ gst_fft_s16_new (gint len, gboolean inverse)
 {
   GstFFTS16 *self;
   gsize subsize = 0, memneeded;
+  kiss_fftr_s16_cfg plan;
 
   g_return_val_if_fail (len > 0, NULL);
   g_return_val_if_fail (len % 2 == 0, NULL);
@@ -98,7 +134,13 @@ gst_fft_s16_new (gint len, gboolean inverse)
   self = (GstFFTS16 *) g_malloc0 (memneeded);
 
   self->cfg = (((guint8 *) self) + ALIGN_STRUCT (sizeof (GstFFTS16)));
-  self->cfg = kiss_fftr_s16_alloc (len, (inverse) ? 1 : 0, self->cfg, &subsize);
+
+  plan = __gst_fft_plan_cache_get (gst_fft_s16_create_plan, len, inverse);
+  if (plan)
+    self->cfg = kiss_fftr_s16_copy (plan, self->cfg, &subsize);
+  else
+    self->cfg =
+        kiss_fftr_s16_alloc (len, (inverse) ? 1 : 0, self->cfg, &subsize);
   g_assert (self->cfg);
 
   self->inverse = inverse;
@@ -121,6 +163,10 @@ gst_fft_s16_new (gint len, gboolean inverse)
  * @freqdata must be large enough to hold @len/2 + 1 #GstFFTS16Complex frequency
  * domain samples.
  *
+ * @timedata and @freqdata can point to the same memory for an in-place
+ * transform, which then has to be large enough for the frequency domain
+ * samples.
+ *
  */
 void
 gst_fft_s16_fft (GstFFTS16 * self, const gint16 * timedata,
@@ -147,6 +193,9 @@ gst_fft_s16_fft (GstFFTS16 * self, const gint16 * timedata,
  *
  * @timedata must be large enough to hold @len time domain samples.
  *
+ * @freqdata and @timedata can point to the same memory for an in-place
+ * transform.
+ *
  */
 void
 gst_fft_s16_inverse_fft (GstFFTS16 * self, const GstFFTS16Complex * freqdata,
@@ -160,6 +209,149 @@ gst_fft_s16_inverse_fft (GstFFTS16 * self, const GstFFTS16Complex * freqdata,
   kiss_fftri_s16 (self->cfg, (kiss_fft_s16_cpx *) freqdata, timedata);
 }
 
+/**
+ * gst_fft_s16_fft_batch:
+ * @self: #GstFFTS16 instance for this call
+ * @timedata: Buffer of the samples in the time domain
+ * @freqdata: Target buffer for the samples in the frequency domain
+ * @n_transforms: Number of transforms to perform
+ *
+ * This performs the FFT on @n_transforms consecutive blocks of @len samples
+ * in @timedata and puts the results as consecutive blocks of @len/2 + 1
+ * #GstFFTS16Complex frequency domain samples in @freqdata, where @len is
+ * the parameter specified while allocating the #GstFFTS16 instance with
+ * gst_fft_s16_new().
+ *
+ * This gives the same result as calling gst_fft_s16_fft() for every block.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_s16_fft_batch (GstFFTS16 * self, const gint16 * timedata,
+    GstFFTS16Complex * freqdata, guint n_transforms)
+{
+  gsize len, freqlen;
+  guint i;
+
+  g_return_if_fail (self);
+  g_return_if_fail (!self->inverse);
+  g_return_if_fail (timedata || n_transforms == 0);
+  g_return_if_fail (freqdata || n_transforms == 0);
+
+  len = self->len;
+  freqlen = len / 2 + 1;
+
+  for (i = 0; i < n_transforms; i++)
+    kiss_fftr_s16 (self->cfg, timedata + i * len,
+        (kiss_fft_s16_cpx *) freqdata + i * freqlen);
+}
+
+/**
+ * gst_fft_s16_inverse_fft_batch:
+ * @self: #GstFFTS16 instance for this call
+ * @freqdata: Buffer of the samples in the frequency domain
+ * @timedata: Target buffer for the samples in the time domain
+ * @n_transforms: Number of transforms to perform
+ *
+ * This performs the inverse FFT on @n_transforms consecutive blocks of
+ * @len/2 + 1 samples in @freqdata and puts the results as consecutive blocks
+ * of @len time domain samples in @timedata, where @len is the parameter
+ * specified while allocating the #GstFFTS16 instance with
+ * gst_fft_s16_new().
+ *
+ * This gives the same result as calling gst_fft_s16_inverse_fft() for every
+ * block.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_s16_inverse_fft_batch (GstFFTS16 * self,
+    const GstFFTS16Complex * freqdata, gint16 * timedata, guint n_transforms)
+{
+  gsize len, freqlen;
+  guint i;
+
+  g_return_if_fail (self);
+  g_return_if_fail (self->inverse);
+  g_return_if_fail (timedata || n_transforms == 0);
+  g_return_if_fail (freqdata || n_transforms == 0);
+
+  len = self->len;
+  freqlen = len / 2 + 1;
+
+  for (i = 0; i < n_transforms; i++)
+    kiss_fftri_s16 (self->cfg,
+        (const kiss_fft_s16_cpx *) freqdata + i * freqlen,
+        timedata + i * len);
+}
+
+/**
+ * gst_fft_s16_fft_interleaved:
+ * @self: #GstFFTS16 instance for this call
+ * @timedata: Buffer of the interleaved samples in the time domain
+ * @channels: Number of channels in @timedata
+ * @window: Window function to apply before the FFT
+ * @freqdata: Target buffer for the samples in the frequency domain
+ *
+ * This applies the window function @window to each of the @channels
+ * interleaved channels in @timedata, performs the FFT on them and puts the
+ * results as consecutive blocks of @len/2 + 1 #GstFFTS16Complex frequency
+ * domain samples in @freqdata, one block per channel.
+ *
+ * @timedata must have @len frames of @channels samples, where @len is the
+ * parameter specified while allocating the #GstFFTS16 instance with
+ * gst_fft_s16_new(). It is not modified.
+ *
+ * This gives the same result as deinterleaving the channels and calling
+ * gst_fft_s16_window() and gst_fft_s16_fft() for each of them.
+ *
+ * Since: 1.20
+ */
+void
+gst_fft_s16_fft_interleaved (GstFFTS16 * self, const gint16 * timedata,
+    guint channels, GstFFTWindow window, GstFFTS16Complex * freqdata)
+{
+  const gdouble *coeffs = NULL;
+  gsize len, size, i;
+  guint c;
+
+  g_return_if_fail (self);
+  g_return_if_fail (!self->inverse);
+  g_return_if_fail (timedata || channels == 0);
+  g_return_if_fail (freqdata || channels == 0);
+
+  len = self->len;
+  size = len * channels;
+  if (self->scratch_size < size) {
+    g_free (self->scratch);
+    self->scratch = g_new (gint16, size);
+    self->scratch_size = size;
+  }
+
+  if (window != GST_FFT_WINDOW_RECTANGULAR)
+    coeffs = gst_fft_s16_get_window (self, window);
+
+  /* deinterleave and window in one pass, reading the input sequentially */
+  if (coeffs) {
+    for (i = 0; i < len; i++) {
+      const gint16 *in = timedata + i * channels;
+      gdouble w = coeffs[i];
+
+      for (c = 0; c < channels; c++)
+        self->scratch[c * len + i] = in[c] * w;
+    }
+  } else {
+    for (i = 0; i < len; i++) {
+      const gint16 *in = timedata + i * channels;
+
+      for (c = 0; c < channels; c++)
+        self->scratch[c * len + i] = in[c];
+    }
+  }
+
+  gst_fft_s16_fft_batch (self, self->scratch, freqdata, channels);
+}
+
 /**
  * gst_fft_s16_free:
  * @self: #GstFFTS16 instance for this call
@@ -170,6 +362,8 @@ gst_fft_s16_inverse_fft (GstFFTS16 * self, const GstFFTS16Complex * freqdata,
 void
 gst_fft_s16_free (GstFFTS16 * self)
 {
+  g_free (self->window_coeffs);
+  g_free (self->scratch);
   g_free (self);
 }
 
@@ -185,36 +379,18 @@ gst_fft_s16_free (GstFFTS16 * self)
 void
 gst_fft_s16_window (GstFFTS16 * self, gint16 * timedata, GstFFTWindow window)
 {
+  const gdouble *coeffs;
   gint i, len;
 
   g_return_if_fail (self);
   g_return_if_fail (timedata);
 
+  if (window == GST_FFT_WINDOW_RECTANGULAR)
+    return;
+
   len = self->len;
+  coeffs = gst_fft_s16_get_window (self, window);
 
-  switch (window) {
-    case GST_FFT_WINDOW_RECTANGULAR:
-      /* do nothing */
-      break;
-    case GST_FFT_WINDOW_HAMMING:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.53836 - 0.46164 * cos (2.0 * G_PI * i / len));
-      break;
-    case GST_FFT_WINDOW_HANN:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.5 - 0.5 * cos (2.0 * G_PI * i / len));
-      break;
-    case GST_FFT_WINDOW_BARTLETT:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (1.0 - fabs ((2.0 * i - len) / len));
-      break;
-    case GST_FFT_WINDOW_BLACKMAN:
-      for (i = 0; i < len; i++)
-        timedata[i] *= (0.42 - 0.5 * cos ((2.0 * i) / len) +
-            0.08 * cos ((4.0 * i) / len));
-      break;
-    default:
-      g_assert_not_reached ();
-      break;
-  }
+  for (i = 0; i < len; i++)
+    timedata[i] *= coeffs[i];
 }
@@ -63,6 +63,19 @@ GST_FFT_API
 void            gst_fft_s16_inverse_fft (GstFFTS16 *self, const GstFFTS16Complex *freqdata,
                                          gint16 *timedata);
 
+GST_FFT_API
+void            gst_fft_s16_fft_batch (GstFFTS16 *self, const gint16 *timedata,
+                                       GstFFTS16Complex *freqdata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_s16_inverse_fft_batch (GstFFTS16 *self, const GstFFTS16Complex *freqdata,
+                                               gint16 *timedata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_s16_fft_interleaved (GstFFTS16 *self, const gint16 *timedata,
+                                             guint channels, GstFFTWindow window,
+                                             GstFFTS16Complex *freqdata);
+
 GST_FFT_API
 void            gst_fft_s16_window      (GstFFTS16 *self, gint16 *timedata, GstFFTWindow window);
 
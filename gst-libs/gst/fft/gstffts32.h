@@ -63,6 +63,19 @@ GST_FFT_API
 void            gst_fft_s32_inverse_fft (GstFFTS32 *self, const GstFFTS32Complex *freqdata,
                                          gint32 *timedata);
 
+GST_FFT_API
+void            gst_fft_s32_fft_batch (GstFFTS32 *self, const gint32 *timedata,
+                                       GstFFTS32Complex *freqdata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_s32_inverse_fft_batch (GstFFTS32 *self, const GstFFTS32Complex *freqdata,
+                                               gint32 *timedata, guint n_transforms);
+
+GST_FFT_API
+void            gst_fft_s32_fft_interleaved (GstFFTS32 *self, const gint32 *timedata,
+                                             guint channels, GstFFTWindow window,
+                                             GstFFTS32Complex *freqdata);
+
 GST_FFT_API
 void            gst_fft_s32_window      (GstFFTS32 *self, gint32 *timedata, GstFFTWindow window);
 
@@ -60,6 +60,43 @@ kiss_fftr_f32_alloc (int nfft, int inverse_fft, void *mem, size_t * lenmem)
   return st;
 }
 
+/* Copies the configuration @src, which avoids calculating the twiddle
+ * factors again. @mem and @lenmem work like for kiss_fftr_f32_alloc() */
+kiss_fftr_f32_cfg
+kiss_fftr_f32_copy (kiss_fftr_f32_cfg src, void *mem, size_t * lenmem)
+{
+  kiss_fftr_f32_cfg st = NULL;
+  size_t subsize = 0, memneeded;
+  int nfft = src->substate->nfft;
+
+  kiss_fft_f32_alloc (nfft, src->substate->inverse, NULL, &subsize);
+  memneeded =
+      ALIGN_STRUCT (sizeof (struct kiss_fftr_f32_state)) +
+      ALIGN_STRUCT (subsize) + sizeof (kiss_fft_f32_cpx) * (nfft * 3 / 2);
+
+  if (lenmem == NULL) {
+    st = (kiss_fftr_f32_cfg) KISS_FFT_F32_MALLOC (memneeded);
+  } else {
+    if (*lenmem >= memneeded)
+      st = (kiss_fftr_f32_cfg) mem;
+    *lenmem = memneeded;
+  }
+  if (!st)
+    return NULL;
+
+  memcpy (st, src, memneeded);
+
+  /* the configuration is a single block, fix up the pointers into it */
+  st->substate =
+      (kiss_fft_f32_cfg) (((char *) st) +
+      ALIGN_STRUCT (sizeof (struct kiss_fftr_f32_state)));
+  st->tmpbuf =
+      (kiss_fft_f32_cpx *) (((char *) st->substate) + ALIGN_STRUCT (subsize));
+  st->super_twiddles = st->tmpbuf + nfft;
+
+  return st;
+}
+
 void
 kiss_fftr_f32 (kiss_fftr_f32_cfg st, const kiss_fft_f32_scalar * timedata,
     kiss_fft_f32_cpx * freqdata)
@@ -34,6 +34,12 @@ kiss_fftr_f64_cfg kiss_fftr_f64_alloc(int nfft,int inverse_fft,void * mem, size_
 */
 
 
+kiss_fftr_f64_cfg kiss_fftr_f64_copy(kiss_fftr_f64_cfg src,void * mem, size_t * lenmem);
+/*
+ Copies an existing configuration without recalculating the twiddle factors.
+ mem and lenmem work like for kiss_fftr_f64_alloc()
+*/
+
 void kiss_fftr_f64(kiss_fftr_f64_cfg cfg,const kiss_fft_f64_scalar *timedata,kiss_fft_f64_cpx *freqdata);
 /*
  input timedata has nfft scalar points
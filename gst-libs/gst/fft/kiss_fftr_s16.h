@@ -34,6 +34,12 @@ kiss_fftr_s16_cfg kiss_fftr_s16_alloc(int nfft,int inverse_fft,void * mem, size_
 */
 
 
+kiss_fftr_s16_cfg kiss_fftr_s16_copy(kiss_fftr_s16_cfg src,void * mem, size_t * lenmem);
+/*
+ Copies an existing configuration without recalculating the twiddle factors.
+ mem and lenmem work like for kiss_fftr_s16_alloc()
+*/
+
 void kiss_fftr_s16(kiss_fftr_s16_cfg cfg,const kiss_fft_s16_scalar *timedata,kiss_fft_s16_cpx *freqdata);
 /*
  input timedata has nfft scalar points
@@ -34,6 +34,12 @@ kiss_fftr_s32_cfg kiss_fftr_s32_alloc(int nfft,int inverse_fft,void * mem, size_
 */
 
 
+kiss_fftr_s32_cfg kiss_fftr_s32_copy(kiss_fftr_s32_cfg src,void * mem, size_t * lenmem);
+/*
+ Copies an existing configuration without recalculating the twiddle factors.
+ mem and lenmem work like for kiss_fftr_s32_alloc()
+*/
+
 void kiss_fftr_s32(kiss_fftr_s32_cfg cfg,const kiss_fft_s32_scalar *timedata,kiss_fft_s32_cpx *freqdata);
 /*
  input timedata has nfft scalar points
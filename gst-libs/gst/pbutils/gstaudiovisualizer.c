@@ -51,12 +51,14 @@ GST_DEBUG_CATEGORY_STATIC (audio_visualizer_debug);
 
 #define DEFAULT_SHADER GST_AUDIO_VISUALIZER_SHADER_FADE
 #define DEFAULT_SHADE_AMOUNT   0x000a0a0a
+#define DEFAULT_MAX_THREADS    1
 
 enum
 {
   PROP_0,
   PROP_SHADER,
-  PROP_SHADE_AMOUNT
+  PROP_SHADE_AMOUNT,
+  PROP_MAX_THREADS
 };
 
 static GstBaseTransformClass *parent_class = NULL;
@@ -97,6 +99,19 @@ static gboolean gst_audio_visualizer_do_bufferpool (GstAudioVisualizer * scope,
 static gboolean
 default_decide_allocation (GstAudioVisualizer * scope, GstQuery * query);
 
+typedef struct
+{
+  const guint8 *s;
+  guint8 *d;
+  gint ss, ds;
+  gint width, height;
+  /* shade amount for two pixels, see shade_pixels() */
+  guint64 amount;
+} GstAudioVisualizerShaderContext;
+
+typedef void (*GstAudioVisualizerShaderRowFunc) (const
+    GstAudioVisualizerShaderContext * ctx, gint j);
+
 struct _GstAudioVisualizerPrivate
 {
   gboolean negotiated;
@@ -111,9 +126,14 @@ struct _GstAudioVisualizerPrivate
   GstPad *srcpad, *sinkpad;
 
   GstAudioVisualizerShader shader_type;
-  GstAudioVisualizerShaderFunc shader;
+  GstAudioVisualizerShaderRowFunc shader;
   guint32 shade_amount;
 
+  /* threaded shading, with config_lock */
+  guint max_threads;
+  guint n_threads;
+  GstTaskPool *task_pool;
+
   GstAdapter *adapter;
 
   GstBuffer *inbuf;
@@ -138,318 +158,254 @@ struct _GstAudioVisualizerPrivate
 
 /* shading functions */
 
-/* we're only supporting GST_VIDEO_FORMAT_xRGB right now) */
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-
-#define SHADE(_d, _s, _i, _r, _g, _b)                     \
-G_STMT_START {                                            \
-    _d[_i * 4 + 0] = (_s[_i * 4 + 0] > _b) ? _s[_i * 4 + 0] - _b : 0; \
-    _d[_i * 4 + 1] = (_s[_i * 4 + 1] > _g) ? _s[_i * 4 + 1] - _g : 0; \
-    _d[_i * 4 + 2] = (_s[_i * 4 + 2] > _r) ? _s[_i * 4 + 2] - _r : 0; \
-    _d[_i * 4 + 3] = 0;                                       \
-} G_STMT_END
+/* we're only supporting GST_VIDEO_FORMAT_xRGB right now.
+ *
+ * Pixels are shaded with a saturating subtraction on all bytes of a 64 bit
+ * word at once, so two pixels are processed per step. The shade amount is
+ * laid out like the pixels in memory, with 0xff for the padding byte so that
+ * it always ends up as 0. As xRGB is stored as 0xXXRRGGBB in a native 32 bit
+ * word on both little and big endian systems, no byte swapping is needed.
+ */
+#define SHADE_HIGH_BITS G_GUINT64_CONSTANT (0x8080808080808080)
 
-#else /* G_BYTE_ORDER == G_LITTLE_ENDIAN */
+static inline guint64
+shade_pixels (guint64 x, guint64 amount)
+{
+  guint64 diff, borrow;
 
-#define SHADE(_d, _s, _i, _r, _g, _b)                     \
-G_STMT_START {                                            \
-    _d[_i * 4 + 0] = 0;                                       \
-    _d[_i * 4 + 1] = (_s[_i * 4 + 1] > _r) ? _s[_i * 4 + 1] - _r : 0; \
-    _d[_i * 4 + 2] = (_s[_i * 4 + 2] > _g) ? _s[_i * 4 + 2] - _g : 0; \
-    _d[_i * 4 + 3] = (_s[_i * 4 + 3] > _b) ? _s[_i * 4 + 3] - _b : 0; \
-} G_STMT_END
+  /* per byte x - amount, without borrowing from the neighbouring byte */
+  diff = ((x | SHADE_HIGH_BITS) - (amount & ~SHADE_HIGH_BITS)) ^
+      ((x ^ ~amount) & SHADE_HIGH_BITS);
+  /* high bit of each byte that underflowed */
+  borrow = ((~x & amount) | (~(x ^ amount) & diff)) & SHADE_HIGH_BITS;
 
-#endif
+  return diff & ~((borrow >> 7) * 0xff);
+}
 
 static void
-shader_fade (GstAudioVisualizer * scope, const GstVideoFrame * sframe,
-    GstVideoFrame * dframe)
+shade_row (guint8 * d, const guint8 * s, gint n_pixels, guint64 amount)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  for (j = 0; j < height; j++) {
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    s += ss;
-    d += ds;
+  gint i;
+
+  for (i = 0; i + 2 <= n_pixels; i += 2) {
+    guint64 x;
+
+    memcpy (&x, s + i * 4, 8);
+    x = shade_pixels (x, amount);
+    memcpy (d + i * 4, &x, 8);
+  }
+  if (i < n_pixels) {
+    guint32 x;
+
+    memcpy (&x, s + i * 4, 4);
+    x = (guint32) shade_pixels (x, amount);
+    memcpy (d + i * 4, &x, 4);
   }
 }
 
+#define SRC_ROW(ctx, j) ((ctx)->s + (j) * (ctx)->ss)
+#define DST_ROW(ctx, j) ((ctx)->d + (j) * (ctx)->ds)
+
+/* The shaders below fill one destination row each. Every destination row is
+ * written by at most one call, so rows can be shaded in any order and from
+ * multiple threads. */
+
 static void
-shader_fade_and_move_up (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade (const GstAudioVisualizerShaderContext * ctx, gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  for (j = 1; j < height; j++) {
-    s += ss;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    d += ds;
-  }
+  shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j), ctx->width, ctx->amount);
 }
 
 static void
-shader_fade_and_move_down (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_up (const GstAudioVisualizerShaderContext * ctx, gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  for (j = 1; j < height; j++) {
-    d += ds;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    s += ss;
-  }
+  if (j < ctx->height - 1)
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j + 1), ctx->width,
+        ctx->amount);
 }
 
 static void
-shader_fade_and_move_left (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_down (const GstAudioVisualizerShaderContext * ctx, gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  width -= 1;
-  s += 4;
-
-  /* move to the left */
-  for (j = 0; j < height; j++) {
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    d += ds;
-    s += ss;
-  }
+  if (j > 0)
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j - 1), ctx->width,
+        ctx->amount);
 }
 
 static void
-shader_fade_and_move_right (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_left (const GstAudioVisualizerShaderContext * ctx, gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  width -= 1;
-  d += 4;
-
-  /* move to the right */
-  for (j = 0; j < height; j++) {
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    d += ds;
-    s += ss;
-  }
+  shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j) + 4, ctx->width - 1,
+      ctx->amount);
 }
 
 static void
-shader_fade_and_move_horiz_out (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_right (const GstAudioVisualizerShaderContext * ctx,
+    gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  /* move upper half up */
-  for (j = 0; j < height / 2; j++) {
-    s += ss;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    d += ds;
-  }
-  /* move lower half down */
-  for (j = 0; j < height / 2; j++) {
-    d += ds;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    s += ss;
-  }
+  shade_row (DST_ROW (ctx, j) + 4, SRC_ROW (ctx, j), ctx->width - 1,
+      ctx->amount);
 }
 
 static void
-shader_fade_and_move_horiz_in (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_horiz_out (const GstAudioVisualizerShaderContext * ctx,
+    gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *d;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  /* move upper half down */
-  for (j = 0; j < height / 2; j++) {
-    d += ds;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    s += ss;
+  gint half = ctx->height / 2;
+
+  if (j < half) {
+    /* move upper half up */
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j + 1), ctx->width,
+        ctx->amount);
+  } else if (j > half) {
+    /* move lower half down */
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j - 1), ctx->width,
+        ctx->amount);
   }
-  /* move lower half up */
-  for (j = 0; j < height / 2; j++) {
-    s += ss;
-    for (i = 0; i < width; i++) {
-      SHADE (d, s, i, r, g, b);
-    }
-    d += ds;
+}
+
+static void
+shader_fade_and_move_horiz_in (const GstAudioVisualizerShaderContext * ctx,
+    gint j)
+{
+  gint half = ctx->height / 2;
+
+  if (j > 0 && j < half) {
+    /* move upper half down */
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j - 1), ctx->width,
+        ctx->amount);
+  } else if (j >= half && j < ctx->height - 1) {
+    /* move lower half up */
+    shade_row (DST_ROW (ctx, j), SRC_ROW (ctx, j + 1), ctx->width,
+        ctx->amount);
   }
 }
 
 static void
-shader_fade_and_move_vert_out (GstAudioVisualizer * scope,
-    const GstVideoFrame * sframe, GstVideoFrame * dframe)
+shader_fade_and_move_vert_out (const GstAudioVisualizerShaderContext * ctx,
+    gint j)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *s1, *d, *d1;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  for (j = 0; j < height; j++) {
-    /* move left half to the left */
-    s1 = s + 1;
-    for (i = 0; i < width / 2; i++) {
-      SHADE (d, s1, i, r, g, b);
-    }
-    /* move right half to the right */
-    d1 = d + 1;
-    for (; i < width - 1; i++) {
-      SHADE (d1, s, i, r, g, b);
-    }
-    s += ss;
-    d += ds;
+  const guint8 *s = SRC_ROW (ctx, j);
+  guint8 *d = DST_ROW (ctx, j);
+  gint half = ctx->width / 2;
+
+  /* move left half to the left */
+  shade_row (d, s + 1, half, ctx->amount);
+  /* move right half to the right */
+  shade_row (d + 1 + half * 4, s + half * 4, ctx->width - 1 - half,
+      ctx->amount);
+}
+
+static void
+shader_fade_and_move_vert_in (const GstAudioVisualizerShaderContext * ctx,
+    gint j)
+{
+  const guint8 *s = SRC_ROW (ctx, j);
+  guint8 *d = DST_ROW (ctx, j);
+  gint half = ctx->width / 2;
+
+  /* move left half to the right */
+  shade_row (d + 1, s, half, ctx->amount);
+  /* move right half to the left */
+  shade_row (d + half * 4, s + 1 + half * 4, ctx->width - 1 - half,
+      ctx->amount);
+}
+
+#undef SRC_ROW
+#undef DST_ROW
+
+typedef struct
+{
+  const GstAudioVisualizerShaderContext *ctx;
+  GstAudioVisualizerShaderRowFunc shader;
+  gint start, end;
+} GstAudioVisualizerShaderBand;
+
+static void
+gst_audio_visualizer_shade_band (gpointer user_data)
+{
+  GstAudioVisualizerShaderBand *band = user_data;
+  gint j;
+
+  for (j = band->start; j < band->end; j++)
+    band->shader (band->ctx, j);
+}
+
+/* with config_lock */
+static void
+gst_audio_visualizer_update_task_pool (GstAudioVisualizer * scope)
+{
+  guint n_threads = scope->priv->max_threads;
+
+  if (n_threads == 0 || n_threads > g_get_num_processors ())
+    n_threads = g_get_num_processors ();
+
+  if (scope->priv->task_pool && scope->priv->n_threads != n_threads) {
+    gst_task_pool_cleanup (scope->priv->task_pool);
+    gst_clear_object (&scope->priv->task_pool);
   }
+
+  if (!scope->priv->task_pool && n_threads > 1) {
+    GST_DEBUG_OBJECT (scope, "Shading with %u threads", n_threads);
+    scope->priv->task_pool = gst_shared_task_pool_new ();
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL
+        (scope->priv->task_pool), n_threads);
+    gst_task_pool_prepare (scope->priv->task_pool, NULL);
+  }
+  scope->priv->n_threads = n_threads;
 }
 
+/* with config_lock */
 static void
-shader_fade_and_move_vert_in (GstAudioVisualizer * scope,
+gst_audio_visualizer_run_shader (GstAudioVisualizer * scope,
     const GstVideoFrame * sframe, GstVideoFrame * dframe)
 {
-  guint i, j;
-  guint r = (scope->priv->shade_amount >> 16) & 0xff;
-  guint g = (scope->priv->shade_amount >> 8) & 0xff;
-  guint b = (scope->priv->shade_amount >> 0) & 0xff;
-  guint8 *s, *s1, *d, *d1;
-  gint ss, ds, width, height;
-
-  s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
-  ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
-  d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
-  ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
-
-  width = GST_VIDEO_FRAME_WIDTH (sframe);
-  height = GST_VIDEO_FRAME_HEIGHT (sframe);
-
-  for (j = 0; j < height; j++) {
-    /* move left half to the right */
-    d1 = d + 1;
-    for (i = 0; i < width / 2; i++) {
-      SHADE (d1, s, i, r, g, b);
-    }
-    /* move right half to the left */
-    s1 = s + 1;
-    for (; i < width - 1; i++) {
-      SHADE (d, s1, i, r, g, b);
-    }
-    s += ss;
-    d += ds;
+  GstAudioVisualizerShaderContext ctx;
+  GstAudioVisualizerShaderBand *bands;
+  gpointer *tasks;
+  guint32 amount;
+  gint i, n_bands;
+
+  ctx.s = GST_VIDEO_FRAME_PLANE_DATA (sframe, 0);
+  ctx.ss = GST_VIDEO_FRAME_PLANE_STRIDE (sframe, 0);
+  ctx.d = GST_VIDEO_FRAME_PLANE_DATA (dframe, 0);
+  ctx.ds = GST_VIDEO_FRAME_PLANE_STRIDE (dframe, 0);
+  ctx.width = GST_VIDEO_FRAME_WIDTH (sframe);
+  ctx.height = GST_VIDEO_FRAME_HEIGHT (sframe);
+
+  amount = 0xff000000 | (scope->priv->shade_amount & 0x00ffffff);
+  ctx.amount = ((guint64) amount << 32) | amount;
+
+  gst_audio_visualizer_update_task_pool (scope);
+
+  n_bands = scope->priv->task_pool ? MIN (scope->priv->n_threads,
+      ctx.height) : 1;
+  if (n_bands < 1)
+    return;
+
+  bands = g_newa (GstAudioVisualizerShaderBand, n_bands);
+  tasks = g_newa (gpointer, n_bands);
+
+  for (i = 0; i < n_bands; i++) {
+    bands[i].ctx = &ctx;
+    bands[i].shader = scope->priv->shader;
+    bands[i].start = (gint) (((gint64) ctx.height * i) / n_bands);
+    bands[i].end = (gint) (((gint64) ctx.height * (i + 1)) / n_bands);
+  }
+
+  for (i = 1; i < n_bands; i++) {
+    tasks[i] = gst_task_pool_push (scope->priv->task_pool,
+        gst_audio_visualizer_shade_band, &bands[i], NULL);
+    /* fall back to shading from the streaming thread */
+    if (!tasks[i])
+      gst_audio_visualizer_shade_band (&bands[i]);
+  }
+
+  gst_audio_visualizer_shade_band (&bands[0]);
+
+  for (i = 1; i < n_bands; i++) {
+    if (tasks[i])
+      gst_task_pool_join (scope->priv->task_pool, tasks[i]);
   }
 }
 
@@ -567,6 +523,21 @@ gst_audio_visualizer_class_init (GstAudioVisualizerClass * klass)
           "Shading color to use (big-endian ARGB)", 0, G_MAXUINT32,
           DEFAULT_SHADE_AMOUNT,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioVisualizer:max-threads:
+   *
+   * Maximum number of threads to use for applying the shader, 0 uses one
+   * thread per CPU core. The rows of each frame are split evenly between
+   * the threads of a shared task pool.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_THREADS,
+      g_param_spec_uint ("max-threads", "Maximum Threads",
+          "Maximum number of threads to use for shading (0 = auto)", 0,
+          G_MAXINT, DEFAULT_MAX_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -605,6 +576,7 @@ gst_audio_visualizer_init (GstAudioVisualizer * scope,
   scope->priv->shader_type = DEFAULT_SHADER;
   gst_audio_visualizer_change_shader (scope);
   scope->priv->shade_amount = DEFAULT_SHADE_AMOUNT;
+  scope->priv->max_threads = DEFAULT_MAX_THREADS;
 
   /* reset the initial video state */
   gst_video_info_init (&scope->vinfo);
@@ -631,6 +603,11 @@ gst_audio_visualizer_set_property (GObject * object, guint prop_id,
     case PROP_SHADE_AMOUNT:
       scope->priv->shade_amount = g_value_get_uint (value);
       break;
+    case PROP_MAX_THREADS:
+      g_mutex_lock (&scope->priv->config_lock);
+      scope->priv->max_threads = g_value_get_uint (value);
+      g_mutex_unlock (&scope->priv->config_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -650,6 +627,11 @@ gst_audio_visualizer_get_property (GObject * object, guint prop_id,
     case PROP_SHADE_AMOUNT:
       g_value_set_uint (value, scope->priv->shade_amount);
       break;
+    case PROP_MAX_THREADS:
+      g_mutex_lock (&scope->priv->config_lock);
+      g_value_set_uint (value, scope->priv->max_threads);
+      g_mutex_unlock (&scope->priv->config_lock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -674,6 +656,10 @@ gst_audio_visualizer_dispose (GObject * object)
     gst_buffer_unref (scope->priv->tempbuf);
     scope->priv->tempbuf = NULL;
   }
+  if (scope->priv->task_pool) {
+    gst_task_pool_cleanup (scope->priv->task_pool);
+    gst_clear_object (&scope->priv->task_pool);
+  }
   if (scope->priv->config_lock.p) {
     g_mutex_clear (&scope->priv->config_lock);
     scope->priv->config_lock.p = NULL;
@@ -1192,7 +1178,8 @@ gst_audio_visualizer_chain (GstPad * pad, GstObject * parent,
         /* FIXME: SHADER assumes 32bpp */
         if (scope->priv->shader &&
             GST_VIDEO_INFO_COMP_PSTRIDE (&scope->vinfo, 0) == 4) {
-          scope->priv->shader (scope, &outframe, &scope->priv->tempframe);
+          gst_audio_visualizer_run_shader (scope, &outframe,
+              &scope->priv->tempframe);
         }
       }
     }
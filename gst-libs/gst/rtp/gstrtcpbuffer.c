@@ -3624,3 +3624,790 @@ gst_rtcp_packet_xr_get_voip_jitter_buffer_params (GstRTCPPacket * packet,
 
   return TRUE;
 }
+
+/**
+ * gst_rtcp_writer_init:
+ * @writer: a #GstRTCPWriter
+ * @data: (array length=size): the memory to write the compound packet into
+ * @size: the size of @data
+ *
+ * Initialize @writer to build a compound RTCP packet at the start of @data.
+ * Nothing is allocated while writing; once @data is full, the functions
+ * adding packets return %FALSE and leave the packets written so far intact.
+ *
+ * Since: 1.20
+ */
+void
+gst_rtcp_writer_init (GstRTCPWriter * writer, guint8 * data, gsize size)
+{
+  g_return_if_fail (writer != NULL);
+  g_return_if_fail (data != NULL || size == 0);
+
+  memset (writer, 0, sizeof (GstRTCPWriter));
+  writer->data = data;
+  writer->size = size;
+  writer->type = GST_RTCP_TYPE_INVALID;
+}
+
+/**
+ * gst_rtcp_writer_get_size:
+ * @writer: a #GstRTCPWriter
+ *
+ * Returns: the size in bytes of the compound packet written so far.
+ *
+ * Since: 1.20
+ */
+gsize
+gst_rtcp_writer_get_size (GstRTCPWriter * writer)
+{
+  g_return_val_if_fail (writer != NULL, 0);
+
+  return writer->offset;
+}
+
+/* start a new packet at the end of the written data with @body_len bytes
+ * following the header. Returns a pointer to the body or %NULL when there is
+ * no space left. */
+static guint8 *
+gst_rtcp_writer_open_packet (GstRTCPWriter * writer, GstRTCPType type,
+    guint8 count, gsize body_len)
+{
+  guint8 *data;
+
+  if (writer->size - writer->offset < 4 + body_len)
+    return NULL;
+
+  data = writer->data + writer->offset;
+  data[0] = (GST_RTCP_VERSION << 6) | count;
+  data[1] = type;
+  /* length in 32-bit words minus one */
+  GST_WRITE_UINT16_BE (data + 2, body_len >> 2);
+
+  writer->packet_offset = writer->offset;
+  writer->offset += 4 + body_len;
+  writer->type = type;
+  writer->count = count;
+  writer->item_offset = 0;
+
+  return data + 4;
+}
+
+static void
+gst_rtcp_writer_update_length (GstRTCPWriter * writer)
+{
+  GST_WRITE_UINT16_BE (writer->data + writer->packet_offset + 2,
+      ((writer->offset - writer->packet_offset) >> 2) - 1);
+}
+
+/* grow the current packet by @len bytes. Returns a pointer to the new bytes
+ * or %NULL when there is no space left. */
+static guint8 *
+gst_rtcp_writer_extend_packet (GstRTCPWriter * writer, gsize len)
+{
+  guint8 *data;
+
+  if (writer->size - writer->offset < len)
+    return NULL;
+
+  data = writer->data + writer->offset;
+  writer->offset += len;
+  gst_rtcp_writer_update_length (writer);
+
+  return data;
+}
+
+static void
+gst_rtcp_writer_set_count (GstRTCPWriter * writer, guint8 count)
+{
+  guint8 *data = writer->data + writer->packet_offset;
+
+  writer->count = count;
+  data[0] = (data[0] & 0xe0) | count;
+}
+
+/**
+ * gst_rtcp_writer_add_sr:
+ * @writer: a #GstRTCPWriter
+ * @ssrc: the SSRC of the sender
+ * @ntptime: the NTP time
+ * @rtptime: the RTP time
+ * @packet_count: the packet count
+ * @octet_count: the octet count
+ *
+ * Add a sender report with the given sender info to @writer. Report blocks
+ * can be appended with gst_rtcp_writer_add_rb().
+ *
+ * Returns: %TRUE if the packet was added, %FALSE if there is no space left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_sr (GstRTCPWriter * writer, guint32 ssrc,
+    guint64 ntptime, guint32 rtptime, guint32 packet_count,
+    guint32 octet_count)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+
+  data = gst_rtcp_writer_open_packet (writer, GST_RTCP_TYPE_SR, 0, 24);
+  if (data == NULL)
+    return FALSE;
+
+  GST_WRITE_UINT32_BE (data, ssrc);
+  GST_WRITE_UINT64_BE (data + 4, ntptime);
+  GST_WRITE_UINT32_BE (data + 12, rtptime);
+  GST_WRITE_UINT32_BE (data + 16, packet_count);
+  GST_WRITE_UINT32_BE (data + 20, octet_count);
+
+  writer->ssrc = ssrc;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_writer_add_rr:
+ * @writer: a #GstRTCPWriter
+ * @ssrc: the SSRC of the sender of the report
+ *
+ * Add a receiver report from @ssrc to @writer. Report blocks can be appended
+ * with gst_rtcp_writer_add_rb().
+ *
+ * Returns: %TRUE if the packet was added, %FALSE if there is no space left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_rr (GstRTCPWriter * writer, guint32 ssrc)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+
+  data = gst_rtcp_writer_open_packet (writer, GST_RTCP_TYPE_RR, 0, 4);
+  if (data == NULL)
+    return FALSE;
+
+  GST_WRITE_UINT32_BE (data, ssrc);
+
+  writer->ssrc = ssrc;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_writer_add_rb:
+ * @writer: a #GstRTCPWriter
+ * @ssrc: data source being reported
+ * @fractionlost: fraction lost since last SR/RR
+ * @packetslost: the cumululative number of packets lost
+ * @exthighestseq: the extended last sequence number received
+ * @jitter: the interarrival jitter
+ * @lsr: the last SR packet from this source
+ * @dlsr: the delay since last SR packet
+ *
+ * Append a report block to the sender or receiver report that was added
+ * last to @writer. When that report already holds #GST_RTCP_MAX_RB_COUNT
+ * blocks, a new receiver report from the same sender is started so that
+ * any number of sources can be reported in one pass.
+ *
+ * Returns: %TRUE if the report block was added, %FALSE if there is no space
+ * left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_rb (GstRTCPWriter * writer, guint32 ssrc,
+    guint8 fractionlost, gint32 packetslost, guint32 exthighestseq,
+    guint32 jitter, guint32 lsr, guint32 dlsr)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+  g_return_val_if_fail (writer->type == GST_RTCP_TYPE_SR ||
+      writer->type == GST_RTCP_TYPE_RR, FALSE);
+
+  if (writer->count >= GST_RTCP_MAX_RB_COUNT) {
+    /* continue in a new receiver report, with space for the block */
+    if (writer->size - writer->offset < 8 + 24)
+      return FALSE;
+
+    data = gst_rtcp_writer_open_packet (writer, GST_RTCP_TYPE_RR, 0, 4);
+    GST_WRITE_UINT32_BE (data, writer->ssrc);
+  }
+
+  data = gst_rtcp_writer_extend_packet (writer, 24);
+  if (data == NULL)
+    return FALSE;
+
+  GST_WRITE_UINT32_BE (data, ssrc);
+  GST_WRITE_UINT32_BE (data + 4,
+      ((guint32) fractionlost << 24) | (packetslost & 0xffffff));
+  GST_WRITE_UINT32_BE (data + 8, exthighestseq);
+  GST_WRITE_UINT32_BE (data + 12, jitter);
+  GST_WRITE_UINT32_BE (data + 16, lsr);
+  GST_WRITE_UINT32_BE (data + 20, dlsr);
+
+  gst_rtcp_writer_set_count (writer, writer->count + 1);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_writer_add_sdes_chunk:
+ * @writer: a #GstRTCPWriter
+ * @ssrc: the SSRC the chunk describes
+ *
+ * Start a new SDES chunk for @ssrc. Consecutive chunks share one SDES packet
+ * as long as it holds less than #GST_RTCP_MAX_SDES_ITEM_COUNT chunks, after
+ * that a new SDES packet is started. Items are added to the chunk with
+ * gst_rtcp_writer_add_sdes_item().
+ *
+ * Returns: %TRUE if the chunk was added, %FALSE if there is no space left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_sdes_chunk (GstRTCPWriter * writer, guint32 ssrc)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+
+  if (writer->type != GST_RTCP_TYPE_SDES ||
+      writer->count >= GST_RTCP_MAX_SDES_ITEM_COUNT) {
+    /* new packet, with space for the chunk */
+    if (writer->size - writer->offset < 4 + 8)
+      return FALSE;
+
+    gst_rtcp_writer_open_packet (writer, GST_RTCP_TYPE_SDES, 0, 0);
+  }
+
+  data = gst_rtcp_writer_extend_packet (writer, 8);
+  if (data == NULL)
+    return FALSE;
+
+  /* SSRC followed by the end of the item list and padding */
+  GST_WRITE_UINT32_BE (data, ssrc);
+  GST_WRITE_UINT32_BE (data + 4, 0);
+
+  gst_rtcp_writer_set_count (writer, writer->count + 1);
+  writer->item_offset = writer->offset - 4;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_writer_add_sdes_item:
+ * @writer: a #GstRTCPWriter
+ * @type: the #GstRTCPSDESType of the item
+ * @len: the data length
+ * @data: (array length=len): the data
+ *
+ * Add an item to the SDES chunk started last with
+ * gst_rtcp_writer_add_sdes_chunk().
+ *
+ * Returns: %TRUE if the item was added, %FALSE if there is no space left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_sdes_item (GstRTCPWriter * writer, GstRTCPSDESType type,
+    guint8 len, const guint8 * data)
+{
+  guint8 *bdata;
+  gsize end;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+  g_return_val_if_fail (writer->type == GST_RTCP_TYPE_SDES, FALSE);
+  g_return_val_if_fail (writer->item_offset != 0, FALSE);
+  g_return_val_if_fail (data != NULL || len == 0, FALSE);
+
+  /* add 1 byte end and up to 3 bytes padding to fill a full 32 bit word */
+  end = (writer->item_offset + 2 + len + 1 + 3) & ~3;
+  if (end > writer->size)
+    return FALSE;
+
+  bdata = writer->data + writer->item_offset;
+  bdata[0] = type;
+  bdata[1] = len;
+  if (len > 0)
+    memcpy (&bdata[2], data, len);
+  memset (&bdata[2 + len], 0, end - writer->item_offset - 2 - len);
+
+  writer->item_offset += 2 + len;
+  writer->offset = end;
+  gst_rtcp_writer_update_length (writer);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_writer_add_fb:
+ * @writer: a #GstRTCPWriter
+ * @type: %GST_RTCP_TYPE_RTPFB or %GST_RTCP_TYPE_PSFB
+ * @fbtype: the #GstRTCPFBType of the feedback message
+ * @sender_ssrc: the SSRC of the sender of the feedback
+ * @media_ssrc: the SSRC of the media source the feedback is about
+ * @fci: (array length=fci_len) (nullable): the feedback control information
+ * @fci_len: the length of @fci in bytes, a multiple of 4
+ *
+ * Add a feedback message to @writer.
+ *
+ * Returns: %TRUE if the packet was added, %FALSE if there is no space left.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_writer_add_fb (GstRTCPWriter * writer, GstRTCPType type,
+    GstRTCPFBType fbtype, guint32 sender_ssrc, guint32 media_ssrc,
+    const guint8 * fci, guint fci_len)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer != NULL, FALSE);
+  g_return_val_if_fail (type == GST_RTCP_TYPE_RTPFB ||
+      type == GST_RTCP_TYPE_PSFB, FALSE);
+  g_return_val_if_fail ((fci_len & 0x3) == 0, FALSE);
+  g_return_val_if_fail (fci != NULL || fci_len == 0, FALSE);
+
+  data = gst_rtcp_writer_open_packet (writer, type, fbtype & 0x1f,
+      8 + fci_len);
+  if (data == NULL)
+    return FALSE;
+
+  GST_WRITE_UINT32_BE (data, sender_ssrc);
+  GST_WRITE_UINT32_BE (data + 4, media_ssrc);
+  if (fci_len > 0)
+    memcpy (data + 8, fci, fci_len);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_reader_init:
+ * @reader: a #GstRTCPReader
+ * @data: (array length=size): a compound RTCP packet
+ * @size: the size of @data
+ *
+ * Initialize @reader to walk the packets in @data. @data must stay valid
+ * while @reader is used. Call gst_rtcp_reader_next_packet() to move to the
+ * first packet.
+ *
+ * Since: 1.20
+ */
+void
+gst_rtcp_reader_init (GstRTCPReader * reader, const guint8 * data, gsize size)
+{
+  g_return_if_fail (reader != NULL);
+  g_return_if_fail (data != NULL || size == 0);
+
+  memset (reader, 0, sizeof (GstRTCPReader));
+  reader->data = data;
+  reader->size = size;
+  reader->type = GST_RTCP_TYPE_INVALID;
+}
+
+/**
+ * gst_rtcp_reader_next_packet:
+ * @reader: a #GstRTCPReader
+ *
+ * Move @reader to the next packet. The version, length and padding of the
+ * packet are validated.
+ *
+ * Returns: %TRUE if @reader points to a valid packet, %FALSE when there are
+ * no more packets or the next packet is invalid.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_next_packet (GstRTCPReader * reader)
+{
+  const guint8 *data;
+  gsize len, packet_len;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  reader->packet = NULL;
+  reader->type = GST_RTCP_TYPE_INVALID;
+
+  /* we need 4 bytes for the type and length */
+  if (reader->size - reader->offset < 4)
+    return FALSE;
+
+  data = reader->data + reader->offset;
+  if ((data[0] & 0xc0) != (GST_RTCP_VERSION << 6))
+    goto wrong_version;
+
+  len = (GST_READ_UINT16_BE (data + 2) + 1) << 2;
+  if (len > reader->size - reader->offset)
+    goto wrong_length;
+
+  packet_len = len;
+  if (data[0] & 0x20) {
+    /* last byte of padding contains the number of padded bytes including
+     * itself */
+    guint8 pad_bytes = data[len - 1];
+
+    if (pad_bytes == 0 || pad_bytes > len - 4)
+      goto wrong_padding;
+    packet_len -= pad_bytes;
+  }
+
+  reader->offset += len;
+  reader->packet = data;
+  reader->packet_len = packet_len;
+  reader->type = data[1];
+  reader->count = data[0] & 0x1f;
+
+  reader->item_offset = 4;
+  reader->chunks_left = reader->count;
+  reader->in_chunk = FALSE;
+
+  return TRUE;
+
+  /* ERRORS */
+wrong_version:
+  {
+    GST_DEBUG ("wrong version (%d < 2)", data[0] >> 6);
+    return FALSE;
+  }
+wrong_length:
+  {
+    GST_DEBUG ("len check failed");
+    return FALSE;
+  }
+wrong_padding:
+  {
+    GST_DEBUG ("padding check failed");
+    return FALSE;
+  }
+}
+
+/**
+ * gst_rtcp_reader_get_packet_type:
+ * @reader: a #GstRTCPReader
+ *
+ * Returns: the #GstRTCPType of the current packet, %GST_RTCP_TYPE_INVALID
+ * if @reader does not point to a packet.
+ *
+ * Since: 1.20
+ */
+GstRTCPType
+gst_rtcp_reader_get_packet_type (GstRTCPReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, GST_RTCP_TYPE_INVALID);
+
+  return reader->type;
+}
+
+/**
+ * gst_rtcp_reader_get_count:
+ * @reader: a #GstRTCPReader
+ *
+ * Get the count field of the current packet. For SR and RR packets this is
+ * the number of report blocks, for SDES packets the number of chunks and for
+ * feedback packets the #GstRTCPFBType.
+ *
+ * Returns: the count field of the current packet.
+ *
+ * Since: 1.20
+ */
+guint8
+gst_rtcp_reader_get_count (GstRTCPReader * reader)
+{
+  g_return_val_if_fail (reader != NULL, 0);
+  g_return_val_if_fail (reader->packet != NULL, 0);
+
+  return reader->count;
+}
+
+/**
+ * gst_rtcp_reader_get_packet_data:
+ * @reader: a #GstRTCPReader
+ * @size: (out) (optional): the size of the packet without padding
+ *
+ * Returns: (transfer none) (nullable): the data of the current packet,
+ * starting with its header, or %NULL if @reader does not point to a packet.
+ *
+ * Since: 1.20
+ */
+const guint8 *
+gst_rtcp_reader_get_packet_data (GstRTCPReader * reader, gsize * size)
+{
+  g_return_val_if_fail (reader != NULL, NULL);
+
+  if (size)
+    *size = reader->packet ? reader->packet_len : 0;
+
+  return reader->packet;
+}
+
+/**
+ * gst_rtcp_reader_get_sender_ssrc:
+ * @reader: a #GstRTCPReader
+ * @ssrc: (out) (optional): the SSRC of the sender of the current packet
+ *
+ * Get the SSRC that follows the header of SR, RR, APP, XR and feedback
+ * packets.
+ *
+ * Returns: %TRUE if the current packet holds a sender SSRC.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_get_sender_ssrc (GstRTCPReader * reader, guint32 * ssrc)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->packet == NULL || reader->packet_len < 8)
+    return FALSE;
+
+  switch (reader->type) {
+    case GST_RTCP_TYPE_SR:
+    case GST_RTCP_TYPE_RR:
+    case GST_RTCP_TYPE_APP:
+    case GST_RTCP_TYPE_RTPFB:
+    case GST_RTCP_TYPE_PSFB:
+    case GST_RTCP_TYPE_XR:
+      break;
+    default:
+      return FALSE;
+  }
+
+  if (ssrc)
+    *ssrc = GST_READ_UINT32_BE (reader->packet + 4);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_reader_get_sr:
+ * @reader: a #GstRTCPReader
+ * @ssrc: (out) (optional): result SSRC
+ * @ntptime: (out) (optional): result NTP time
+ * @rtptime: (out) (optional): result RTP time
+ * @packet_count: (out) (optional): result packet count
+ * @octet_count: (out) (optional): result octet count
+ *
+ * Parse the sender info of the current SR packet.
+ *
+ * Returns: %TRUE if the current packet is a valid SR packet.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_get_sr (GstRTCPReader * reader, guint32 * ssrc,
+    guint64 * ntptime, guint32 * rtptime, guint32 * packet_count,
+    guint32 * octet_count)
+{
+  const guint8 *data;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->type != GST_RTCP_TYPE_SR || reader->packet_len < 28)
+    return FALSE;
+
+  data = reader->packet + 4;
+  if (ssrc)
+    *ssrc = GST_READ_UINT32_BE (data);
+  if (ntptime)
+    *ntptime = GST_READ_UINT64_BE (data + 4);
+  if (rtptime)
+    *rtptime = GST_READ_UINT32_BE (data + 12);
+  if (packet_count)
+    *packet_count = GST_READ_UINT32_BE (data + 16);
+  if (octet_count)
+    *octet_count = GST_READ_UINT32_BE (data + 20);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_reader_get_rb:
+ * @reader: a #GstRTCPReader
+ * @nth: the nth report block in the current packet
+ * @ssrc: (out) (optional): result for data source being reported
+ * @fractionlost: (out) (optional): result for fraction lost since last SR/RR
+ * @packetslost: (out) (optional): result for the cumululative number of packets lost
+ * @exthighestseq: (out) (optional): result for the extended last sequence number received
+ * @jitter: (out) (optional): result for the interarrival jitter
+ * @lsr: (out) (optional): result for the last SR packet from this source
+ * @dlsr: (out) (optional): result for the delay since last SR packet
+ *
+ * Parse the values of the @nth report block of the current SR or RR packet.
+ *
+ * Returns: %TRUE if the report block could be read.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_get_rb (GstRTCPReader * reader, guint nth, guint32 * ssrc,
+    guint8 * fractionlost, gint32 * packetslost, guint32 * exthighestseq,
+    guint32 * jitter, guint32 * lsr, guint32 * dlsr)
+{
+  const guint8 *data;
+  gsize offset;
+  guint32 tmp;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->type == GST_RTCP_TYPE_RR)
+    offset = 8;
+  else if (reader->type == GST_RTCP_TYPE_SR)
+    offset = 28;
+  else
+    return FALSE;
+
+  if (nth >= reader->count)
+    return FALSE;
+
+  offset += nth * 24;
+  if (offset + 24 > reader->packet_len)
+    return FALSE;
+
+  data = reader->packet + offset;
+  if (ssrc)
+    *ssrc = GST_READ_UINT32_BE (data);
+  tmp = GST_READ_UINT32_BE (data + 4);
+  if (fractionlost)
+    *fractionlost = (tmp >> 24);
+  if (packetslost) {
+    /* sign extend */
+    if (tmp & 0x00800000)
+      tmp |= 0xff000000;
+    else
+      tmp &= 0x00ffffff;
+    *packetslost = (gint32) tmp;
+  }
+  if (exthighestseq)
+    *exthighestseq = GST_READ_UINT32_BE (data + 8);
+  if (jitter)
+    *jitter = GST_READ_UINT32_BE (data + 12);
+  if (lsr)
+    *lsr = GST_READ_UINT32_BE (data + 16);
+  if (dlsr)
+    *dlsr = GST_READ_UINT32_BE (data + 20);
+
+  return TRUE;
+}
+
+/**
+ * gst_rtcp_reader_next_sdes_item:
+ * @reader: a #GstRTCPReader
+ * @ssrc: (out) (optional): the SSRC of the chunk holding the item
+ * @type: (out) (optional): the type of the item
+ * @len: (out) (optional): the length of the item data
+ * @data: (out) (optional) (array length=len) (transfer none): the item data
+ *
+ * Move to the next item of the current SDES packet, going through the
+ * items of all chunks in order.
+ *
+ * Returns: %TRUE if an item was read, %FALSE when there are no more items
+ * or the packet is malformed.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_next_sdes_item (GstRTCPReader * reader, guint32 * ssrc,
+    GstRTCPSDESType * type, guint8 * len, const guint8 ** data)
+{
+  const guint8 *pdata;
+  gsize end;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->type != GST_RTCP_TYPE_SDES)
+    return FALSE;
+
+  pdata = reader->packet;
+  end = reader->packet_len;
+
+  while (TRUE) {
+    guint8 item_len;
+
+    if (!reader->in_chunk) {
+      if (reader->chunks_left == 0 || reader->item_offset + 4 > end)
+        return FALSE;
+
+      reader->chunk_ssrc = GST_READ_UINT32_BE (pdata + reader->item_offset);
+      reader->item_offset += 4;
+      reader->chunks_left--;
+      reader->in_chunk = TRUE;
+    }
+
+    if (reader->item_offset >= end)
+      return FALSE;
+
+    if (pdata[reader->item_offset] == GST_RTCP_SDES_END) {
+      /* end of the chunk, the next one starts at the next 32 bit word */
+      reader->item_offset = (reader->item_offset + 4) & ~3;
+      reader->in_chunk = FALSE;
+      continue;
+    }
+
+    if (reader->item_offset + 2 > end)
+      return FALSE;
+
+    item_len = pdata[reader->item_offset + 1];
+    if (reader->item_offset + 2 + item_len > end)
+      return FALSE;
+
+    if (ssrc)
+      *ssrc = reader->chunk_ssrc;
+    if (type)
+      *type = pdata[reader->item_offset];
+    if (len)
+      *len = item_len;
+    if (data)
+      *data = pdata + reader->item_offset + 2;
+
+    reader->item_offset += 2 + item_len;
+
+    return TRUE;
+  }
+}
+
+/**
+ * gst_rtcp_reader_get_fb:
+ * @reader: a #GstRTCPReader
+ * @fbtype: (out) (optional): the #GstRTCPFBType of the message
+ * @sender_ssrc: (out) (optional): the SSRC of the sender of the feedback
+ * @media_ssrc: (out) (optional): the SSRC of the media source
+ * @fci: (out) (optional) (array length=fci_len) (transfer none): the
+ *   feedback control information
+ * @fci_len: (out) (optional): the length of @fci in bytes
+ *
+ * Parse the current RTPFB or PSFB packet.
+ *
+ * Returns: %TRUE if the current packet is a valid feedback packet.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtcp_reader_get_fb (GstRTCPReader * reader, GstRTCPFBType * fbtype,
+    guint32 * sender_ssrc, guint32 * media_ssrc, const guint8 ** fci,
+    guint * fci_len)
+{
+  g_return_val_if_fail (reader != NULL, FALSE);
+
+  if (reader->type != GST_RTCP_TYPE_RTPFB &&
+      reader->type != GST_RTCP_TYPE_PSFB)
+    return FALSE;
+
+  if (reader->packet_len < 12)
+    return FALSE;
+
+  if (fbtype)
+    *fbtype = reader->count;
+  if (sender_ssrc)
+    *sender_ssrc = GST_READ_UINT32_BE (reader->packet + 4);
+  if (media_ssrc)
+    *media_ssrc = GST_READ_UINT32_BE (reader->packet + 8);
+  if (fci)
+    *fci = reader->packet + 12;
+  if (fci_len)
+    *fci_len = reader->packet_len - 12;
+
+  return TRUE;
+}
@@ -311,6 +311,61 @@ struct _GstRTCPPacket
   guint          entry_offset; /* current entry offset for navigating SDES items */
 };
 
+typedef struct _GstRTCPWriter GstRTCPWriter;
+typedef struct _GstRTCPReader GstRTCPReader;
+
+/**
+ * GstRTCPWriter:
+ *
+ * Builds a compound RTCP packet into caller provided memory without
+ * allocating. The data written so far is a valid compound packet after
+ * every successful call. The size of the structure is made public to allow
+ * stack allocations.
+ *
+ * Since: 1.20
+ */
+struct _GstRTCPWriter
+{
+  /*< private >*/
+  guint8        *data;
+  gsize          size;
+  gsize          offset;        /* end of the written data */
+
+  gsize          packet_offset; /* start of the current packet */
+  GstRTCPType    type;          /* type of the current packet */
+  guint8         count;         /* count field of the current packet */
+  guint32        ssrc;          /* sender SSRC of the current SR or RR */
+
+  gsize          item_offset;   /* next SDES item of the current chunk, 0 if none */
+};
+
+/**
+ * GstRTCPReader:
+ *
+ * Walks the packets of a compound RTCP packet in caller provided memory
+ * without allocating. The size of the structure is made public to allow
+ * stack allocations.
+ *
+ * Since: 1.20
+ */
+struct _GstRTCPReader
+{
+  /*< private >*/
+  const guint8  *data;
+  gsize          size;
+  gsize          offset;        /* start of the next packet */
+
+  const guint8  *packet;        /* current packet, NULL if none */
+  gsize          packet_len;    /* length of the current packet without padding */
+  GstRTCPType    type;          /* type of the current packet */
+  guint8         count;         /* count field of the current packet */
+
+  gsize          item_offset;   /* next SDES item or chunk in the current packet */
+  guint          chunks_left;   /* SDES chunks not started yet */
+  gboolean       in_chunk;      /* whether item_offset points into a chunk */
+  guint32        chunk_ssrc;    /* SSRC of the current SDES chunk */
+};
+
 /* creating buffers */
 
 GST_RTP_API
@@ -665,6 +720,84 @@ gboolean        gst_rtcp_packet_xr_get_voip_jitter_buffer_params        (GstRTCP
                                                                          guint16 * jb_maximum,
                                                                          guint16 * jb_abs_max);
 
+/* writing compound packets into memory */
+
+GST_RTP_API
+void            gst_rtcp_writer_init                  (GstRTCPWriter * writer, guint8 * data,
+                                                       gsize size);
+
+GST_RTP_API
+gsize           gst_rtcp_writer_get_size              (GstRTCPWriter * writer);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_sr                (GstRTCPWriter * writer, guint32 ssrc,
+                                                       guint64 ntptime, guint32 rtptime,
+                                                       guint32 packet_count, guint32 octet_count);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_rr                (GstRTCPWriter * writer, guint32 ssrc);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_rb                (GstRTCPWriter * writer, guint32 ssrc,
+                                                       guint8 fractionlost, gint32 packetslost,
+                                                       guint32 exthighestseq, guint32 jitter,
+                                                       guint32 lsr, guint32 dlsr);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_sdes_chunk        (GstRTCPWriter * writer, guint32 ssrc);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_sdes_item         (GstRTCPWriter * writer, GstRTCPSDESType type,
+                                                       guint8 len, const guint8 * data);
+
+GST_RTP_API
+gboolean        gst_rtcp_writer_add_fb                (GstRTCPWriter * writer, GstRTCPType type,
+                                                       GstRTCPFBType fbtype, guint32 sender_ssrc,
+                                                       guint32 media_ssrc, const guint8 * fci,
+                                                       guint fci_len);
+
+/* reading compound packets from memory */
+
+GST_RTP_API
+void            gst_rtcp_reader_init                  (GstRTCPReader * reader, const guint8 * data,
+                                                       gsize size);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_next_packet           (GstRTCPReader * reader);
+
+GST_RTP_API
+GstRTCPType     gst_rtcp_reader_get_packet_type       (GstRTCPReader * reader);
+
+GST_RTP_API
+guint8          gst_rtcp_reader_get_count             (GstRTCPReader * reader);
+
+GST_RTP_API
+const guint8 *  gst_rtcp_reader_get_packet_data       (GstRTCPReader * reader, gsize * size);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_get_sender_ssrc       (GstRTCPReader * reader, guint32 * ssrc);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_get_sr                (GstRTCPReader * reader, guint32 * ssrc,
+                                                       guint64 * ntptime, guint32 * rtptime,
+                                                       guint32 * packet_count, guint32 * octet_count);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_get_rb                (GstRTCPReader * reader, guint nth,
+                                                       guint32 * ssrc, guint8 * fractionlost,
+                                                       gint32 * packetslost, guint32 * exthighestseq,
+                                                       guint32 * jitter, guint32 * lsr, guint32 * dlsr);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_next_sdes_item        (GstRTCPReader * reader, guint32 * ssrc,
+                                                       GstRTCPSDESType * type, guint8 * len,
+                                                       const guint8 ** data);
+
+GST_RTP_API
+gboolean        gst_rtcp_reader_get_fb                (GstRTCPReader * reader, GstRTCPFBType * fbtype,
+                                                       guint32 * sender_ssrc, guint32 * media_ssrc,
+                                                       const guint8 ** fci, guint * fci_len);
+
 G_END_DECLS
 
 #endif /* __GST_RTCPBUFFER_H__ */
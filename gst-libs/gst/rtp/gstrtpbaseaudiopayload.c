@@ -68,7 +68,7 @@
 GST_DEBUG_CATEGORY_STATIC (rtpbaseaudiopayload_debug);
 #define GST_CAT_DEFAULT (rtpbaseaudiopayload_debug)
 
-#define DEFAULT_BUFFER_LIST             FALSE
+#define DEFAULT_BUFFER_LIST             TRUE
 
 enum
 {
@@ -111,8 +111,6 @@ struct _GstRTPBaseAudioPayloadPrivate
   guint cached_ptime_multiple;
   guint cached_align;
   guint cached_csrc_count;
-
-  gboolean buffer_list;
 };
 
 static void gst_rtp_base_audio_payload_finalize (GObject * object);
@@ -178,6 +176,13 @@ gst_rtp_base_audio_payload_class_init (GstRTPBaseAudioPayloadClass * klass)
   gobject_class->set_property = gst_rtp_base_audio_payload_set_property;
   gobject_class->get_property = gst_rtp_base_audio_payload_get_property;
 
+  /**
+   * GstRTPBaseAudioPayload:buffer-list:
+   *
+   * Push the packets created from one input buffer downstream as a single
+   * buffer list. The packets are collected by #GstRTPBasePayload:frame-lists,
+   * this property mirrors that one.
+   */
   g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_BUFFER_LIST,
       g_param_spec_boolean ("buffer-list", "Buffer List",
           "Use Buffer Lists",
@@ -208,8 +213,6 @@ gst_rtp_base_audio_payload_init (GstRTPBaseAudioPayload * payload)
   payload->sample_size = 0;
 
   payload->priv->adapter = gst_adapter_new ();
-
-  payload->priv->buffer_list = DEFAULT_BUFFER_LIST;
 }
 
 static void
@@ -234,10 +237,7 @@ gst_rtp_base_audio_payload_set_property (GObject * object,
 
   switch (prop_id) {
     case PROP_BUFFER_LIST:
-#if 0
-      payload->priv->buffer_list = g_value_get_boolean (value);
-#endif
-      payload->priv->buffer_list = FALSE;
+      g_object_set (payload, "frame-lists", g_value_get_boolean (value), NULL);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -254,9 +254,13 @@ gst_rtp_base_audio_payload_get_property (GObject * object,
   payload = GST_RTP_BASE_AUDIO_PAYLOAD (object);
 
   switch (prop_id) {
-    case PROP_BUFFER_LIST:
-      g_value_set_boolean (value, payload->priv->buffer_list);
+    case PROP_BUFFER_LIST:{
+      gboolean frame_lists;
+
+      g_object_get (payload, "frame-lists", &frame_lists, NULL);
+      g_value_set_boolean (value, frame_lists);
       break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -507,60 +511,111 @@ foreach_metadata (GstBuffer * inbuf, GstMeta ** meta, gpointer user_data)
   return TRUE;
 }
 
-static GstFlowReturn
-gst_rtp_base_audio_payload_push_buffer (GstRTPBaseAudioPayload *
-    baseaudiopayload, GstBuffer * buffer, GstClockTime timestamp)
+#define ALIGN_DOWN(val,len) ((val) - ((val) % (len)))
+
+/* Create an RTP packet with @paybuf as the payload. @paybuf usually shares
+ * the memory of the input, no payload data is copied. */
+static GstBuffer *
+gst_rtp_base_audio_payload_make_packet (GstRTPBaseAudioPayload *
+    baseaudiopayload, GstBuffer * paybuf, GstClockTime timestamp)
 {
   GstRTPBasePayload *basepayload;
-  GstRTPBaseAudioPayloadPrivate *priv;
   GstBuffer *outbuf;
-  guint payload_len;
-  GstFlowReturn ret;
+  CopyMetaData data;
 
-  priv = baseaudiopayload->priv;
   basepayload = GST_RTP_BASE_PAYLOAD (baseaudiopayload);
 
-  payload_len = gst_buffer_get_size (buffer);
-
-  GST_DEBUG_OBJECT (baseaudiopayload, "Pushing %d bytes ts %" GST_TIME_FORMAT,
-      payload_len, GST_TIME_ARGS (timestamp));
-
   /* create just the RTP header buffer */
   outbuf = gst_rtp_base_payload_allocate_output_buffer (basepayload, 0, 0, 0);
 
   /* set metadata */
-  gst_rtp_base_audio_payload_set_meta (baseaudiopayload, outbuf, payload_len,
+  gst_rtp_base_audio_payload_set_meta (baseaudiopayload, outbuf,
+      gst_buffer_get_size (paybuf), timestamp);
+
+  /* copy payload */
+  data.pay = baseaudiopayload;
+  data.outbuf = outbuf;
+  gst_buffer_foreach_meta (paybuf, foreach_metadata, &data);
+
+  return gst_buffer_append (outbuf, paybuf);
+}
+
+static GstFlowReturn
+gst_rtp_base_audio_payload_push_buffer (GstRTPBaseAudioPayload *
+    baseaudiopayload, GstBuffer * buffer, GstClockTime timestamp)
+{
+  GstBuffer *outbuf;
+
+  GST_DEBUG_OBJECT (baseaudiopayload, "Pushing %" G_GSIZE_FORMAT " bytes ts %"
+      GST_TIME_FORMAT, gst_buffer_get_size (buffer), GST_TIME_ARGS (timestamp));
+
+  outbuf = gst_rtp_base_audio_payload_make_packet (baseaudiopayload, buffer,
       timestamp);
 
-  if (priv->buffer_list) {
-    GstBufferList *list;
-    guint i, len;
+  /* packets created while handling one input buffer are collected into a
+   * single buffer list by the base class */
+  return gst_rtp_base_payload_push (GST_RTP_BASE_PAYLOAD (baseaudiopayload),
+      outbuf);
+}
 
-    list = gst_buffer_list_new ();
-    len = gst_buffer_list_length (list);
+/* Payload as many packets as possible directly from @buffer when nothing is
+ * queued in the adapter. The packets share the memory of @buffer and get
+ * their timestamps from their position in it. Any remainder that does not
+ * fill a packet is queued in the adapter. Takes ownership of @buffer. */
+static GstFlowReturn
+gst_rtp_base_audio_payload_split_buffer (GstRTPBaseAudioPayload *
+    baseaudiopayload, GstBuffer * buffer, guint min_payload_len,
+    guint max_payload_len, guint align)
+{
+  GstRTPBaseAudioPayloadPrivate *priv;
+  GstClockTime timestamp;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gsize size, offset = 0;
 
-    for (i = 0; i < len; i++) {
-      /* FIXME */
-      g_warning ("bufferlist not implemented");
-      gst_buffer_list_add (list, outbuf);
-      gst_buffer_list_add (list, buffer);
-    }
+  priv = baseaudiopayload->priv;
 
-    GST_DEBUG_OBJECT (baseaudiopayload, "Pushing list %p", list);
-    ret = gst_rtp_base_payload_push_list (basepayload, list);
-  } else {
-    CopyMetaData data;
+  timestamp = GST_BUFFER_PTS (buffer);
+  size = gst_buffer_get_size (buffer);
+
+  while (size - offset >= min_payload_len) {
+    GstBuffer *paybuf;
+    GstClockTime pts = timestamp;
+    guint payload_len;
+
+    /* get multiple of alignment */
+    payload_len = MIN (max_payload_len, size - offset);
+    payload_len = ALIGN_DOWN (payload_len, align);
+    if (payload_len == 0)
+      break;
+
+    if (GST_CLOCK_TIME_IS_VALID (pts) && offset > 0)
+      pts += priv->bytes_to_time (baseaudiopayload, offset);
 
-    /* copy payload */
-    data.pay = baseaudiopayload;
-    data.outbuf = outbuf;
-    gst_buffer_foreach_meta (buffer, foreach_metadata, &data);
-    outbuf = gst_buffer_append (outbuf, buffer);
+    paybuf = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_ALL, offset,
+        payload_len);
+    ret = gst_rtp_base_audio_payload_push_buffer (baseaudiopayload, paybuf,
+        pts);
 
-    GST_DEBUG_OBJECT (baseaudiopayload, "Pushing buffer %p", outbuf);
-    ret = gst_rtp_base_payload_push (basepayload, outbuf);
+    offset += payload_len;
+    if (ret != GST_FLOW_OK)
+      break;
   }
 
+  GST_DEBUG_OBJECT (baseaudiopayload, "split %" G_GSIZE_FORMAT " of %"
+      G_GSIZE_FORMAT " bytes", offset, size);
+
+  if (ret == GST_FLOW_OK && offset < size) {
+    GstBuffer *rest;
+
+    /* keep the remainder with its own timestamp for the next packet */
+    rest = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_ALL, offset, -1);
+    if (GST_CLOCK_TIME_IS_VALID (timestamp))
+      GST_BUFFER_PTS (rest) =
+          timestamp + priv->bytes_to_time (baseaudiopayload, offset);
+    gst_adapter_push (priv->adapter, rest);
+  }
+  gst_buffer_unref (buffer);
+
   return ret;
 }
 
@@ -583,9 +638,8 @@ GstFlowReturn
 gst_rtp_base_audio_payload_flush (GstRTPBaseAudioPayload * baseaudiopayload,
     guint payload_len, GstClockTime timestamp)
 {
-  GstRTPBasePayload *basepayload;
   GstRTPBaseAudioPayloadPrivate *priv;
-  GstBuffer *outbuf;
+  GstBuffer *paybuf;
   GstFlowReturn ret;
   GstAdapter *adapter;
   guint64 distance;
@@ -593,8 +647,6 @@ gst_rtp_base_audio_payload_flush (GstRTPBaseAudioPayload * baseaudiopayload,
   priv = baseaudiopayload->priv;
   adapter = priv->adapter;
 
-  basepayload = GST_RTP_BASE_PAYLOAD (baseaudiopayload);
-
   if (payload_len == -1)
     payload_len = gst_adapter_available (adapter);
 
@@ -617,45 +669,16 @@ gst_rtp_base_audio_payload_flush (GstRTPBaseAudioPayload * baseaudiopayload,
     }
   }
 
-  GST_DEBUG_OBJECT (baseaudiopayload, "Pushing %d bytes ts %" GST_TIME_FORMAT,
-      payload_len, GST_TIME_ARGS (timestamp));
-
-  if (priv->buffer_list && gst_adapter_available_fast (adapter) >= payload_len) {
-    GstBuffer *buffer;
-    /* we can quickly take a buffer out of the adapter without having to copy
-     * anything. */
-    buffer = gst_adapter_take_buffer (adapter, payload_len);
-
-    ret =
-        gst_rtp_base_audio_payload_push_buffer (baseaudiopayload, buffer,
-        timestamp);
-  } else {
-    GstBuffer *paybuf;
-    CopyMetaData data;
-
+  /* this takes a sub-buffer without copying when the payload does not span
+   * multiple input buffers */
+  paybuf = gst_adapter_take_buffer_fast (adapter, payload_len);
 
-    /* create buffer to hold the payload */
-    outbuf = gst_rtp_base_payload_allocate_output_buffer (basepayload, 0, 0, 0);
-
-    paybuf = gst_adapter_take_buffer_fast (adapter, payload_len);
-
-    data.pay = baseaudiopayload;
-    data.outbuf = outbuf;
-    gst_buffer_foreach_meta (paybuf, foreach_metadata, &data);
-    outbuf = gst_buffer_append (outbuf, paybuf);
-
-    /* set metadata */
-    gst_rtp_base_audio_payload_set_meta (baseaudiopayload, outbuf, payload_len,
-        timestamp);
-
-    ret = gst_rtp_base_payload_push (basepayload, outbuf);
-  }
+  ret = gst_rtp_base_audio_payload_push_buffer (baseaudiopayload, paybuf,
+      timestamp);
 
   return ret;
 }
 
-#define ALIGN_DOWN(val,len) ((val) - ((val) % (len)))
-
 /* calculate the min and max length of a packet. This depends on the configured
  * mtu and min/max_ptime values. We cache those so that we don't have to redo
  * all the calculations */
@@ -910,6 +933,12 @@ gst_rtp_base_audio_payload_handle_buffer (GstRTPBasePayload *
      * this will check against max_ptime and max_mtu */
     GST_DEBUG_OBJECT (payload, "Fast packet push");
     ret = gst_rtp_base_audio_payload_push_buffer (payload, buffer, timestamp);
+  } else if (available == 0 && size > max_payload_len) {
+    /* carve the packets straight out of the buffer, the remainder goes to
+     * the adapter */
+    GST_DEBUG_OBJECT (payload, "Splitting buffer");
+    ret = gst_rtp_base_audio_payload_split_buffer (payload, buffer,
+        min_payload_len, max_payload_len, align);
   } else {
     /* push the buffer in the adapter */
     gst_adapter_push (priv->adapter, buffer);
@@ -918,7 +947,6 @@ gst_rtp_base_audio_payload_handle_buffer (GstRTPBasePayload *
     GST_DEBUG_OBJECT (payload, "available now %u", available);
 
     /* as long as we have full frames */
-    /* TODO: Use buffer lists here */
     while (available >= min_payload_len) {
       /* get multiple of alignment */
       payload_len = MIN (max_payload_len, available);
@@ -32,6 +32,7 @@
 #include "gstrtpbasedepayload.h"
 #include "gstrtpmeta.h"
 #include "gstrtphdrext.h"
+#include "gstrtphdrextprivate.h"
 
 GST_DEBUG_CATEGORY_STATIC (rtpbasedepayload_debug);
 #define GST_CAT_DEFAULT (rtpbasedepayload_debug)
@@ -70,6 +71,9 @@ struct _GstRTPBaseDepayloadPrivate
 
   /* array of GstRTPHeaderExtension's * */
   GPtrArray *header_exts;
+  /* resolved from header_exts, rebuilt lazily after it or the id of an
+   * extension changed */
+  GstRTPHeaderExtensionPlan *ext_plan;
 };
 
 /* Filter signals and args */
@@ -412,6 +416,8 @@ gst_rtp_base_depayload_finalize (GObject * object)
 
   g_ptr_array_unref (rtpbasedepayload->priv->header_exts);
   rtpbasedepayload->priv->header_exts = NULL;
+  gst_rtp_header_extension_plan_free (rtpbasedepayload->priv->ext_plan);
+  rtpbasedepayload->priv->ext_plan = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -628,6 +634,8 @@ gst_rtp_base_depayload_setcaps (GstRTPBaseDepayload * filter, GstCaps * caps)
         filter->priv->header_exts);
     g_ptr_array_foreach (to_add, (GFunc) add_item_to,
         filter->priv->header_exts);
+    gst_rtp_header_extension_plan_free (filter->priv->ext_plan);
+    filter->priv->ext_plan = NULL;
     GST_OBJECT_UNLOCK (filter);
 
   ext_out:
@@ -663,45 +671,33 @@ caps_not_changed:
   }
 }
 
-/* takes ownership of the input buffer */
-static GstFlowReturn
-gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
-    GstRTPBaseDepayloadClass * bclass, GstBuffer * in)
+/* Maps @in into @rtp and tracks its seqnum. Old packets and duplicates are
+ * rejected, a gap in the seqnums marks @in as DISCONT, in which case @in
+ * may be replaced by a writable copy. Returns %FALSE when the packet is to
+ * be dropped, @rtp is not mapped then. */
+static gboolean
+gst_rtp_base_depayload_check_packet (GstRTPBaseDepayload * filter,
+    GstBuffer ** in, GstRTPBuffer * rtp)
 {
-  GstBuffer *(*process_rtp_packet_func) (GstRTPBaseDepayload * base,
-      GstRTPBuffer * rtp_buffer);
-  GstBuffer *(*process_func) (GstRTPBaseDepayload * base, GstBuffer * in);
-  GstRTPBaseDepayloadPrivate *priv;
-  GstBuffer *out_buf;
+  GstRTPBaseDepayloadPrivate *priv = filter->priv;
   guint32 ssrc;
   guint16 seqnum;
   guint32 rtptime;
   gboolean discont, buf_discont;
   gint gap;
-  GstRTPBuffer rtp = { NULL };
-
-  priv = filter->priv;
-  priv->process_flow_ret = GST_FLOW_OK;
-
-  process_func = bclass->process;
-  process_rtp_packet_func = bclass->process_rtp_packet;
 
-  /* we must have a setcaps first */
-  if (G_UNLIKELY (!priv->negotiated))
-    goto not_negotiated;
-
-  if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, &rtp)))
+  if (G_UNLIKELY (!gst_rtp_buffer_map (*in, GST_MAP_READ, rtp)))
     goto invalid_buffer;
 
-  buf_discont = GST_BUFFER_IS_DISCONT (in);
+  buf_discont = GST_BUFFER_IS_DISCONT (*in);
 
-  priv->pts = GST_BUFFER_PTS (in);
-  priv->dts = GST_BUFFER_DTS (in);
-  priv->duration = GST_BUFFER_DURATION (in);
+  priv->pts = GST_BUFFER_PTS (*in);
+  priv->dts = GST_BUFFER_DTS (*in);
+  priv->duration = GST_BUFFER_DURATION (*in);
 
-  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
-  seqnum = gst_rtp_buffer_get_seq (&rtp);
-  rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (rtp);
+  seqnum = gst_rtp_buffer_get_seq (rtp);
+  rtptime = gst_rtp_buffer_get_timestamp (rtp);
 
   priv->last_seqnum = seqnum;
   priv->last_rtptime = rtptime;
@@ -758,19 +754,19 @@ gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
   if (G_UNLIKELY (discont)) {
     priv->discont = TRUE;
     if (!buf_discont) {
-      gpointer old_inbuf = in;
+      gpointer old_inbuf = *in;
 
       /* we detected a seqnum discont but the buffer was not flagged with a discont,
        * set the discont flag so that the subclass can throw away old data. */
       GST_LOG_OBJECT (filter, "mark DISCONT on input buffer");
-      in = gst_buffer_make_writable (in);
-      GST_BUFFER_FLAG_SET (in, GST_BUFFER_FLAG_DISCONT);
+      *in = gst_buffer_make_writable (*in);
+      GST_BUFFER_FLAG_SET (*in, GST_BUFFER_FLAG_DISCONT);
       /* depayloaders will check flag on rtpbuffer->buffer, so if the input
        * buffer was not writable already we need to remap to make our
        * newly-flagged buffer current on the rtpbuffer */
-      if (in != old_inbuf) {
-        gst_rtp_buffer_unmap (&rtp);
-        if (G_UNLIKELY (!gst_rtp_buffer_map (in, GST_MAP_READ, &rtp)))
+      if (*in != old_inbuf) {
+        gst_rtp_buffer_unmap (rtp);
+        if (G_UNLIKELY (!gst_rtp_buffer_map (*in, GST_MAP_READ, rtp)))
           goto invalid_buffer;
       }
     }
@@ -779,10 +775,52 @@ gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
   /* prepare segment event if needed */
   if (filter->need_newsegment) {
     priv->segment_event = create_segment_event (filter, rtptime,
-        GST_BUFFER_PTS (in));
+        GST_BUFFER_PTS (*in));
     filter->need_newsegment = FALSE;
   }
 
+  return TRUE;
+
+  /* ERRORS */
+invalid_buffer:
+  {
+    /* this is not fatal but should be filtered earlier */
+    GST_ELEMENT_WARNING (filter, STREAM, DECODE, (NULL),
+        ("Received invalid RTP payload, dropping"));
+    return FALSE;
+  }
+dropping:
+  {
+    gst_rtp_buffer_unmap (rtp);
+    return FALSE;
+  }
+}
+
+/* takes ownership of the input buffer */
+static GstFlowReturn
+gst_rtp_base_depayload_handle_buffer (GstRTPBaseDepayload * filter,
+    GstRTPBaseDepayloadClass * bclass, GstBuffer * in)
+{
+  GstBuffer *(*process_rtp_packet_func) (GstRTPBaseDepayload * base,
+      GstRTPBuffer * rtp_buffer);
+  GstBuffer *(*process_func) (GstRTPBaseDepayload * base, GstBuffer * in);
+  GstRTPBaseDepayloadPrivate *priv;
+  GstBuffer *out_buf;
+  GstRTPBuffer rtp = { NULL };
+
+  priv = filter->priv;
+  priv->process_flow_ret = GST_FLOW_OK;
+
+  process_func = bclass->process;
+  process_rtp_packet_func = bclass->process_rtp_packet;
+
+  /* we must have a setcaps first */
+  if (G_UNLIKELY (!priv->negotiated))
+    goto not_negotiated;
+
+  if (!gst_rtp_base_depayload_check_packet (filter, &in, &rtp))
+    goto dropping;
+
   priv->input_buffer = in;
 
   if (process_rtp_packet_func != NULL) {
@@ -823,17 +861,8 @@ not_negotiated:
     gst_buffer_unref (in);
     return GST_FLOW_NOT_NEGOTIATED;
   }
-invalid_buffer:
-  {
-    /* this is not fatal but should be filtered earlier */
-    GST_ELEMENT_WARNING (filter, STREAM, DECODE, (NULL),
-        ("Received invalid RTP payload, dropping"));
-    gst_buffer_unref (in);
-    return GST_FLOW_OK;
-  }
 dropping:
   {
-    gst_rtp_buffer_unmap (&rtp);
     gst_buffer_unref (in);
     return GST_FLOW_OK;
   }
@@ -844,10 +873,90 @@ no_process:
     GST_ELEMENT_ERROR (filter, STREAM, NOT_IMPLEMENTED, (NULL),
         ("The subclass does not have a process or process_rtp_packet method"));
     gst_buffer_unref (in);
+    priv->input_buffer = NULL;
     return GST_FLOW_ERROR;
   }
 }
 
+/* Hands all valid packets of @list to the subclass' process_rtp_packet_list
+ * function at once and pushes the output as a single list. Seqnum tracking
+ * and discont detection are done for each packet first. The first output
+ * buffer gets the timestamps of the first packet and is marked DISCONT when
+ * any packet was, header extensions and source info are applied to the
+ * output from the last packet in @list. Must be called when negotiated,
+ * takes ownership of @list. */
+static GstFlowReturn
+gst_rtp_base_depayload_handle_list (GstRTPBaseDepayload * filter,
+    GstRTPBaseDepayloadClass * bclass, GstBufferList * list)
+{
+  GstRTPBaseDepayloadPrivate *priv;
+  GstBufferList *packets, *out_list;
+  GstBuffer *last = NULL;
+  GstClockTime pts = GST_CLOCK_TIME_NONE;
+  GstClockTime dts = GST_CLOCK_TIME_NONE;
+  GstClockTime duration = GST_CLOCK_TIME_NONE;
+  guint i, len;
+
+  priv = filter->priv;
+  priv->process_flow_ret = GST_FLOW_OK;
+
+  len = gst_buffer_list_length (list);
+  packets = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *in = gst_buffer_ref (gst_buffer_list_get (list, i));
+
+    if (!gst_rtp_base_depayload_check_packet (filter, &in, &rtp)) {
+      gst_buffer_unref (in);
+      continue;
+    }
+    gst_rtp_buffer_unmap (&rtp);
+
+    if (last == NULL) {
+      pts = priv->pts;
+      dts = priv->dts;
+      duration = priv->duration;
+    }
+
+    gst_buffer_list_add (packets, in);
+    last = in;
+  }
+  gst_buffer_list_unref (list);
+
+  if (last == NULL) {
+    gst_buffer_list_unref (packets);
+    return GST_FLOW_OK;
+  }
+
+  /* check_packet kept the timestamps of the last packet, the output starts
+   * with the first one. priv->discont stays set when any packet was
+   * discont */
+  priv->pts = pts;
+  priv->dts = dts;
+  priv->duration = duration;
+
+  GST_LOG_OBJECT (filter, "processing list of %u packets",
+      gst_buffer_list_length (packets));
+
+  priv->input_buffer = gst_buffer_ref (last);
+
+  out_list = bclass->process_rtp_packet_list (filter, packets);
+
+  if (out_list) {
+    if (priv->process_flow_ret == GST_FLOW_OK
+        && gst_buffer_list_length (out_list) > 0)
+      priv->process_flow_ret =
+          gst_rtp_base_depayload_push_list (filter, out_list);
+    else
+      gst_buffer_list_unref (out_list);
+  }
+
+  gst_buffer_replace (&priv->input_buffer, NULL);
+
+  return priv->process_flow_ret;
+}
+
 static GstFlowReturn
 gst_rtp_base_depayload_chain (GstPad * pad, GstObject * parent, GstBuffer * in)
 {
@@ -886,6 +995,11 @@ gst_rtp_base_depayload_chain_list (GstPad * pad, GstObject * parent,
   if (len == 0)
     goto done;
 
+  /* let the subclass process the whole list at once if it can, errors are
+   * reported by handle_buffer */
+  if (bclass->process_rtp_packet_list && basedepay->priv->negotiated)
+    return gst_rtp_base_depayload_handle_list (basedepay, bclass, list);
+
   for (i = 0; i < len; i++) {
     buffer = gst_buffer_list_get (list, i);
 
@@ -1128,6 +1242,8 @@ gst_rtp_base_depayload_add_extension (GstRTPBaseDepayload * rtpbasepayload,
   /* XXX: check for duplicate ids? */
   GST_OBJECT_LOCK (rtpbasepayload);
   g_ptr_array_add (rtpbasepayload->priv->header_exts, gst_object_ref (ext));
+  gst_rtp_header_extension_plan_free (rtpbasepayload->priv->ext_plan);
+  rtpbasepayload->priv->ext_plan = NULL;
   GST_OBJECT_UNLOCK (rtpbasepayload);
 }
 
@@ -1136,6 +1252,8 @@ gst_rtp_base_depayload_clear_extensions (GstRTPBaseDepayload * rtpbasepayload)
 {
   GST_OBJECT_LOCK (rtpbasepayload);
   g_ptr_array_set_size (rtpbasepayload->priv->header_exts, 0);
+  gst_rtp_header_extension_plan_free (rtpbasepayload->priv->ext_plan);
+  rtpbasepayload->priv->ext_plan = NULL;
   GST_OBJECT_UNLOCK (rtpbasepayload);
 }
 
@@ -1161,99 +1279,20 @@ read_rtp_header_extensions (GstRTPBaseDepayload * depayload,
 
   if (gst_rtp_buffer_get_extension_data (&rtp, &bit_pattern, (gpointer) & pdata,
           &wordlen)) {
-    GstRTPHeaderExtensionFlags ext_flags = 0;
-    gsize bytelen = wordlen * 4;
-    guint hdr_unit_bytes;
-    gsize offset = 0;
-
-    if (bit_pattern == 0xBEDE) {
-      /* one byte extensions */
-      hdr_unit_bytes = 1;
-      ext_flags |= GST_RTP_HEADER_EXTENSION_ONE_BYTE;
-    } else if (bit_pattern >> 4 == 0x100) {
-      /* two byte extensions */
-      hdr_unit_bytes = 2;
-      ext_flags |= GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-    } else {
-      GST_DEBUG_OBJECT (depayload, "unknown extension bit pattern 0x%02x%02x",
-          bit_pattern >> 8, bit_pattern & 0xff);
-      goto out;
-    }
-
-    while (TRUE) {
-      guint8 read_id, read_len;
-      GstRTPHeaderExtension *ext = NULL;
-      guint i;
-
-      if (offset + hdr_unit_bytes >= bytelen)
-        /* not enough remaning data */
-        break;
-
-      if (ext_flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
-        read_id = GST_READ_UINT8 (pdata + offset) >> 4;
-        read_len = (GST_READ_UINT8 (pdata + offset) & 0x0F) + 1;
-        offset += 1;
-
-        if (read_id == 0)
-          /* padding */
-          continue;
-
-        if (read_id == 15)
-          /* special id for possible future expansion */
-          break;
-      } else {
-        read_id = GST_READ_UINT8 (pdata + offset);
-        offset += 1;
-
-        if (read_id == 0)
-          /* padding */
-          continue;
-
-        read_len = GST_READ_UINT8 (pdata + offset);
-        offset += 1;
-      }
-      GST_TRACE_OBJECT (depayload, "found rtp header extension with id %u and "
-          "length %u", read_id, read_len);
-
-      /* Ignore extension headers where the size does not fit */
-      if (offset + read_len > bytelen) {
-        GST_WARNING_OBJECT (depayload, "Extension length extends past the "
-            "size of the extension data");
-        break;
-      }
-
-      GST_OBJECT_LOCK (depayload);
-      for (i = 0; i < depayload->priv->header_exts->len; i++) {
-        ext = g_ptr_array_index (depayload->priv->header_exts, i);
-        if (read_id == gst_rtp_header_extension_get_id (ext)) {
-          gst_object_ref (ext);
-          break;
-        }
-        ext = NULL;
-      }
-
-      if (ext) {
-        if (!gst_rtp_header_extension_read (ext, ext_flags, &pdata[offset],
-                read_len, output)) {
-          GST_WARNING_OBJECT (depayload, "RTP header extension (%s) could "
-              "not read payloaded data", GST_OBJECT_NAME (ext));
-          gst_object_unref (ext);
-          goto out;
-        }
-
-        if (gst_rtp_header_extension_wants_update_non_rtp_src_caps (ext)) {
-          needs_src_caps_update = TRUE;
-        }
+    GstRTPBaseDepayloadPrivate *priv = depayload->priv;
 
-        gst_object_unref (ext);
-      }
-      GST_OBJECT_UNLOCK (depayload);
+    GST_OBJECT_LOCK (depayload);
+    if (priv->header_exts->len > 0) {
+      gst_rtp_header_extension_plan_ensure (&priv->ext_plan, priv->header_exts);
 
-      offset += read_len;
+      if (!gst_rtp_header_extension_plan_read (priv->ext_plan, bit_pattern,
+              pdata, wordlen * 4, output, &needs_src_caps_update))
+        GST_WARNING_OBJECT (depayload, "Failed to read RTP header extensions "
+            "with bit pattern 0x%04x", bit_pattern);
     }
+    GST_OBJECT_UNLOCK (depayload);
   }
 
-out:
   gst_rtp_buffer_unmap (&rtp);
 
   return needs_src_caps_update;
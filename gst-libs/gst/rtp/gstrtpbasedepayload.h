@@ -82,6 +82,16 @@ struct _GstRTPBaseDepayload
  * timestamp, the timestamp of the input buffer will be applied to the result
  * buffer and the output buffer will be pushed out. If this function returns
  * %NULL, nothing is pushed out. Since: 1.6.
+ * @process_rtp_packet_list: Process a list of incoming rtp packets at once.
+ * When implemented, buffer lists received by the depayloader are handed to
+ * this function as a whole instead of calling @process or
+ * @process_rtp_packet for each packet. The base class has already tracked
+ * the seqnums of the packets, dropped duplicates and marked discontinuities
+ * on the packets. The first output buffer gets the timestamps of the first
+ * packet if it has none and is marked DISCONT when any of the packets was.
+ * Header extensions and source info are taken from the last packet of the
+ * list. Takes ownership of the list, the returned list is pushed out as a
+ * whole. Since: 1.20.
  *
  * Base class for RTP depayloaders.
  */
@@ -107,8 +117,10 @@ struct _GstRTPBaseDepayloadClass
 
   GstBuffer * (*process_rtp_packet) (GstRTPBaseDepayload *base, GstRTPBuffer * rtp_buffer);
 
+  GstBufferList * (*process_rtp_packet_list) (GstRTPBaseDepayload *base, GstBufferList * list);
+
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING - 1];
+  gpointer _gst_reserved[GST_PADDING - 2];
 };
 
 GST_RTP_API
@@ -31,12 +31,66 @@
 #include "gstrtpbasepayload.h"
 #include "gstrtpmeta.h"
 #include "gstrtphdrext.h"
+#include "gstrtphdrextprivate.h"
 
 GST_DEBUG_CATEGORY_STATIC (rtpbasepayload_debug);
 #define GST_CAT_DEFAULT (rtpbasepayload_debug)
 
 static gboolean enable_experimental_twcc = FALSE;
 
+/* largest RTP header without extension: fixed part plus 15 CSRCs */
+#define RTP_HEADER_LEN 12
+#define RTP_MAX_HEADER_LEN (RTP_HEADER_LEN + 15 * sizeof (guint32))
+
+/* GstRTPHeaderPool:
+ *
+ * Buffer pool handing out buffers with a single header-sized memory. Packets
+ * are built by appending payload (and padding or extension) memory to the
+ * pooled header; that memory is stripped again when the packet is returned
+ * so that the header buffer can be recycled. */
+typedef struct
+{
+  GstBufferPool parent;
+} GstRTPHeaderPool;
+
+typedef struct
+{
+  GstBufferPoolClass parent_class;
+} GstRTPHeaderPoolClass;
+
+static GType gst_rtp_header_pool_get_type (void);
+
+G_DEFINE_TYPE (GstRTPHeaderPool, gst_rtp_header_pool, GST_TYPE_BUFFER_POOL);
+
+static void
+gst_rtp_header_pool_reset_buffer (GstBufferPool * pool, GstBuffer * buffer)
+{
+  if (gst_buffer_n_memory (buffer) > 1)
+    gst_buffer_remove_memory_range (buffer, 1, -1);
+
+  /* only the header memory is left, the buffer can be reused if it is still
+   * large enough, the base class will drop it otherwise */
+  if (gst_buffer_n_memory (buffer) == 1 &&
+      gst_buffer_peek_memory (buffer, 0)->maxsize >= RTP_MAX_HEADER_LEN)
+    GST_BUFFER_FLAG_UNSET (buffer, GST_BUFFER_FLAG_TAG_MEMORY);
+
+  GST_BUFFER_POOL_CLASS (gst_rtp_header_pool_parent_class)->reset_buffer (pool,
+      buffer);
+}
+
+static void
+gst_rtp_header_pool_class_init (GstRTPHeaderPoolClass * klass)
+{
+  GstBufferPoolClass *pool_class = (GstBufferPoolClass *) klass;
+
+  pool_class->reset_buffer = gst_rtp_header_pool_reset_buffer;
+}
+
+static void
+gst_rtp_header_pool_init (GstRTPHeaderPool * pool)
+{
+}
+
 struct _GstRTPBasePayloadPrivate
 {
   gboolean ts_offset_random;
@@ -73,6 +127,23 @@ struct _GstRTPBasePayloadPrivate
 
   /* array of GstRTPHeaderExtension's * */
   GPtrArray *header_exts;
+  /* resolved from header_exts, rebuilt lazily after it or the id of an
+   * extension changed */
+  GstRTPHeaderExtensionPlan *ext_plan;
+  /* input meta for packets pushed outside of the chain function */
+  GstBuffer *empty_meta_buffer;
+
+  /* recycled header buffers */
+  GstBufferPool *header_pool;
+
+  /* packets of the frame being payloaded */
+  gboolean frame_lists;
+  gboolean collect_frame;
+  GstBufferList *frame_list;
+  /* serialized event that is waiting for frame_list to be pushed */
+  GstEvent *frame_list_event;
+  /* result of pushing packets of the current frame */
+  GstFlowReturn frame_list_ret;
 };
 
 /* RTPBasePayload signals and args */
@@ -107,11 +178,10 @@ static guint gst_rtp_base_payload_signals[LAST_SIGNAL] = { 0 };
 #define DEFAULT_ONVIF_NO_RATE_CONTROL   FALSE
 #define DEFAULT_SCALE_RTPTIME           TRUE
 #define DEFAULT_AUTO_HEADER_EXTENSION   TRUE
+#define DEFAULT_FRAME_LISTS             TRUE
 
-#define RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE 16
-#define RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE 256
-#define RTP_HEADER_EXT_ONE_BYTE_MAX_ID 14
-#define RTP_HEADER_EXT_TWO_BYTE_MAX_ID 255
+/* number of packet headers mapped at once when updating buffer lists */
+#define HEADER_BATCH_SIZE 32
 
 enum
 {
@@ -132,6 +202,7 @@ enum
   PROP_ONVIF_NO_RATE_CONTROL,
   PROP_SCALE_RTPTIME,
   PROP_AUTO_HEADER_EXTENSION,
+  PROP_FRAME_LISTS,
   PROP_LAST
 };
 
@@ -157,6 +228,10 @@ static gboolean gst_rtp_base_payload_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 static GstFlowReturn gst_rtp_base_payload_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
+static GstFlowReturn gst_rtp_base_payload_push_frame_list (GstRTPBasePayload *
+    payload);
+static GstPadProbeReturn gst_rtp_base_payload_src_event_probe (GstPad * pad,
+    GstPadProbeInfo * info, gpointer user_data);
 
 static void gst_rtp_base_payload_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -440,6 +515,36 @@ gst_rtp_base_payload_class_init (GstRTPBasePayloadClass * klass)
           DEFAULT_AUTO_HEADER_EXTENSION,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRTPBasePayload:frame-lists:
+   *
+   * Collect all packets pushed with gst_rtp_base_payload_push() and
+   * gst_rtp_base_payload_push_list() while payloading one input buffer and
+   * push them downstream as a single #GstBufferList once the subclass'
+   * handle_buffer function returns.
+   *
+   * The packet headers are still updated when the packets are pushed by the
+   * subclass, only the actual push is deferred. Packets collected so far are
+   * pushed before any serialized event the subclass pushes on the source
+   * pad, so events stay in order with the packets.
+   *
+   * Because of this, gst_rtp_base_payload_push() and
+   * gst_rtp_base_payload_push_list() can't return the #GstFlowReturn for the
+   * packets passed to them. They return %GST_FLOW_FLUSHING while the source
+   * pad is flushing, %GST_FLOW_EOS after EOS was pushed on it and otherwise
+   * the result of packets of the same frame that were pushed already before
+   * an event or new caps, so subclasses can stop payloading early. The result
+   * for the remaining packets is returned by the chain function after
+   * handle_buffer.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_FRAME_LISTS, g_param_spec_boolean ("frame-lists",
+          "Frame lists",
+          "Push all packets of an input buffer as a single buffer list",
+          DEFAULT_FRAME_LISTS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstRTPBasePayload::add-extension:
    * @object: the #GstRTPBasePayload
@@ -517,6 +622,10 @@ gst_rtp_base_payload_init (GstRTPBasePayload * rtpbasepayload, gpointer g_class)
   rtpbasepayload->srcpad = gst_pad_new_from_template (templ, "src");
   gst_pad_set_event_function (rtpbasepayload->srcpad,
       gst_rtp_base_payload_src_event);
+  /* keeps collected packets in front of events pushed by subclasses */
+  gst_pad_add_probe (rtpbasepayload->srcpad,
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      gst_rtp_base_payload_src_event_probe, rtpbasepayload, NULL);
   gst_element_add_pad (GST_ELEMENT (rtpbasepayload), rtpbasepayload->srcpad);
 
   templ =
@@ -553,6 +662,7 @@ gst_rtp_base_payload_init (GstRTPBasePayload * rtpbasepayload, gpointer g_class)
   rtpbasepayload->priv->onvif_no_rate_control = DEFAULT_ONVIF_NO_RATE_CONTROL;
   rtpbasepayload->priv->scale_rtptime = DEFAULT_SCALE_RTPTIME;
   rtpbasepayload->priv->auto_hdr_ext = DEFAULT_AUTO_HEADER_EXTENSION;
+  rtpbasepayload->priv->frame_lists = DEFAULT_FRAME_LISTS;
 
   rtpbasepayload->media = NULL;
   rtpbasepayload->encoding_name = NULL;
@@ -582,6 +692,19 @@ gst_rtp_base_payload_finalize (GObject * object)
 
   g_ptr_array_unref (rtpbasepayload->priv->header_exts);
   rtpbasepayload->priv->header_exts = NULL;
+  gst_rtp_header_extension_plan_free (rtpbasepayload->priv->ext_plan);
+  rtpbasepayload->priv->ext_plan = NULL;
+  gst_buffer_replace (&rtpbasepayload->priv->empty_meta_buffer, NULL);
+
+  if (rtpbasepayload->priv->header_pool) {
+    gst_buffer_pool_set_active (rtpbasepayload->priv->header_pool, FALSE);
+    gst_object_unref (rtpbasepayload->priv->header_pool);
+    rtpbasepayload->priv->header_pool = NULL;
+  }
+  if (rtpbasepayload->priv->frame_list) {
+    gst_buffer_list_unref (rtpbasepayload->priv->frame_list);
+    rtpbasepayload->priv->frame_list = NULL;
+  }
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -865,10 +988,23 @@ gst_rtp_base_payload_chain (GstPad * pad, GstObject * parent,
     }
   }
 
+  rtpbasepayload->priv->collect_frame = rtpbasepayload->priv->frame_lists;
+  rtpbasepayload->priv->frame_list_ret = GST_FLOW_OK;
+
   ret = rtpbasepayload_class->handle_buffer (rtpbasepayload, buffer);
 
+  rtpbasepayload->priv->collect_frame = FALSE;
+
   gst_buffer_replace (&rtpbasepayload->priv->input_meta_buffer, NULL);
 
+  /* the headers were already written, push the packets even if the
+   * subclass failed halfway through the frame */
+  if (rtpbasepayload->priv->frame_list)
+    rtpbasepayload->priv->frame_list_ret =
+        gst_rtp_base_payload_push_frame_list (rtpbasepayload);
+  if (ret == GST_FLOW_OK)
+    ret = rtpbasepayload->priv->frame_list_ret;
+
   return ret;
 
   /* ERRORS */
@@ -1069,6 +1205,11 @@ gst_rtp_base_payload_negotiate (GstRTPBasePayload * payload)
   GstStructure *s, *d;
   gboolean res = TRUE;
 
+  /* packets collected so far belong to the old caps */
+  if (payload->priv->frame_list)
+    payload->priv->frame_list_ret =
+        gst_rtp_base_payload_push_frame_list (payload);
+
   payload->priv->caps_max_ptime = DEFAULT_MAX_PTIME;
   payload->ptime = 0;
 
@@ -1475,6 +1616,8 @@ gst_rtp_base_payload_negotiate (GstRTPBasePayload * payload)
         payload->priv->header_exts);
     g_ptr_array_foreach (to_add, (GFunc) add_item_to,
         payload->priv->header_exts);
+    gst_rtp_header_extension_plan_free (payload->priv->ext_plan);
+    payload->priv->ext_plan = NULL;
     /* let extensions update their internal state from sinkcaps */
     if (payload->priv->sinkcaps) {
       gint i;
@@ -1555,6 +1698,13 @@ typedef struct
   GstClockTime pts;
   guint64 offset;
   guint32 rtptime;
+
+  /* header extension layout, resolved once per push */
+  GstRTPHeaderExtensionPlan *ext_plan;
+  const GstBuffer *input_meta;
+  GstRTPHeaderExtensionFlags ext_flags;
+  guint16 ext_bit_pattern;
+  guint ext_wordlen;
 } HeaderData;
 
 static gboolean
@@ -1583,6 +1733,8 @@ gst_rtp_base_payload_add_extension (GstRTPBasePayload * payload,
   /* XXX: check for duplicate ids? */
   GST_OBJECT_LOCK (payload);
   g_ptr_array_add (payload->priv->header_exts, gst_object_ref (ext));
+  gst_rtp_header_extension_plan_free (payload->priv->ext_plan);
+  payload->priv->ext_plan = NULL;
   gst_pad_mark_reconfigure (GST_RTP_BASE_PAYLOAD_SRCPAD (payload));
   GST_OBJECT_UNLOCK (payload);
 }
@@ -1592,230 +1744,163 @@ gst_rtp_base_payload_clear_extensions (GstRTPBasePayload * payload)
 {
   GST_OBJECT_LOCK (payload);
   g_ptr_array_set_size (payload->priv->header_exts, 0);
+  gst_rtp_header_extension_plan_free (payload->priv->ext_plan);
+  payload->priv->ext_plan = NULL;
   GST_OBJECT_UNLOCK (payload);
 }
 
-typedef struct
-{
-  GstRTPBasePayload *payload;
-  GstRTPHeaderExtensionFlags flags;
-  GstBuffer *output;
-  guint8 *data;
-  gsize allocated_size;
-  gsize written_size;
-  gsize hdr_unit_size;
-  gboolean abort;
-} HeaderExt;
-
-static void
-determine_header_extension_flags_size (GstRTPHeaderExtension * ext,
-    gpointer user_data)
-{
-  HeaderExt *hdr = user_data;
-  guint ext_id;
-  gsize max_size;
-
-  hdr->flags &= gst_rtp_header_extension_get_supported_flags (ext);
-  max_size =
-      gst_rtp_header_extension_get_max_size (ext,
-      hdr->payload->priv->input_meta_buffer);
-
-  if (max_size > RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE)
-    hdr->flags &= ~GST_RTP_HEADER_EXTENSION_ONE_BYTE;
-  if (max_size > RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE)
-    hdr->flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-
-  ext_id = gst_rtp_header_extension_get_id (ext);
-  if (ext_id > RTP_HEADER_EXT_ONE_BYTE_MAX_ID)
-    hdr->flags &= ~GST_RTP_HEADER_EXTENSION_ONE_BYTE;
-  if (ext_id > RTP_HEADER_EXT_TWO_BYTE_MAX_ID)
-    hdr->flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-
-  hdr->allocated_size += max_size;
-}
-
-static void
-write_header_extension (GstRTPHeaderExtension * ext, gpointer user_data)
+/* Resolves the header extension flags and sizes once for all packets of a
+ * push. Must be called with the OBJECT_LOCK. */
+static gboolean
+prepare_header_extensions (HeaderData * data)
 {
-  HeaderExt *hdr = user_data;
-  gsize remaining =
-      hdr->allocated_size - hdr->written_size - hdr->hdr_unit_size;
-  gsize offset = hdr->written_size + hdr->hdr_unit_size;
-  gssize written;
-  guint ext_id;
-
-  if (hdr->abort)
-    return;
-
-  written = gst_rtp_header_extension_write (ext,
-      hdr->payload->priv->input_meta_buffer, hdr->flags, hdr->output,
-      &hdr->data[offset], remaining);
-
-  if (written == 0) {
-    /* extension wrote no data */
-    return;
-  } else if (written < 0) {
-    GST_WARNING_OBJECT (hdr->payload, "%s failed to write extension data",
-        GST_OBJECT_NAME (ext));
-    goto error;
-  } else if (written > remaining) {
-    /* wrote too much! */
-    g_error ("Overflow detected writing rtp header extensions. One of the "
-        "instances likely did not report a large enough maximum size. "
-        "Memory corruption has occured. Aborting");
-    goto error;
-  }
+  GstRTPBasePayloadPrivate *priv = data->payload->priv;
+  gsize extlen;
 
-  ext_id = gst_rtp_header_extension_get_id (ext);
-
-  /* move to the beginning of the extension header */
-  offset -= hdr->hdr_unit_size;
-
-  /* write extension header */
-  if (hdr->flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
-    if (written > RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE) {
-      g_critical ("Amount of data written by %s is larger than allowed with "
-          "a one byte header.", GST_OBJECT_NAME (ext));
-      goto error;
-    }
+  data->ext_plan = NULL;
+  if (priv->header_exts->len == 0)
+    return TRUE;
 
-    hdr->data[offset] = ((ext_id & 0x0F) << 4) | ((written - 1) & 0x0F);
-  } else if (hdr->flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
-    if (written > RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE) {
-      g_critical ("Amount of data written by %s is larger than allowed with "
-          "a two byte header.", GST_OBJECT_NAME (ext));
-      goto error;
-    }
+  gst_rtp_header_extension_plan_ensure (&priv->ext_plan, priv->header_exts);
 
-    hdr->data[offset] = ext_id & 0xFF;
-    hdr->data[offset + 1] = written & 0xFF;
-  } else {
-    g_critical ("Don't know how to write extension data with flags 0x%x!",
-        hdr->flags);
-    goto error;
+  /* packets pushed outside of the chain function, e.g. when draining, have
+   * no input buffer to take the meta from */
+  data->input_meta = priv->input_meta_buffer;
+  if (data->input_meta == NULL) {
+    if (priv->empty_meta_buffer == NULL)
+      priv->empty_meta_buffer = gst_buffer_new ();
+    data->input_meta = priv->empty_meta_buffer;
   }
 
-  hdr->written_size += written + hdr->hdr_unit_size;
+  if (!gst_rtp_header_extension_plan_get_write_layout (priv->ext_plan,
+          data->input_meta, &data->ext_flags, &data->ext_bit_pattern,
+          &extlen))
+    return FALSE;
 
-  return;
+  data->ext_plan = priv->ext_plan;
+  data->ext_wordlen = extlen / 4 + ((extlen % 4) ? 1 : 0);
 
-error:
-  hdr->abort = TRUE;
-  return;
+  return TRUE;
 }
 
+/* Must be called with the OBJECT_LOCK. */
 static gboolean
-set_headers (GstBuffer ** buffer, guint idx, gpointer user_data)
+write_header_extensions (HeaderData * data, GstBuffer * buffer)
 {
-  HeaderData *data = user_data;
-  HeaderExt hdrext = { NULL, };
-  GstRTPBuffer rtp = { NULL, };
-
-  if (!gst_rtp_buffer_map (*buffer, GST_MAP_READWRITE, &rtp))
-    goto map_failed;
-
-  gst_rtp_buffer_set_ssrc (&rtp, data->ssrc);
-  gst_rtp_buffer_set_payload_type (&rtp, data->pt);
-  gst_rtp_buffer_set_seq (&rtp, data->seqnum);
-  gst_rtp_buffer_set_timestamp (&rtp, data->rtptime);
-
-  GST_OBJECT_LOCK (data->payload);
-  if (data->payload->priv->header_exts->len > 0) {
-    guint wordlen;
-    gsize extlen;
-    guint16 bit_pattern;
-
-    /* write header extensions */
-    hdrext.payload = data->payload;
-    hdrext.output = *buffer;
-    /* XXX: pre-calculate these flags and sizes? */
-    hdrext.flags =
-        GST_RTP_HEADER_EXTENSION_ONE_BYTE | GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-    g_ptr_array_foreach (data->payload->priv->header_exts,
-        (GFunc) determine_header_extension_flags_size, &hdrext);
-    hdrext.hdr_unit_size = 0;
-    if (hdrext.flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
-      /* prefer the one byte header */
-      hdrext.hdr_unit_size = 1;
-      /* TODO: support mixed size writing modes, i.e. RFC8285 */
-      hdrext.flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
-      bit_pattern = 0xBEDE;
-    } else if (hdrext.flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
-      hdrext.hdr_unit_size = 2;
-      bit_pattern = 0x1000;
-    } else {
-      goto unsupported_flags;
-    }
-
-    extlen =
-        hdrext.hdr_unit_size * data->payload->priv->header_exts->len +
-        hdrext.allocated_size;
-    wordlen = extlen / 4 + ((extlen % 4) ? 1 : 0);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint wordlen = data->ext_wordlen;
+  guint8 *ext_data;
+  gsize written_size;
 
-    /* XXX: do we need to add to any existing extension data instead of
-     * overwriting everything? */
-    gst_rtp_buffer_set_extension_data (&rtp, bit_pattern, wordlen);
-    gst_rtp_buffer_get_extension_data (&rtp, NULL, (gpointer) & hdrext.data,
-        &wordlen);
+  if (!gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtp))
+    return FALSE;
 
-    /* from 32-bit words to bytes */
-    hdrext.allocated_size = wordlen * 4;
+  /* XXX: do we need to add to any existing extension data instead of
+   * overwriting everything? */
+  gst_rtp_buffer_set_extension_data (&rtp, data->ext_bit_pattern, wordlen);
+  gst_rtp_buffer_get_extension_data (&rtp, NULL, (gpointer) & ext_data,
+      &wordlen);
 
-    g_ptr_array_foreach (data->payload->priv->header_exts,
-        (GFunc) write_header_extension, &hdrext);
+  written_size = gst_rtp_header_extension_plan_write (data->ext_plan,
+      data->input_meta, data->ext_flags, buffer, ext_data, wordlen * 4);
 
-    if (hdrext.written_size > 0) {
-      wordlen = hdrext.written_size / 4 + ((hdrext.written_size % 4) ? 1 : 0);
+  if (written_size > 0) {
+    wordlen = written_size / 4 + ((written_size % 4) ? 1 : 0);
 
-      /* zero-fill the hdrext padding bytes */
-      memset (&hdrext.data[hdrext.written_size], 0,
-          wordlen * 4 - hdrext.written_size);
+    /* zero-fill the hdrext padding bytes */
+    memset (&ext_data[written_size], 0, wordlen * 4 - written_size);
 
-      gst_rtp_buffer_set_extension_data (&rtp, bit_pattern, wordlen);
-    } else {
-      gst_rtp_buffer_remove_extension_data (&rtp);
-    }
+    gst_rtp_buffer_set_extension_data (&rtp, data->ext_bit_pattern, wordlen);
+  } else {
+    gst_rtp_buffer_remove_extension_data (&rtp);
   }
-  GST_OBJECT_UNLOCK (data->payload);
-  gst_rtp_buffer_unmap (&rtp);
 
-  /* increment the seqnum for each buffer */
-  data->seqnum++;
+  gst_rtp_buffer_unmap (&rtp);
 
   return TRUE;
-  /* ERRORS */
-map_failed:
-  {
-    GST_ERROR ("failed to map buffer %p", *buffer);
-    return FALSE;
-  }
-
-unsupported_flags:
-  {
-    GST_OBJECT_UNLOCK (data->payload);
-    gst_rtp_buffer_unmap (&rtp);
-    GST_ERROR ("Cannot add rtp header extensions with mixed header types");
-    return FALSE;
-  }
 }
 
 static gboolean
 foreach_metadata_drop (GstBuffer * buffer, GstMeta ** meta, gpointer user_data)
 {
-  GType drop_api_type = (GType) user_data;
   const GstMetaInfo *info = (*meta)->info;
 
-  if (info->api == drop_api_type)
+  /* the source meta was consumed when allocating the packet and a cached
+   * packet view no longer matches the rewritten header */
+  if (info->api == GST_RTP_SOURCE_META_API_TYPE ||
+      info->api == GST_RTP_PACKET_VIEW_META_API_TYPE)
     *meta = NULL;
 
   return TRUE;
 }
 
+/* Updates the SSRC, payload type, seqnum and timestamp of @n_buffers packets,
+ * writes their header extensions and drops unwanted meta in a single pass.
+ * The headers of up to HEADER_BATCH_SIZE packets are mapped up front, each
+ * packet is then finished before the next one is written. Must be called
+ * with the OBJECT_LOCK. Returns %FALSE when a packet could not be updated,
+ * the following packets are left untouched in that case. */
 static gboolean
-filter_meta (GstBuffer ** buffer, guint idx, gpointer user_data)
+set_headers (HeaderData * data, GstBuffer ** buffers, guint n_buffers)
 {
-  return gst_buffer_foreach_meta (*buffer, foreach_metadata_drop,
-      (gpointer) GST_RTP_SOURCE_META_API_TYPE);
+  GstMapInfo maps[HEADER_BATCH_SIZE];
+  guint i, n_mapped;
+  gboolean ret = TRUE;
+
+  g_assert (n_buffers <= HEADER_BATCH_SIZE);
+
+  /* resolve the header of each packet */
+  for (n_mapped = 0; n_mapped < n_buffers; n_mapped++) {
+    GstMapInfo *map = &maps[n_mapped];
+
+    if (!gst_buffer_map_range (buffers[n_mapped], 0, 1, map,
+            GST_MAP_READWRITE))
+      goto map_failed;
+
+    if (map->size < RTP_HEADER_LEN
+        || (map->data[0] & 0xc0) != (GST_RTP_VERSION << 6)) {
+      gst_buffer_unmap (buffers[n_mapped], map);
+      goto map_failed;
+    }
+  }
+
+done:
+  for (i = 0; i < n_mapped; i++) {
+    guint8 *hdr = maps[i].data;
+
+    /* write the fixed header fields */
+    hdr[1] = (hdr[1] & 0x80) | (data->pt & 0x7f);
+    GST_WRITE_UINT16_BE (hdr + 2, data->seqnum + i);
+    GST_WRITE_UINT32_BE (hdr + 4, data->rtptime);
+    GST_WRITE_UINT32_BE (hdr + 8, data->ssrc);
+
+    gst_buffer_unmap (buffers[i], &maps[i]);
+
+    if (data->ext_plan && !write_header_extensions (data, buffers[i])) {
+      GST_ERROR ("failed to map buffer %p", buffers[i]);
+      /* this packet keeps its seqnum, the packets that follow are left
+       * untouched so their seqnums are only used by the next push */
+      data->seqnum += i + 1;
+      for (i = i + 1; i < n_mapped; i++)
+        gst_buffer_unmap (buffers[i], &maps[i]);
+      return FALSE;
+    }
+
+    gst_buffer_foreach_meta (buffers[i], foreach_metadata_drop, NULL);
+  }
+
+  /* increment the seqnum for each buffer */
+  data->seqnum += n_mapped;
+
+  return ret;
+
+  /* ERRORS */
+map_failed:
+  {
+    GST_ERROR ("failed to map buffer %p", buffers[n_mapped]);
+    ret = FALSE;
+    goto done;
+  }
 }
 
 /* Updates the SSRC, payload type, seqnum and timestamp of the RTP buffer
@@ -1920,16 +2005,32 @@ gst_rtp_base_payload_prepare_push (GstRTPBasePayload * payload,
 
   /* set ssrc, payload type, seq number, caps and rtptime */
   /* remove unwanted meta */
+  GST_OBJECT_LOCK (payload);
+  if (!prepare_header_extensions (&data))
+    GST_ERROR_OBJECT (payload,
+        "Cannot add rtp header extensions with mixed header types");
+
   if (is_list) {
-    gst_buffer_list_foreach (GST_BUFFER_LIST_CAST (obj), set_headers, &data);
-    gst_buffer_list_foreach (GST_BUFFER_LIST_CAST (obj), filter_meta, NULL);
+    GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+    GstBuffer *buffers[HEADER_BATCH_SIZE];
+    guint i, j, len;
+
+    len = gst_buffer_list_length (list);
+    for (i = 0; i < len; i += HEADER_BATCH_SIZE) {
+      guint n = MIN (len - i, HEADER_BATCH_SIZE);
+
+      for (j = 0; j < n; j++)
+        buffers[j] = gst_buffer_list_get (list, i + j);
+      if (!set_headers (&data, buffers, n))
+        break;
+    }
     /* sequence number has increased more if this was a buffer list */
     payload->seqnum = data.seqnum - 1;
   } else {
     GstBuffer *buf = GST_BUFFER_CAST (obj);
-    set_headers (&buf, 0, &data);
-    filter_meta (&buf, 0, NULL);
+    set_headers (&data, &buf, 1);
   }
+  GST_OBJECT_UNLOCK (payload);
 
   priv->next_seqnum = data.seqnum;
   payload->timestamp = data.rtptime;
@@ -1958,6 +2059,74 @@ no_rate:
   }
 }
 
+static void
+gst_rtp_base_payload_push_pending_segment (GstRTPBasePayload * payload)
+{
+  if (G_UNLIKELY (payload->priv->pending_segment)) {
+    gst_pad_push_event (payload->srcpad, payload->priv->pending_segment);
+    payload->priv->pending_segment = FALSE;
+    payload->priv->delay_segment = FALSE;
+  }
+}
+
+/* Pushes the packets collected while payloading the current input buffer.
+ * Must be called with the STREAM_LOCK. */
+static GstFlowReturn
+gst_rtp_base_payload_push_frame_list (GstRTPBasePayload * payload)
+{
+  GstBufferList *list = payload->priv->frame_list;
+
+  payload->priv->frame_list = NULL;
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  GST_LOG_OBJECT (payload, "pushing %u packets of frame",
+      gst_buffer_list_length (list));
+
+  gst_rtp_base_payload_push_pending_segment (payload);
+
+  /* no need for the list overhead for single packet frames */
+  if (gst_buffer_list_length (list) == 1) {
+    GstBuffer *buffer = gst_buffer_ref (gst_buffer_list_get (list, 0));
+
+    gst_buffer_list_unref (list);
+    return gst_pad_push (payload->srcpad, buffer);
+  }
+
+  return gst_pad_push_list (payload->srcpad, list);
+}
+
+static GstPadProbeReturn
+gst_rtp_base_payload_src_event_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstRTPBasePayload *payload = user_data;
+  GstRTPBasePayloadPrivate *priv = payload->priv;
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+
+  if (!GST_EVENT_IS_SERIALIZED (event))
+    return GST_PAD_PROBE_OK;
+
+  /* a sticky event is stored on the pad before it is pushed, so pushing the
+   * packets tries to send it first. Keep it pending there, it is sent by
+   * its own push once the packets are out */
+  if (event == priv->frame_list_event)
+    return GST_PAD_PROBE_DROP;
+
+  /* only set while handle_buffer runs, with the STREAM_LOCK */
+  if (priv->frame_list == NULL)
+    return GST_PAD_PROBE_OK;
+
+  GST_LOG_OBJECT (payload, "pushing collected packets before %"
+      GST_PTR_FORMAT, event);
+
+  priv->frame_list_event = event;
+  priv->frame_list_ret = gst_rtp_base_payload_push_frame_list (payload);
+  priv->frame_list_event = NULL;
+
+  return GST_PAD_PROBE_OK;
+}
+
 /**
  * gst_rtp_base_payload_push_list:
  * @payload: a #GstRTPBasePayload
@@ -1966,6 +2135,12 @@ no_rate:
  * Push @list to the peer element of the payloader. The SSRC, payload type,
  * seqnum and timestamp of the RTP buffer will be updated first.
  *
+ * When #GstRTPBasePayload:frame-lists is enabled and this is called from the
+ * handle_buffer function, the buffers are added to the list of packets of the
+ * current frame and pushed after handle_buffer returns. The return value then
+ * only reports errors of packets of the frame pushed earlier, see
+ * #GstRTPBasePayload:frame-lists.
+ *
  * This function takes ownership of @list.
  *
  * Returns: a #GstFlowReturn.
@@ -1974,16 +2149,41 @@ GstFlowReturn
 gst_rtp_base_payload_push_list (GstRTPBasePayload * payload,
     GstBufferList * list)
 {
+  GstRTPBasePayloadPrivate *priv = payload->priv;
   GstFlowReturn res;
 
+  /* the packets are only pushed once handle_buffer returns, stop the
+   * subclass if packets of this frame could not be pushed already */
+  if (priv->collect_frame) {
+    res = priv->frame_list_ret;
+    if (res == GST_FLOW_OK && GST_PAD_IS_FLUSHING (payload->srcpad))
+      res = GST_FLOW_FLUSHING;
+    else if (res == GST_FLOW_OK && GST_PAD_IS_EOS (payload->srcpad))
+      res = GST_FLOW_EOS;
+    if (G_UNLIKELY (res != GST_FLOW_OK)) {
+      gst_buffer_list_unref (list);
+      return res;
+    }
+  }
+
   res = gst_rtp_base_payload_prepare_push (payload, list, TRUE);
 
   if (G_LIKELY (res == GST_FLOW_OK)) {
-    if (G_UNLIKELY (payload->priv->pending_segment)) {
-      gst_pad_push_event (payload->srcpad, payload->priv->pending_segment);
-      payload->priv->pending_segment = FALSE;
-      payload->priv->delay_segment = FALSE;
+    if (priv->collect_frame) {
+      if (priv->frame_list == NULL) {
+        priv->frame_list = gst_buffer_list_make_writable (list);
+      } else {
+        guint i, len = gst_buffer_list_length (list);
+
+        for (i = 0; i < len; i++)
+          gst_buffer_list_add (priv->frame_list,
+              gst_buffer_ref (gst_buffer_list_get (list, i)));
+        gst_buffer_list_unref (list);
+      }
+      return GST_FLOW_OK;
     }
+
+    gst_rtp_base_payload_push_pending_segment (payload);
     res = gst_pad_push_list (payload->srcpad, list);
   } else {
     gst_buffer_list_unref (list);
@@ -2000,6 +2200,12 @@ gst_rtp_base_payload_push_list (GstRTPBasePayload * payload,
  * Push @buffer to the peer element of the payloader. The SSRC, payload type,
  * seqnum and timestamp of the RTP buffer will be updated first.
  *
+ * When #GstRTPBasePayload:frame-lists is enabled and this is called from the
+ * handle_buffer function, @buffer is added to the list of packets of the
+ * current frame and pushed after handle_buffer returns. The return value then
+ * only reports errors of packets of the frame pushed earlier, see
+ * #GstRTPBasePayload:frame-lists.
+ *
  * This function takes ownership of @buffer.
  *
  * Returns: a #GstFlowReturn.
@@ -2007,16 +2213,34 @@ gst_rtp_base_payload_push_list (GstRTPBasePayload * payload,
 GstFlowReturn
 gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
 {
+  GstRTPBasePayloadPrivate *priv = payload->priv;
   GstFlowReturn res;
 
+  /* the packets are only pushed once handle_buffer returns, stop the
+   * subclass if packets of this frame could not be pushed already */
+  if (priv->collect_frame) {
+    res = priv->frame_list_ret;
+    if (res == GST_FLOW_OK && GST_PAD_IS_FLUSHING (payload->srcpad))
+      res = GST_FLOW_FLUSHING;
+    else if (res == GST_FLOW_OK && GST_PAD_IS_EOS (payload->srcpad))
+      res = GST_FLOW_EOS;
+    if (G_UNLIKELY (res != GST_FLOW_OK)) {
+      gst_buffer_unref (buffer);
+      return res;
+    }
+  }
+
   res = gst_rtp_base_payload_prepare_push (payload, buffer, FALSE);
 
   if (G_LIKELY (res == GST_FLOW_OK)) {
-    if (G_UNLIKELY (payload->priv->pending_segment)) {
-      gst_pad_push_event (payload->srcpad, payload->priv->pending_segment);
-      payload->priv->pending_segment = FALSE;
-      payload->priv->delay_segment = FALSE;
+    if (priv->collect_frame) {
+      if (priv->frame_list == NULL)
+        priv->frame_list = gst_buffer_list_new ();
+      gst_buffer_list_add (priv->frame_list, buffer);
+      return GST_FLOW_OK;
     }
+
+    gst_rtp_base_payload_push_pending_segment (payload);
     res = gst_pad_push (payload->srcpad, buffer);
   } else {
     gst_buffer_unref (buffer);
@@ -2025,6 +2249,64 @@ gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
   return res;
 }
 
+/* Allocates a packet whose header memory comes from the recycling header
+ * pool, with separate memory for the payload and the padding like
+ * gst_rtp_buffer_allocate_data() does. */
+static GstBuffer *
+gst_rtp_base_payload_allocate_packet (GstRTPBasePayload * payload,
+    guint payload_len, guint8 pad_len, guint8 csrc_count)
+{
+  GstRTPBasePayloadPrivate *priv = payload->priv;
+  GstBuffer *buffer = NULL;
+  GstMapInfo map;
+  gsize hlen;
+
+  g_return_val_if_fail (csrc_count <= 15, NULL);
+
+  if (G_UNLIKELY (priv->header_pool == NULL)) {
+    GstStructure *config;
+
+    priv->header_pool = g_object_new (gst_rtp_header_pool_get_type (), NULL);
+    gst_object_ref_sink (priv->header_pool);
+
+    config = gst_buffer_pool_get_config (priv->header_pool);
+    gst_buffer_pool_config_set_params (config, NULL, RTP_MAX_HEADER_LEN, 0, 0);
+    if (!gst_buffer_pool_set_config (priv->header_pool, config) ||
+        !gst_buffer_pool_set_active (priv->header_pool, TRUE))
+      GST_WARNING_OBJECT (payload, "failed to activate header pool");
+  }
+
+  if (gst_buffer_pool_acquire_buffer (priv->header_pool, &buffer,
+          NULL) != GST_FLOW_OK) {
+    GST_DEBUG_OBJECT (payload, "no pooled header, allocating");
+    return gst_rtp_buffer_new_allocate (payload_len, pad_len, csrc_count);
+  }
+
+  hlen = RTP_HEADER_LEN + csrc_count * sizeof (guint32);
+  gst_buffer_set_size (buffer, hlen);
+
+  /* the header is recycled, reset all fields */
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  memset (map.data, 0, hlen);
+  map.data[0] = (GST_RTP_VERSION << 6) | (pad_len ? 0x20 : 0x00) | csrc_count;
+  gst_buffer_unmap (buffer, &map);
+
+  if (payload_len)
+    gst_buffer_append_memory (buffer,
+        gst_allocator_alloc (NULL, payload_len, NULL));
+  if (pad_len) {
+    GstMemory *mem = gst_allocator_alloc (NULL, pad_len, NULL);
+
+    gst_memory_map (mem, &map, GST_MAP_WRITE);
+    map.data[pad_len - 1] = pad_len;
+    gst_memory_unmap (mem, &map);
+
+    gst_buffer_append_memory (buffer, mem);
+  }
+
+  return buffer;
+}
+
 /**
  * gst_rtp_base_payload_allocate_output_buffer:
  * @payload: a #GstRTPBasePayload
@@ -2037,6 +2319,11 @@ gst_rtp_base_payload_push (GstRTPBasePayload * payload, GstBuffer * buffer)
  * @pad_len. If @payload has #GstRTPBasePayload:source-info %TRUE additional
  * CSRCs may be allocated and filled with RTP source information.
  *
+ * The RTP header is placed in its own memory, which is recycled by the
+ * payloader once downstream releases the packet. Payload and padding are
+ * allocated as separate memories, a payload length of 0 can be used to
+ * append existing payload memory to the header instead.
+ *
  * Returns: A newly allocated buffer that can hold an RTP packet with given
  * parameters.
  *
@@ -2058,8 +2345,8 @@ gst_rtp_base_payload_allocate_output_buffer (GstRTPBasePayload * payload,
       total_csrc_count = csrc_count + meta->csrc_count +
           (meta->ssrc_valid ? 1 : 0);
       total_csrc_count = MIN (total_csrc_count, 15);
-      buffer = gst_rtp_buffer_new_allocate (payload_len, pad_len,
-          total_csrc_count);
+      buffer = gst_rtp_base_payload_allocate_packet (payload, payload_len,
+          pad_len, total_csrc_count);
 
       gst_rtp_buffer_map (buffer, GST_MAP_READWRITE, &rtp);
 
@@ -2076,7 +2363,51 @@ gst_rtp_base_payload_allocate_output_buffer (GstRTPBasePayload * payload,
   }
 
   if (buffer == NULL)
-    buffer = gst_rtp_buffer_new_allocate (payload_len, pad_len, csrc_count);
+    buffer = gst_rtp_base_payload_allocate_packet (payload, payload_len,
+        pad_len, csrc_count);
+
+  return buffer;
+}
+
+/**
+ * gst_rtp_base_payload_wrap_output_buffer:
+ * @payload: a #GstRTPBasePayload
+ * @input: (transfer none): the #GstBuffer containing the payload
+ * @offset: the offset of the payload in @input
+ * @size: the size of the payload or -1 to use everything after @offset
+ * @csrc_count: the minimum number of CSRC entries
+ *
+ * Allocate an RTP packet like gst_rtp_base_payload_allocate_output_buffer()
+ * without payload or padding and append the memory of @input in the region
+ * described by @offset and @size to it. The payload memory is shared with
+ * @input, no data is copied.
+ *
+ * This allows fragmenting a large input buffer into packets made up of a
+ * recycled header and a sub-memory of the input.
+ *
+ * Returns: (transfer full): A new RTP packet carrying the given region of
+ * @input as payload.
+ *
+ * Since: 1.20
+ */
+GstBuffer *
+gst_rtp_base_payload_wrap_output_buffer (GstRTPBasePayload * payload,
+    GstBuffer * input, gsize offset, gssize size, guint8 csrc_count)
+{
+  GstBuffer *buffer;
+
+  g_return_val_if_fail (GST_IS_RTP_BASE_PAYLOAD (payload), NULL);
+  g_return_val_if_fail (GST_IS_BUFFER (input), NULL);
+
+  buffer = gst_rtp_base_payload_allocate_output_buffer (payload, 0, 0,
+      csrc_count);
+
+  if (!gst_buffer_copy_into (buffer, input, GST_BUFFER_COPY_MEMORY, offset,
+          size)) {
+    GST_WARNING_OBJECT (payload, "failed to wrap payload region");
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
 
   return buffer;
 }
@@ -2164,6 +2495,9 @@ gst_rtp_base_payload_set_property (GObject * object, guint prop_id,
     case PROP_AUTO_HEADER_EXTENSION:
       priv->auto_hdr_ext = g_value_get_boolean (value);
       break;
+    case PROP_FRAME_LISTS:
+      priv->frame_lists = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2240,6 +2574,9 @@ gst_rtp_base_payload_get_property (GObject * object, guint prop_id,
     case PROP_AUTO_HEADER_EXTENSION:
       g_value_set_boolean (value, priv->auto_hdr_ext);
       break;
+    case PROP_FRAME_LISTS:
+      g_value_set_boolean (value, priv->frame_lists);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2301,6 +2638,15 @@ gst_rtp_base_payload_change_state (GstElement * element,
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_event_replace (&rtpbasepayload->priv->pending_segment, NULL);
+      if (priv->frame_list) {
+        gst_buffer_list_unref (priv->frame_list);
+        priv->frame_list = NULL;
+      }
+      if (priv->header_pool) {
+        gst_buffer_pool_set_active (priv->header_pool, FALSE);
+        gst_object_unref (priv->header_pool);
+        priv->header_pool = NULL;
+      }
       break;
     default:
       break;
@@ -34,6 +34,7 @@
 #endif
 
 #include "gstrtpbuffer.h"
+#include "gstrtpmeta.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -503,6 +504,15 @@ gst_rtp_buffer_unmap (GstRTPBuffer * rtp)
   g_return_if_fail (rtp != NULL);
   g_return_if_fail (rtp->buffer != NULL);
 
+  /* the header might have been changed, drop the cached view */
+  if (rtp->map[0].flags & GST_MAP_WRITE) {
+    GstMeta *meta = gst_buffer_get_meta (rtp->buffer,
+        GST_RTP_PACKET_VIEW_META_API_TYPE);
+
+    if (meta)
+      gst_buffer_remove_meta (rtp->buffer, meta);
+  }
+
   for (i = 0; i < 4; i++) {
     if (rtp->map[i].memory != NULL) {
       gst_buffer_unmap (rtp->buffer, &rtp->map[i]);
@@ -514,6 +524,105 @@ gst_rtp_buffer_unmap (GstRTPBuffer * rtp)
   rtp->buffer = NULL;
 }
 
+/**
+ * gst_rtp_packet_view_parse:
+ * @buffer: a #GstBuffer
+ * @view: (out caller-allocates): a #GstRTPPacketView to fill
+ *
+ * Parses the fixed RTP header and CSRC count of @buffer into @view. Only the
+ * first memory of @buffer is looked at, and unlike gst_rtp_buffer_map() the
+ * header extension, padding and payload are neither mapped nor validated.
+ * This makes it a cheap way to look at sequence numbers, timestamps and
+ * SSRCs of packets that are otherwise passed on untouched.
+ *
+ * See gst_buffer_get_rtp_packet_view() for a variant that caches the
+ * result on the buffer.
+ *
+ * Returns: %TRUE if @buffer starts with a valid RTP header.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_rtp_packet_view_parse (GstBuffer * buffer, GstRTPPacketView * view)
+{
+  GstMemory *mem;
+  GstMapInfo map;
+  const guint8 *data;
+  guint8 version, pt;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (view != NULL, FALSE);
+
+  if (G_UNLIKELY (gst_buffer_n_memory (buffer) < 1))
+    goto no_memory;
+
+  /* the header must be completely in the first memory */
+  mem = gst_buffer_peek_memory (buffer, 0);
+  if (!gst_memory_map (mem, &map, GST_MAP_READ))
+    goto map_failed;
+
+  data = map.data;
+  if (G_UNLIKELY (map.size < GST_RTP_HEADER_LEN))
+    goto wrong_length;
+
+  version = (data[0] & 0xc0);
+  if (G_UNLIKELY (version != (GST_RTP_VERSION << 6)))
+    goto wrong_version;
+
+  /* same relaxed RTCP check as gst_rtp_buffer_map() */
+  pt = data[1];
+  if (G_UNLIKELY (pt >= 200 && pt <= 204))
+    goto reserved_pt;
+
+  view->version = version >> 6;
+  view->padding = (data[0] & 0x20) != 0;
+  view->extension = (data[0] & 0x10) != 0;
+  view->csrc_count = data[0] & 0x0f;
+  view->marker = (data[1] & 0x80) != 0;
+  view->payload_type = data[1] & 0x7f;
+  view->seq = GST_READ_UINT16_BE (data + 2);
+  view->timestamp = GST_READ_UINT32_BE (data + 4);
+  view->ssrc = GST_READ_UINT32_BE (data + 8);
+  view->header_len = GST_RTP_HEADER_LEN + view->csrc_count * sizeof (guint32);
+
+  if (G_UNLIKELY (map.size < view->header_len))
+    goto wrong_length;
+
+  gst_memory_unmap (mem, &map);
+
+  return TRUE;
+
+  /* ERRORS */
+no_memory:
+  {
+    GST_ERROR ("buffer without memory");
+    return FALSE;
+  }
+map_failed:
+  {
+    GST_ERROR ("failed to map memory");
+    return FALSE;
+  }
+wrong_length:
+  {
+    GST_DEBUG ("length check failed");
+    gst_memory_unmap (mem, &map);
+    return FALSE;
+  }
+wrong_version:
+  {
+    GST_DEBUG ("version check failed (%d != %d)", version, GST_RTP_VERSION);
+    gst_memory_unmap (mem, &map);
+    return FALSE;
+  }
+reserved_pt:
+  {
+    GST_DEBUG ("reserved PT %d found", pt);
+    gst_memory_unmap (mem, &map);
+    return FALSE;
+  }
+}
+
 
 /**
  * gst_rtp_buffer_set_packet_len:
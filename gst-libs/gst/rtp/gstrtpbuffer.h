@@ -62,6 +62,44 @@ struct _GstRTPBuffer
 #define GST_RTP_BUFFER_INIT { NULL, 0, { NULL, NULL, NULL, NULL}, { 0, 0, 0, 0 }, \
   { GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT, GST_MAP_INFO_INIT} }
 
+typedef struct _GstRTPPacketView GstRTPPacketView;
+
+/**
+ * GstRTPPacketView:
+ * @version: the RTP version
+ * @padding: whether the padding bit is set
+ * @extension: whether the extension bit is set
+ * @csrc_count: the number of CSRCs
+ * @marker: whether the marker bit is set
+ * @payload_type: the payload type
+ * @seq: the sequence number
+ * @timestamp: the RTP timestamp
+ * @ssrc: the SSRC
+ * @header_len: length of the fixed header and the CSRC list, not including
+ *     any header extension
+ *
+ * Read-only copy of the fixed RTP header fields of a packet, filled by
+ * gst_rtp_packet_view_parse().
+ *
+ * Since: 1.20
+ */
+struct _GstRTPPacketView
+{
+  guint8       version;
+  gboolean     padding;
+  gboolean     extension;
+  guint8       csrc_count;
+  gboolean     marker;
+  guint8       payload_type;
+  guint16      seq;
+  guint32      timestamp;
+  guint32      ssrc;
+  guint        header_len;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
 /* creating buffers */
 
 GST_RTP_API
@@ -192,6 +230,11 @@ gpointer        gst_rtp_buffer_get_payload           (GstRTPBuffer *rtp);
 GST_RTP_API
 GBytes*         gst_rtp_buffer_get_payload_bytes     (GstRTPBuffer *rtp);
 
+/* header-only access */
+
+GST_RTP_API
+gboolean        gst_rtp_packet_view_parse            (GstBuffer *buffer, GstRTPPacketView *view);
+
 /* some helpers */
 
 GST_RTP_API
@@ -30,6 +30,7 @@
 #endif
 
 #include "gstrtphdrext.h"
+#include "gstrtphdrextprivate.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -39,12 +40,20 @@ GST_DEBUG_CATEGORY_STATIC (rtphderext_debug);
 
 #define MAX_RTP_EXT_ID 256
 
+#define RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE 16
+#define RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE 256
+#define RTP_HEADER_EXT_ONE_BYTE_MAX_ID 14
+#define RTP_HEADER_EXT_TWO_BYTE_MAX_ID 255
+
 typedef struct
 {
   guint ext_id;
   gboolean wants_update_non_rtp_src_caps;
 } GstRTPHeaderExtensionPrivate;
 
+/* bumped whenever the id of any extension changes */
+static gint ext_id_generation = 0;
+
 /**
  * gst_rtp_hdrext_set_ntp_64:
  * @data: the data to write to
@@ -372,7 +381,11 @@ gst_rtp_header_extension_set_id (GstRTPHeaderExtension * ext, guint ext_id)
   g_return_if_fail (GST_IS_RTP_HEADER_EXTENSION (ext));
   g_return_if_fail (ext_id < MAX_RTP_EXT_ID);
 
-  priv->ext_id = ext_id;
+  if (priv->ext_id != ext_id) {
+    priv->ext_id = ext_id;
+    /* plans built with the old id are stale now */
+    g_atomic_int_inc (&ext_id_generation);
+  }
 }
 
 /**
@@ -733,3 +746,293 @@ gst_rtp_header_extension_create_from_uri (const gchar * uri)
 
   return NULL;
 }
+
+/* Builds a plan for the extensions in @exts, leaving out the ones that do not
+ * implement the vfuncs the plan calls directly. Must be called with the lock
+ * protecting @exts held. */
+GstRTPHeaderExtensionPlan *
+gst_rtp_header_extension_plan_new (GPtrArray * exts)
+{
+  GstRTPHeaderExtensionPlan *plan;
+  guint i;
+
+  plan = g_new0 (GstRTPHeaderExtensionPlan, 1);
+  plan->id_generation = g_atomic_int_get (&ext_id_generation);
+  plan->exts = g_new (GstRTPHeaderExtension *, MAX (exts->len, 1));
+  plan->flags =
+      GST_RTP_HEADER_EXTENSION_ONE_BYTE | GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+
+  for (i = 0; i < exts->len; i++) {
+    GstRTPHeaderExtension *ext = g_ptr_array_index (exts, i);
+    GstRTPHeaderExtensionClass *klass =
+        GST_RTP_HEADER_EXTENSION_GET_CLASS (ext);
+    GstRTPHeaderExtensionPrivate *priv =
+        gst_rtp_header_extension_get_instance_private (ext);
+
+    if (klass->get_supported_flags == NULL || klass->get_max_size == NULL
+        || klass->write == NULL || klass->read == NULL) {
+      GST_WARNING_OBJECT (ext, "extension does not implement all required "
+          "methods, ignoring it");
+      continue;
+    }
+
+    plan->exts[plan->n_exts++] = gst_object_ref (ext);
+    plan->flags &= gst_rtp_header_extension_get_supported_flags (ext);
+
+    if (priv->ext_id > RTP_HEADER_EXT_ONE_BYTE_MAX_ID)
+      plan->flags &= ~GST_RTP_HEADER_EXTENSION_ONE_BYTE;
+    if (priv->ext_id > RTP_HEADER_EXT_TWO_BYTE_MAX_ID)
+      plan->flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+
+    /* the first extension configured with an id handles it */
+    if (priv->ext_id < MAX_RTP_EXT_ID && plan->by_id[priv->ext_id] == NULL)
+      plan->by_id[priv->ext_id] = ext;
+  }
+
+  return plan;
+}
+
+void
+gst_rtp_header_extension_plan_free (GstRTPHeaderExtensionPlan * plan)
+{
+  guint i;
+
+  if (plan == NULL)
+    return;
+
+  for (i = 0; i < plan->n_exts; i++)
+    gst_object_unref (plan->exts[i]);
+  g_free (plan->exts);
+  g_free (plan);
+}
+
+/* Returns the plan in @plan for the extensions in @exts, building it when
+ * there is none yet or when the id of an extension may have changed since
+ * it was built. Must be called with the lock protecting @exts held. */
+GstRTPHeaderExtensionPlan *
+gst_rtp_header_extension_plan_ensure (GstRTPHeaderExtensionPlan ** plan,
+    GPtrArray * exts)
+{
+  if (*plan
+      && (*plan)->id_generation != g_atomic_int_get (&ext_id_generation)) {
+    gst_rtp_header_extension_plan_free (*plan);
+    *plan = NULL;
+  }
+
+  if (*plan == NULL)
+    *plan = gst_rtp_header_extension_plan_new (exts);
+
+  return *plan;
+}
+
+/* Resolves the header form and the maximum number of bytes, including the
+ * per extension headers, needed to write the extensions of a packet
+ * produced from @input_meta. Returns %FALSE when no single header form can
+ * hold all extensions. */
+gboolean
+gst_rtp_header_extension_plan_get_write_layout (GstRTPHeaderExtensionPlan *
+    plan, const GstBuffer * input_meta, GstRTPHeaderExtensionFlags * flags,
+    guint16 * bit_pattern, gsize * max_size)
+{
+  GstRTPHeaderExtensionFlags ext_flags = plan->flags;
+  gsize unit_size, total = 0;
+  guint i;
+
+  for (i = 0; i < plan->n_exts; i++) {
+    GstRTPHeaderExtension *ext = plan->exts[i];
+    gsize size;
+
+    size = GST_RTP_HEADER_EXTENSION_GET_CLASS (ext)->get_max_size (ext,
+        input_meta);
+
+    if (size > RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE)
+      ext_flags &= ~GST_RTP_HEADER_EXTENSION_ONE_BYTE;
+    if (size > RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE)
+      ext_flags &= ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+
+    total += size;
+  }
+
+  if (ext_flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
+    /* prefer the one byte header */
+    unit_size = 1;
+    /* TODO: support mixed size writing modes, i.e. RFC8285 */
+    *flags = ext_flags & ~GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+    *bit_pattern = 0xBEDE;
+  } else if (ext_flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
+    unit_size = 2;
+    *flags = ext_flags;
+    *bit_pattern = 0x1000;
+  } else {
+    return FALSE;
+  }
+
+  *max_size = unit_size * plan->n_exts + total;
+
+  return TRUE;
+}
+
+/* Writes all extensions of the plan into @data using the header form from
+ * @flags. Returns the number of bytes written, writing stops at the first
+ * extension that fails. */
+gsize
+gst_rtp_header_extension_plan_write (GstRTPHeaderExtensionPlan * plan,
+    const GstBuffer * input_meta, GstRTPHeaderExtensionFlags flags,
+    GstBuffer * output, guint8 * data, gsize size)
+{
+  gsize unit_size, written_size = 0;
+  guint i;
+
+  if (flags & GST_RTP_HEADER_EXTENSION_ONE_BYTE) {
+    unit_size = 1;
+  } else if (flags & GST_RTP_HEADER_EXTENSION_TWO_BYTE) {
+    unit_size = 2;
+  } else {
+    g_critical ("Don't know how to write extension data with flags 0x%x!",
+        flags);
+    return 0;
+  }
+
+  for (i = 0; i < plan->n_exts; i++) {
+    GstRTPHeaderExtension *ext = plan->exts[i];
+    GstRTPHeaderExtensionPrivate *priv =
+        gst_rtp_header_extension_get_instance_private (ext);
+    gsize offset = written_size + unit_size;
+    gssize written;
+
+    if (offset > size)
+      break;
+
+    written = GST_RTP_HEADER_EXTENSION_GET_CLASS (ext)->write (ext, input_meta,
+        flags, output, &data[offset], size - offset);
+
+    if (written == 0) {
+      /* extension wrote no data */
+      continue;
+    } else if (written < 0) {
+      GST_WARNING_OBJECT (ext, "failed to write extension data");
+      break;
+    } else if (written > size - offset) {
+      /* wrote too much! */
+      g_error ("Overflow detected writing rtp header extensions. One of the "
+          "instances likely did not report a large enough maximum size. "
+          "Memory corruption has occured. Aborting");
+      break;
+    }
+
+    /* write extension header */
+    if (unit_size == 1) {
+      if (written > RTP_HEADER_EXT_ONE_BYTE_MAX_SIZE) {
+        g_critical ("Amount of data written by %s is larger than allowed with "
+            "a one byte header.", GST_OBJECT_NAME (ext));
+        break;
+      }
+
+      data[written_size] =
+          ((priv->ext_id & 0x0F) << 4) | ((written - 1) & 0x0F);
+    } else {
+      if (written > RTP_HEADER_EXT_TWO_BYTE_MAX_SIZE) {
+        g_critical ("Amount of data written by %s is larger than allowed with "
+            "a two byte header.", GST_OBJECT_NAME (ext));
+        break;
+      }
+
+      data[written_size] = priv->ext_id & 0xFF;
+      data[written_size + 1] = written & 0xFF;
+    }
+
+    written_size = offset + written;
+  }
+
+  return written_size;
+}
+
+/* Parses the extension block @data with the given @bit_pattern and lets the
+ * extension configured for each id read its data into @output. Blocks that
+ * are not in one of the RFC 8285 forms are ignored. Returns %FALSE when an
+ * extension failed to read its data. */
+gboolean
+gst_rtp_header_extension_plan_read (GstRTPHeaderExtensionPlan * plan,
+    guint16 bit_pattern, const guint8 * data, gsize size, GstBuffer * output,
+    gboolean * update_src_caps)
+{
+  GstRTPHeaderExtensionFlags ext_flags;
+  guint hdr_unit_bytes;
+  gsize offset = 0;
+
+  if (bit_pattern == 0xBEDE) {
+    /* one byte extensions */
+    hdr_unit_bytes = 1;
+    ext_flags = GST_RTP_HEADER_EXTENSION_ONE_BYTE;
+  } else if (bit_pattern >> 4 == 0x100) {
+    /* two byte extensions */
+    hdr_unit_bytes = 2;
+    ext_flags = GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+  } else {
+    GST_DEBUG ("unknown extension bit pattern 0x%02x%02x",
+        bit_pattern >> 8, bit_pattern & 0xff);
+    return TRUE;
+  }
+
+  while (TRUE) {
+    GstRTPHeaderExtension *ext;
+    guint8 read_id, read_len;
+
+    if (offset + hdr_unit_bytes >= size)
+      /* not enough remaning data */
+      break;
+
+    if (hdr_unit_bytes == 1) {
+      read_id = GST_READ_UINT8 (data + offset) >> 4;
+      read_len = (GST_READ_UINT8 (data + offset) & 0x0F) + 1;
+      offset += 1;
+
+      if (read_id == 0)
+        /* padding */
+        continue;
+
+      if (read_id == 15)
+        /* special id for possible future expansion */
+        break;
+    } else {
+      read_id = GST_READ_UINT8 (data + offset);
+      offset += 1;
+
+      if (read_id == 0)
+        /* padding */
+        continue;
+
+      read_len = GST_READ_UINT8 (data + offset);
+      offset += 1;
+    }
+    GST_TRACE ("found rtp header extension with id %u and length %u",
+        read_id, read_len);
+
+    /* Ignore extension headers where the size does not fit */
+    if (offset + read_len > size) {
+      GST_WARNING ("Extension length extends past the size of the extension "
+          "data");
+      break;
+    }
+
+    ext = plan->by_id[read_id];
+    if (ext) {
+      GstRTPHeaderExtensionPrivate *priv =
+          gst_rtp_header_extension_get_instance_private (ext);
+
+      if (!GST_RTP_HEADER_EXTENSION_GET_CLASS (ext)->read (ext, ext_flags,
+              &data[offset], read_len, output)) {
+        GST_WARNING_OBJECT (ext, "RTP header extension could not read "
+            "payloaded data");
+        return FALSE;
+      }
+
+      if (priv->wants_update_non_rtp_src_caps)
+        *update_src_caps = TRUE;
+    }
+
+    offset += read_len;
+  }
+
+  return TRUE;
+}
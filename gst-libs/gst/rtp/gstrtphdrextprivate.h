@@ -0,0 +1,89 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_HDREXT_PRIVATE_H__
+#define __GST_RTP_HDREXT_PRIVATE_H__
+
+#include <gst/gst.h>
+#include <gst/rtp/gstrtphdrext.h>
+
+G_BEGIN_DECLS
+
+#define GST_RTP_HEADER_EXTENSION_PLAN_MAX_ID 256
+
+typedef struct _GstRTPHeaderExtensionPlan GstRTPHeaderExtensionPlan;
+
+/*
+ * GstRTPHeaderExtensionPlan:
+ *
+ * Snapshot of a set of header extensions, resolved once when the set of
+ * negotiated extensions changes so that reading and writing the extensions
+ * of a packet does not need to look up ids and supported flags again.
+ */
+struct _GstRTPHeaderExtensionPlan
+{
+  /* extensions in write order, owned */
+  GstRTPHeaderExtension **exts;
+  guint n_exts;
+
+  /* header forms supported by all extensions and allowed by their ids */
+  GstRTPHeaderExtensionFlags flags;
+
+  /* extension for each id, not owned */
+  GstRTPHeaderExtension *by_id[GST_RTP_HEADER_EXTENSION_PLAN_MAX_ID];
+
+  /* extension id generation the plan was built for */
+  gint id_generation;
+};
+
+G_GNUC_INTERNAL
+GstRTPHeaderExtensionPlan * gst_rtp_header_extension_plan_new (GPtrArray * exts);
+
+G_GNUC_INTERNAL
+void          gst_rtp_header_extension_plan_free (GstRTPHeaderExtensionPlan * plan);
+
+G_GNUC_INTERNAL
+GstRTPHeaderExtensionPlan * gst_rtp_header_extension_plan_ensure (GstRTPHeaderExtensionPlan ** plan,
+                                                                  GPtrArray * exts);
+
+G_GNUC_INTERNAL
+gboolean      gst_rtp_header_extension_plan_get_write_layout (GstRTPHeaderExtensionPlan * plan,
+                                                              const GstBuffer * input_meta,
+                                                              GstRTPHeaderExtensionFlags * flags,
+                                                              guint16 * bit_pattern,
+                                                              gsize * max_size);
+
+G_GNUC_INTERNAL
+gsize         gst_rtp_header_extension_plan_write (GstRTPHeaderExtensionPlan * plan,
+                                                   const GstBuffer * input_meta,
+                                                   GstRTPHeaderExtensionFlags flags,
+                                                   GstBuffer * output,
+                                                   guint8 * data,
+                                                   gsize size);
+
+G_GNUC_INTERNAL
+gboolean      gst_rtp_header_extension_plan_read (GstRTPHeaderExtensionPlan * plan,
+                                                  guint16 bit_pattern,
+                                                  const guint8 * data,
+                                                  gsize size,
+                                                  GstBuffer * output,
+                                                  gboolean * update_src_caps);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_HDREXT_PRIVATE_H__ */
@@ -227,3 +227,89 @@ gst_rtp_source_meta_get_info (void)
   }
   return rtp_source_meta_info;
 }
+
+GType
+gst_rtp_packet_view_meta_api_get_type (void)
+{
+  static GType type = 0;
+  static const gchar *tags[] = { NULL };
+
+  if (g_once_init_enter (&type)) {
+    GType _type = gst_meta_api_type_register ("GstRTPPacketViewMetaAPI", tags);
+    g_once_init_leave (&type, _type);
+  }
+  return type;
+}
+
+static gboolean
+gst_rtp_packet_view_meta_transform (GstBuffer * dst, GstMeta * meta,
+    GstBuffer * src, GQuark type, gpointer data)
+{
+  /* never carried over, the copy may start at a different offset or get
+   * its header rewritten afterwards, it is cheap to parse again */
+  return FALSE;
+}
+
+const GstMetaInfo *
+gst_rtp_packet_view_meta_get_info (void)
+{
+  static const GstMetaInfo *rtp_packet_view_meta_info = NULL;
+
+  if (g_once_init_enter (&rtp_packet_view_meta_info)) {
+    const GstMetaInfo *meta =
+        gst_meta_register (GST_RTP_PACKET_VIEW_META_API_TYPE,
+        "GstRTPPacketViewMeta",
+        sizeof (GstRTPPacketViewMeta),
+        (GstMetaInitFunction) NULL,
+        (GstMetaFreeFunction) NULL,
+        gst_rtp_packet_view_meta_transform);
+    g_once_init_leave (&rtp_packet_view_meta_info, meta);
+  }
+  return rtp_packet_view_meta_info;
+}
+
+/**
+ * gst_buffer_get_rtp_packet_view:
+ * @buffer: a #GstBuffer
+ * @view: (out caller-allocates): a #GstRTPPacketView to fill
+ *
+ * Fills @view with the RTP header of @buffer. The header is parsed with
+ * gst_rtp_packet_view_parse() only the first time, the result is cached in
+ * a #GstRTPPacketViewMeta if @buffer is writable, so later calls only copy
+ * it.
+ *
+ * The cached view is dropped when @buffer is unmapped with
+ * gst_rtp_buffer_unmap() after being mapped for writing. Code changing the
+ * header by other means has to remove the #GstRTPPacketViewMeta itself.
+ *
+ * Returns: %TRUE if @buffer starts with a valid RTP header.
+ *
+ * Since: 1.20
+ */
+gboolean
+gst_buffer_get_rtp_packet_view (GstBuffer * buffer, GstRTPPacketView * view)
+{
+  GstRTPPacketViewMeta *meta;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (view != NULL, FALSE);
+
+  meta = (GstRTPPacketViewMeta *) gst_buffer_get_meta (buffer,
+      GST_RTP_PACKET_VIEW_META_API_TYPE);
+  if (meta) {
+    *view = meta->view;
+    return TRUE;
+  }
+
+  if (!gst_rtp_packet_view_parse (buffer, view))
+    return FALSE;
+
+  if (gst_buffer_is_writable (buffer)) {
+    meta = (GstRTPPacketViewMeta *) gst_buffer_add_meta (buffer,
+        GST_RTP_PACKET_VIEW_META_INFO, NULL);
+    if (meta)
+      meta->view = *view;
+  }
+
+  return TRUE;
+}
@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/rtp/rtp-prelude.h>
+#include <gst/rtp/gstrtpbuffer.h>
 
 G_BEGIN_DECLS
 
@@ -74,6 +75,37 @@ gboolean            gst_rtp_source_meta_append_csrc      (GstRTPSourceMeta * met
 GST_RTP_API
 const GstMetaInfo * gst_rtp_source_meta_get_info         (void);
 
+#define GST_RTP_PACKET_VIEW_META_API_TYPE  (gst_rtp_packet_view_meta_api_get_type())
+#define GST_RTP_PACKET_VIEW_META_INFO  (gst_rtp_packet_view_meta_get_info())
+typedef struct _GstRTPPacketViewMeta GstRTPPacketViewMeta;
+
+/**
+ * GstRTPPacketViewMeta:
+ * @meta: parent #GstMeta
+ * @view: the parsed header of the buffer
+ *
+ * Meta caching the parsed RTP header of the buffer it is attached to, see
+ * gst_buffer_get_rtp_packet_view().
+ *
+ * Since: 1.20
+ */
+struct _GstRTPPacketViewMeta
+{
+  GstMeta meta;
+
+  GstRTPPacketView view;
+};
+
+GST_RTP_API
+GType               gst_rtp_packet_view_meta_api_get_type (void);
+
+GST_RTP_API
+const GstMetaInfo * gst_rtp_packet_view_meta_get_info     (void);
+
+GST_RTP_API
+gboolean            gst_buffer_get_rtp_packet_view        (GstBuffer * buffer,
+                                                           GstRTPPacketView * view);
+
 G_END_DECLS
 
 #endif /* __GST_RTP_META_H__ */
@@ -145,6 +145,13 @@ typedef enum
 
 #define TUNNELID_LEN   24
 
+/* amount of data read from the input stream at once */
+#define READ_BUFFER_SIZE 4096
+
+/* maximum number of vectors passed to a single writev call, the socket output
+ * stream clamps this further to IOV_MAX */
+#define MAX_WRITE_VECTORS 1024
+
 struct _GstRTSPConnection
 {
   /*< private > */
@@ -188,6 +195,12 @@ struct _GstRTSPConnection
   gchar *initial_buffer;
   gsize initial_buffer_offset;
 
+  /* raw data read ahead from the input stream but not consumed yet, valid
+   * from read_buffer_offset up to read_buffer_size */
+  guint8 *read_buffer;
+  guint read_buffer_offset;
+  guint read_buffer_size;
+
   gboolean remember_session_id; /* remember the session id or not */
 
   /* Session state */
@@ -1400,7 +1413,7 @@ writev_bytes (GOutputStream * stream, GOutputVector * vectors, gint n_vectors,
 #endif
 
 static gint
-fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
+read_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
     gboolean block, GError ** err)
 {
   gint out = 0;
@@ -1445,6 +1458,53 @@ fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
   return out;
 }
 
+static inline gboolean
+has_read_buffer_data (GstRTSPConnection * conn)
+{
+  return conn->read_buffer_offset < conn->read_buffer_size;
+}
+
+static inline void
+consume_read_buffer (GstRTSPConnection * conn, guint size)
+{
+  conn->read_buffer_offset += size;
+  if (conn->read_buffer_offset == conn->read_buffer_size)
+    conn->read_buffer_offset = conn->read_buffer_size = 0;
+}
+
+/* Reads from the input stream in READ_BUFFER_SIZE chunks so that parsing a
+ * message does not need a read call for every byte. Requests for at least
+ * that much data are read directly into @buffer once the read-ahead data is
+ * used up. */
+static gint
+fill_raw_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
+    gboolean block, GError ** err)
+{
+  gint out;
+
+  if (!has_read_buffer_data (conn)) {
+    if (size >= READ_BUFFER_SIZE)
+      return read_raw_bytes (conn, buffer, size, block, err);
+
+    if (conn->read_buffer == NULL)
+      conn->read_buffer = g_malloc (READ_BUFFER_SIZE);
+
+    out = read_raw_bytes (conn, conn->read_buffer, READ_BUFFER_SIZE, block,
+        err);
+    if (out <= 0)
+      return out;
+
+    conn->read_buffer_offset = 0;
+    conn->read_buffer_size = out;
+  }
+
+  out = MIN (size, conn->read_buffer_size - conn->read_buffer_offset);
+  memcpy (buffer, &conn->read_buffer[conn->read_buffer_offset], out);
+  consume_read_buffer (conn, out);
+
+  return out;
+}
+
 static gint
 fill_bytes (GstRTSPConnection * conn, guint8 * buffer, guint size,
     gboolean block, GError ** err)
@@ -1529,6 +1589,37 @@ error:
   }
 }
 
+/* Copies the read-ahead data up to the next line ending to @buffer at once,
+ * dropping what does not fit like read_line() does. Only usable when the
+ * read-ahead data does not need to be decoded. */
+static void
+read_line_buffered (GstRTSPConnection * conn, guint8 * buffer, guint * idx,
+    guint size)
+{
+  const guint8 *data, *end;
+  guint len, n;
+
+  if (!has_read_buffer_data (conn))
+    return;
+
+  data = &conn->read_buffer[conn->read_buffer_offset];
+  len = conn->read_buffer_size - conn->read_buffer_offset;
+
+  /* memchr() is much faster than looking at each byte */
+  end = memchr (data, '\n', len);
+  if (end)
+    len = end - data;
+  end = memchr (data, '\r', len);
+  if (end)
+    len = end - data;
+
+  n = *idx < size - 1 ? MIN (len, size - 1 - *idx) : 0;
+  memcpy (&buffer[*idx], data, n);
+  *idx += n;
+
+  consume_read_buffer (conn, len);
+}
+
 /* The code below tries to handle clients using \r, \n or \r\n to indicate the
  * end of a line. It even does its best to handle clients which mix them (even
  * though this is a really stupid idea (tm).) It also handles Line White Space
@@ -1561,6 +1652,10 @@ read_line (GstRTSPConnection * conn, guint8 * buffer, guint * idx, guint size,
       c = (guint8) conn->read_ahead;
       conn->read_ahead = 0;
     } else {
+      /* take the rest of the line from what was read already */
+      if (conn->ctxp == NULL)
+        read_line_buffered (conn, buffer, idx, size);
+
       /* read the next character */
       i = 0;
       res = read_bytes (conn, &c, &i, 1, block);
@@ -2016,66 +2111,76 @@ gst_rtsp_connection_send_messages_usec (GstRTSPConnection * conn,
     }
   }
 
-  vectors = g_newa (GOutputVector, n_vectors);
-  map_infos = n_memories ? g_newa (GstMapInfo, n_memories) : NULL;
+  n_vectors = MIN (n_vectors, MAX_WRITE_VECTORS);
+  vectors = g_new (GOutputVector, n_vectors);
+  map_infos = n_memories ? g_new (GstMapInfo, MIN (n_memories, n_vectors)) :
+      NULL;
+
+  /* write request: this is synchronous */
+  set_write_socket_timeout (conn, timeout);
+
+  /* write as many messages as fit into MAX_WRITE_VECTORS at once */
+  res = GST_RTSP_OK;
+  for (i = 0; i < n_messages && res == GST_RTSP_OK;) {
+    for (j = 0, k = 0, bytes_to_write = 0; i < n_messages; i++) {
+      guint msg_vectors = 1;
+
+      if (serialized_messages[i].body_data)
+        msg_vectors++;
+      else if (serialized_messages[i].body_buffer)
+        msg_vectors += gst_buffer_n_memory (serialized_messages[i].body_buffer);
 
-  for (i = 0, j = 0, k = 0; i < n_messages; i++) {
-    vectors[j].buffer = serialized_messages[i].data_is_data_header ?
-        serialized_messages[i].data_header : serialized_messages[i].data;
-    vectors[j].size = serialized_messages[i].data_size;
-    bytes_to_write += vectors[j].size;
-    j++;
+      if (j > 0 && j + msg_vectors > n_vectors)
+        break;
 
-    if (serialized_messages[i].body_data) {
-      vectors[j].buffer = serialized_messages[i].body_data;
-      vectors[j].size = serialized_messages[i].body_data_size;
+      vectors[j].buffer = serialized_messages[i].data_is_data_header ?
+          serialized_messages[i].data_header : serialized_messages[i].data;
+      vectors[j].size = serialized_messages[i].data_size;
       bytes_to_write += vectors[j].size;
       j++;
-    } else if (serialized_messages[i].body_buffer) {
-      gint l, n;
-
-      n = gst_buffer_n_memory (serialized_messages[i].body_buffer);
-      for (l = 0; l < n; l++) {
-        GstMemory *mem =
-            gst_buffer_peek_memory (serialized_messages[i].body_buffer, l);
 
-        gst_memory_map (mem, &map_infos[k], GST_MAP_READ);
-        vectors[j].buffer = map_infos[k].data;
-        vectors[j].size = map_infos[k].size;
+      if (serialized_messages[i].body_data) {
+        vectors[j].buffer = serialized_messages[i].body_data;
+        vectors[j].size = serialized_messages[i].body_data_size;
         bytes_to_write += vectors[j].size;
-
-        k++;
         j++;
-      }
-    }
-  }
-
-  /* write request: this is synchronous */
-  set_write_socket_timeout (conn, timeout);
+      } else if (serialized_messages[i].body_buffer) {
+        gint l, n;
 
-  res =
-      writev_bytes (conn->output_stream, vectors, n_vectors, &bytes_written,
-      TRUE, conn->cancellable);
+        n = gst_buffer_n_memory (serialized_messages[i].body_buffer);
+        for (l = 0; l < n; l++) {
+          GstMemory *mem =
+              gst_buffer_peek_memory (serialized_messages[i].body_buffer, l);
 
-  clear_write_socket_timeout (conn);
+          gst_memory_map (mem, &map_infos[k], GST_MAP_READ);
+          vectors[j].buffer = map_infos[k].data;
+          vectors[j].size = map_infos[k].size;
+          bytes_to_write += vectors[j].size;
 
-  g_assert (bytes_written == bytes_to_write || res != GST_RTSP_OK);
+          k++;
+          j++;
+        }
+      }
+    }
 
-  /* free everything */
-  for (i = 0, k = 0; i < n_messages; i++) {
-    if (serialized_messages[i].body_buffer) {
-      gint l, n;
+    res =
+        writev_bytes (conn->output_stream, vectors, j, &bytes_written,
+        TRUE, conn->cancellable);
 
-      n = gst_buffer_n_memory (serialized_messages[i].body_buffer);
-      for (l = 0; l < n; l++) {
-        GstMemory *mem =
-            gst_buffer_peek_memory (serialized_messages[i].body_buffer, l);
+    g_assert (bytes_written == bytes_to_write || res != GST_RTSP_OK);
 
-        gst_memory_unmap (mem, &map_infos[k]);
-        k++;
-      }
+    while (k > 0) {
+      k--;
+      gst_memory_unmap (map_infos[k].memory, &map_infos[k]);
     }
+  }
+
+  clear_write_socket_timeout (conn);
 
+  /* free everything */
+  g_free (vectors);
+  g_free (map_infos);
+  for (i = 0; i < n_messages; i++) {
     g_free (serialized_messages[i].data);
   }
 
@@ -2892,6 +2997,9 @@ gst_rtsp_connection_close (GstRTSPConnection * conn)
   conn->initial_buffer = NULL;
   conn->initial_buffer_offset = 0;
 
+  conn->read_buffer_offset = 0;
+  conn->read_buffer_size = 0;
+
   conn->write_socket = NULL;
   conn->read_socket = NULL;
   conn->write_socket_used = FALSE;
@@ -2943,6 +3051,7 @@ gst_rtsp_connection_free (GstRTSPConnection * conn)
   g_timer_destroy (conn->timer);
   gst_rtsp_url_free (conn->url);
   g_free (conn->proxy_host);
+  g_free (conn->read_buffer);
   g_free (conn);
 
   return res;
@@ -2982,6 +3091,17 @@ gst_rtsp_connection_poll_usec (GstRTSPConnection * conn, GstRTSPEvent events,
   g_return_val_if_fail (conn->read_socket != NULL, GST_RTSP_EINVAL);
   g_return_val_if_fail (conn->write_socket != NULL, GST_RTSP_EINVAL);
 
+  /* data that was read ahead can be received without waiting */
+  if ((events & GST_RTSP_EV_READ) && has_read_buffer_data (conn)) {
+    *revents = GST_RTSP_EV_READ;
+    if (events & GST_RTSP_EV_WRITE) {
+      condition = g_socket_condition_check (conn->write_socket, G_IO_OUT);
+      if ((condition & G_IO_OUT))
+        *revents |= GST_RTSP_EV_WRITE;
+    }
+    return GST_RTSP_OK;
+  }
+
   ctx = g_main_context_new ();
 
   /* configure timeout if any */
@@ -3620,6 +3740,14 @@ gst_rtsp_connection_do_tunnel (GstRTSPConnection * conn,
       conn->input_stream = conn2->input_stream;
       conn->control_stream = g_io_stream_get_input_stream (conn->stream0);
       conn2->output_stream = NULL;
+
+      /* and what was already read from it */
+      g_free (conn->read_buffer);
+      conn->read_buffer = conn2->read_buffer;
+      conn->read_buffer_offset = conn2->read_buffer_offset;
+      conn->read_buffer_size = conn2->read_buffer_size;
+      conn2->read_buffer = NULL;
+      conn2->read_buffer_offset = conn2->read_buffer_size = 0;
     } else {
       /* conn2 is the HTTP GET channel. take its socket and set it as write
        * socket in conn */
@@ -3733,6 +3861,11 @@ struct _GstRTSPWatch
   GCond queue_not_full;
   gboolean flushing;
 
+  /* reused for writing the queued messages */
+  GOutputVector *write_vectors;
+  GstMapInfo *write_map_infos;
+  guint write_vectors_size;
+
   GstRTSPWatchFuncs funcs;
 
   gpointer user_data;
@@ -3747,7 +3880,10 @@ gst_rtsp_source_prepare (GSource * source, gint * timeout)
 {
   GstRTSPWatch *watch = (GstRTSPWatch *) source;
 
-  if (watch->conn->initial_buffer != NULL)
+  /* dispatch without waiting for the socket if there is data left that was
+   * read already, e.g. the next of several messages received at once */
+  if (watch->conn->initial_buffer != NULL
+      || has_read_buffer_data (watch->conn))
     return TRUE;
 
   *timeout = (watch->conn->timeout * 1000);
@@ -3971,13 +4107,29 @@ gst_rtsp_source_dispatch (GSource * source, GSourceFunc callback G_GNUC_UNUSED,
   GstRTSPWatch *watch = (GstRTSPWatch *) source;
   GstRTSPConnection *conn = watch->conn;
 
-  if (conn->initial_buffer != NULL) {
+  if (conn->initial_buffer != NULL || has_read_buffer_data (conn)) {
     gst_rtsp_source_dispatch_read (G_POLLABLE_INPUT_STREAM (conn->input_stream),
         watch);
   }
   return watch->keep_running;
 }
 
+/* makes sure there is space for writing @n_vectors vectors, which is also
+ * enough for the mappings of their memories. Must be called with the watch
+ * lock */
+static void
+ensure_write_vectors (GstRTSPWatch * watch, guint n_vectors)
+{
+  if (n_vectors <= watch->write_vectors_size)
+    return;
+
+  watch->write_vectors =
+      g_renew (GOutputVector, watch->write_vectors, n_vectors);
+  watch->write_map_infos =
+      g_renew (GstMapInfo, watch->write_map_infos, n_vectors);
+  watch->write_vectors_size = n_vectors;
+}
+
 static gboolean
 gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
     GstRTSPWatch * watch)
@@ -4035,16 +4187,18 @@ gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
       break;
     }
 
+    /* write as many messages as fit into MAX_WRITE_VECTORS at once, the
+     * remaining ones are written in the next iteration */
     for (i = 0, n_vectors = 0, n_memories = 0, n_ids = 0; i < n_messages; i++) {
+      guint msg_vectors = 0, msg_memories = 0;
+
       msg = gst_queue_array_peek_nth_struct (watch->messages, i);
-      if (msg->id != 0)
-        n_ids++;
 
       if (msg->data_offset < msg->data_size)
-        n_vectors++;
+        msg_vectors++;
 
       if (msg->body_data && msg->body_offset < msg->body_data_size) {
-        n_vectors++;
+        msg_vectors++;
       } else if (msg->body_buffer) {
         guint m, n;
         guint offset = 0;
@@ -4060,14 +4214,24 @@ gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
           }
           offset += mem->size;
 
-          n_memories++;
-          n_vectors++;
+          msg_memories++;
+          msg_vectors++;
         }
       }
+
+      if (i > 0 && n_vectors + msg_vectors > MAX_WRITE_VECTORS)
+        break;
+
+      n_vectors += msg_vectors;
+      n_memories += msg_memories;
+      if (msg->id != 0)
+        n_ids++;
     }
+    n_messages = i;
 
-    vectors = g_newa (GOutputVector, n_vectors);
-    map_infos = n_memories ? g_newa (GstMapInfo, n_memories) : NULL;
+    ensure_write_vectors (watch, n_vectors);
+    vectors = watch->write_vectors;
+    map_infos = watch->write_map_infos;
     ids = n_ids ? g_newa (guint, n_ids + 1) : NULL;
     if (ids)
       memset (ids, 0, sizeof (guint) * (n_ids + 1));
@@ -4138,9 +4302,11 @@ gst_rtsp_source_dispatch_write (GPollableOutputStream * stream,
     }
 
     if (bytes_written == bytes_to_write) {
-      /* fast path, just unmap all memories, free memory, drop all messages and notify them */
+      /* fast path, just unmap all memories, free memory, drop all written
+       * messages and notify them */
       l = 0;
-      while ((msg = gst_queue_array_pop_head_struct (watch->messages))) {
+      for (i = 0; i < n_messages; i++) {
+        msg = gst_queue_array_pop_head_struct (watch->messages);
         if (msg->id) {
           ids[l] = msg->id;
           l++;
@@ -4283,6 +4449,9 @@ gst_rtsp_source_finalize (GSource * source)
   watch->messages_bytes = 0;
   watch->messages_count = 0;
 
+  g_free (watch->write_vectors);
+  g_free (watch->write_map_infos);
+
   g_cond_clear (&watch->queue_not_full);
 
   if (watch->readsrc)
@@ -4499,6 +4668,33 @@ gst_rtsp_watch_get_send_backlog (GstRTSPWatch * watch,
   g_mutex_unlock (&watch->mutex);
 }
 
+/**
+ * gst_rtsp_watch_get_send_backlog_level:
+ * @watch: a #GstRTSPWatch
+ * @bytes: (out) (allow-none): queued bytes
+ * @messages: (out) (allow-none): queued messages
+ *
+ * Get the amount of bytes and messages currently queued in @watch that were
+ * not written to the connection yet. These are the values compared against
+ * the limits set with gst_rtsp_watch_set_send_backlog(), messages sent
+ * together with gst_rtsp_watch_send_messages() count as one.
+ *
+ * Since: 1.20
+ */
+void
+gst_rtsp_watch_get_send_backlog_level (GstRTSPWatch * watch,
+    gsize * bytes, guint * messages)
+{
+  g_return_if_fail (watch != NULL);
+
+  g_mutex_lock (&watch->mutex);
+  if (bytes)
+    *bytes = watch->messages_bytes;
+  if (messages)
+    *messages = watch->messages_count;
+  g_mutex_unlock (&watch->mutex);
+}
+
 static GstRTSPResult
 gst_rtsp_watch_write_serialized_messages (GstRTSPWatch * watch,
     GstRTSPSerializedMessage * messages, guint n_messages, guint * id)
@@ -4514,28 +4710,39 @@ gst_rtsp_watch_write_serialized_messages (GstRTSPWatch * watch,
   if (watch->flushing)
     goto flushing;
 
-  /* try to send the message synchronously first */
+  /* try to send the messages synchronously first. Only as many messages as
+   * fit into MAX_WRITE_VECTORS are written at once, the remaining ones are
+   * queued and written in chunks from the write source */
   if (gst_queue_array_get_length (watch->messages) == 0) {
     gint j, k;
     GOutputVector *vectors;
     GstMapInfo *map_infos;
     gsize bytes_to_write, bytes_written;
-    guint n_vectors, n_memories, drop_messages;
+    guint n_vectors, n_memories, n_sync, drop_messages;
 
-    for (i = 0, n_vectors = 0, n_memories = 0; i < n_messages; i++) {
-      n_vectors++;
-      if (messages[i].body_data) {
-        n_vectors++;
-      } else if (messages[i].body_buffer) {
-        n_vectors += gst_buffer_n_memory (messages[i].body_buffer);
-        n_memories += gst_buffer_n_memory (messages[i].body_buffer);
+    for (n_sync = 0, n_vectors = 0, n_memories = 0; n_sync < n_messages;
+        n_sync++) {
+      guint msg_vectors = 1, msg_memories = 0;
+
+      if (messages[n_sync].body_data) {
+        msg_vectors++;
+      } else if (messages[n_sync].body_buffer) {
+        msg_memories = gst_buffer_n_memory (messages[n_sync].body_buffer);
+        msg_vectors += msg_memories;
       }
+
+      if (n_sync > 0 && n_vectors + msg_vectors > MAX_WRITE_VECTORS)
+        break;
+
+      n_vectors += msg_vectors;
+      n_memories += msg_memories;
     }
 
-    vectors = g_newa (GOutputVector, n_vectors);
-    map_infos = n_memories ? g_newa (GstMapInfo, n_memories) : NULL;
+    ensure_write_vectors (watch, n_vectors);
+    vectors = watch->write_vectors;
+    map_infos = watch->write_map_infos;
 
-    for (i = 0, j = 0, k = 0, bytes_to_write = 0; i < n_messages; i++) {
+    for (i = 0, j = 0, k = 0, bytes_to_write = 0; i < n_sync; i++) {
       vectors[j].buffer = messages[i].data_is_data_header ?
           messages[i].data_header : messages[i].data;
       vectors[j].size = messages[i].data_size;
@@ -4578,7 +4785,8 @@ gst_rtsp_watch_write_serialized_messages (GstRTSPWatch * watch,
       gst_memory_unmap (map_infos[k].memory, &map_infos[k]);
     }
 
-    if (res != GST_RTSP_EINTR) {
+    if (res != GST_RTSP_EINTR && (res != GST_RTSP_OK
+            || n_sync == n_messages)) {
       /* actual error or done completely */
       if (id != NULL)
         *id = 0;
@@ -4591,8 +4799,9 @@ gst_rtsp_watch_write_serialized_messages (GstRTSPWatch * watch,
       goto done;
     }
 
-    /* not done, let's skip all messages that were sent already and free them */
-    for (i = 0, k = 0, drop_messages = 0; i < n_messages; i++) {
+    /* not done, let's skip all messages that were sent already and free them,
+     * the remaining ones are queued below */
+    for (i = 0, k = 0, drop_messages = 0; i < n_sync; i++) {
       if (bytes_written >= messages[i].data_size) {
         guint body_size;
 
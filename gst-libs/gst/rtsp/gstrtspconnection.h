@@ -318,6 +318,10 @@ GST_RTSP_API
 void               gst_rtsp_watch_get_send_backlog  (GstRTSPWatch *watch,
                                                      gsize *bytes, guint *messages);
 
+GST_RTSP_API
+void               gst_rtsp_watch_get_send_backlog_level (GstRTSPWatch *watch,
+                                                          gsize *bytes, guint *messages);
+
 GST_RTSP_API
 GstRTSPResult      gst_rtsp_watch_write_data         (GstRTSPWatch *watch,
                                                       const guint8 *data,
@@ -72,6 +72,15 @@ gst_audio_interleave_pad_get_property (GObject * object, guint prop_id,
   }
 }
 
+static void
+gst_audio_interleave_pad_finalize (GObject * object)
+{
+  GstAudioInterleavePad *pad = GST_AUDIO_INTERLEAVE_PAD (object);
+
+  gst_clear_buffer (&pad->pending);
+
+  G_OBJECT_CLASS (gst_audio_interleave_pad_parent_class)->finalize (object);
+}
 
 static void
 gst_audio_interleave_pad_class_init (GstAudioInterleavePadClass * klass)
@@ -79,6 +88,7 @@ gst_audio_interleave_pad_class_init (GstAudioInterleavePadClass * klass)
   GObjectClass *gobject_class = (GObjectClass *) klass;
 
   gobject_class->get_property = gst_audio_interleave_pad_get_property;
+  gobject_class->finalize = gst_audio_interleave_pad_finalize;
 
   g_object_class_install_property (gobject_class,
       PROP_PAD_CHANNEL,
@@ -131,7 +141,7 @@ GST_STATIC_PAD_TEMPLATE ("src",
         "rate = (int) [ 1, MAX ], "
         "channels = (int) [ 1, MAX ], "
         "format = (string) " GST_AUDIO_FORMATS_ALL ", "
-        "layout = (string) interleaved")
+        "layout = (string) { interleaved, non-interleaved }")
     );
 
 static void gst_audio_interleave_child_proxy_init (gpointer g_iface,
@@ -156,6 +166,10 @@ static void gst_audio_interleave_release_pad (GstElement * element,
     GstPad * pad);
 
 static gboolean gst_audio_interleave_stop (GstAggregator * agg);
+static GstFlowReturn gst_audio_interleave_finish_buffer (GstAggregator * agg,
+    GstBuffer * buffer);
+static GstBuffer *gst_audio_interleave_create_output_buffer (GstAudioAggregator
+    * aagg, guint num_frames);
 
 static gboolean
 gst_audio_interleave_aggregate_one_buffer (GstAudioAggregator * aagg,
@@ -351,9 +365,16 @@ gst_audio_interleave_get_channel_mask (GstAudioInterleave * self)
 static void interleave_##type (guint##type *out, guint##type *in, \
     guint stride, guint nframes) \
 { \
-  gint i; \
+  guint i; \
   \
-  for (i = 0; i < nframes; i++) { \
+  for (i = 0; i + 4 <= nframes; i += 4) { \
+    out[0] = in[i]; \
+    out[stride] = in[i + 1]; \
+    out[2 * stride] = in[i + 2]; \
+    out[3 * stride] = in[i + 3]; \
+    out += 4 * stride; \
+  } \
+  for (; i < nframes; i++) { \
     *out = in[i]; \
     out += stride; \
   } \
@@ -509,6 +530,9 @@ gst_audio_interleave_update_src_caps (GstAggregator * agg, GstCaps * caps,
 {
   GstAudioInterleave *self = GST_AUDIO_INTERLEAVE (agg);
   GstStructure *s;
+  GstCaps *filtered = NULL;
+  GValue layouts = G_VALUE_INIT;
+  GValue layout = G_VALUE_INIT;
 
   /* This means that either no caps have been set on the sink pad (if
    * sinkcaps is NULL) or that there is no sink pad (if channels == 0).
@@ -522,12 +546,38 @@ gst_audio_interleave_update_src_caps (GstAggregator * agg, GstCaps * caps,
   *ret = gst_caps_copy (self->sinkcaps);
   s = gst_caps_get_structure (*ret, 0);
 
-  gst_structure_set (s, "channels", G_TYPE_INT, self->channels, "layout",
-      G_TYPE_STRING, "interleaved", "channel-mask", GST_TYPE_BITMASK,
+  gst_structure_set (s, "channels", G_TYPE_INT, self->channels,
+      "channel-mask", GST_TYPE_BITMASK,
       gst_audio_interleave_get_channel_mask (self), NULL);
 
   GST_OBJECT_UNLOCK (self);
 
+  /* Interleaved output is preferred, but planar output can be produced
+   * without copying the input samples if downstream accepts it */
+  g_value_init (&layouts, GST_TYPE_LIST);
+  g_value_init (&layout, G_TYPE_STRING);
+  g_value_set_static_string (&layout, "interleaved");
+  gst_value_list_append_value (&layouts, &layout);
+  g_value_set_static_string (&layout, "non-interleaved");
+  gst_value_list_append_value (&layouts, &layout);
+  gst_structure_take_value (s, "layout", &layouts);
+
+  if (caps) {
+    filtered = gst_caps_intersect (*ret, caps);
+    if (gst_caps_is_empty (filtered))
+      gst_clear_caps (&filtered);
+  }
+
+  if (filtered) {
+    gst_caps_unref (*ret);
+    *ret = filtered;
+  } else {
+    /* no downstream preference, or downstream accepts neither layout */
+    g_value_set_static_string (&layout, "interleaved");
+    gst_structure_set_value (s, "layout", &layout);
+  }
+  g_value_unset (&layout);
+
   return GST_FLOW_OK;
 }
 
@@ -578,8 +628,11 @@ gst_audio_interleave_class_init (GstAudioInterleaveClass * klass)
   agg_class->stop = gst_audio_interleave_stop;
   agg_class->update_src_caps = gst_audio_interleave_update_src_caps;
   agg_class->negotiated_src_caps = gst_audio_interleave_negotiated_src_caps;
+  agg_class->finish_buffer =
+      GST_DEBUG_FUNCPTR (gst_audio_interleave_finish_buffer);
 
   aagg_class->aggregate_one_buffer = gst_audio_interleave_aggregate_one_buffer;
+  aagg_class->create_output_buffer = gst_audio_interleave_create_output_buffer;
 
   /**
    * GstInterleave:channel-positions
@@ -704,6 +757,22 @@ gst_audio_interleave_get_property (GObject * object, guint prop_id,
   }
 }
 
+static void
+gst_audio_interleave_clear_pending (GstAudioInterleave * self)
+{
+  GList *l;
+
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT_CAST (self)->sinkpads; l != NULL; l = l->next) {
+    GstAudioInterleavePad *pad = GST_AUDIO_INTERLEAVE_PAD (l->data);
+
+    GST_OBJECT_LOCK (pad);
+    gst_clear_buffer (&pad->pending);
+    GST_OBJECT_UNLOCK (pad);
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
 static gboolean
 gst_audio_interleave_stop (GstAggregator * agg)
 {
@@ -713,6 +782,7 @@ gst_audio_interleave_stop (GstAggregator * agg)
     return FALSE;
 
   gst_caps_replace (&self->sinkcaps, NULL);
+  gst_audio_interleave_clear_pending (self);
 
   return TRUE;
 }
@@ -808,6 +878,33 @@ gst_audio_interleave_release_pad (GstElement * element, GstPad * pad)
 }
 
 
+static GstBuffer *
+gst_audio_interleave_create_output_buffer (GstAudioAggregator * aagg,
+    guint num_frames)
+{
+  GstAudioInterleave *self = GST_AUDIO_INTERLEAVE (aagg);
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR (aagg)->srcpad);
+  GstAudioInfo info;
+  GstBuffer *outbuf;
+
+  outbuf =
+      GST_AUDIO_AGGREGATOR_CLASS (parent_class)->create_output_buffer (aagg,
+      num_frames);
+
+  /* leftovers of an output buffer that was never finished */
+  gst_audio_interleave_clear_pending (self);
+
+  GST_OBJECT_LOCK (aagg);
+  info = srcpad->info;
+  GST_OBJECT_UNLOCK (aagg);
+
+  if (GST_AUDIO_INFO_LAYOUT (&info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED)
+    gst_buffer_add_audio_meta (outbuf, &info, num_frames, NULL);
+
+  return outbuf;
+}
+
 /* Called with object lock and pad object lock held */
 static gboolean
 gst_audio_interleave_aggregate_one_buffer (GstAudioAggregator * aagg,
@@ -819,6 +916,9 @@ gst_audio_interleave_aggregate_one_buffer (GstAudioAggregator * aagg,
   GstMapInfo inmap;
   GstMapInfo outmap;
   gint out_width, in_bpf, out_bpf, out_channels, channel;
+  guint out_frames;
+  gboolean planar;
+  GstInterleaveFunc func;
   guint8 *outdata;
   GstAggregator *agg = GST_AGGREGATOR (aagg);
   GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
@@ -830,6 +930,40 @@ gst_audio_interleave_aggregate_one_buffer (GstAudioAggregator * aagg,
   in_bpf = GST_AUDIO_INFO_BPF (&aaggpad->info);
   out_bpf = GST_AUDIO_INFO_BPF (&srcpad->info);
   out_channels = GST_AUDIO_INFO_CHANNELS (&srcpad->info);
+  planar = GST_AUDIO_INFO_LAYOUT (&srcpad->info) ==
+      GST_AUDIO_LAYOUT_NON_INTERLEAVED;
+  out_frames = gst_buffer_get_size (outbuf) / out_bpf;
+
+  if (self->channels > 64) {
+    channel = pad->channel;
+  } else {
+    channel = self->default_channels_ordering_map[pad->channel];
+  }
+  func = self->func;
+
+  if (out_offset == 0 && num_frames == out_frames) {
+    /* This input covers the whole output buffer: only keep a reference to
+     * its memory. For planar output it becomes one of the planes as is, for
+     * interleaved output all channels are interleaved together in a cache
+     * friendly order when the buffer is finished. */
+    GST_LOG_OBJECT (pad, "deferring %u frames on channel %d/%d from offset %u",
+        num_frames, pad->channel, out_channels, in_offset * in_bpf);
+
+    gst_clear_buffer (&pad->pending);
+    pad->pending = gst_buffer_copy_region (inbuf, GST_BUFFER_COPY_MEMORY,
+        in_offset * in_bpf, num_frames * in_bpf);
+    pad->pending_channel = channel;
+
+    GST_OBJECT_UNLOCK (aaggpad);
+    GST_OBJECT_UNLOCK (aagg);
+
+    return TRUE;
+  }
+
+  /* don't hold the locks while interleaving, the aggregator might handle
+   * different parts of the output buffer from multiple threads */
+  GST_OBJECT_UNLOCK (aaggpad);
+  GST_OBJECT_UNLOCK (aagg);
 
   gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
   gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
@@ -837,28 +971,233 @@ gst_audio_interleave_aggregate_one_buffer (GstAudioAggregator * aagg,
       " from offset %u", num_frames, pad->channel, out_channels,
       out_offset * out_bpf, in_offset * in_bpf);
 
-  if (self->channels > 64) {
-    channel = pad->channel;
+  if (planar) {
+    outdata = outmap.data + (channel * out_frames + out_offset) * out_width;
+    memcpy (outdata, inmap.data + (in_offset * in_bpf), num_frames * in_bpf);
   } else {
-    channel = self->default_channels_ordering_map[pad->channel];
+    outdata = outmap.data + (out_offset * out_bpf) + (out_width * channel);
+    func (outdata, inmap.data + (in_offset * in_bpf), out_channels,
+        num_frames);
   }
 
-  outdata = outmap.data + (out_offset * out_bpf) + (out_width * channel);
+  gst_buffer_unmap (inbuf, &inmap);
+  gst_buffer_unmap (outbuf, &outmap);
+
+  return TRUE;
+}
 
+/* Takes the deferred inputs of all pads, indexed by output channel */
+static guint
+gst_audio_interleave_take_pending (GstAudioInterleave * self,
+    GstBuffer ** pending, guint channels)
+{
+  guint n_pending = 0;
+  GList *l;
 
-  self->func (outdata, inmap.data + (in_offset * in_bpf), out_channels,
-      num_frames);
+  GST_OBJECT_LOCK (self);
+  for (l = GST_ELEMENT_CAST (self)->sinkpads; l != NULL; l = l->next) {
+    GstAudioInterleavePad *pad = GST_AUDIO_INTERLEAVE_PAD (l->data);
+    GstBuffer *buffer;
+    guint channel;
+
+    GST_OBJECT_LOCK (pad);
+    buffer = g_steal_pointer (&pad->pending);
+    channel = pad->pending_channel;
+    GST_OBJECT_UNLOCK (pad);
+
+    if (buffer == NULL)
+      continue;
+
+    /* channels were renumbered in the meantime */
+    if (channel >= channels || pending[channel] != NULL) {
+      GST_WARNING_OBJECT (pad, "dropping input for invalid channel %u",
+          channel);
+      gst_buffer_unref (buffer);
+      continue;
+    }
 
+    pending[channel] = buffer;
+    n_pending++;
+  }
+  GST_OBJECT_UNLOCK (self);
 
-  gst_buffer_unmap (inbuf, &inmap);
-  gst_buffer_unmap (outbuf, &outmap);
+  return n_pending;
+}
 
-  GST_OBJECT_UNLOCK (aaggpad);
-  GST_OBJECT_UNLOCK (aagg);
+/* Number of output frames per block so that one block of the output buffer
+ * stays in the L1 cache while all channels are written into it */
+#define INTERLEAVE_BLOCK_BYTES 16384
 
-  return TRUE;
+static void
+gst_audio_interleave_finish_interleaved (GstAudioInterleave * self,
+    const GstAudioInfo * info, GstBuffer * buffer, GstBuffer ** pending)
+{
+  gint width = GST_AUDIO_INFO_WIDTH (info) / 8;
+  gint bpf = GST_AUDIO_INFO_BPF (info);
+  guint channels = GST_AUDIO_INFO_CHANNELS (info);
+  guint block_frames = MAX (16, INTERLEAVE_BLOCK_BYTES / bpf);
+  GstInterleaveFunc func;
+  GstMapInfo outmap;
+  GstMapInfo *inmaps;
+  guint nframes, start, c;
+
+  GST_OBJECT_LOCK (self);
+  func = self->func;
+  GST_OBJECT_UNLOCK (self);
+
+  inmaps = g_new0 (GstMapInfo, channels);
+  gst_buffer_map (buffer, &outmap, GST_MAP_READWRITE);
+  nframes = outmap.size / bpf;
+
+  for (c = 0; c < channels; c++) {
+    if (pending[c])
+      gst_buffer_map (pending[c], &inmaps[c], GST_MAP_READ);
+  }
+
+  for (start = 0; start < nframes; start += block_frames) {
+    guint len = MIN (block_frames, nframes - start);
+
+    for (c = 0; c < channels; c++) {
+      if (!pending[c])
+        continue;
+
+      func (outmap.data + start * bpf + c * width,
+          inmaps[c].data + start * width, channels, len);
+    }
+  }
+
+  for (c = 0; c < channels; c++) {
+    if (pending[c])
+      gst_buffer_unmap (pending[c], &inmaps[c]);
+  }
+
+  gst_buffer_unmap (buffer, &outmap);
+  g_free (inmaps);
+}
+
+static GstBuffer *
+gst_audio_interleave_finish_planar (GstAudioInterleave * self,
+    const GstAudioInfo * info, GstBuffer * buffer, GstBuffer ** pending,
+    guint n_pending)
+{
+  gint width = GST_AUDIO_INFO_WIDTH (info) / 8;
+  gint bpf = GST_AUDIO_INFO_BPF (info);
+  guint channels = GST_AUDIO_INFO_CHANNELS (info);
+  GstAudioMeta *meta;
+  gsize plane_size, full_plane_size;
+  guint n_mems = 0, c;
+  GstBuffer *outbuf;
+
+  meta = gst_buffer_get_audio_meta (buffer);
+  if (meta == NULL) {
+    GST_WARNING_OBJECT (self, "output buffer without audio meta");
+    return buffer;
+  }
+
+  /* the buffer is truncated at EOS, which cuts into the planes */
+  full_plane_size = meta->samples * width;
+  plane_size = (gst_buffer_get_size (buffer) / bpf) * width;
+
+  if (n_pending == 0 && plane_size == full_plane_size)
+    return buffer;
+
+  if (plane_size < full_plane_size)
+    gst_buffer_resize (buffer, 0, full_plane_size * channels);
+
+  for (c = 0; c < channels; c++) {
+    if (pending[c]) {
+      n_mems += gst_buffer_n_memory (pending[c]);
+    } else {
+      n_mems++;
+      /* neighbouring silent planes are contiguous in the output buffer */
+      while (plane_size == full_plane_size && c + 1 < channels
+          && !pending[c + 1])
+        c++;
+    }
+  }
+
+  if (n_mems > gst_buffer_get_max_memory ()) {
+    GstMapInfo map;
+
+    /* More planes than a buffer can hold without merging them, copy into
+     * the output buffer instead */
+    gst_buffer_map (buffer, &map, GST_MAP_READWRITE);
+    for (c = 0; c < channels; c++) {
+      if (pending[c])
+        gst_buffer_extract (pending[c], 0, map.data + c * full_plane_size,
+            plane_size);
+      if (plane_size < full_plane_size && c > 0)
+        memmove (map.data + c * plane_size, map.data + c * full_plane_size,
+            plane_size);
+    }
+    gst_buffer_unmap (buffer, &map);
+
+    if (plane_size == full_plane_size)
+      return buffer;
+
+    gst_buffer_resize (buffer, 0, plane_size * channels);
+    gst_buffer_remove_meta (buffer, (GstMeta *) meta);
+    gst_buffer_add_audio_meta (buffer, info, plane_size / width, NULL);
+
+    return buffer;
+  }
+
+  outbuf = gst_buffer_new ();
+  gst_buffer_copy_into (outbuf, buffer,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  for (c = 0; c < channels; c++) {
+    guint first = c;
+
+    if (pending[c]) {
+      gst_buffer_copy_into (outbuf, pending[c], GST_BUFFER_COPY_MEMORY, 0,
+          plane_size);
+      continue;
+    }
+
+    while (plane_size == full_plane_size && c + 1 < channels
+        && !pending[c + 1])
+      c++;
+
+    gst_buffer_copy_into (outbuf, buffer, GST_BUFFER_COPY_MEMORY,
+        first * full_plane_size, (c - first + 1) * plane_size);
+  }
+
+  gst_buffer_add_audio_meta (outbuf, info, plane_size / width, NULL);
+  gst_buffer_unref (buffer);
+
+  return outbuf;
 }
 
+static GstFlowReturn
+gst_audio_interleave_finish_buffer (GstAggregator * agg, GstBuffer * buffer)
+{
+  GstAudioInterleave *self = GST_AUDIO_INTERLEAVE (agg);
+  GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+  GstAudioInfo info;
+  GstBuffer **pending;
+  guint n_pending, c;
+
+  GST_OBJECT_LOCK (agg);
+  info = srcpad->info;
+  GST_OBJECT_UNLOCK (agg);
+
+  pending = g_new0 (GstBuffer *, GST_AUDIO_INFO_CHANNELS (&info));
+  n_pending = gst_audio_interleave_take_pending (self, pending,
+      GST_AUDIO_INFO_CHANNELS (&info));
+
+  if (GST_AUDIO_INFO_LAYOUT (&info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED)
+    buffer = gst_audio_interleave_finish_planar (self, &info, buffer, pending,
+        n_pending);
+  else if (n_pending > 0)
+    gst_audio_interleave_finish_interleaved (self, &info, buffer, pending);
+
+  for (c = 0; c < GST_AUDIO_INFO_CHANNELS (&info); c++)
+    gst_clear_buffer (&pending[c]);
+  g_free (pending);
+
+  return GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+}
 
 /* GstChildProxy implementation */
 static GObject *
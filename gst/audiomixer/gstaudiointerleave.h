@@ -69,6 +69,11 @@ struct _GstAudioInterleavePad {
   GstAudioAggregatorPad parent;
 
   guint channel;
+
+  /* input covering the whole current output buffer, placed into the
+   * output in finish_buffer; object lock */
+  GstBuffer *pending;
+  guint pending_channel;
 };
 
 G_END_DECLS
@@ -49,17 +49,37 @@
  * * "mute": Whether to mute the pad or not (#gboolean)
  * * "volume": The volume of the pad, between 0.0 and 10.0 (#gdouble)
  *
+ * For conferencing use cases, "minus_%u" source pads can be requested in
+ * addition to the always source pad. Each of them outputs the mix of all
+ * inputs except the one of the sink pad with the same index ("N-1" or
+ * "mix-minus" output), so that every participant can receive everything but
+ * its own input. All mix-minus outputs are derived from a single sum of all
+ * inputs, which makes the cost of each additional output linear in the
+ * number of samples instead of the number of inputs. (Since: 1.20)
+ *
  * ## Example launch line
  * |[
  * gst-launch-1.0 audiotestsrc freq=100 ! audiomixer name=mix ! audioconvert ! alsasink audiotestsrc freq=500 ! mix.
  * ]| This pipeline produces two sine waves mixed together.
  *
+ * |[
+ * gst-launch-1.0 audiomixer name=mix \
+ *     audiotestsrc freq=100 ! mix.sink_0  audiotestsrc freq=500 ! mix.sink_1 \
+ *     mix.src ! audioconvert ! autoaudiosink \
+ *     mix.minus_0 ! audioconvert ! autoaudiosink
+ * ]| This pipeline plays the mix of both sine waves, and separately only the
+ * 500Hz sine wave, which is the mix without the input of sink_0.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
 #include "gstaudiomixerelements.h"
 #include "gstaudiomixerorc.h"
 
@@ -137,6 +157,16 @@ gst_audiomixer_pad_set_property (GObject * object, guint prop_id,
   }
 }
 
+static void
+gst_audiomixer_pad_finalize (GObject * object)
+{
+  GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (object);
+
+  g_free (pad->minus_contrib);
+
+  G_OBJECT_CLASS (gst_audiomixer_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
 {
@@ -144,6 +174,7 @@ gst_audiomixer_pad_class_init (GstAudioMixerPadClass * klass)
 
   gobject_class->set_property = gst_audiomixer_pad_set_property;
   gobject_class->get_property = gst_audiomixer_pad_get_property;
+  gobject_class->finalize = gst_audiomixer_pad_finalize;
 
   g_object_class_install_property (gobject_class, PROP_PAD_VOLUME,
       g_param_spec_double ("volume", "Volume", "Volume of this pad",
@@ -186,6 +217,13 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_STATIC_CAPS (CAPS)
     );
 
+static GstStaticPadTemplate gst_audiomixer_minus_template =
+GST_STATIC_PAD_TEMPLATE ("minus_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (CAPS)
+    );
+
 #define SINK_CAPS \
   GST_STATIC_CAPS (GST_AUDIO_CAPS_MAKE (GST_AUDIO_FORMATS_ALL) \
       ", layout=interleaved")
@@ -212,16 +250,34 @@ static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
     GstAudioAggregatorPad * aaggpad, GstBuffer * inbuf, guint in_offset,
     GstBuffer * outbuf, guint out_offset, guint num_samples);
+static GstBuffer *gst_audiomixer_create_output_buffer (GstAudioAggregator *
+    aagg, guint num_frames);
+static GstFlowReturn gst_audiomixer_finish_buffer (GstAggregator * agg,
+    GstBuffer * buffer);
+static void gst_audiomixer_finalize (GObject * object);
+
+typedef struct
+{
+  GstPad *srcpad;
+  /* sink pad whose input is left out, or %NULL */
+  GstAudioMixerPad *sinkpad;
+} GstAudioMixerMinusOutput;
 
 
 static void
 gst_audiomixer_class_init (GstAudioMixerClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
   GstElementClass *gstelement_class = (GstElementClass *) klass;
+  GstAggregatorClass *agg_class = (GstAggregatorClass *) klass;
   GstAudioAggregatorClass *aagg_class = (GstAudioAggregatorClass *) klass;
 
+  gobject_class->finalize = gst_audiomixer_finalize;
+
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_src_template, GST_TYPE_AUDIO_AGGREGATOR_CONVERT_PAD);
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &gst_audiomixer_minus_template);
   gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
       &gst_audiomixer_sink_template, GST_TYPE_AUDIO_MIXER_PAD);
   gst_element_class_set_static_metadata (gstelement_class, "AudioMixer",
@@ -233,14 +289,159 @@ gst_audiomixer_class_init (GstAudioMixerClass * klass)
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (gst_audiomixer_release_pad);
 
+  agg_class->finish_buffer = GST_DEBUG_FUNCPTR (gst_audiomixer_finish_buffer);
+
   aagg_class->aggregate_one_buffer = gst_audiomixer_aggregate_one_buffer;
+  aagg_class->create_output_buffer = gst_audiomixer_create_output_buffer;
 
   gst_type_mark_as_plugin_api (GST_TYPE_AUDIO_MIXER_PAD, 0);
 }
 
+static void
+gst_audiomixer_clear_minus_output (GstAudioMixerMinusOutput * output)
+{
+  gst_clear_object (&output->srcpad);
+  gst_clear_object (&output->sinkpad);
+}
+
+static GstEvent *
+gst_audiomixer_minus_pad_event (GstPad * pad, GstEvent * event)
+{
+  /* every mix-minus pad is a separate stream */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_STREAM_START) {
+    GstEvent *new_event;
+    const gchar *stream_id;
+    gchar *new_stream_id;
+    guint group_id;
+
+    gst_event_parse_stream_start (event, &stream_id);
+    new_stream_id = g_strdup_printf ("%s/%s", stream_id, GST_PAD_NAME (pad));
+    new_event = gst_event_new_stream_start (new_stream_id);
+    if (gst_event_parse_group_id (event, &group_id))
+      gst_event_set_group_id (new_event, group_id);
+    g_free (new_stream_id);
+
+    return new_event;
+  }
+
+  return gst_event_ref (event);
+}
+
+static gboolean
+copy_sticky_events (GstPad * srcpad, GstEvent ** event, gpointer user_data)
+{
+  GstPad *pad = user_data;
+  GstEvent *new_event;
+
+  new_event = gst_audiomixer_minus_pad_event (pad, *event);
+  gst_pad_store_sticky_event (pad, new_event);
+  gst_event_unref (new_event);
+
+  return TRUE;
+}
+
+/* Forwards all events of the always source pad to the mix-minus pads */
+static GstPadProbeReturn
+gst_audiomixer_src_event_probe (GstPad * srcpad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (user_data);
+  GstEvent *event = GST_PAD_PROBE_INFO_EVENT (info);
+  GList *pads, *l;
+
+  GST_OBJECT_LOCK (audiomixer);
+  pads = g_list_copy_deep (audiomixer->minus_pads, (GCopyFunc) gst_object_ref,
+      NULL);
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  for (l = pads; l; l = l->next) {
+    GstPad *pad = l->data;
+
+    gst_pad_push_event (pad, gst_audiomixer_minus_pad_event (pad, event));
+  }
+  g_list_free_full (pads, gst_object_unref);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+gst_audiomixer_minus_pad_query (GstPad * pad, GstObject * parent,
+    GstQuery * query)
+{
+  /* answer like the always source pad, all source pads produce the same
+   * format with the same latency */
+  return gst_pad_query (GST_AGGREGATOR (parent)->srcpad, query);
+}
+
+static gboolean
+gst_audiomixer_minus_pad_event_func (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK)
+    return gst_pad_send_event (GST_AGGREGATOR (parent)->srcpad, event);
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
 static void
 gst_audiomixer_init (GstAudioMixer * audiomixer)
 {
+  audiomixer->minus_outputs =
+      g_array_new (FALSE, FALSE, sizeof (GstAudioMixerMinusOutput));
+  g_array_set_clear_func (audiomixer->minus_outputs,
+      (GDestroyNotify) gst_audiomixer_clear_minus_output);
+
+  gst_pad_add_probe (GST_AGGREGATOR (audiomixer)->srcpad,
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+      gst_audiomixer_src_event_probe, audiomixer, NULL);
+}
+
+static void
+gst_audiomixer_finalize (GObject * object)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (object);
+
+  g_array_unref (audiomixer->minus_outputs);
+  g_free (audiomixer->minus_sum);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static GstPad *
+gst_audiomixer_request_minus_pad (GstAudioMixer * audiomixer,
+    GstPadTemplate * templ, const gchar * req_name)
+{
+  GstPad *pad;
+  guint index;
+
+  if (req_name == NULL || sscanf (req_name, "minus_%u", &index) != 1) {
+    GST_WARNING_OBJECT (audiomixer, "mix-minus pads must be requested by "
+        "name, e.g. minus_0 for the mix without the input of sink_0");
+    return NULL;
+  }
+
+  pad = gst_pad_new_from_template (templ, req_name);
+  gst_pad_set_query_function (pad,
+      GST_DEBUG_FUNCPTR (gst_audiomixer_minus_pad_query));
+  gst_pad_set_event_function (pad,
+      GST_DEBUG_FUNCPTR (gst_audiomixer_minus_pad_event_func));
+
+  gst_pad_sticky_events_foreach (GST_AGGREGATOR (audiomixer)->srcpad,
+      copy_sticky_events, pad);
+
+  if (!gst_element_add_pad (GST_ELEMENT_CAST (audiomixer), pad)) {
+    GST_DEBUG_OBJECT (audiomixer, "could not add pad %s", req_name);
+    return NULL;
+  }
+
+  GST_OBJECT_LOCK (audiomixer);
+  audiomixer->minus_pads =
+      g_list_append (audiomixer->minus_pads, gst_object_ref (pad));
+  GST_OBJECT_UNLOCK (audiomixer);
+
+  GST_DEBUG_OBJECT (audiomixer, "added mix-minus pad %s", req_name);
+
+  return pad;
 }
 
 static GstPad *
@@ -249,6 +450,10 @@ gst_audiomixer_request_new_pad (GstElement * element, GstPadTemplate * templ,
 {
   GstAudioMixerPad *newpad;
 
+  if (GST_PAD_TEMPLATE_DIRECTION (templ) == GST_PAD_SRC)
+    return gst_audiomixer_request_minus_pad (GST_AUDIO_MIXER (element), templ,
+        req_name);
+
   newpad = (GstAudioMixerPad *)
       GST_ELEMENT_CLASS (parent_class)->request_new_pad (element,
       templ, req_name, caps);
@@ -277,12 +482,137 @@ gst_audiomixer_release_pad (GstElement * element, GstPad * pad)
 
   GST_DEBUG_OBJECT (audiomixer, "release pad %s:%s", GST_DEBUG_PAD_NAME (pad));
 
+  if (GST_PAD_DIRECTION (pad) == GST_PAD_SRC) {
+    GList *l;
+
+    GST_OBJECT_LOCK (audiomixer);
+    l = g_list_find (audiomixer->minus_pads, pad);
+    if (l) {
+      audiomixer->minus_pads = g_list_delete_link (audiomixer->minus_pads, l);
+      gst_object_unref (pad);
+    }
+    GST_OBJECT_UNLOCK (audiomixer);
+
+    gst_pad_set_active (pad, FALSE);
+    gst_element_remove_pad (element, pad);
+    return;
+  }
+
   gst_child_proxy_child_removed (GST_CHILD_PROXY (audiomixer), G_OBJECT (pad),
       GST_OBJECT_NAME (pad));
 
   GST_ELEMENT_CLASS (parent_class)->release_pad (element, pad);
 }
 
+/* Mix-minus outputs are computed from the unclipped sum of all inputs,
+ * from which the contribution of a single pad is subtracted before clipping
+ * to the range of the output format */
+#define ACCUMULATE(type, offset) G_STMT_START {                   \
+  const type *in = data;                                          \
+  if (contrib) {                                                  \
+    for (i = 0; i < n_samples; i++) {                             \
+      gdouble v = ((gdouble) in[i] - (offset)) * volume;          \
+      sum[i] += v;                                                \
+      contrib[i] += v;                                            \
+    }                                                             \
+  } else {                                                        \
+    for (i = 0; i < n_samples; i++)                               \
+      sum[i] += ((gdouble) in[i] - (offset)) * volume;            \
+  }                                                               \
+} G_STMT_END
+
+static void
+gst_audiomixer_accumulate (GstAudioFormat format, gconstpointer data,
+    gdouble volume, gdouble * sum, gdouble * contrib, guint n_samples)
+{
+  guint i;
+
+  switch (format) {
+    case GST_AUDIO_FORMAT_U8:
+      ACCUMULATE (guint8, 128.0);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      ACCUMULATE (gint8, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      ACCUMULATE (guint16, 32768.0);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      ACCUMULATE (gint16, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      ACCUMULATE (guint32, 2147483648.0);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      ACCUMULATE (gint32, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      ACCUMULATE (gfloat, 0.0);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      ACCUMULATE (gdouble, 0.0);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
+#undef ACCUMULATE
+
+#define WRITE_MINUS_INT(type, offset, min, max) G_STMT_START {    \
+  type *out = data;                                               \
+  for (i = 0; i < n_samples; i++) {                               \
+    gdouble v = floor (sum[i] - (contrib ? contrib[i] : 0.0) + 0.5); \
+    out[i] = (type) (CLAMP (v, (min), (max)) + (offset));         \
+  }                                                               \
+} G_STMT_END
+
+#define WRITE_MINUS_FLOAT(type) G_STMT_START {                    \
+  type *out = data;                                               \
+  for (i = 0; i < n_samples; i++)                                 \
+    out[i] = sum[i] - (contrib ? contrib[i] : 0.0);               \
+} G_STMT_END
+
+static void
+gst_audiomixer_write_minus (GstAudioFormat format, gpointer data,
+    const gdouble * sum, const gdouble * contrib, guint n_samples)
+{
+  guint i;
+
+  switch (format) {
+    case GST_AUDIO_FORMAT_U8:
+      WRITE_MINUS_INT (guint8, 128.0, -128.0, 127.0);
+      break;
+    case GST_AUDIO_FORMAT_S8:
+      WRITE_MINUS_INT (gint8, 0.0, G_MININT8, G_MAXINT8);
+      break;
+    case GST_AUDIO_FORMAT_U16:
+      WRITE_MINUS_INT (guint16, 32768.0, -32768.0, 32767.0);
+      break;
+    case GST_AUDIO_FORMAT_S16:
+      WRITE_MINUS_INT (gint16, 0.0, G_MININT16, G_MAXINT16);
+      break;
+    case GST_AUDIO_FORMAT_U32:
+      WRITE_MINUS_INT (guint32, 2147483648.0, -2147483648.0, 2147483647.0);
+      break;
+    case GST_AUDIO_FORMAT_S32:
+      WRITE_MINUS_INT (gint32, 0.0, G_MININT32, G_MAXINT32);
+      break;
+    case GST_AUDIO_FORMAT_F32:
+      WRITE_MINUS_FLOAT (gfloat);
+      break;
+    case GST_AUDIO_FORMAT_F64:
+      WRITE_MINUS_FLOAT (gdouble);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+}
+
+#undef WRITE_MINUS_INT
+#undef WRITE_MINUS_FLOAT
 
 static gboolean
 gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
@@ -292,9 +622,13 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
   GstAudioMixerPad *pad = GST_AUDIO_MIXER_PAD (aaggpad);
   GstMapInfo inmap;
   GstMapInfo outmap;
-  gint bpf;
+  gint bpf, channels;
+  GstAudioFormat format;
+  gdouble volume;
+  gint volume_i8, volume_i16, volume_i32;
   GstAggregator *agg = GST_AGGREGATOR (aagg);
   GstAudioAggregatorPad *srcpad = GST_AUDIO_AGGREGATOR_PAD (agg->srcpad);
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (aagg);
 
   GST_OBJECT_LOCK (aagg);
   GST_OBJECT_LOCK (aaggpad);
@@ -307,6 +641,17 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
   }
 
   bpf = GST_AUDIO_INFO_BPF (&srcpad->info);
+  channels = GST_AUDIO_INFO_CHANNELS (&srcpad->info);
+  format = GST_AUDIO_INFO_FORMAT (&srcpad->info);
+  volume = pad->volume;
+  volume_i8 = pad->volume_i8;
+  volume_i16 = pad->volume_i16;
+  volume_i32 = pad->volume_i32;
+
+  /* don't hold the locks while mixing, the aggregator might mix different
+   * parts of the output buffer from multiple threads */
+  GST_OBJECT_UNLOCK (aaggpad);
+  GST_OBJECT_UNLOCK (aagg);
 
   gst_buffer_map (outbuf, &outmap, GST_MAP_READWRITE);
   gst_buffer_map (inbuf, &inmap, GST_MAP_READ);
@@ -314,106 +659,269 @@ gst_audiomixer_aggregate_one_buffer (GstAudioAggregator * aagg,
       num_frames * bpf, out_offset * bpf, in_offset * bpf);
 
   /* further buffers, need to add them */
-  if (pad->volume == 1.0) {
-    switch (srcpad->info.finfo->format) {
+  if (volume == 1.0) {
+    switch (format) {
       case GST_AUDIO_FORMAT_U8:
         audiomixer_orc_add_u8 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S8:
         audiomixer_orc_add_s8 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_U16:
         audiomixer_orc_add_u16 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S16:
         audiomixer_orc_add_s16 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_U32:
         audiomixer_orc_add_u32 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S32:
         audiomixer_orc_add_s32 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_F32:
         audiomixer_orc_add_f32 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_F64:
         audiomixer_orc_add_f64 ((gpointer) (outmap.data + out_offset * bpf),
             (gpointer) (inmap.data + in_offset * bpf),
-            num_frames * srcpad->info.channels);
+            num_frames * channels);
         break;
       default:
         g_assert_not_reached ();
         break;
     }
   } else {
-    switch (srcpad->info.finfo->format) {
+    switch (format) {
       case GST_AUDIO_FORMAT_U8:
         audiomixer_orc_add_volume_u8 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i8, num_frames * srcpad->info.channels);
+            volume_i8, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S8:
         audiomixer_orc_add_volume_s8 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i8, num_frames * srcpad->info.channels);
+            volume_i8, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_U16:
         audiomixer_orc_add_volume_u16 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i16, num_frames * srcpad->info.channels);
+            volume_i16, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S16:
         audiomixer_orc_add_volume_s16 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i16, num_frames * srcpad->info.channels);
+            volume_i16, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_U32:
         audiomixer_orc_add_volume_u32 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i32, num_frames * srcpad->info.channels);
+            volume_i32, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_S32:
         audiomixer_orc_add_volume_s32 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume_i32, num_frames * srcpad->info.channels);
+            volume_i32, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_F32:
         audiomixer_orc_add_volume_f32 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume, num_frames * srcpad->info.channels);
+            volume, num_frames * channels);
         break;
       case GST_AUDIO_FORMAT_F64:
         audiomixer_orc_add_volume_f64 ((gpointer) (outmap.data +
                 out_offset * bpf), (gpointer) (inmap.data + in_offset * bpf),
-            pad->volume, num_frames * srcpad->info.channels);
+            volume, num_frames * channels);
         break;
       default:
         g_assert_not_reached ();
         break;
     }
   }
+
+  /* the mix-minus state is only changed from the streaming thread between
+   * output buffers */
+  if (audiomixer->minus_sum) {
+    gsize offset = (gsize) out_offset * channels;
+
+    gst_audiomixer_accumulate (format, inmap.data + in_offset * bpf, volume,
+        audiomixer->minus_sum + offset,
+        pad->minus_active ? pad->minus_contrib + offset : NULL,
+        num_frames * channels);
+  }
+
   gst_buffer_unmap (inbuf, &inmap);
   gst_buffer_unmap (outbuf, &outmap);
 
-  GST_OBJECT_UNLOCK (aaggpad);
+  return TRUE;
+}
+
+static void
+gst_audiomixer_reset_minus (GstAudioMixer * audiomixer)
+{
+  guint i;
+
+  for (i = 0; i < audiomixer->minus_outputs->len; i++) {
+    GstAudioMixerMinusOutput *output =
+        &g_array_index (audiomixer->minus_outputs, GstAudioMixerMinusOutput, i);
+
+    if (output->sinkpad)
+      output->sinkpad->minus_active = FALSE;
+  }
+  g_array_set_size (audiomixer->minus_outputs, 0);
+
+  g_clear_pointer (&audiomixer->minus_sum, g_free);
+  audiomixer->minus_sum_size = 0;
+}
+
+static GstBuffer *
+gst_audiomixer_create_output_buffer (GstAudioAggregator * aagg,
+    guint num_frames)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (aagg);
+  GstAudioAggregatorPad *srcpad =
+      GST_AUDIO_AGGREGATOR_PAD (GST_AGGREGATOR (aagg)->srcpad);
+  GHashTable *outputs_by_index;
+  GstBuffer *outbuf;
+  gsize n_samples;
+  GList *l;
+
+  outbuf =
+      GST_AUDIO_AGGREGATOR_CLASS (parent_class)->create_output_buffer (aagg,
+      num_frames);
+
+  gst_audiomixer_reset_minus (audiomixer);
+
+  GST_OBJECT_LOCK (aagg);
+  if (audiomixer->minus_pads == NULL) {
+    GST_OBJECT_UNLOCK (aagg);
+    return outbuf;
+  }
+
+  audiomixer->minus_info = srcpad->info;
+  n_samples = (gsize) num_frames * GST_AUDIO_INFO_CHANNELS (&srcpad->info);
+  audiomixer->minus_sum = g_new0 (gdouble, n_samples);
+  audiomixer->minus_sum_size = n_samples;
+
+  /* pair up minus_N and sink_N */
+  outputs_by_index = g_hash_table_new (NULL, NULL);
+  for (l = audiomixer->minus_pads; l; l = l->next) {
+    GstAudioMixerMinusOutput output;
+    guint index;
+
+    output.srcpad = gst_object_ref (l->data);
+    output.sinkpad = NULL;
+    g_array_append_val (audiomixer->minus_outputs, output);
+
+    if (sscanf (GST_PAD_NAME (output.srcpad), "minus_%u", &index) == 1)
+      g_hash_table_insert (outputs_by_index, GUINT_TO_POINTER (index),
+          GUINT_TO_POINTER (audiomixer->minus_outputs->len));
+  }
+
+  for (l = GST_ELEMENT_CAST (aagg)->sinkpads; l; l = l->next) {
+    GstAudioMixerPad *pad = l->data;
+    GstAudioMixerMinusOutput *output;
+    guint index, pos;
+
+    if (sscanf (GST_PAD_NAME (pad), "sink_%u", &index) != 1)
+      continue;
+
+    pos = GPOINTER_TO_UINT (g_hash_table_lookup (outputs_by_index,
+            GUINT_TO_POINTER (index)));
+    if (pos == 0)
+      continue;
+
+    output = &g_array_index (audiomixer->minus_outputs,
+        GstAudioMixerMinusOutput, pos - 1);
+    output->sinkpad = gst_object_ref (pad);
+
+    if (pad->minus_contrib_size < n_samples) {
+      g_free (pad->minus_contrib);
+      pad->minus_contrib = g_new (gdouble, n_samples);
+      pad->minus_contrib_size = n_samples;
+    }
+    memset (pad->minus_contrib, 0, n_samples * sizeof (gdouble));
+    pad->minus_active = TRUE;
+  }
+  g_hash_table_unref (outputs_by_index);
   GST_OBJECT_UNLOCK (aagg);
 
-  return TRUE;
+  return outbuf;
+}
+
+static GstBuffer *
+gst_audiomixer_create_minus_buffer (GstAudioMixer * audiomixer,
+    GstAudioMixerPad * pad, GstBuffer * outbuf)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gsize size, n_samples;
+
+  size = gst_buffer_get_size (outbuf);
+  n_samples = size / (GST_AUDIO_INFO_WIDTH (&audiomixer->minus_info) / 8);
+  n_samples = MIN (n_samples, audiomixer->minus_sum_size);
+
+  buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_copy_into (buffer, outbuf,
+      GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  gst_audiomixer_write_minus (GST_AUDIO_INFO_FORMAT (&audiomixer->minus_info),
+      map.data, audiomixer->minus_sum, pad ? pad->minus_contrib : NULL,
+      n_samples);
+  gst_buffer_unmap (buffer, &map);
+
+  return buffer;
+}
+
+static GstFlowReturn
+gst_audiomixer_finish_buffer (GstAggregator * agg, GstBuffer * buffer)
+{
+  GstAudioMixer *audiomixer = GST_AUDIO_MIXER (agg);
+  GstFlowReturn ret, minus_ret = GST_FLOW_OK;
+  guint i;
+
+  for (i = 0; i < audiomixer->minus_outputs->len; i++) {
+    GstAudioMixerMinusOutput *output =
+        &g_array_index (audiomixer->minus_outputs, GstAudioMixerMinusOutput, i);
+    GstBuffer *minusbuf;
+    GstFlowReturn output_ret;
+
+    /* nothing was mixed in, silence for everybody */
+    if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_GAP))
+      minusbuf = gst_buffer_ref (buffer);
+    else
+      minusbuf = gst_audiomixer_create_minus_buffer (audiomixer,
+          output->sinkpad, buffer);
+
+    output_ret = gst_pad_push (output->srcpad, minusbuf);
+    if (output_ret <= GST_FLOW_NOT_NEGOTIATED) {
+      GST_WARNING_OBJECT (output->srcpad, "pushing failed: %s",
+          gst_flow_get_name (output_ret));
+      minus_ret = output_ret;
+    }
+  }
+  gst_audiomixer_reset_minus (audiomixer);
+
+  ret = GST_AGGREGATOR_CLASS (parent_class)->finish_buffer (agg, buffer);
+  if (ret == GST_FLOW_OK)
+    ret = minus_ret;
+
+  return ret;
 }
 
 
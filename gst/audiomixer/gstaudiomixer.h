@@ -41,6 +41,17 @@ G_DECLARE_FINAL_TYPE (GstAudioMixer, gst_audiomixer, GST, AUDIO_MIXER,
  */
 struct _GstAudioMixer {
   GstAudioAggregator element;
+
+  /*< private >*/
+  /* mix-minus source pads, protected by the object lock */
+  GList *minus_pads;
+
+  /* state for the output buffer that is currently mixed, only accessed from
+   * the streaming thread */
+  GstAudioInfo minus_info;
+  gdouble *minus_sum;
+  gsize minus_sum_size;
+  GArray *minus_outputs;
 };
 
 #define GST_TYPE_AUDIO_MIXER_PAD (gst_audiomixer_pad_get_type())
@@ -55,6 +66,13 @@ struct _GstAudioMixerPad {
   gint volume_i16;
   gint volume_i8;
   gboolean mute;
+
+  /*< private >*/
+  /* contribution of this pad to the current output buffer, only set if a
+   * mix-minus pad exists for it */
+  gboolean minus_active;
+  gdouble *minus_contrib;
+  gsize minus_contrib_size;
 };
 
 G_END_DECLS
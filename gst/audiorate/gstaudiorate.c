@@ -49,6 +49,12 @@
  * that the incoming data is then simply shifted (by less than the indicated
  * tolerance) to a perfect time.
  *
+ * Inserted silence always references the same preallocated memory. With
+ * #GstAudioRate:coalesce enabled, silence of up to one second is prepended
+ * to the following buffer instead of being pushed as a separate buffer,
+ * which avoids extra buffers for the frequent small corrections of jittery
+ * sources. The #GstAudioRate:stats property summarizes all corrections.
+ *
  * ## Example pipelines
  * |[
  * gst-launch-1.0 -v autoaudiosrc ! audiorate ! audioconvert ! wavenc ! filesink location=alsa.wav
@@ -87,6 +93,7 @@ enum
 #define DEFAULT_SILENT     TRUE
 #define DEFAULT_TOLERANCE  (40 * GST_MSECOND)
 #define DEFAULT_SKIP_TO_FIRST FALSE
+#define DEFAULT_COALESCE   FALSE
 
 enum
 {
@@ -97,7 +104,9 @@ enum
   PROP_DROP,
   PROP_SILENT,
   PROP_TOLERANCE,
-  PROP_SKIP_TO_FIRST
+  PROP_SKIP_TO_FIRST,
+  PROP_COALESCE,
+  PROP_STATS
 };
 
 static GstStaticPadTemplate gst_audio_rate_src_template =
@@ -190,6 +199,43 @@ gst_audio_rate_class_init (GstAudioRateClass * klass)
           "Don't produce buffers before the first one we receive",
           DEFAULT_SKIP_TO_FIRST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioRate:coalesce:
+   *
+   * Prepend inserted silence of up to one second to the next buffer instead
+   * of pushing it as a separate buffer. Only used for interleaved audio.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (object_class, PROP_COALESCE,
+      g_param_spec_boolean ("coalesce", "Coalesce",
+          "Merge inserted silence into the following buffer",
+          DEFAULT_COALESCE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstAudioRate:stats:
+   *
+   * Statistics about the corrections done so far. This property returns a
+   * GstStructure named application/x-audio-rate-stats with the following
+   * fields:
+   *
+   *   * `in`: #G_TYPE_UINT64, number of input samples
+   *   * `out`: #G_TYPE_UINT64, number of output samples
+   *   * `add`: #G_TYPE_UINT64, number of inserted samples
+   *   * `drop`: #G_TYPE_UINT64, number of dropped samples
+   *   * `add-count`: #G_TYPE_UINT64, number of times samples were inserted
+   *   * `drop-count`: #G_TYPE_UINT64, number of times samples were dropped
+   *   * `coalesced`: #G_TYPE_UINT64, number of insertions that were merged
+   *      into the following buffer
+   *   * `max-add`: #G_TYPE_UINT64, largest number of samples inserted at once
+   *   * `max-drop`: #G_TYPE_UINT64, largest number of samples dropped at once
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (object_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics", "Various statistics",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class,
       "Audio rate adjuster", "Filter/Effect/Audio",
       "Drops/duplicates/adjusts timestamps on audio samples to make a perfect stream",
@@ -227,6 +273,8 @@ gst_audio_rate_setcaps (GstAudioRate * audiorate, GstCaps * caps)
   prev_rate = audiorate->info.rate;
   audiorate->info = info;
 
+  gst_clear_buffer (&audiorate->silence);
+
   if (audiorate->next_offset >= 0 && prev_rate > 0 && prev_rate != info.rate) {
     GST_DEBUG_OBJECT (audiorate,
         "rate changed from %d to %d", prev_rate, info.rate);
@@ -269,6 +317,53 @@ gst_audio_rate_init (GstAudioRate * audiorate)
   audiorate->add = 0;
   audiorate->silent = DEFAULT_SILENT;
   audiorate->tolerance = DEFAULT_TOLERANCE;
+  audiorate->coalesce = DEFAULT_COALESCE;
+}
+
+/* Returns @samples samples of silence, @samples being at most one second.
+ * The memory is shared with all other silence buffers */
+static GstBuffer *
+gst_audio_rate_make_silence (GstAudioRate * audiorate, guint64 samples)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&audiorate->info);
+  gint bpf = GST_AUDIO_INFO_BPF (&audiorate->info);
+  GstBuffer *fill;
+
+  if (audiorate->silence == NULL) {
+    GstMapInfo map;
+
+    audiorate->silence = gst_buffer_new_and_alloc ((gsize) rate * bpf);
+    gst_buffer_map (audiorate->silence, &map, GST_MAP_WRITE);
+    gst_audio_format_info_fill_silence (audiorate->info.finfo, map.data,
+        map.size);
+    gst_buffer_unmap (audiorate->silence, &map);
+  }
+
+  /* silence is the same pattern for every sample, so any part of it is
+   * also valid for non-interleaved audio */
+  fill = gst_buffer_copy_region (audiorate->silence, GST_BUFFER_COPY_MEMORY,
+      0, samples * bpf);
+
+  if (audiorate->info.layout == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    gst_buffer_add_audio_meta (fill, &audiorate->info, samples, NULL);
+  }
+
+  return fill;
+}
+
+static GstStructure *
+gst_audio_rate_create_stats (GstAudioRate * audiorate)
+{
+  return gst_structure_new ("application/x-audio-rate-stats",
+      "in", G_TYPE_UINT64, audiorate->in,
+      "out", G_TYPE_UINT64, audiorate->out,
+      "add", G_TYPE_UINT64, audiorate->add,
+      "drop", G_TYPE_UINT64, audiorate->drop,
+      "add-count", G_TYPE_UINT64, audiorate->add_count,
+      "drop-count", G_TYPE_UINT64, audiorate->drop_count,
+      "coalesced", G_TYPE_UINT64, audiorate->coalesced,
+      "max-add", G_TYPE_UINT64, audiorate->max_add,
+      "max-drop", G_TYPE_UINT64, audiorate->max_drop, NULL);
 }
 
 static void
@@ -544,7 +639,6 @@ gst_audio_rate_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   /* do we need to insert samples */
   if (in_offset > audiorate->next_offset) {
     GstBuffer *fill;
-    gint fillsize;
     guint64 fillsamples;
 
     /* We don't want to allocate a single unreasonably huge buffer - it might
@@ -552,23 +646,50 @@ gst_audio_rate_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
        audio */
     fillsamples = in_offset - audiorate->next_offset;
 
+    audiorate->add_count++;
+    audiorate->max_add = MAX (audiorate->max_add, fillsamples);
+
+    if (audiorate->coalesce && fillsamples <= rate &&
+        audiorate->info.layout == GST_AUDIO_LAYOUT_INTERLEAVED) {
+      gboolean is_gap = in_samples == 0;
+
+      GST_DEBUG_OBJECT (audiorate, "prepending %" G_GUINT64_FORMAT
+          " samples", fillsamples);
+
+      /* the buffer now starts at next_offset, in_offset_end is unchanged.
+       * It replaces the input buffer, so it keeps its flags and metas */
+      fill = gst_audio_rate_make_silence (audiorate, fillsamples);
+      gst_buffer_copy_into (fill, buf,
+          GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_META, 0, -1);
+      if (meta) {
+        GstAudioMeta *fill_meta = gst_buffer_get_audio_meta (fill);
+
+        /* update the number of samples of the copied audio meta */
+        if (fill_meta)
+          gst_buffer_remove_meta (fill, (GstMeta *) fill_meta);
+        gst_buffer_add_audio_meta (fill, &audiorate->info,
+            fillsamples + in_samples, NULL);
+      }
+      buf = gst_buffer_append (fill, buf);
+      if (is_gap)
+        GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_GAP);
+
+      audiorate->out += fillsamples;
+      audiorate->add += fillsamples;
+      audiorate->coalesced++;
+
+      if (!audiorate->silent)
+        gst_audio_rate_notify_add (audiorate);
+
+      goto send;
+    }
+
     while (fillsamples > 0) {
       guint64 cursamples = MIN (fillsamples, rate);
-      GstMapInfo fillmap;
 
       fillsamples -= cursamples;
-      fillsize = cursamples * bpf;
-
-      fill = gst_buffer_new_and_alloc (fillsize);
 
-      gst_buffer_map (fill, &fillmap, GST_MAP_WRITE);
-      gst_audio_format_info_fill_silence (audiorate->info.finfo, fillmap.data,
-          fillmap.size);
-      gst_buffer_unmap (fill, &fillmap);
-
-      if (audiorate->info.layout == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
-        gst_buffer_add_audio_meta (fill, &audiorate->info, cursamples, NULL);
-      }
+      fill = gst_audio_rate_make_silence (audiorate, cursamples);
 
       GST_DEBUG_OBJECT (audiorate, "inserting %" G_GUINT64_FORMAT " samples",
           cursamples);
@@ -615,6 +736,8 @@ gst_audio_rate_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       guint64 drop = in_samples;
 
       audiorate->drop += drop;
+      audiorate->drop_count++;
+      audiorate->max_drop = MAX (audiorate->max_drop, drop);
 
       GST_DEBUG_OBJECT (audiorate, "dropping %" G_GUINT64_FORMAT " samples",
           drop);
@@ -637,6 +760,8 @@ gst_audio_rate_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       buf = gst_audio_buffer_truncate (buf, bpf, truncsamples, leftsamples);
 
       audiorate->drop += truncsamples;
+      audiorate->drop_count++;
+      audiorate->max_drop = MAX (audiorate->max_drop, truncsamples);
       audiorate->out += leftsamples;
       GST_DEBUG_OBJECT (audiorate, "truncating %" G_GUINT64_FORMAT " samples",
           truncsamples);
@@ -719,6 +844,9 @@ gst_audio_rate_set_property (GObject * object,
     case PROP_SKIP_TO_FIRST:
       audiorate->skip_to_first = g_value_get_boolean (value);
       break;
+    case PROP_COALESCE:
+      audiorate->coalesce = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -753,6 +881,12 @@ gst_audio_rate_get_property (GObject * object,
     case PROP_SKIP_TO_FIRST:
       g_value_set_boolean (value, audiorate->skip_to_first);
       break;
+    case PROP_COALESCE:
+      g_value_set_boolean (value, audiorate->coalesce);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_audio_rate_create_stats (audiorate));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -763,6 +897,7 @@ static GstStateChangeReturn
 gst_audio_rate_change_state (GstElement * element, GstStateChange transition)
 {
   GstAudioRate *audiorate = GST_AUDIO_RATE (element);
+  GstStateChangeReturn ret;
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
@@ -772,6 +907,11 @@ gst_audio_rate_change_state (GstElement * element, GstStateChange transition)
       audiorate->out = 0;
       audiorate->drop = 0;
       audiorate->add = 0;
+      audiorate->add_count = 0;
+      audiorate->drop_count = 0;
+      audiorate->coalesced = 0;
+      audiorate->max_add = 0;
+      audiorate->max_drop = 0;
       gst_audio_info_init (&audiorate->info);
       gst_audio_rate_reset (audiorate);
       break;
@@ -779,7 +919,17 @@ gst_audio_rate_change_state (GstElement * element, GstStateChange transition)
       break;
   }
 
-  return GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_clear_buffer (&audiorate->silence);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
 }
 
 static gboolean
@@ -44,9 +44,15 @@ struct _GstAudioRate
 
   /* stats */
   guint64 in, out, add, drop;
+  guint64 add_count, drop_count, coalesced;
+  guint64 max_add, max_drop;
   gboolean silent;
   guint64 tolerance;
   gboolean skip_to_first;
+  gboolean coalesce;
+
+  /* one second of silence, shared by all inserted samples */
+  GstBuffer *silence;
 
   /* audio state */
   guint64 next_offset;
@@ -111,6 +111,10 @@ GST_DEBUG_CATEGORY_STATIC (audio_test_src_debug);
 #define DEFAULT_APPLY_TICK_RAMP         FALSE
 #define DEFAULT_CAN_ACTIVATE_PUSH       TRUE
 #define DEFAULT_CAN_ACTIVATE_PULL       FALSE
+#define DEFAULT_REPEAT_BUFFERS          FALSE
+
+/* longest period of a static tone that is precomputed, in samples */
+#define MAX_PERIOD_SAMPLES              (1 << 16)
 
 enum
 {
@@ -127,7 +131,8 @@ enum
   PROP_MARKER_TICK_VOLUME,
   PROP_APPLY_TICK_RAMP,
   PROP_CAN_ACTIVATE_PUSH,
-  PROP_CAN_ACTIVATE_PULL
+  PROP_CAN_ACTIVATE_PULL,
+  PROP_REPEAT_BUFFERS
 };
 
 #define FORMAT_STR  " { S16LE, S16BE, U16LE, U16BE, " \
@@ -212,6 +217,8 @@ static void gst_audio_test_src_get_times (GstBaseSrc * basesrc,
     GstBuffer * buffer, GstClockTime * start, GstClockTime * end);
 static gboolean gst_audio_test_src_start (GstBaseSrc * basesrc);
 static gboolean gst_audio_test_src_stop (GstBaseSrc * basesrc);
+static GstFlowReturn gst_audio_test_src_alloc (GstBaseSrc * basesrc,
+    guint64 offset, guint size, GstBuffer ** buffer);
 static GstFlowReturn gst_audio_test_src_fill (GstBaseSrc * basesrc,
     guint64 offset, guint length, GstBuffer * buffer);
 
@@ -293,6 +300,22 @@ gst_audio_test_src_class_init (GstAudioTestSrcClass * klass)
           "Can activate in pull mode", DEFAULT_CAN_ACTIVATE_PULL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAudioTestSrc:repeat-buffers:
+   *
+   * Push buffers sharing the same read-only memory as long as the generated
+   * signal does not change from one buffer to the next, instead of
+   * generating every buffer again. This is the case for silence, a volume
+   * of 0 and for tones with an integer frequency whose period divides the
+   * number of samples per buffer.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_REPEAT_BUFFERS,
+      g_param_spec_boolean ("repeat-buffers", "Repeat buffers",
+          "Reuse the memory of the previous buffer for constant signals",
+          DEFAULT_REPEAT_BUFFERS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_audio_test_src_src_template);
   gst_element_class_set_static_metadata (gstelement_class, "Audio test source",
@@ -310,6 +333,7 @@ gst_audio_test_src_class_init (GstAudioTestSrcClass * klass)
       GST_DEBUG_FUNCPTR (gst_audio_test_src_get_times);
   gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_audio_test_src_start);
   gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_audio_test_src_stop);
+  gstbasesrc_class->alloc = GST_DEBUG_FUNCPTR (gst_audio_test_src_alloc);
   gstbasesrc_class->fill = GST_DEBUG_FUNCPTR (gst_audio_test_src_fill);
 
   gst_type_mark_as_plugin_api (GST_TYPE_AUDIO_TEST_SRC_WAVE, 0);
@@ -335,6 +359,7 @@ gst_audio_test_src_init (GstAudioTestSrc * src)
   src->marker_tick_period = DEFAULT_MARKER_TICK_PERIOD;
   src->marker_tick_volume = DEFAULT_MARKER_TICK_VOLUME;
   src->apply_tick_ramp = DEFAULT_APPLY_TICK_RAMP;
+  src->repeat_buffers = DEFAULT_REPEAT_BUFFERS;
 
   src->gen = NULL;
 
@@ -353,6 +378,11 @@ gst_audio_test_src_finalize (GObject * object)
   g_free (src->tmp);
   src->tmp = NULL;
   src->tmpsize = 0;
+  g_free (src->period_table);
+  src->period_table = NULL;
+  if (src->repeat_mem)
+    gst_memory_unref (src->repeat_mem);
+  src->repeat_mem = NULL;
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -701,6 +731,14 @@ static const ProcessFunc silence_funcs[] = {
   (ProcessFunc) gst_audio_test_src_create_silence_double
 };
 
+/* uniform random value in [-1.0, 1.0) from a single 32 bit random number,
+ * which is about half the work of g_rand_double_range() */
+static inline gdouble
+gst_audio_test_src_rand_bipolar (GRand * gen)
+{
+  return (gint32) g_rand_int (gen) * (1.0 / 2147483648.0);
+}
+
 #define DEFINE_WHITE_NOISE(type,scale) \
 static void \
 gst_audio_test_src_create_white_noise_##type (GstAudioTestSrc * src, g##type * samples) \
@@ -721,7 +759,7 @@ gst_audio_test_src_create_white_noise_##type (GstAudioTestSrc * src, g##type * s
   for (i = 0; i < src->generate_samples_per_buffer; i++) { \
     ptr = samples; \
     for (c = 0; c < channels; ++c) { \
-      *ptr = (g##type) (amp * g_rand_double_range (src->gen, -1.0, 1.0)); \
+      *ptr = (g##type) (amp * gst_audio_test_src_rand_bipolar (src->gen)); \
       ptr += channel_step; \
     } \
     samples += sample_step; \
@@ -778,14 +816,7 @@ gst_audio_test_src_generate_pink_noise_value (GstAudioTestSrc * src)
   /* If index is zero, don't update any random values. */
   if (pink->index != 0) {
     /* Determine how many trailing zeros in PinkIndex. */
-    /* This algorithm will hang if n==0 so test first. */
-    gint num_zeros = 0;
-    gint n = pink->index;
-
-    while ((n & 1) == 0) {
-      n = n >> 1;
-      num_zeros++;
-    }
+    gint num_zeros = g_bit_nth_lsf (pink->index, -1);
 
     /* Replace the indexed ROWS random value.
      * Subtract and add back to RunningSum instead of adding all the random
@@ -1077,7 +1108,7 @@ gst_audio_test_src_create_red_noise_##type (GstAudioTestSrc * src, g##type * sam
     ptr = samples; \
     for (c = 0; c < channels; ++c) { \
       while (TRUE) { \
-        gdouble r = g_rand_double_range (src->gen, -1.0, 1.0); \
+        gdouble r = gst_audio_test_src_rand_bipolar (src->gen); \
         state += r; \
         if (state < -8.0f || state > 8.0f) state -= r; \
         else break; \
@@ -1197,10 +1228,14 @@ static const ProcessFunc violet_noise_funcs[] = {
 static void
 gst_audio_test_src_change_wave (GstAudioTestSrc * src)
 {
+  static const gint process_sizes[] = {
+    sizeof (gint16), sizeof (gint32), sizeof (gfloat), sizeof (gdouble)
+  };
   gint idx;
 
   src->pack_func = NULL;
   src->process = NULL;
+  g_atomic_int_set (&src->period_dirty, 1);
 
   /* not negotiated yet? */
   if (src->info.finfo == NULL)
@@ -1237,6 +1272,7 @@ gst_audio_test_src_change_wave (GstAudioTestSrc * src)
           return;
       }
   }
+  src->process_size = process_sizes[idx];
 
   switch (src->wave) {
     case GST_AUDIO_TEST_SRC_WAVE_SINE:
@@ -1321,6 +1357,194 @@ gst_audio_test_src_change_volume (GstAudioTestSrc * src)
   }
 }
 
+static void
+gst_audio_test_src_reset_period (GstAudioTestSrc * src)
+{
+  g_free (src->period_table);
+  src->period_table = NULL;
+  src->period_samples = 0;
+
+  if (src->repeat_mem)
+    gst_memory_unref (src->repeat_mem);
+  src->repeat_mem = NULL;
+}
+
+/*
+ * gst_audio_test_src_build_period:
+ * Precompute one period of periodic waves, so that buffers can be copied
+ * together from a table instead of evaluating the wave for every sample.
+ */
+static void
+gst_audio_test_src_build_period (GstAudioTestSrc * src)
+{
+  gint rate = GST_AUDIO_INFO_RATE (&src->info);
+  gint channels, samples, period;
+  GstAudioLayout layout;
+  guint64 a, b, t;
+
+  src->period_samples = -1;
+
+  switch (src->wave) {
+    case GST_AUDIO_TEST_SRC_WAVE_SINE:
+    case GST_AUDIO_TEST_SRC_WAVE_SQUARE:
+    case GST_AUDIO_TEST_SRC_WAVE_SAW:
+    case GST_AUDIO_TEST_SRC_WAVE_TRIANGLE:
+    case GST_AUDIO_TEST_SRC_WAVE_SINE_TAB:
+      break;
+    default:
+      return;
+  }
+
+  /* only integer frequencies repeat after a whole number of samples */
+  if (src->process == NULL || rate <= 0 || src->freq <= 0.0 ||
+      src->freq != floor (src->freq))
+    return;
+
+  /* the period is rate / gcd (rate, freq) samples long */
+  a = rate;
+  b = (guint64) src->freq;
+  while (b != 0) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  if (rate / a > MAX_PERIOD_SAMPLES)
+    return;
+  period = rate / a;
+
+  GST_DEBUG_OBJECT (src, "precomputing period of %d samples", period);
+
+  src->period_table = g_realloc (src->period_table,
+      (gsize) period * src->process_size);
+
+  /* let the generator produce one period of a single channel, it starts
+   * from the current phase and ends up in the same phase again */
+  channels = src->info.channels;
+  layout = src->info.layout;
+  samples = src->generate_samples_per_buffer;
+
+  src->info.channels = 1;
+  src->info.layout = GST_AUDIO_LAYOUT_INTERLEAVED;
+  src->generate_samples_per_buffer = period;
+  src->period_accumulator = src->accumulator;
+  src->process (src, src->period_table);
+
+  src->info.channels = channels;
+  src->info.layout = layout;
+  src->generate_samples_per_buffer = samples;
+  src->accumulator = src->period_accumulator;
+
+  src->period_pos = 0;
+  src->period_samples = period;
+}
+
+static void
+gst_audio_test_src_advance_period (GstAudioTestSrc * src, gint samples)
+{
+  src->period_pos = (src->period_pos + samples) % src->period_samples;
+  /* keep the accumulator in sync for when the table is dropped again */
+  src->accumulator = fmod (src->period_accumulator +
+      src->period_pos * (M_PI_M2 * src->freq / GST_AUDIO_INFO_RATE (&src->info)),
+      M_PI_M2);
+}
+
+static void
+gst_audio_test_src_copy_period (GstAudioTestSrc * src, guint8 * samples,
+    gint n_samples)
+{
+  const guint8 *table = src->period_table;
+  gint size = src->process_size;
+  gint pos = src->period_pos;
+
+  while (n_samples > 0) {
+    gint chunk = MIN (n_samples, src->period_samples - pos);
+
+    memcpy (samples, table + pos * size, chunk * size);
+    samples += chunk * size;
+    n_samples -= chunk;
+    pos = 0;
+  }
+}
+
+#define DEFINE_PERIOD_INTERLEAVE(type) \
+static void \
+gst_audio_test_src_interleave_period_##type (GstAudioTestSrc * src, \
+    type * samples, gint n_samples, gint channels) \
+{ \
+  const type *table = src->period_table; \
+  gint i, c, pos = src->period_pos; \
+  \
+  for (i = 0; i < n_samples; i++) { \
+    type v = table[pos]; \
+    \
+    for (c = 0; c < channels; c++) \
+      *samples++ = v; \
+    if (++pos == src->period_samples) \
+      pos = 0; \
+  } \
+}
+
+DEFINE_PERIOD_INTERLEAVE (guint16);
+DEFINE_PERIOD_INTERLEAVE (guint32);
+DEFINE_PERIOD_INTERLEAVE (guint64);
+
+/* same as calling src->process, but from the precomputed period */
+static void
+gst_audio_test_src_process_period (GstAudioTestSrc * src, guint8 * samples)
+{
+  gint n_samples = src->generate_samples_per_buffer;
+  gint channels = GST_AUDIO_INFO_CHANNELS (&src->info);
+  gint c;
+
+  if (GST_AUDIO_INFO_LAYOUT (&src->info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    for (c = 0; c < channels; c++)
+      gst_audio_test_src_copy_period (src,
+          samples + c * n_samples * src->process_size, n_samples);
+  } else if (channels == 1) {
+    gst_audio_test_src_copy_period (src, samples, n_samples);
+  } else {
+    switch (src->process_size) {
+      case 2:
+        gst_audio_test_src_interleave_period_guint16 (src, (guint16 *) samples,
+            n_samples, channels);
+        break;
+      case 4:
+        gst_audio_test_src_interleave_period_guint32 (src, (guint32 *) samples,
+            n_samples, channels);
+        break;
+      case 8:
+        gst_audio_test_src_interleave_period_guint64 (src, (guint64 *) samples,
+            n_samples, channels);
+        break;
+      default:
+        g_assert_not_reached ();
+        break;
+    }
+  }
+
+  gst_audio_test_src_advance_period (src, n_samples);
+}
+
+/* whether the next @n_samples are identical to the previous ones, @key
+ * identifies the content */
+static gboolean
+gst_audio_test_src_is_constant (GstAudioTestSrc * src, gint n_samples,
+    gint64 * key)
+{
+  if (src->wave == GST_AUDIO_TEST_SRC_WAVE_SILENCE ||
+      (src->volume == 0.0 && src->wave != GST_AUDIO_TEST_SRC_WAVE_TICKS)) {
+    *key = -1;
+    return TRUE;
+  }
+
+  if (src->period_samples > 0 && n_samples % src->period_samples == 0) {
+    *key = src->period_pos;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 static void
 gst_audio_test_src_get_times (GstBaseSrc * basesrc, GstBuffer * buffer,
     GstClockTime * start, GstClockTime * end)
@@ -1357,6 +1581,7 @@ gst_audio_test_src_start (GstBaseSrc * basesrc)
   src->tags_pushed = FALSE;
   src->accumulator = 0;
   src->tick_counter = 0;
+  gst_audio_test_src_reset_period (src);
 
   return TRUE;
 }
@@ -1427,6 +1652,29 @@ gst_audio_test_src_is_seekable (GstBaseSrc * basesrc)
   return TRUE;
 }
 
+static GstFlowReturn
+gst_audio_test_src_alloc (GstBaseSrc * basesrc, guint64 offset, guint size,
+    GstBuffer ** buffer)
+{
+  GstAudioTestSrc *src = GST_AUDIO_TEST_SRC (basesrc);
+  gint bpf = GST_AUDIO_INFO_BPF (&src->info);
+  gint64 key;
+
+  /* hand out the memory of the previous buffer again if the signal is
+   * constant, fill() checks again after syncing the controlled properties */
+  if (src->repeat_mem && bpf > 0 && !g_atomic_int_get (&src->period_dirty)
+      && gst_memory_get_sizes (src->repeat_mem, NULL, NULL) == size
+      && gst_audio_test_src_is_constant (src, size / bpf, &key)
+      && key == src->repeat_key) {
+    *buffer = gst_buffer_new ();
+    gst_buffer_append_memory (*buffer, gst_memory_ref (src->repeat_mem));
+    return GST_FLOW_OK;
+  }
+
+  return GST_BASE_SRC_CLASS (parent_class)->alloc (basesrc, offset, size,
+      buffer);
+}
+
 static GstFlowReturn
 gst_audio_test_src_fill (GstBaseSrc * basesrc, guint64 offset,
     guint length, GstBuffer * buffer)
@@ -1438,6 +1686,10 @@ gst_audio_test_src_fill (GstBaseSrc * basesrc, guint64 offset,
   GstElementClass *eclass;
   GstMapInfo map;
   gint samplerate, bpf;
+  GstMapInfo map2;
+  GstMemory *repeat_mem = NULL;
+  gboolean constant;
+  gint64 key;
 
   src = GST_AUDIO_TEST_SRC (basesrc);
 
@@ -1516,7 +1768,12 @@ gst_audio_test_src_fill (GstBaseSrc * basesrc, guint64 offset,
   GST_LOG_OBJECT (src, "next_sample %" G_GINT64_FORMAT ", ts %" GST_TIME_FORMAT,
       next_sample, GST_TIME_ARGS (next_time));
 
-  gst_buffer_set_size (buffer, bytes);
+  /* buffer from alloc() that shares the memory of the previous one */
+  if (src->repeat_mem && gst_buffer_n_memory (buffer) == 1 &&
+      gst_buffer_peek_memory (buffer, 0) == src->repeat_mem)
+    repeat_mem = src->repeat_mem;
+  else
+    gst_buffer_set_size (buffer, bytes);
 
   GST_BUFFER_OFFSET (buffer) = src->next_sample;
   GST_BUFFER_OFFSET_END (buffer) = next_sample;
@@ -1538,6 +1795,32 @@ gst_audio_test_src_fill (GstBaseSrc * basesrc, guint64 offset,
       src->generate_samples_per_buffer,
       GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buffer)));
 
+  if (g_atomic_int_get (&src->period_dirty)) {
+    g_atomic_int_set (&src->period_dirty, 0);
+    gst_audio_test_src_reset_period (src);
+  }
+  if (src->period_samples == 0)
+    gst_audio_test_src_build_period (src);
+
+  constant = src->repeat_buffers &&
+      gst_audio_test_src_is_constant (src, src->generate_samples_per_buffer,
+      &key);
+
+  if (repeat_mem) {
+    if (constant && repeat_mem == src->repeat_mem && key == src->repeat_key
+        && gst_memory_get_sizes (repeat_mem, NULL, NULL) == bytes) {
+      /* nothing to generate, only keep the phase running */
+      if (src->period_samples > 0)
+        gst_audio_test_src_advance_period (src,
+            src->generate_samples_per_buffer);
+      goto done;
+    }
+
+    /* the signal changed in the meantime */
+    gst_buffer_replace_all_memory (buffer,
+        gst_allocator_alloc (NULL, bytes, NULL));
+  }
+
   gst_buffer_map (buffer, &map, GST_MAP_WRITE);
   if (src->pack_func) {
     gsize tmpsize;
@@ -1550,15 +1833,33 @@ gst_audio_test_src_fill (GstBaseSrc * basesrc, guint64 offset,
       src->tmp = g_realloc (src->tmp, tmpsize);
       src->tmpsize = tmpsize;
     }
-    src->process (src, src->tmp);
+    if (src->period_samples > 0)
+      gst_audio_test_src_process_period (src, src->tmp);
+    else
+      src->process (src, src->tmp);
     src->pack_func (src->info.finfo, 0, src->tmp, map.data,
         src->generate_samples_per_buffer *
         GST_AUDIO_INFO_CHANNELS (&src->info));
+  } else if (src->period_samples > 0) {
+    gst_audio_test_src_process_period (src, map.data);
   } else {
     src->process (src, map.data);
   }
+
+  /* keep a read-only copy around for the following buffers */
+  if (constant && (!src->repeat_mem || key != src->repeat_key ||
+          gst_memory_get_sizes (src->repeat_mem, NULL, NULL) != bytes)) {
+    if (src->repeat_mem)
+      gst_memory_unref (src->repeat_mem);
+    src->repeat_mem = gst_allocator_alloc (NULL, bytes, NULL);
+    gst_memory_map (src->repeat_mem, &map2, GST_MAP_WRITE);
+    memcpy (map2.data, map.data, bytes);
+    gst_memory_unmap (src->repeat_mem, &map2);
+    src->repeat_key = key;
+  }
   gst_buffer_unmap (buffer, &map);
 
+done:
   if (G_UNLIKELY ((src->wave == GST_AUDIO_TEST_SRC_WAVE_SILENCE)
           || (src->volume == 0.0))) {
     GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
@@ -1588,13 +1889,23 @@ gst_audio_test_src_set_property (GObject * object, guint prop_id,
       src->wave = g_value_get_enum (value);
       gst_audio_test_src_change_wave (src);
       break;
-    case PROP_FREQ:
-      src->freq = g_value_get_double (value);
+    case PROP_FREQ:{
+      gdouble freq = g_value_get_double (value);
+
+      if (freq != src->freq)
+        g_atomic_int_set (&src->period_dirty, 1);
+      src->freq = freq;
       break;
-    case PROP_VOLUME:
-      src->volume = g_value_get_double (value);
+    }
+    case PROP_VOLUME:{
+      gdouble volume = g_value_get_double (value);
+
+      if (volume != src->volume)
+        g_atomic_int_set (&src->period_dirty, 1);
+      src->volume = volume;
       gst_audio_test_src_change_volume (src);
       break;
+    }
     case PROP_IS_LIVE:
       gst_base_src_set_live (GST_BASE_SRC (src), g_value_get_boolean (value));
       break;
@@ -1622,6 +1933,10 @@ gst_audio_test_src_set_property (GObject * object, guint prop_id,
     case PROP_CAN_ACTIVATE_PULL:
       src->can_activate_pull = g_value_get_boolean (value);
       break;
+    case PROP_REPEAT_BUFFERS:
+      src->repeat_buffers = g_value_get_boolean (value);
+      g_atomic_int_set (&src->period_dirty, 1);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1674,6 +1989,9 @@ gst_audio_test_src_get_property (GObject * object, guint prop_id,
     case PROP_CAN_ACTIVATE_PULL:
       g_value_set_boolean (value, src->can_activate_pull);
       break;
+    case PROP_REPEAT_BUFFERS:
+      g_value_set_boolean (value, src->repeat_buffers);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -93,6 +93,7 @@ struct _GstAudioTestSrc {
   GstBaseSrc parent;
 
   ProcessFunc process;
+  gint process_size;                 /* sample size produced by process */
   GstAudioFormatPack pack_func;
   gint pack_size;
   gpointer tmp;
@@ -133,6 +134,18 @@ struct _GstAudioTestSrc {
   gboolean apply_tick_ramp;
   guint samples_between_ticks;
   guint tick_counter;
+
+  /* one precomputed period of static tones */
+  gint period_dirty;                 /* atomic, set on parameter changes */
+  gpointer period_table;             /* mono, in the format of process */
+  gint period_samples;               /* 0 = not built yet, -1 = not periodic */
+  gint period_pos;                   /* table position of accumulator */
+  gdouble period_accumulator;        /* accumulator at table position 0 */
+
+  /* zero-copy repeated buffers for constant signals */
+  gboolean repeat_buffers;
+  GstMemory *repeat_mem;
+  gint64 repeat_key;
 };
 
 GST_ELEMENT_REGISTER_DECLARE (audiotestsrc);
@@ -79,6 +79,9 @@
 #define VOLUME_MAX_INT32             G_MAXINT32
 #define VOLUME_MIN_INT32             G_MININT32
 
+/* number of frames for which per-sample gains are expanded at once */
+#define VOLUME_GAIN_BLOCK_FRAMES     256
+
 #define GST_CAT_DEFAULT gst_volume_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
@@ -91,12 +94,15 @@ enum
 
 #define DEFAULT_PROP_MUTE       FALSE
 #define DEFAULT_PROP_VOLUME     1.0
+#define DEFAULT_PROP_RAMP       FALSE
 
 enum
 {
   PROP_0,
   PROP_MUTE,
-  PROP_VOLUME
+  PROP_VOLUME,
+  PROP_CHANNEL_VOLUMES,
+  PROP_RAMP
 };
 
 #if G_BYTE_ORDER == G_LITTLE_ENDIAN
@@ -229,11 +235,57 @@ volume_choose_func (GstVolume * self, const GstAudioInfo * info)
   return (self->process != NULL);
 }
 
+static void
+volume_update_passthrough (GstVolume * self)
+{
+  gboolean passthrough;
+
+  passthrough = !self->current_mute
+      && self->current_vol_i16 == VOLUME_UNITY_INT16
+      && self->current_channel_volumes == NULL && !self->ramp_pending;
+
+  /* If a controller is used, never use passthrough mode
+   * because the property can change from 1.0 to something
+   * else in the middle of a buffer.
+   */
+  passthrough &= !gst_object_has_active_control_bindings (GST_OBJECT (self));
+
+  GST_DEBUG_OBJECT (self, "set passthrough %d", passthrough);
+
+  gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (self), passthrough);
+}
+
+static void
+volume_update_channel_volumes (GstVolume * self, const GstAudioInfo * info)
+{
+  guint i, channels = GST_AUDIO_INFO_CHANNELS (info);
+  gboolean unity = TRUE;
+  gdouble *volumes;
+
+  g_free (self->current_channel_volumes);
+  self->current_channel_volumes = NULL;
+
+  volumes = g_new (gdouble, MAX (channels, 1));
+
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < channels; i++) {
+    volumes[i] = i < self->n_channel_volumes ? self->channel_volumes[i] : 1.0;
+    if (volumes[i] != 1.0)
+      unity = FALSE;
+  }
+  self->channel_volumes_changed = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  if (unity)
+    g_free (volumes);
+  else
+    self->current_channel_volumes = volumes;
+}
+
 static gboolean
 volume_update_volume (GstVolume * self, const GstAudioInfo * info,
     gdouble volume, gboolean mute)
 {
-  gboolean passthrough;
   gboolean res;
 
   GST_DEBUG_OBJECT (self, "configure mute %d, volume %f", mute, volume);
@@ -246,8 +298,6 @@ volume_update_volume (GstVolume * self, const GstAudioInfo * info,
     self->current_vol_i16 = 0;
     self->current_vol_i24 = 0;
     self->current_vol_i32 = 0;
-
-    passthrough = FALSE;
   } else {
     self->current_mute = FALSE;
     self->current_volume = volume;
@@ -260,19 +310,9 @@ volume_update_volume (GstVolume * self, const GstAudioInfo * info,
         (gint) ((gdouble) volume * (gdouble) VOLUME_UNITY_INT24);
     self->current_vol_i32 =
         (gint) ((gdouble) volume * (gdouble) VOLUME_UNITY_INT32);
-
-    passthrough = (self->current_vol_i16 == VOLUME_UNITY_INT16);
   }
 
-  /* If a controller is used, never use passthrough mode
-   * because the property can change from 1.0 to something
-   * else in the middle of a buffer.
-   */
-  passthrough &= !gst_object_has_active_control_bindings (GST_OBJECT (self));
-
-  GST_DEBUG_OBJECT (self, "set passthrough %d", passthrough);
-
-  gst_base_transform_set_passthrough (GST_BASE_TRANSFORM (self), passthrough);
+  volume_update_passthrough (self);
 
   res = self->negotiated = volume_choose_func (self, info);
 
@@ -296,6 +336,17 @@ gst_volume_dispose (GObject * object)
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_volume_finalize (GObject * object)
+{
+  GstVolume *volume = GST_VOLUME (object);
+
+  g_free (volume->channel_volumes);
+  g_free (volume->current_channel_volumes);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_volume_class_init (GstVolumeClass * klass)
 {
@@ -313,6 +364,7 @@ gst_volume_class_init (GstVolumeClass * klass)
   gobject_class->set_property = volume_set_property;
   gobject_class->get_property = volume_get_property;
   gobject_class->dispose = gst_volume_dispose;
+  gobject_class->finalize = gst_volume_finalize;
 
   g_object_class_install_property (gobject_class, PROP_MUTE,
       g_param_spec_boolean ("mute", "Mute", "mute channel",
@@ -324,6 +376,37 @@ gst_volume_class_init (GstVolumeClass * klass)
           0.0, VOLUME_MAX_DOUBLE, DEFAULT_PROP_VOLUME,
           G_PARAM_READWRITE | GST_PARAM_CONTROLLABLE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstVolume:channel-volumes:
+   *
+   * Volume factors of the individual channels, in the channel order of the
+   * stream. They are applied on top of #GstVolume:volume, missing entries
+   * are treated as 1.0.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_CHANNEL_VOLUMES,
+      gst_param_spec_array ("channel-volumes", "Channel volumes",
+          "Per-channel volume factors, 1.0=100%",
+          g_param_spec_double ("channel-volume", "Channel volume",
+              "Volume factor of one channel", 0.0, VOLUME_MAX_DOUBLE, 1.0,
+              G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS),
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstVolume:ramp:
+   *
+   * Apply changes of #GstVolume:volume and #GstVolume:mute as a linear ramp
+   * over the next buffer instead of switching at once, which avoids clicks.
+   * Not used while the properties are controlled.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_RAMP,
+      g_param_spec_boolean ("ramp", "Ramp",
+          "Ramp linearly to new volume values over one buffer",
+          DEFAULT_PROP_RAMP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (element_class, "Volume",
       "Filter/Effect/Audio",
       "Set volume on audio/raw streams", "Andy Wingo <wingo@pobox.com>");
@@ -345,6 +428,7 @@ gst_volume_init (GstVolume * self)
 {
   self->mute = DEFAULT_PROP_MUTE;
   self->volume = DEFAULT_PROP_VOLUME;
+  self->ramp = DEFAULT_PROP_RAMP;
 
   self->tracklist = NULL;
   self->negotiated = FALSE;
@@ -640,6 +724,109 @@ volume_process_controlled_int8_clamp (GstVolume * self, gpointer bytes,
   }
 }
 
+static void
+volume_ensure_volumes (GstVolume * self, guint n_frames)
+{
+  if (self->volumes_count < n_frames) {
+    self->volumes = g_realloc (self->volumes, sizeof (gdouble) * n_frames);
+    self->volumes_count = n_frames;
+  }
+}
+
+/* gains going linearly from @from to @to, which is reached right after the
+ * last frame */
+static void
+volume_fill_ramp (gdouble * volumes, gdouble from, gdouble to,
+    guint n_frames)
+{
+  gdouble step = (to - from) / n_frames;
+  guint i;
+
+  for (i = 0; i < n_frames; i++)
+    volumes[i] = from + step * i;
+}
+
+/* formats that have a two channel kernel for per-frame gains */
+static gboolean
+volume_have_stereo_kernel (GstAudioFormat format)
+{
+  return format == GST_AUDIO_FORMAT_F32 || format == GST_AUDIO_FORMAT_S16 ||
+      format == GST_AUDIO_FORMAT_S8;
+}
+
+/* Applies one gain per frame, combined with the per-channel gains. For
+ * interleaved data the gains of a block of frames are expanded to one per
+ * sample so the single channel kernels can process all channels in one go,
+ * mute and clipping included. */
+static void
+volume_process_gains (GstVolume * self, guint8 * data,
+    const gdouble * volumes, guint channels, guint n_bytes)
+{
+  const GstAudioInfo *info = GST_AUDIO_FILTER_INFO (self);
+  const gdouble *cv = self->current_channel_volumes;
+  guint width = GST_AUDIO_INFO_WIDTH (info) / 8;
+  guint bpf = width * channels;
+  guint n_frames = n_bytes / bpf;
+  guint start, len, i, c;
+  gdouble *gains;
+
+  if (cv == NULL && (channels == 1 || (channels == 2
+              && volume_have_stereo_kernel (GST_AUDIO_INFO_FORMAT (info))))) {
+    self->process_controlled (self, data, (gdouble *) volumes, channels,
+        n_bytes);
+    return;
+  }
+
+  if (GST_AUDIO_INFO_LAYOUT (info) == GST_AUDIO_LAYOUT_NON_INTERLEAVED) {
+    if (self->gains_count < VOLUME_GAIN_BLOCK_FRAMES) {
+      self->gains = g_realloc (self->gains,
+          sizeof (gdouble) * VOLUME_GAIN_BLOCK_FRAMES);
+      self->gains_count = VOLUME_GAIN_BLOCK_FRAMES;
+    }
+    gains = self->gains;
+
+    for (c = 0; c < channels; c++) {
+      guint8 *plane = data + c * n_frames * width;
+      gdouble gain = cv ? cv[c] : 1.0;
+
+      for (start = 0; start < n_frames; start += VOLUME_GAIN_BLOCK_FRAMES) {
+        len = MIN (VOLUME_GAIN_BLOCK_FRAMES, n_frames - start);
+        for (i = 0; i < len; i++)
+          gains[i] = volumes[start + i] * gain;
+        self->process_controlled (self, plane + start * width, gains, 1,
+            len * width);
+      }
+    }
+    return;
+  }
+
+  if (self->gains_count < VOLUME_GAIN_BLOCK_FRAMES * channels) {
+    self->gains = g_realloc (self->gains,
+        sizeof (gdouble) * VOLUME_GAIN_BLOCK_FRAMES * channels);
+    self->gains_count = VOLUME_GAIN_BLOCK_FRAMES * channels;
+  }
+
+  for (start = 0; start < n_frames; start += VOLUME_GAIN_BLOCK_FRAMES) {
+    len = MIN (VOLUME_GAIN_BLOCK_FRAMES, n_frames - start);
+    gains = self->gains;
+
+    if (cv) {
+      for (i = 0; i < len; i++) {
+        for (c = 0; c < channels; c++)
+          *gains++ = volumes[start + i] * cv[c];
+      }
+    } else {
+      for (i = 0; i < len; i++) {
+        for (c = 0; c < channels; c++)
+          *gains++ = volumes[start + i];
+      }
+    }
+
+    self->process_controlled (self, data + start * bpf, self->gains, 1,
+        len * bpf);
+  }
+}
+
 /* GstBaseTransform vmethod implementations */
 
 /* get notified of caps and plug in the correct process function */
@@ -656,6 +843,7 @@ volume_setup (GstAudioFilter * filter, const GstAudioInfo * info)
   mute = self->mute;
   GST_OBJECT_UNLOCK (self);
 
+  volume_update_channel_volumes (self, info);
   res = volume_update_volume (self, info, volume, mute);
   if (!res) {
     GST_ELEMENT_ERROR (self, CORE, NEGOTIATION,
@@ -679,6 +867,12 @@ volume_stop (GstBaseTransform * base)
   self->mutes = NULL;
   self->mutes_count = 0;
 
+  g_free (self->gains);
+  self->gains = NULL;
+  self->gains_count = 0;
+
+  self->ramp_pending = FALSE;
+
   return GST_CALL_PARENT_WITH_DEFAULT (GST_BASE_TRANSFORM_CLASS, stop, (base),
       TRUE);
 }
@@ -689,7 +883,7 @@ volume_before_transform (GstBaseTransform * base, GstBuffer * buffer)
   GstClockTime timestamp;
   GstVolume *self = GST_VOLUME (base);
   gdouble volume;
-  gboolean mute;
+  gboolean mute, ramp, channel_volumes_changed;
 
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   timestamp =
@@ -705,9 +899,24 @@ volume_before_transform (GstBaseTransform * base, GstBuffer * buffer)
   GST_OBJECT_LOCK (self);
   volume = self->volume;
   mute = self->mute;
+  ramp = self->ramp;
+  channel_volumes_changed = self->channel_volumes_changed;
   GST_OBJECT_UNLOCK (self);
 
-  if ((volume != self->current_volume) || (mute != self->current_mute)) {
+  if (channel_volumes_changed)
+    volume_update_channel_volumes (self, GST_AUDIO_FILTER_INFO (self));
+
+  if ((volume != self->current_volume) || (mute != self->current_mute)
+      || channel_volumes_changed) {
+    gdouble current = self->current_mute ? 0.0 : self->current_volume;
+
+    /* start the ramp from where the last buffer ended */
+    if (ramp && self->negotiated && current != (mute ? 0.0 : volume)
+        && !gst_object_has_active_control_bindings (GST_OBJECT (self))) {
+      self->ramp_pending = TRUE;
+      self->ramp_from = current;
+    }
+
     /* the volume or mute was updated, update our internal state before
      * we continue processing. */
     volume_update_volume (self, GST_AUDIO_FILTER_INFO (self), volume, mute);
@@ -725,15 +934,29 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
   GstVolume *self = GST_VOLUME (base);
   GstMapInfo map;
   GstClockTime ts;
+  gboolean ramp;
+  gint width, channels;
+  guint nsamples;
 
   if (G_UNLIKELY (!self->negotiated))
     goto not_negotiated;
 
-  /* don't process data with GAP */
+  /* don't process data with GAP, a pending ramp is kept for the next
+   * buffer with data */
   if (GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_GAP))
     return GST_FLOW_OK;
 
+  /* a ramp only ever covers a single buffer */
+  ramp = self->ramp_pending;
+  if (G_UNLIKELY (ramp)) {
+    self->ramp_pending = FALSE;
+    volume_update_passthrough (self);
+  }
+
   gst_buffer_map (outbuf, &map, GST_MAP_READWRITE);
+  width = GST_AUDIO_FORMAT_INFO_WIDTH (filter->info.finfo) / 8;
+  channels = GST_AUDIO_INFO_CHANNELS (&filter->info);
+  nsamples = map.size / (width * channels);
   ts = GST_BUFFER_TIMESTAMP (outbuf);
   ts = gst_segment_to_stream_time (&base->segment, GST_FORMAT_TIME, ts);
 
@@ -745,9 +968,6 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
 
     if (mute_cb || (volume_cb && !self->current_mute)) {
       gint rate = GST_AUDIO_INFO_RATE (&filter->info);
-      gint width = GST_AUDIO_FORMAT_INFO_WIDTH (filter->info.finfo) / 8;
-      gint channels = GST_AUDIO_INFO_CHANNELS (&filter->info);
-      guint nsamples = map.size / (width * channels);
       GstClockTime interval = gst_util_uint64_scale_int (1, GST_SECOND, rate);
       gboolean have_mutes = FALSE;
       gboolean have_volumes = FALSE;
@@ -757,10 +977,7 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
         self->mutes_count = nsamples;
       }
 
-      if (self->volumes_count < nsamples) {
-        self->volumes = g_realloc (self->volumes, sizeof (gdouble) * nsamples);
-        self->volumes_count = nsamples;
-      }
+      volume_ensure_volumes (self, nsamples);
 
       if (volume_cb && self->volumes) {
         have_volumes =
@@ -785,7 +1002,7 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
         self->mutes_count = 0;
       }
 
-      self->process_controlled (self, map.data, self->volumes, channels,
+      volume_process_gains (self, map.data, self->volumes, channels,
           map.size);
 
       goto done;
@@ -794,9 +1011,18 @@ volume_transform_ip (GstBaseTransform * base, GstBuffer * outbuf)
     }
   }
 
-  if (self->current_volume == 0.0 || self->current_mute) {
+  if (ramp) {
+    volume_ensure_volumes (self, nsamples);
+    volume_fill_ramp (self->volumes, self->ramp_from,
+        self->current_mute ? 0.0 : self->current_volume, nsamples);
+    volume_process_gains (self, map.data, self->volumes, channels, map.size);
+  } else if (self->current_volume == 0.0 || self->current_mute) {
     orc_memset (map.data, 0, map.size);
     GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_GAP);
+  } else if (self->current_channel_volumes) {
+    volume_ensure_volumes (self, nsamples);
+    volume_orc_memset_f64 (self->volumes, self->current_volume, nsamples);
+    volume_process_gains (self, map.data, self->volumes, channels, map.size);
   } else if (self->current_volume != 1.0) {
     self->process (self, map.data, map.size);
   }
@@ -832,6 +1058,25 @@ volume_set_property (GObject * object, guint prop_id, const GValue * value,
       self->volume = g_value_get_double (value);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_CHANNEL_VOLUMES:{
+      guint i, n = gst_value_array_get_size (value);
+
+      GST_OBJECT_LOCK (self);
+      g_free (self->channel_volumes);
+      self->channel_volumes = g_new (gdouble, MAX (n, 1));
+      for (i = 0; i < n; i++)
+        self->channel_volumes[i] =
+            g_value_get_double (gst_value_array_get_value (value, i));
+      self->n_channel_volumes = n;
+      self->channel_volumes_changed = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    }
+    case PROP_RAMP:
+      GST_OBJECT_LOCK (self);
+      self->ramp = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -855,6 +1100,25 @@ volume_get_property (GObject * object, guint prop_id, GValue * value,
       g_value_set_double (value, self->volume);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_CHANNEL_VOLUMES:{
+      GValue v = G_VALUE_INIT;
+      guint i;
+
+      g_value_init (&v, G_TYPE_DOUBLE);
+      GST_OBJECT_LOCK (self);
+      for (i = 0; i < self->n_channel_volumes; i++) {
+        g_value_set_double (&v, self->channel_volumes[i]);
+        gst_value_array_append_value (value, &v);
+      }
+      GST_OBJECT_UNLOCK (self);
+      g_value_unset (&v);
+      break;
+    }
+    case PROP_RAMP:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->ramp);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -64,6 +64,22 @@ struct _GstVolume {
   guint mutes_count;
   gdouble *volumes;
   guint volumes_count;
+
+  /* per-channel gains on top of the volume, object lock */
+  gdouble *channel_volumes;
+  guint n_channel_volumes;
+  gboolean channel_volumes_changed;
+  gboolean ramp;
+
+  /* gains for the negotiated channels, NULL if they are all 1.0 */
+  gdouble *current_channel_volumes;
+  /* per-sample gains for one block of frames */
+  gdouble *gains;
+  guint gains_count;
+
+  /* ramp from this gain to the current one over the next buffer */
+  gboolean ramp_pending;
+  gdouble ramp_from;
 };
 
 GST_ELEMENT_REGISTER_DECLARE (volume);
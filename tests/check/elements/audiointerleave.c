@@ -673,6 +673,123 @@ GST_START_TEST (test_audiointerleave_2ch_pipeline_non_audiointerleaved)
 
 GST_END_TEST;
 
+static void
+sink_handoff_float32_planar (GstElement * element, GstBuffer * buffer,
+    GstPad * pad, gpointer user_data)
+{
+  GstAudioMeta *meta;
+  GstAudioBuffer abuf;
+  gfloat *left, *right;
+  gint i;
+
+  fail_unless (GST_IS_BUFFER (buffer));
+
+  meta = gst_buffer_get_audio_meta (buffer);
+  fail_unless (meta != NULL);
+  fail_unless_equals_int (GST_AUDIO_INFO_LAYOUT (&meta->info),
+      GST_AUDIO_LAYOUT_NON_INTERLEAVED);
+  fail_unless_equals_int (GST_AUDIO_INFO_CHANNELS (&meta->info), 2);
+
+  /* one plane per input, taken over without copying */
+  fail_unless_equals_int (gst_buffer_n_memory (buffer), 2);
+
+  fail_unless (gst_audio_buffer_map (&abuf, &meta->info, buffer,
+          GST_MAP_READ));
+  fail_unless_equals_int (abuf.n_planes, 2);
+  left = abuf.planes[0];
+  right = abuf.planes[1];
+  for (i = 0; i < abuf.n_samples; i++) {
+    fail_unless_equals_float (left[i], -1.0);
+    fail_unless_equals_float (right[i], 1.0);
+  }
+  gst_audio_buffer_unmap (&abuf);
+
+  have_data += gst_buffer_get_size (buffer);
+}
+
+GST_START_TEST (test_audiointerleave_2ch_pipeline_planar)
+{
+  GstElement *pipeline, *src1, *src2, *interleave, *capsfilter, *sink;
+  GstPad *sinkpad0, *sinkpad1, *tmp;
+  GstCaps *caps;
+  GstMessage *msg;
+
+  have_data = 0;
+
+  pipeline = (GstElement *) gst_pipeline_new ("pipeline");
+  fail_unless (pipeline != NULL);
+
+  src1 = gst_element_factory_make ("fakesrc", "src1");
+  fail_unless (src1 != NULL);
+  g_object_set (src1, "num-buffers", 4, "sizetype", 2,
+      "sizemax", (int) 48000 * sizeof (gfloat),
+      "datarate", (int) 48000 * sizeof (gfloat),
+      "signal-handoffs", TRUE, "format", GST_FORMAT_TIME, NULL);
+  g_signal_connect (src1, "handoff",
+      G_CALLBACK (src_handoff_float32_audiointerleaved), GINT_TO_POINTER (0));
+  gst_bin_add (GST_BIN (pipeline), src1);
+
+  src2 = gst_element_factory_make ("fakesrc", "src2");
+  fail_unless (src2 != NULL);
+  g_object_set (src2, "num-buffers", 4, "sizetype", 2,
+      "sizemax", (int) 48000 * sizeof (gfloat),
+      "datarate", (int) 48000 * sizeof (gfloat),
+      "signal-handoffs", TRUE, "format", GST_FORMAT_TIME, NULL);
+  g_signal_connect (src2, "handoff",
+      G_CALLBACK (src_handoff_float32_audiointerleaved), GINT_TO_POINTER (1));
+  gst_bin_add (GST_BIN (pipeline), src2);
+
+  interleave = gst_element_factory_make ("audiointerleave", "audiointerleave");
+  fail_unless (interleave != NULL);
+  gst_bin_add (GST_BIN (pipeline), gst_object_ref (interleave));
+
+  sinkpad0 = gst_element_request_pad_simple (interleave, "sink_%u");
+  fail_unless (sinkpad0 != NULL);
+  tmp = gst_element_get_static_pad (src1, "src");
+  fail_unless (gst_pad_link (tmp, sinkpad0) == GST_PAD_LINK_OK);
+  gst_object_unref (tmp);
+
+  sinkpad1 = gst_element_request_pad_simple (interleave, "sink_%u");
+  fail_unless (sinkpad1 != NULL);
+  tmp = gst_element_get_static_pad (src2, "src");
+  fail_unless (gst_pad_link (tmp, sinkpad1) == GST_PAD_LINK_OK);
+  gst_object_unref (tmp);
+
+  capsfilter = gst_element_factory_make ("capsfilter", "capsfilter");
+  fail_unless (capsfilter != NULL);
+  caps = gst_caps_from_string ("audio/x-raw, layout=(string)non-interleaved");
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  gst_bin_add (GST_BIN (pipeline), capsfilter);
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+  fail_unless (sink != NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (sink_handoff_float32_planar),
+      NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+
+  fail_unless (gst_element_link_many (interleave, capsfilter, sink, NULL));
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  msg = gst_bus_poll (GST_ELEMENT_BUS (pipeline), GST_MESSAGE_EOS, -1);
+  gst_message_unref (msg);
+
+  /* 48000 samples per buffer * 2 sources * 4 buffers */
+  fail_unless (have_data == 48000 * 2 * 4 * sizeof (gfloat));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_element_release_request_pad (interleave, sinkpad0);
+  gst_object_unref (sinkpad0);
+  gst_element_release_request_pad (interleave, sinkpad1);
+  gst_object_unref (sinkpad1);
+  gst_object_unref (interleave);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_audiointerleave_2ch_pipeline_input_chanpos)
 {
   GstElement *pipeline, *queue, *src1, *src2, *interleave, *sink;
@@ -1117,6 +1234,7 @@ audiointerleave_suite (void)
   tcase_add_test (tc_chain, test_audiointerleave_2ch_pipeline_audiointerleaved);
   tcase_add_test (tc_chain,
       test_audiointerleave_2ch_pipeline_non_audiointerleaved);
+  tcase_add_test (tc_chain, test_audiointerleave_2ch_pipeline_planar);
   tcase_add_test (tc_chain, test_audiointerleave_2ch_pipeline_input_chanpos);
   tcase_add_test (tc_chain, test_audiointerleave_2ch_pipeline_custom_chanpos);
   tcase_add_test (tc_chain, test_audiointerleave_2ch_pipeline_no_chanpos);
@@ -2220,6 +2220,169 @@ GST_START_TEST (test_qos_message_live)
 
 GST_END_TEST;
 
+GST_START_TEST (test_mix_threads)
+{
+  static const char *caps_str = "audio/x-raw, format=(string)S16LE, "
+      "rate=(int)1000, channels=(int)1, layout=(string)interleaved";
+  GstHarness *h[8];
+  GstBuffer *b;
+  GstMapInfo map;
+  gint i;
+
+  h[0] = gst_harness_new_with_padnames ("audiomixer", "sink_0", "src");
+  g_object_set (h[0]->element, "output-buffer-duration", GST_SECOND,
+      "max-threads", 4, NULL);
+  for (i = 1; i < G_N_ELEMENTS (h); i++) {
+    gchar *name = g_strdup_printf ("sink_%d", i);
+
+    h[i] = gst_harness_new_with_element (h[0]->element, name, NULL);
+    g_free (name);
+  }
+
+  gst_harness_set_caps_str (h[0], caps_str, caps_str);
+  for (i = 1; i < G_N_ELEMENTS (h); i++)
+    gst_harness_set_src_caps_str (h[i], caps_str);
+
+  /* every pad adds i + 1 to both bytes of each sample */
+  for (i = 0; i < G_N_ELEMENTS (h); i++)
+    fail_unless_equals_int (gst_harness_push (h[i], new_buffer (2000, i + 1, 0,
+                GST_SECOND, 0)), GST_FLOW_OK);
+
+  b = gst_harness_pull (h[0]);
+  fail_unless_equals_int64 (GST_BUFFER_PTS (b), 0);
+  fail_unless_equals_int64 (GST_BUFFER_DURATION (b), GST_SECOND);
+
+  gst_buffer_map (b, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 2000);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], 36);
+  gst_buffer_unmap (b, &map);
+  gst_buffer_unref (b);
+
+  for (i = G_N_ELEMENTS (h) - 1; i >= 0; i--)
+    gst_harness_teardown (h[i]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mix_minus)
+{
+  static const char *caps_str = "audio/x-raw, format=(string)S16LE, "
+      "rate=(int)1000, channels=(int)1, layout=(string)interleaved";
+  /* each input adds its value to both bytes of every sample */
+  static const gint values[] = { 1, 2, 4 };
+  GstHarness *h[3], *minus[3];
+  GstBuffer *b;
+  GstMapInfo map;
+  gint i, j;
+
+  h[0] = gst_harness_new_with_padnames ("audiomixer", "sink_0", "src");
+  g_object_set (h[0]->element, "output-buffer-duration", GST_SECOND, NULL);
+  for (i = 1; i < G_N_ELEMENTS (h); i++) {
+    gchar *name = g_strdup_printf ("sink_%d", i);
+
+    h[i] = gst_harness_new_with_element (h[0]->element, name, NULL);
+    g_free (name);
+  }
+  for (i = 0; i < G_N_ELEMENTS (minus); i++) {
+    gchar *name = g_strdup_printf ("minus_%d", i);
+
+    minus[i] = gst_harness_new_with_element (h[0]->element, NULL, name);
+    g_free (name);
+  }
+
+  gst_harness_set_caps_str (h[0], caps_str, caps_str);
+  for (i = 1; i < G_N_ELEMENTS (h); i++)
+    gst_harness_set_src_caps_str (h[i], caps_str);
+
+  for (i = 0; i < G_N_ELEMENTS (h); i++)
+    fail_unless_equals_int (gst_harness_push (h[i], new_buffer (2000,
+                values[i], 0, GST_SECOND, 0)), GST_FLOW_OK);
+
+  b = gst_harness_pull (h[0]);
+  gst_buffer_map (b, &map, GST_MAP_READ);
+  for (j = 0; j < map.size; j++)
+    fail_unless_equals_int (map.data[j], 7);
+  gst_buffer_unmap (b, &map);
+  gst_buffer_unref (b);
+
+  for (i = 0; i < G_N_ELEMENTS (minus); i++) {
+    b = gst_harness_pull (minus[i]);
+    fail_unless_equals_int64 (GST_BUFFER_PTS (b), 0);
+    fail_unless_equals_int64 (GST_BUFFER_DURATION (b), GST_SECOND);
+
+    gst_buffer_map (b, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, 2000);
+    for (j = 0; j < map.size; j++)
+      fail_unless_equals_int (map.data[j], 7 - values[i]);
+    gst_buffer_unmap (b, &map);
+    gst_buffer_unref (b);
+  }
+
+  for (i = G_N_ELEMENTS (minus) - 1; i >= 0; i--)
+    gst_harness_teardown (minus[i]);
+  for (i = G_N_ELEMENTS (h) - 1; i >= 0; i--)
+    gst_harness_teardown (h[i]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_detect_silence)
+{
+  static const char *caps_str = "audio/x-raw, format=(string)S16LE, "
+      "rate=(int)1000, channels=(int)1, layout=(string)interleaved";
+  GstHarness *h0, *h1;
+  GstBuffer *b;
+  GstMapInfo map;
+  gint i;
+
+  h0 = gst_harness_new_with_padnames ("audiomixer", "sink_0", "src");
+  g_object_set (h0->element, "output-buffer-duration", GST_SECOND,
+      "detect-silence", TRUE, NULL);
+  h1 = gst_harness_new_with_element (h0->element, "sink_1", NULL);
+
+  gst_harness_set_caps_str (h0, caps_str, caps_str);
+  gst_harness_set_src_caps_str (h1, caps_str);
+
+  /* only silence: the output is a GAP buffer */
+  fail_unless_equals_int (gst_harness_push (h0, new_buffer (2000, 0, 0,
+              GST_SECOND, 0)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h1, new_buffer (2000, 0, 0,
+              GST_SECOND, 0)), GST_FLOW_OK);
+
+  b = gst_harness_pull (h0);
+  fail_unless_equals_int64 (GST_BUFFER_PTS (b), 0);
+  fail_unless_equals_int64 (GST_BUFFER_DURATION (b), GST_SECOND);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (b, GST_BUFFER_FLAG_GAP));
+  gst_buffer_map (b, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 2000);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], 0);
+  gst_buffer_unmap (b, &map);
+  gst_buffer_unref (b);
+
+  /* one pad is not silent anymore */
+  fail_unless_equals_int (gst_harness_push (h0, new_buffer (2000, 1,
+              GST_SECOND, GST_SECOND, 0)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h1, new_buffer (2000, 0,
+              GST_SECOND, GST_SECOND, 0)), GST_FLOW_OK);
+
+  b = gst_harness_pull (h0);
+  fail_unless_equals_int64 (GST_BUFFER_PTS (b), GST_SECOND);
+  fail_if (GST_BUFFER_FLAG_IS_SET (b, GST_BUFFER_FLAG_GAP));
+  gst_buffer_map (b, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, 2000);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], 1);
+  gst_buffer_unmap (b, &map);
+  gst_buffer_unref (b);
+
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h0);
+}
+
+GST_END_TEST;
+
 static Suite *
 audiomixer_suite (void)
 {
@@ -2249,6 +2412,9 @@ audiomixer_suite (void)
   tcase_add_test (tc_chain, test_segment_base_handling);
   tcase_add_test (tc_chain, test_sinkpad_property_controller);
   tcase_add_test (tc_chain, test_qos_message_live);
+  tcase_add_test (tc_chain, test_mix_threads);
+  tcase_add_test (tc_chain, test_mix_minus);
+  tcase_add_test (tc_chain, test_detect_silence);
   tcase_add_checked_fixture (tc_chain, test_setup, test_teardown);
   tcase_add_test (tc_chain, test_change_output_caps);
   tcase_add_test (tc_chain, test_change_output_caps_mid_output_buffer);
@@ -452,6 +452,91 @@ GST_START_TEST (test_large_discont)
 
 GST_END_TEST;
 
+GST_START_TEST (test_coalesce)
+{
+  GstElement *audiorate;
+  GstCaps *caps, *ref_caps;
+  GstPad *srcpad, *sinkpad;
+  GstBuffer *buf;
+  GstStructure *stats;
+  guint64 add, add_count, coalesced;
+  gfloat sample;
+
+  audiorate = gst_check_setup_element ("audiorate");
+  g_object_set (audiorate, "coalesce", TRUE, "tolerance", (guint64) 0, NULL);
+  ref_caps = gst_caps_new_empty_simple ("timestamp/x-test");
+  caps = gst_caps_new_simple ("audio/x-raw",
+      "format", G_TYPE_STRING, GST_AUDIO_NE (F32),
+      "layout", G_TYPE_STRING, "interleaved",
+      "channels", G_TYPE_INT, 1, "rate", G_TYPE_INT, 44100, NULL);
+
+  srcpad = gst_check_setup_src_pad (audiorate, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (audiorate, &sinktemplate);
+
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_check_setup_events (srcpad, audiorate, caps, GST_FORMAT_TIME);
+
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (audiorate,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "failed to set audiorate playing");
+
+  /* 10ms of audio at 0 and at 20ms, leaving a gap of 441 samples */
+  buf = gst_buffer_new_and_alloc (441 * sizeof (gfloat));
+  gst_buffer_memset (buf, 0, 0x3f, 441 * sizeof (gfloat));
+  GST_BUFFER_TIMESTAMP (buf) = 0;
+  gst_pad_push (srcpad, buf);
+
+  buf = gst_buffer_new_and_alloc (441 * sizeof (gfloat));
+  gst_buffer_memset (buf, 0, 0x3f, 441 * sizeof (gfloat));
+  GST_BUFFER_TIMESTAMP (buf) = 20 * GST_MSECOND;
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_RESYNC);
+  gst_buffer_add_reference_timestamp_meta (buf, ref_caps, GST_SECOND,
+      GST_CLOCK_TIME_NONE);
+  gst_pad_push (srcpad, buf);
+
+  /* the silence went out together with the second buffer */
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  buf = g_list_nth_data (buffers, 1);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 882 * sizeof (gfloat));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 441);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET_END (buf), 1323);
+  fail_unless_equals_uint64 (GST_BUFFER_TIMESTAMP (buf), 10 * GST_MSECOND);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP));
+
+  /* flags and metas of the input buffer are kept */
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_RESYNC));
+  fail_unless (gst_buffer_get_reference_timestamp_meta (buf, ref_caps));
+
+  gst_buffer_extract (buf, 0, &sample, sizeof (gfloat));
+  fail_unless_equals_float (sample, 0.0);
+  gst_buffer_extract (buf, 881 * sizeof (gfloat), &sample, sizeof (gfloat));
+  fail_unless (sample != 0.0);
+
+  g_object_get (audiorate, "stats", &stats, NULL);
+  fail_unless (gst_structure_get (stats, "add", G_TYPE_UINT64, &add,
+          "add-count", G_TYPE_UINT64, &add_count,
+          "coalesced", G_TYPE_UINT64, &coalesced, NULL));
+  fail_unless_equals_uint64 (add, 441);
+  fail_unless_equals_uint64 (add_count, 1);
+  fail_unless_equals_uint64 (coalesced, 1);
+  gst_structure_free (stats);
+
+  gst_element_set_state (audiorate, GST_STATE_NULL);
+  gst_caps_unref (caps);
+  gst_caps_unref (ref_caps);
+
+  gst_check_drop_buffers ();
+  gst_check_teardown_sink_pad (audiorate);
+  gst_check_teardown_src_pad (audiorate);
+
+  gst_object_unref (audiorate);
+}
+
+GST_END_TEST;
 
 #define FIRST_CAPS \
   "audio/x-raw,format=S16LE,layout=interleaved,rate=48000,channels=1"
@@ -580,6 +665,7 @@ audiorate_suite (void)
   tcase_add_test (tc_chain, test_perfect_stream_inject90);
   tcase_add_test (tc_chain, test_perfect_stream_drop45_inject25);
   tcase_add_test (tc_chain, test_large_discont);
+  tcase_add_test (tc_chain, test_coalesce);
   tcase_add_test (tc_chain, test_rate_change_down);
 
   return s;
@@ -24,6 +24,8 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
 #include <gst/audio/audio.h>
@@ -297,6 +299,59 @@ GST_START_TEST (test_layout)
 
 GST_END_TEST;
 
+GST_START_TEST (test_repeat_buffers)
+{
+  GstHarness *h;
+  GstBuffer *buf, *prev = NULL;
+  guint i, s;
+  guint k = 0;
+
+  h = gst_harness_new ("audiotestsrc");
+  gst_harness_set_sink_caps_str (h, "audio/x-raw, format = (string) "
+      GST_AUDIO_NE (S16) ", rate = (int) 44100, channels = (int) 2, "
+      "layout = (string) interleaved");
+  /* 441 Hz repeats every 100 samples at 44100 Hz */
+  g_object_set (h->element, "freq", 441.0, "samplesperbuffer", 200,
+      "repeat-buffers", TRUE, NULL);
+  gst_harness_play (h);
+
+  for (i = 0; i < 5; i++) {
+    GstMapInfo map;
+    gint16 *data;
+
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+
+    /* all buffers after the first one share the same memory */
+    if (i > 1)
+      fail_unless (gst_buffer_peek_memory (buf, 0) ==
+          gst_buffer_peek_memory (prev, 0));
+
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.size, 200 * 2 * sizeof (gint16));
+    data = (gint16 *) map.data;
+    for (s = 0; s < 200; s++) {
+      gint16 expected;
+
+      k++;
+      expected = (gint16) (sin (2.0 * G_PI * 441.0 * k / 44100.0) * 0.8 *
+          32767.0);
+      fail_unless (ABS (data[2 * s] - expected) <= 1);
+      fail_unless_equals_int (data[2 * s], data[2 * s + 1]);
+    }
+    gst_buffer_unmap (buf, &map);
+
+    if (prev)
+      gst_buffer_unref (prev);
+    prev = buf;
+  }
+  gst_buffer_unref (prev);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 audiotestsrc_suite (void)
 {
@@ -306,6 +361,7 @@ audiotestsrc_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_all_waves);
   tcase_add_test (tc_chain, test_layout);
+  tcase_add_test (tc_chain, test_repeat_buffers);
 
   return s;
 }
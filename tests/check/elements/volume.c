@@ -76,6 +76,13 @@ static GstPad *mysrcpad, *mysinkpad;
     "rate = (int) 44100,"               \
     "layout = (string) interleaved"
 
+#define VOLUME_CAPS_STRING_S16_STEREO   \
+    "audio/x-raw, "                     \
+    "format = (string) "FORMATS3", "   \
+    "channels = (int) 2, "              \
+    "rate = (int) 44100,"               \
+    "layout = (string) interleaved"
+
 #define VOLUME_CAPS_STRING_S24          \
     "audio/x-raw, "                     \
     "format = (string) "FORMATS4", "   \
@@ -1864,6 +1871,122 @@ GST_START_TEST (test_controller_defaults_at_ts0)
 
 GST_END_TEST;
 
+GST_START_TEST (test_channel_volumes_s16)
+{
+  GstElement *volume;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  gint16 in[6] = { 16384, 16384, -256, -256, 20000, -20000 };
+  gint16 out[6] = { 8192, 32767, -128, -512, 10000, -32768 };
+  GValue array = G_VALUE_INIT;
+  GValue val = G_VALUE_INIT;
+  GstMapInfo map;
+
+  volume = setup_volume ();
+
+  g_value_init (&array, GST_TYPE_ARRAY);
+  g_value_init (&val, G_TYPE_DOUBLE);
+  g_value_set_double (&val, 0.5);
+  gst_value_array_append_value (&array, &val);
+  g_value_set_double (&val, 2.0);
+  gst_value_array_append_value (&array, &val);
+  g_object_set_property (G_OBJECT (volume), "channel-volumes", &array);
+  g_value_unset (&val);
+  g_value_unset (&array);
+
+  fail_unless (gst_element_set_state (volume,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  inbuffer = gst_buffer_new_and_alloc (12);
+  gst_buffer_fill (inbuffer, 0, in, 12);
+  caps = gst_caps_from_string (VOLUME_CAPS_STRING_S16_STEREO);
+  gst_check_setup_events (mysrcpad, volume, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 1);
+  fail_if ((outbuffer = (GstBuffer *) buffers->data) == NULL);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, out, 12) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  /* cleanup */
+  cleanup_volume (volume);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ramp_f32)
+{
+  GstElement *volume;
+  GstBuffer *inbuffer, *outbuffer;
+  GstCaps *caps;
+  gfloat in[4] = { 1.0, 1.0, 1.0, 1.0 };
+  gfloat ramp[4] = { 1.0, 0.75, 0.5, 0.25 };
+  gfloat silence[4] = { 0.0, 0.0, 0.0, 0.0 };
+  GstMapInfo map;
+
+  volume = setup_volume ();
+  g_object_set (volume, "ramp", TRUE, NULL);
+  fail_unless (gst_element_set_state (volume,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VOLUME_CAPS_STRING_F32);
+  gst_check_setup_events (mysrcpad, volume, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* unity gain, passed through */
+  inbuffer = gst_buffer_new_and_alloc (16);
+  gst_buffer_fill (inbuffer, 0, in, 16);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  /* fades out over the next buffer with data, a GAP buffer doesn't
+   * consume the ramp */
+  g_object_set (volume, "mute", TRUE, NULL);
+  inbuffer = gst_buffer_new_and_alloc (16);
+  gst_buffer_fill (inbuffer, 0, silence, 16);
+  GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_GAP);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  inbuffer = gst_buffer_new_and_alloc (16);
+  gst_buffer_fill (inbuffer, 0, in, 16);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  inbuffer = gst_buffer_new_and_alloc (16);
+  gst_buffer_fill (inbuffer, 0, in, 16);
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+
+  fail_unless_equals_int (g_list_length (buffers), 4);
+
+  outbuffer = g_list_nth_data (buffers, 0);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, in, 16) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  outbuffer = g_list_nth_data (buffers, 1);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (outbuffer, GST_BUFFER_FLAG_GAP));
+
+  outbuffer = g_list_nth_data (buffers, 2);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  GST_INFO ("expected %+1.4f %+1.4f %+1.4f %+1.4f  real %+1.4f %+1.4f %+1.4f "
+      "%+1.4f", ramp[0], ramp[1], ramp[2], ramp[3], ((gfloat *) map.data)[0],
+      ((gfloat *) map.data)[1], ((gfloat *) map.data)[2],
+      ((gfloat *) map.data)[3]);
+  fail_unless (memcmp (map.data, ramp, 16) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  outbuffer = g_list_nth_data (buffers, 3);
+  gst_buffer_map (outbuffer, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data, silence, 16) == 0);
+  gst_buffer_unmap (outbuffer, &map);
+
+  /* cleanup */
+  cleanup_volume (volume);
+}
+
+GST_END_TEST;
 
 static Suite *
 volume_suite (void)
@@ -1908,6 +2031,8 @@ volume_suite (void)
   tcase_add_test (tc_chain, test_controller_usability);
   tcase_add_test (tc_chain, test_controller_processing);
   tcase_add_test (tc_chain, test_controller_defaults_at_ts0);
+  tcase_add_test (tc_chain, test_channel_volumes_s16);
+  tcase_add_test (tc_chain, test_ramp_f32);
 
   return s;
 }
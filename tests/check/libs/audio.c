@@ -987,6 +987,40 @@ GST_START_TEST (test_fill_silence)
 
 GST_END_TEST;
 
+GST_START_TEST (test_audio_quantize_dither)
+{
+  GstAudioDitherMethod dither;
+  GstAudioNoiseShapingMethod ns;
+  GstAudioQuantize *quant;
+  gint32 in[3 * 256], out[3 * 256];
+  gpointer inp[1] = { in }, outp[1] = { out };
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = (i % 3 - 1) * (i << 16);
+
+  for (dither = GST_AUDIO_DITHER_NONE; dither <= GST_AUDIO_DITHER_TPDF_HF;
+      dither++) {
+    for (ns = GST_AUDIO_NOISE_SHAPING_NONE; ns <= GST_AUDIO_NOISE_SHAPING_HIGH;
+        ns++) {
+      quant = gst_audio_quantize_new (dither, ns, GST_AUDIO_QUANTIZE_FLAG_NONE,
+          GST_AUDIO_FORMAT_S32, 3, 1 << 16);
+      fail_unless (quant != NULL);
+
+      gst_audio_quantize_samples (quant, inp, outp, 256);
+
+      /* all samples must be quantized and stay close to the input */
+      for (i = 0; i < G_N_ELEMENTS (out); i++) {
+        fail_unless_equals_int (out[i] & 0xffff, 0);
+        fail_unless (ABS ((gint64) out[i] - in[i]) < (64 << 16));
+      }
+      gst_audio_quantize_free (quant);
+    }
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_stream_align)
 {
   GstAudioStreamAlign *align;
@@ -1167,6 +1201,76 @@ GST_START_TEST (test_stream_align)
 
 GST_END_TEST;
 
+GST_START_TEST (test_stream_align_drift)
+{
+  GstAudioStreamAlign *align;
+  GstStructure *stats;
+  guint i;
+  GstClockTime timestamp;
+  guint64 disconts, max_drift, time_since_discont;
+  gint64 drift, drift_estimate;
+  gboolean discont;
+
+  align = gst_audio_stream_align_new (1000, 40 * GST_MSECOND, 0);
+  gst_audio_stream_align_set_drift_window (align, 4);
+  fail_unless_equals_int (gst_audio_stream_align_get_drift_window (align), 4);
+
+  for (i = 0; i < 10; i++) {
+    timestamp = 10 * GST_MSECOND * i;
+    discont = gst_audio_stream_align_process (align, i == 0, timestamp, 10,
+        NULL, NULL, NULL);
+    fail_unless (discont == (i == 0));
+    fail_unless_equals_int64 (gst_audio_stream_align_get_drift (align), 0);
+  }
+
+  /* jitter of 4ms on every other buffer averages out to 2ms */
+  for (i = 10; i < 20; i++) {
+    timestamp = 10 * GST_MSECOND * i;
+    if (i % 2 == 0)
+      timestamp += 4 * GST_MSECOND;
+    discont = gst_audio_stream_align_process (align, FALSE, timestamp, 10,
+        NULL, NULL, NULL);
+    fail_unless (!discont);
+    fail_unless_equals_int64 (gst_audio_stream_align_get_drift (align),
+        i % 2 == 0 ? 4 * GST_MSECOND : 0);
+  }
+  fail_unless_equals_int64 (gst_audio_stream_align_get_drift_estimate (align),
+      2 * GST_MSECOND);
+
+  /* going back in time gives negative drift */
+  discont = gst_audio_stream_align_process (align, FALSE,
+      10 * GST_MSECOND * 20 - 5 * GST_MSECOND, 10, NULL, NULL, NULL);
+  fail_unless (!discont);
+  fail_unless_equals_int64 (gst_audio_stream_align_get_drift (align),
+      -5 * GST_MSECOND);
+
+  /* jumping ahead beyond the threshold resyncs and restarts tracking */
+  discont = gst_audio_stream_align_process (align, FALSE,
+      10 * GST_MSECOND * 21 + 100 * GST_MSECOND, 10, NULL, NULL, NULL);
+  fail_unless (discont);
+
+  stats = gst_audio_stream_align_get_stats (align);
+  fail_unless (gst_structure_has_name (stats,
+          "application/x-gst-audio-stream-align-stats"));
+  fail_unless (gst_structure_get_uint64 (stats, "disconts", &disconts));
+  fail_unless (gst_structure_get_int64 (stats, "drift", &drift));
+  fail_unless (gst_structure_get_int64 (stats, "drift-estimate",
+          &drift_estimate));
+  fail_unless (gst_structure_get_uint64 (stats, "max-drift", &max_drift));
+  fail_unless (gst_structure_get_uint64 (stats, "time-since-discont",
+          &time_since_discont));
+  fail_unless_equals_uint64 (disconts, 1);
+  fail_unless_equals_int64 (drift, 0);
+  fail_unless_equals_int64 (drift_estimate, 0);
+  fail_unless_equals_uint64 (max_drift, 100 * GST_MSECOND);
+  fail_unless_equals_uint64 (time_since_discont, 10 * GST_MSECOND);
+  gst_structure_free (stats);
+
+  gst_audio_stream_align_free (align);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_stream_align_reverse)
 {
   GstAudioStreamAlign *align;
@@ -1611,7 +1715,9 @@ audio_suite (void)
   tcase_add_test (tc_chain, test_audio_format_s8);
   tcase_add_test (tc_chain, test_audio_format_u8);
   tcase_add_test (tc_chain, test_fill_silence);
+  tcase_add_test (tc_chain, test_audio_quantize_dither);
   tcase_add_test (tc_chain, test_stream_align);
+  tcase_add_test (tc_chain, test_stream_align_drift);
   tcase_add_test (tc_chain, test_stream_align_reverse);
   tcase_add_test (tc_chain, test_audio_buffer_and_audio_meta);
   tcase_add_test (tc_chain, test_audio_info_from_caps);
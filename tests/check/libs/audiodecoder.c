@@ -74,6 +74,7 @@ struct _GstAudioDecoderTester
   gboolean setoutputformat_on_decoding;
   gboolean output_too_many_frames;
   gboolean delay_decoding;
+  gboolean use_allocate_output;
   GstBuffer *prev_buf;
 };
 
@@ -166,14 +167,23 @@ gst_audio_decoder_tester_handle_frame (GstAudioDecoder * dec,
       /* the output is SE32LE stereo 44100 Hz */
       size = 2 * 4;
       g_assert (size == sizeof (guint64));
-      data = g_malloc0 (size);
+      if (tester->use_allocate_output) {
+        output_buffer = gst_audio_decoder_allocate_output_buffer (dec, size);
+        gst_buffer_memset (output_buffer, 0, 0, size);
+        if (map.size) {
+          g_assert_cmpint (map.size, >=, sizeof (guint64));
+          gst_buffer_fill (output_buffer, 0, map.data, sizeof (guint64));
+        }
+      } else {
+        data = g_malloc0 (size);
 
-      if (map.size) {
-        g_assert_cmpint (map.size, >=, sizeof (guint64));
-        memcpy (data, map.data, sizeof (guint64));
-      }
+        if (map.size) {
+          g_assert_cmpint (map.size, >=, sizeof (guint64));
+          memcpy (data, map.data, sizeof (guint64));
+        }
 
-      output_buffer = gst_buffer_new_wrapped (data, size);
+        output_buffer = gst_buffer_new_wrapped (data, size);
+      }
 
       gst_buffer_unmap (cur_buf, &map);
 
@@ -313,6 +323,172 @@ GST_START_TEST (audiodecoder_playback)
 
 GST_END_TEST;
 
+GST_START_TEST (audiodecoder_pooled_output)
+{
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+  GstAudioDecoderTester *tester = (GstAudioDecoderTester *) h->element;
+  GstStructure *stats;
+  GstBuffer *output;
+  guint64 frames, pooled, allocated;
+  guint64 i;
+
+  tester->use_allocate_output = TRUE;
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    GstBuffer *buffer;
+    GstMapInfo map;
+
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+
+    /* output comes from the negotiated pool and goes back to it */
+    buffer = gst_harness_pull (h);
+    fail_unless (buffer->pool != NULL);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    gst_buffer_unmap (buffer, &map);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (i, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    gst_buffer_unref (buffer);
+  }
+
+  /* a bigger frame than before grows the pool instead of bypassing it */
+  output = gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER
+      (h->element), 64);
+  fail_unless (output->pool != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (output), 64);
+  gst_buffer_unref (output);
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_has_name (stats,
+          "application/x-gst-audio-decoder-stats"));
+  fail_unless (gst_structure_get_uint64 (stats, "frames", &frames));
+  fail_unless (gst_structure_get_uint64 (stats, "pooled-buffers", &pooled));
+  fail_unless (gst_structure_get_uint64 (stats, "allocated-buffers",
+          &allocated));
+  fail_unless_equals_uint64 (frames, NUM_BUFFERS);
+  fail_unless_equals_uint64 (pooled, NUM_BUFFERS + 1);
+  fail_unless_equals_uint64 (allocated, 0);
+  gst_structure_free (stats);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define NUM_HELD_BUFFERS 3
+
+/* growing the pool for a bigger frame while downstream still holds on to
+ * earlier output keeps those buffers valid and later output pooled */
+GST_START_TEST (audiodecoder_pooled_output_held)
+{
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+  GstAudioDecoderTester *tester = (GstAudioDecoderTester *) h->element;
+  GstBuffer *held[NUM_HELD_BUFFERS + 1];
+  GstStructure *stats;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint64 pooled, allocated;
+  guint64 i;
+
+  tester->use_allocate_output = TRUE;
+
+  for (i = 0; i < NUM_HELD_BUFFERS; i++) {
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+    held[i] = gst_harness_pull (h);
+    fail_unless (held[i]->pool != NULL);
+  }
+
+  /* a bigger frame than before */
+  held[NUM_HELD_BUFFERS] =
+      gst_audio_decoder_allocate_output_buffer (GST_AUDIO_DECODER
+      (h->element), 64);
+  fail_unless (held[NUM_HELD_BUFFERS]->pool != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (held[NUM_HELD_BUFFERS]), 64);
+
+  /* later frames are still pooled */
+  fail_unless (gst_harness_push (h,
+          create_test_buffer (NUM_HELD_BUFFERS)) == GST_FLOW_OK);
+  buffer = gst_harness_pull (h);
+  fail_unless (buffer->pool != NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_uint64 (*(guint64 *) map.data, NUM_HELD_BUFFERS);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  /* and the buffers held across the change are untouched */
+  for (i = 0; i < NUM_HELD_BUFFERS; i++) {
+    gst_buffer_map (held[i], &map, GST_MAP_READ);
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    gst_buffer_unmap (held[i], &map);
+  }
+  for (i = 0; i <= NUM_HELD_BUFFERS; i++)
+    gst_buffer_unref (held[i]);
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "pooled-buffers", &pooled));
+  fail_unless (gst_structure_get_uint64 (stats, "allocated-buffers",
+          &allocated));
+  fail_unless_equals_uint64 (pooled, NUM_HELD_BUFFERS + 2);
+  fail_unless_equals_uint64 (allocated, 0);
+  gst_structure_free (stats);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static void
+check_batch_output (GstHarness * h, guint64 first, guint64 count)
+{
+  guint64 i;
+
+  fail_unless_equals_int (count, gst_harness_buffers_in_queue (h));
+  for (i = first; i < first + count; i++) {
+    GstBuffer *buffer = gst_harness_pull (h);
+    GstMapInfo map;
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    gst_buffer_unmap (buffer, &map);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+        gst_util_uint64_scale_round (i, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer),
+        gst_util_uint64_scale_round (1, GST_SECOND, TEST_MSECS_PER_SAMPLE));
+    gst_buffer_unref (buffer);
+  }
+}
+
+GST_START_TEST (audiodecoder_batch_output)
+{
+  GstHarness *h = setup_audiodecodertester (NULL, NULL);
+  GstBufferList *list;
+  guint64 i;
+
+  g_object_set (h->element, "batch-size", 3, NULL);
+
+  /* output is held back until a batch is complete */
+  for (i = 0; i < 8; i++)
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+  check_batch_output (h, 0, 6);
+
+  /* a buffer list is decoded and pushed as a whole */
+  list = gst_buffer_list_new ();
+  gst_buffer_list_add (list, create_test_buffer (8));
+  gst_buffer_list_add (list, create_test_buffer (9));
+  fail_unless (gst_pad_push_list (h->srcpad, list) == GST_FLOW_OK);
+  check_batch_output (h, 6, 4);
+
+  /* serialized events push out what was decoded before them */
+  fail_unless (gst_harness_push (h, create_test_buffer (10)) == GST_FLOW_OK);
+  fail_unless_equals_int (0, gst_harness_buffers_in_queue (h));
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  check_batch_output (h, 10, 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 
 static void
 check_audiodecoder_negotiation (GstHarness * h)
@@ -1144,6 +1320,9 @@ gst_audiodecoder_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, audiodecoder_playback);
+  tcase_add_test (tc, audiodecoder_pooled_output);
+  tcase_add_test (tc, audiodecoder_pooled_output_held);
+  tcase_add_test (tc, audiodecoder_batch_output);
   tcase_add_test (tc, audiodecoder_negotiation_with_buffer);
 
   tcase_add_test (tc, audiodecoder_negotiation_with_gap_event);
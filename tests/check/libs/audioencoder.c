@@ -41,6 +41,8 @@ typedef struct _GstAudioEncoderTesterClass GstAudioEncoderTesterClass;
 struct _GstAudioEncoderTester
 {
   GstAudioEncoder parent;
+
+  gboolean use_allocate_output;
 };
 
 struct _GstAudioEncoderTesterClass
@@ -80,6 +82,7 @@ static GstFlowReturn
 gst_audio_encoder_tester_handle_frame (GstAudioEncoder * enc,
     GstBuffer * buffer)
 {
+  GstAudioEncoderTester *tester = (GstAudioEncoderTester *) enc;
   guint8 *data;
   GstMapInfo map;
   guint64 input_num;
@@ -92,10 +95,16 @@ gst_audio_encoder_tester_handle_frame (GstAudioEncoder * enc,
   input_num = *((guint64 *) map.data);
   gst_buffer_unmap (buffer, &map);
 
-  data = g_malloc (sizeof (guint64));
-  *(guint64 *) data = input_num;
+  if (tester->use_allocate_output) {
+    output_buffer =
+        gst_audio_encoder_allocate_output_buffer (enc, sizeof (guint64));
+    gst_buffer_fill (output_buffer, 0, &input_num, sizeof (guint64));
+  } else {
+    data = g_malloc (sizeof (guint64));
+    *(guint64 *) data = input_num;
 
-  output_buffer = gst_buffer_new_wrapped (data, sizeof (guint64));
+    output_buffer = gst_buffer_new_wrapped (data, sizeof (guint64));
+  }
   GST_BUFFER_PTS (output_buffer) = GST_BUFFER_PTS (buffer);
   GST_BUFFER_DURATION (output_buffer) = GST_BUFFER_DURATION (buffer);
 
@@ -228,6 +237,110 @@ GST_START_TEST (audioencoder_playback)
 
 GST_END_TEST;
 
+GST_START_TEST (audioencoder_pooled_output)
+{
+  GstHarness *h = setup_audioencodertester ();
+  GstAudioEncoderTester *tester = (GstAudioEncoderTester *) h->element;
+  GstStructure *stats;
+  guint64 frames, pooled, allocated;
+  guint64 i;
+
+  tester->use_allocate_output = TRUE;
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    GstBuffer *buffer;
+    GstMapInfo map;
+
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+
+    /* output comes from the negotiated pool and goes back to it */
+    buffer = gst_harness_pull (h);
+    fail_unless (buffer->pool != NULL);
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.size, sizeof (guint64));
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_has_name (stats,
+          "application/x-gst-audio-encoder-stats"));
+  fail_unless (gst_structure_get_uint64 (stats, "frames", &frames));
+  fail_unless (gst_structure_get_uint64 (stats, "pooled-buffers", &pooled));
+  fail_unless (gst_structure_get_uint64 (stats, "allocated-buffers",
+          &allocated));
+  fail_unless_equals_uint64 (frames, NUM_BUFFERS);
+  fail_unless_equals_uint64 (pooled, NUM_BUFFERS);
+  fail_unless_equals_uint64 (allocated, 0);
+  gst_structure_free (stats);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define NUM_HELD_BUFFERS 3
+
+/* growing the pool for a bigger frame while downstream still holds on to
+ * earlier output keeps those buffers valid and later output pooled */
+GST_START_TEST (audioencoder_pooled_output_held)
+{
+  GstHarness *h = setup_audioencodertester ();
+  GstAudioEncoderTester *tester = (GstAudioEncoderTester *) h->element;
+  GstBuffer *held[NUM_HELD_BUFFERS + 1];
+  GstStructure *stats;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint64 pooled, allocated;
+  guint64 i;
+
+  tester->use_allocate_output = TRUE;
+
+  for (i = 0; i < NUM_HELD_BUFFERS; i++) {
+    fail_unless (gst_harness_push (h, create_test_buffer (i)) == GST_FLOW_OK);
+    held[i] = gst_harness_pull (h);
+    fail_unless (held[i]->pool != NULL);
+  }
+
+  /* a bigger frame than before */
+  held[NUM_HELD_BUFFERS] =
+      gst_audio_encoder_allocate_output_buffer (GST_AUDIO_ENCODER
+      (h->element), 64);
+  fail_unless (held[NUM_HELD_BUFFERS]->pool != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (held[NUM_HELD_BUFFERS]), 64);
+
+  /* later frames are still pooled */
+  fail_unless (gst_harness_push (h,
+          create_test_buffer (NUM_HELD_BUFFERS)) == GST_FLOW_OK);
+  buffer = gst_harness_pull (h);
+  fail_unless (buffer->pool != NULL);
+  gst_buffer_map (buffer, &map, GST_MAP_READ);
+  fail_unless_equals_uint64 (*(guint64 *) map.data, NUM_HELD_BUFFERS);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  /* and the buffers held across the change are untouched */
+  for (i = 0; i < NUM_HELD_BUFFERS; i++) {
+    gst_buffer_map (held[i], &map, GST_MAP_READ);
+    fail_unless_equals_uint64 (*(guint64 *) map.data, i);
+    gst_buffer_unmap (held[i], &map);
+  }
+  for (i = 0; i <= NUM_HELD_BUFFERS; i++)
+    gst_buffer_unref (held[i]);
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "pooled-buffers", &pooled));
+  fail_unless (gst_structure_get_uint64 (stats, "allocated-buffers",
+          &allocated));
+  fail_unless_equals_uint64 (pooled, NUM_HELD_BUFFERS + 2);
+  fail_unless_equals_uint64 (allocated, 0);
+  gst_structure_free (stats);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
 
 GST_START_TEST (audioencoder_flush_events)
 {
@@ -403,6 +516,8 @@ gst_audioencoder_suite (void)
 
   suite_add_tcase (s, tc);
   tcase_add_test (tc, audioencoder_playback);
+  tcase_add_test (tc, audioencoder_pooled_output);
+  tcase_add_test (tc, audioencoder_pooled_output_held);
 
   tcase_add_test (tc, audioencoder_tags_before_eos);
   tcase_add_test (tc, audioencoder_events_before_eos);
@@ -107,6 +107,45 @@ GST_START_TEST (test_class_extension)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ringbuffer_stats)
+{
+  GstAudioFooSink *foosink = NULL;
+  GstAudioRingBuffer *ringbuffer;
+  GstStructure *stats;
+  const GValue *histogram;
+  guint underruns = 1;
+
+  foosink = g_object_new (GST_TYPE_AUDIO_FOO_SINK, NULL);
+  fail_unless (foosink != NULL);
+
+  fail_unless (gst_element_set_state (GST_ELEMENT (foosink),
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS);
+
+  ringbuffer = GST_AUDIO_BASE_SINK (foosink)->ringbuffer;
+  fail_unless (ringbuffer != NULL);
+
+  /* disabled by default */
+  fail_unless (gst_audio_ring_buffer_get_stats (ringbuffer) == NULL);
+
+  gst_audio_ring_buffer_set_stats_enabled (ringbuffer, TRUE);
+  stats = gst_audio_ring_buffer_get_stats (ringbuffer);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint (stats, "underruns", &underruns));
+  fail_unless_equals_int (underruns, 0);
+  histogram = gst_structure_get_value (stats, "wakeup-latency");
+  fail_unless (histogram != NULL);
+  fail_unless_equals_int (gst_value_array_get_size (histogram), 16);
+  gst_structure_free (stats);
+
+  gst_audio_ring_buffer_set_stats_enabled (ringbuffer, FALSE);
+  fail_unless (gst_audio_ring_buffer_get_stats (ringbuffer) == NULL);
+
+  gst_element_set_state (GST_ELEMENT (foosink), GST_STATE_NULL);
+  gst_clear_object (&foosink);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 audiosink_suite (void)
@@ -116,6 +155,7 @@ audiosink_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_class_extension);
+  tcase_add_test (tc_chain, test_ringbuffer_stats);
 
   return s;
 }
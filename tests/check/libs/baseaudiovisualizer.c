@@ -65,10 +65,24 @@ static GType gst_test_scope_get_type (void);
 
 G_DEFINE_TYPE (GstTestScope, gst_test_scope, GST_TYPE_AUDIO_VISUALIZER);
 
+/* draws a white pixel into the lower left corner */
+static gboolean
+gst_test_scope_render (GstAudioVisualizer * scope, GstBuffer * audio,
+    GstVideoFrame * video)
+{
+  guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (video, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (video, 0);
+
+  memset (data + (GST_VIDEO_FRAME_HEIGHT (video) - 1) * stride, 0xff, 4);
+
+  return TRUE;
+}
+
 static void
 gst_test_scope_class_init (GstTestScopeClass * g_class)
 {
   GstElementClass *element_class = GST_ELEMENT_CLASS (g_class);
+  GstAudioVisualizerClass *scope_class = GST_AUDIO_VISUALIZER_CLASS (g_class);
 
   gst_element_class_set_static_metadata (element_class, "test scope",
       "Visualization",
@@ -78,6 +92,8 @@ gst_test_scope_class_init (GstTestScopeClass * g_class)
       &gst_test_scope_src_template);
   gst_element_class_add_static_pad_template (element_class,
       &gst_test_scope_sink_template);
+
+  scope_class->render = gst_test_scope_render;
 }
 
 static void
@@ -154,6 +170,84 @@ GST_START_TEST (count_in_out)
 
 GST_END_TEST;
 
+static GList *
+render_frames (guint max_threads)
+{
+  GstElement *elem;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GList *result;
+
+  elem = gst_check_setup_element ("testscope");
+  g_object_set (elem, "shader", GST_AUDIO_VISUALIZER_SHADER_FADE_AND_MOVE_UP,
+      "shade-amount", 0x00101010, "max-threads", max_threads, NULL);
+  srcpad = gst_check_setup_src_pad (elem, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (elem, &sinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  fail_unless (gst_element_set_state (elem,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (CAPS);
+  gst_check_setup_events (srcpad, elem, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_pad_push (srcpad,
+          gst_buffer_new_and_alloc (44100 * 2 * sizeof (gint16)))
+      == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 30);
+  result = buffers;
+  buffers = NULL;
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (elem);
+  gst_check_teardown_sink_pad (elem);
+  gst_check_teardown_element (elem);
+
+  return result;
+}
+
+GST_START_TEST (shader_threads)
+{
+  GList *single, *threaded, *l1, *l2;
+  GstMapInfo map;
+  guint32 pixel;
+  gint i;
+
+  single = render_frames (1);
+  threaded = render_frames (4);
+
+  /* the dot drawn in the previous frame moved up one row and got darker */
+  fail_unless (gst_buffer_map (single->next->data, &map, GST_MAP_READ));
+  memcpy (&pixel, map.data + 238 * 320 * 4, 4);
+  fail_unless_equals_int (pixel, 0x00efefef);
+  memcpy (&pixel, map.data + 237 * 320 * 4, 4);
+  fail_unless_equals_int (pixel, 0);
+  gst_buffer_unmap (single->next->data, &map);
+
+  for (i = 0, l1 = single, l2 = threaded; l1 && l2;
+      i++, l1 = l1->next, l2 = l2->next) {
+    GstMapInfo map2;
+
+    fail_unless (gst_buffer_map (l1->data, &map, GST_MAP_READ));
+    fail_unless (gst_buffer_map (l2->data, &map2, GST_MAP_READ));
+    fail_unless_equals_int (map.size, map2.size);
+    fail_unless (memcmp (map.data, map2.data, map.size) == 0,
+        "frame %d differs", i);
+    gst_buffer_unmap (l2->data, &map2);
+    gst_buffer_unmap (l1->data, &map);
+  }
+  fail_unless_equals_int (i, 30);
+
+  g_list_free_full (single, (GDestroyNotify) gst_mini_object_unref);
+  g_list_free_full (threaded, (GDestroyNotify) gst_mini_object_unref);
+}
+
+GST_END_TEST;
+
 static void
 baseaudiovisualizer_init (void)
 {
@@ -170,6 +264,7 @@ baseaudiovisualizer_suite (void)
   tcase_add_checked_fixture (tc_chain, baseaudiovisualizer_init, NULL);
 
   tcase_add_test (tc_chain, count_in_out);
+  tcase_add_test (tc_chain, shader_threads);
 
   return s;
 }
@@ -521,6 +521,143 @@ GST_START_TEST (test_f64_22050hz)
 
 GST_END_TEST;
 
+GST_START_TEST (test_f32_batch)
+{
+  gint i, j;
+  gfloat *in, *inplace;
+  GstFFTF32Complex *out, *out_batch;
+  GstFFTF32 *ctx, *ctx2;
+
+  in = g_new (gfloat, 3 * 2048);
+  out = g_new (GstFFTF32Complex, 1025);
+  out_batch = g_new (GstFFTF32Complex, 3 * 1025);
+  inplace = g_new (gfloat, 2 * 1025);
+
+  ctx = gst_fft_f32_new (2048, FALSE);
+  /* shares the twiddle factors with the first instance */
+  ctx2 = gst_fft_f32_new (2048, FALSE);
+
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 2048; j++)
+      in[i * 2048 + j] = sin (2.0 * G_PI * (i + 1) * 1000.0 * j / 44100.0);
+
+  gst_fft_f32_fft_batch (ctx, in, out_batch, 3);
+
+  for (i = 0; i < 3; i++) {
+    gst_fft_f32_fft (ctx2, in + i * 2048, out);
+    for (j = 0; j < 1025; j++) {
+      fail_unless_equals_float (out[j].r, out_batch[i * 1025 + j].r);
+      fail_unless_equals_float (out[j].i, out_batch[i * 1025 + j].i);
+    }
+
+    memcpy (inplace, in + i * 2048, 2048 * sizeof (gfloat));
+    gst_fft_f32_fft (ctx, inplace, (GstFFTF32Complex *) inplace);
+    for (j = 0; j < 1025; j++) {
+      fail_unless_equals_float (out[j].r, inplace[2 * j]);
+      fail_unless_equals_float (out[j].i, inplace[2 * j + 1]);
+    }
+  }
+
+  gst_fft_f32_free (ctx2);
+  gst_fft_f32_free (ctx);
+  g_free (in);
+  g_free (out);
+  g_free (out_batch);
+  g_free (inplace);
+}
+
+GST_END_TEST;
+
+/* power of two lengths use a different implementation than the others */
+GST_START_TEST (test_f32_against_f64)
+{
+  static const gint lengths[] = { 16, 30, 64, 1000, 1024, 4096 };
+  guint l;
+  gint i;
+
+  for (l = 0; l < G_N_ELEMENTS (lengths); l++) {
+    gint len = lengths[l];
+    gfloat *in_f32 = g_new (gfloat, len);
+    gdouble *in_f64 = g_new (gdouble, len);
+    GstFFTF32Complex *out_f32 = g_new (GstFFTF32Complex, len / 2 + 1);
+    GstFFTF64Complex *out_f64 = g_new (GstFFTF64Complex, len / 2 + 1);
+    GstFFTF32 *ctx_f32 = gst_fft_f32_new (len, FALSE);
+    GstFFTF64 *ctx_f64 = gst_fft_f64_new (len, FALSE);
+    GstFFTF32 *ictx_f32 = gst_fft_f32_new (len, TRUE);
+
+    for (i = 0; i < len; i++) {
+      in_f64[i] = sin (2.0 * G_PI * 1000.0 * i / 44100.0)
+          + 0.5 * cos (2.0 * G_PI * 7000.0 * i / 44100.0);
+      in_f32[i] = in_f64[i];
+    }
+
+    gst_fft_f32_fft (ctx_f32, in_f32, out_f32);
+    gst_fft_f64_fft (ctx_f64, in_f64, out_f64);
+
+    for (i = 0; i < len / 2 + 1; i++) {
+      fail_unless (fabs (out_f32[i].r - out_f64[i].r) < 1e-5 * len);
+      fail_unless (fabs (out_f32[i].i - out_f64[i].i) < 1e-5 * len);
+    }
+
+    /* the inverse FFT of the FFT is the input scaled by the length */
+    gst_fft_f32_inverse_fft (ictx_f32, out_f32, in_f32);
+    for (i = 0; i < len; i++)
+      fail_unless (fabs (in_f32[i] / len - in_f64[i]) < 1e-5);
+
+    gst_fft_f32_free (ictx_f32);
+    gst_fft_f64_free (ctx_f64);
+    gst_fft_f32_free (ctx_f32);
+    g_free (in_f32);
+    g_free (in_f64);
+    g_free (out_f32);
+    g_free (out_f64);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_s16_interleaved)
+{
+  gint i, c;
+  gint16 *in, *deinterleaved;
+  GstFFTS16Complex *out, *out_interleaved;
+  GstFFTS16 *ctx;
+
+  in = g_new (gint16, 3 * 2048);
+  deinterleaved = g_new (gint16, 2048);
+  out = g_new (GstFFTS16Complex, 1025);
+  out_interleaved = g_new (GstFFTS16Complex, 3 * 1025);
+  ctx = gst_fft_s16_new (2048, FALSE);
+
+  for (i = 0; i < 2048; i++)
+    for (c = 0; c < 3; c++)
+      in[i * 3 + c] =
+          16384 * sin (2.0 * G_PI * (c + 1) * 1000.0 * i / 44100.0);
+
+  gst_fft_s16_fft_interleaved (ctx, in, 3, GST_FFT_WINDOW_HAMMING,
+      out_interleaved);
+
+  for (c = 0; c < 3; c++) {
+    for (i = 0; i < 2048; i++)
+      deinterleaved[i] = in[i * 3 + c];
+    gst_fft_s16_window (ctx, deinterleaved, GST_FFT_WINDOW_HAMMING);
+    gst_fft_s16_fft (ctx, deinterleaved, out);
+
+    for (i = 0; i < 1025; i++) {
+      fail_unless_equals_int (out[i].r, out_interleaved[c * 1025 + i].r);
+      fail_unless_equals_int (out[i].i, out_interleaved[c * 1025 + i].i);
+    }
+  }
+
+  gst_fft_s16_free (ctx);
+  g_free (in);
+  g_free (deinterleaved);
+  g_free (out);
+  g_free (out_interleaved);
+}
+
+GST_END_TEST;
+
 static Suite *
 fft_suite (void)
 {
@@ -541,6 +678,9 @@ fft_suite (void)
   tcase_add_test (tc_chain, test_f64_0hz);
   tcase_add_test (tc_chain, test_f64_11025hz);
   tcase_add_test (tc_chain, test_f64_22050hz);
+  tcase_add_test (tc_chain, test_f32_batch);
+  tcase_add_test (tc_chain, test_f32_against_f64);
+  tcase_add_test (tc_chain, test_s16_interleaved);
 
   return s;
 }
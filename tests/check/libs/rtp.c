@@ -2168,6 +2168,140 @@ GST_START_TEST (test_rtcp_compound_padding)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtcp_writer_reader)
+{
+  guint8 data[2048];
+  GstRTCPWriter writer;
+  GstRTCPReader reader;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  GstBuffer *buffer;
+  guint32 ssrc, media_ssrc, exthighestseq;
+  guint64 ntptime;
+  gint32 packetslost;
+  GstRTCPSDESType type;
+  GstRTCPFBType fbtype;
+  const guint8 *item;
+  guint8 len;
+  guint fci_len;
+  guint i, n_rb = 0, n_items = 0;
+
+  gst_rtcp_writer_init (&writer, data, sizeof (data));
+  fail_unless (gst_rtcp_writer_add_sr (&writer, 0x1234, G_GUINT64_CONSTANT
+          (0x0102030405060708), 90000, 10, 1000));
+  /* more blocks than fit in one report */
+  for (i = 0; i < 40; i++)
+    fail_unless (gst_rtcp_writer_add_rb (&writer, 0x1000 + i, 0, -(gint) i,
+            i, 0, 0, 0));
+  for (i = 0; i < 40; i++) {
+    fail_unless (gst_rtcp_writer_add_sdes_chunk (&writer, 0x1000 + i));
+    fail_unless (gst_rtcp_writer_add_sdes_item (&writer, GST_RTCP_SDES_CNAME,
+            3, (const guint8 *) "foo"));
+  }
+  fail_unless (gst_rtcp_writer_add_fb (&writer, GST_RTCP_TYPE_PSFB,
+          GST_RTCP_PSFB_TYPE_PLI, 0x1234, 0x1000, NULL, 0));
+
+  fail_unless (gst_rtcp_buffer_validate_data (data,
+          gst_rtcp_writer_get_size (&writer)));
+
+  /* the regular parser agrees on the layout */
+  buffer = gst_rtcp_buffer_new_copy_data (data,
+      gst_rtcp_writer_get_size (&writer));
+  fail_unless (gst_rtcp_buffer_map (buffer, GST_MAP_READ, &rtcp));
+  fail_unless_equals_int (gst_rtcp_buffer_get_packet_count (&rtcp), 5);
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &packet));
+  fail_unless_equals_int (gst_rtcp_packet_get_rb_count (&packet), 31);
+  fail_unless (gst_rtcp_packet_move_to_next (&packet));
+  fail_unless_equals_int (gst_rtcp_packet_get_type (&packet),
+      GST_RTCP_TYPE_RR);
+  fail_unless_equals_int (gst_rtcp_packet_rr_get_ssrc (&packet), 0x1234);
+  fail_unless_equals_int (gst_rtcp_packet_get_rb_count (&packet), 9);
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buffer);
+
+  gst_rtcp_reader_init (&reader, data, gst_rtcp_writer_get_size (&writer));
+
+  fail_unless (gst_rtcp_reader_next_packet (&reader));
+  fail_unless (gst_rtcp_reader_get_sr (&reader, &ssrc, &ntptime, NULL, NULL,
+          NULL));
+  fail_unless_equals_int (ssrc, 0x1234);
+  fail_unless_equals_uint64 (ntptime, G_GUINT64_CONSTANT (0x0102030405060708));
+  for (i = 0; i < gst_rtcp_reader_get_count (&reader); i++, n_rb++) {
+    fail_unless (gst_rtcp_reader_get_rb (&reader, i, &ssrc, NULL,
+            &packetslost, &exthighestseq, NULL, NULL, NULL));
+    fail_unless_equals_int (ssrc, 0x1000 + n_rb);
+    fail_unless_equals_int (packetslost, -(gint) n_rb);
+    fail_unless_equals_int (exthighestseq, n_rb);
+  }
+  fail_if (gst_rtcp_reader_get_rb (&reader, i, NULL, NULL, NULL, NULL, NULL,
+          NULL, NULL));
+
+  fail_unless (gst_rtcp_reader_next_packet (&reader));
+  fail_unless_equals_int (gst_rtcp_reader_get_packet_type (&reader),
+      GST_RTCP_TYPE_RR);
+  fail_unless (gst_rtcp_reader_get_sender_ssrc (&reader, &ssrc));
+  fail_unless_equals_int (ssrc, 0x1234);
+  for (i = 0; i < gst_rtcp_reader_get_count (&reader); i++, n_rb++) {
+    fail_unless (gst_rtcp_reader_get_rb (&reader, i, &ssrc, NULL, NULL, NULL,
+            NULL, NULL, NULL));
+    fail_unless_equals_int (ssrc, 0x1000 + n_rb);
+  }
+  fail_unless_equals_int (n_rb, 40);
+
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_rtcp_reader_next_packet (&reader));
+    fail_unless_equals_int (gst_rtcp_reader_get_packet_type (&reader),
+        GST_RTCP_TYPE_SDES);
+    while (gst_rtcp_reader_next_sdes_item (&reader, &ssrc, &type, &len,
+            &item)) {
+      fail_unless_equals_int (ssrc, 0x1000 + n_items);
+      fail_unless_equals_int (type, GST_RTCP_SDES_CNAME);
+      fail_unless_equals_int (len, 3);
+      fail_unless (memcmp (item, "foo", 3) == 0);
+      n_items++;
+    }
+  }
+  fail_unless_equals_int (n_items, 40);
+
+  fail_unless (gst_rtcp_reader_next_packet (&reader));
+  fail_unless (gst_rtcp_reader_get_fb (&reader, &fbtype, &ssrc, &media_ssrc,
+          NULL, &fci_len));
+  fail_unless_equals_int (fbtype, GST_RTCP_PSFB_TYPE_PLI);
+  fail_unless_equals_int (ssrc, 0x1234);
+  fail_unless_equals_int (media_ssrc, 0x1000);
+  fail_unless_equals_int (fci_len, 0);
+
+  fail_if (gst_rtcp_reader_next_packet (&reader));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtcp_writer_no_space)
+{
+  guint8 data[68];
+  GstRTCPWriter writer;
+
+  gst_rtcp_writer_init (&writer, data, sizeof (data));
+  fail_unless (gst_rtcp_writer_add_rr (&writer, 0x1234));
+  fail_unless (gst_rtcp_writer_add_rb (&writer, 1, 0, 0, 0, 0, 0, 0));
+  fail_unless (gst_rtcp_writer_add_rb (&writer, 2, 0, 0, 0, 0, 0, 0));
+  fail_unless_equals_int (gst_rtcp_writer_get_size (&writer), 56);
+
+  /* nothing is written when the packet does not fit */
+  fail_if (gst_rtcp_writer_add_rb (&writer, 3, 0, 0, 0, 0, 0, 0));
+  fail_unless_equals_int (gst_rtcp_writer_get_size (&writer), 56);
+
+  fail_unless (gst_rtcp_writer_add_fb (&writer, GST_RTCP_TYPE_PSFB,
+          GST_RTCP_PSFB_TYPE_PLI, 0x1234, 1, NULL, 0));
+  fail_unless_equals_int (gst_rtcp_writer_get_size (&writer), 68);
+
+  fail_if (gst_rtcp_writer_add_sdes_chunk (&writer, 0x1234));
+  fail_unless_equals_int (gst_rtcp_writer_get_size (&writer), 68);
+  fail_unless (gst_rtcp_buffer_validate_data (data, 68));
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtp_buffer_extlen_wraparound)
 {
   GstBuffer *buf;
@@ -2288,6 +2422,8 @@ rtp_suite (void)
       test_ext_timestamp_wraparound_disordered_cannot_unwrap);
 
   tcase_add_test (tc_chain, test_rtcp_compound_padding);
+  tcase_add_test (tc_chain, test_rtcp_writer_reader);
+  tcase_add_test (tc_chain, test_rtcp_writer_no_space);
   tcase_add_test (tc_chain, test_rtp_buffer_extlen_wraparound);
   tcase_add_test (tc_chain, test_rtp_buffer_remove_extension_data);
 
@@ -0,0 +1,300 @@
+/* GStreamer RTP base audio payloader unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/rtp/rtp.h>
+
+#define CLOCK_RATE (8000)
+/* 20 ms of 8 bit samples */
+#define PACKET_SIZE (160)
+
+/* GstRtpDummyAudioPay */
+
+#define GST_TYPE_RTP_DUMMY_AUDIO_PAY \
+  (gst_rtp_dummy_audio_pay_get_type())
+
+typedef struct _GstRtpDummyAudioPay GstRtpDummyAudioPay;
+typedef struct _GstRtpDummyAudioPayClass GstRtpDummyAudioPayClass;
+
+struct _GstRtpDummyAudioPay
+{
+  GstRTPBaseAudioPayload payload;
+};
+
+struct _GstRtpDummyAudioPayClass
+{
+  GstRTPBaseAudioPayloadClass parent_class;
+};
+
+GType gst_rtp_dummy_audio_pay_get_type (void);
+
+G_DEFINE_TYPE (GstRtpDummyAudioPay, gst_rtp_dummy_audio_pay,
+    GST_TYPE_RTP_BASE_AUDIO_PAYLOAD);
+
+static GstStaticPadTemplate gst_rtp_dummy_audio_pay_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate gst_rtp_dummy_audio_pay_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static gboolean
+gst_rtp_dummy_audio_pay_set_caps (GstRTPBasePayload * pay, GstCaps * caps)
+{
+  return gst_rtp_base_payload_set_outcaps (pay, NULL);
+}
+
+static void
+gst_rtp_dummy_audio_pay_class_init (GstRtpDummyAudioPayClass * klass)
+{
+  GstElementClass *gstelement_class;
+  GstRTPBasePayloadClass *gstrtpbasepayload_class;
+
+  gstelement_class = GST_ELEMENT_CLASS (klass);
+  gstrtpbasepayload_class = GST_RTP_BASE_PAYLOAD_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &gst_rtp_dummy_audio_pay_sink_template);
+  gst_element_class_add_static_pad_template (gstelement_class,
+      &gst_rtp_dummy_audio_pay_src_template);
+
+  gstrtpbasepayload_class->set_caps = gst_rtp_dummy_audio_pay_set_caps;
+}
+
+static void
+gst_rtp_dummy_audio_pay_init (GstRtpDummyAudioPay * pay)
+{
+  GstRTPBaseAudioPayload *audiopayload = GST_RTP_BASE_AUDIO_PAYLOAD (pay);
+
+  gst_rtp_base_payload_set_options (GST_RTP_BASE_PAYLOAD (pay), "audio",
+      FALSE, "DUMMY", CLOCK_RATE);
+  gst_rtp_base_audio_payload_set_sample_based (audiopayload);
+  gst_rtp_base_audio_payload_set_sample_options (audiopayload, 1);
+}
+
+static gulong n_lists;
+
+static GstPadProbeReturn
+count_lists (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  n_lists++;
+  return GST_PAD_PROBE_OK;
+}
+
+static GstHarness *
+create_harness (void)
+{
+  GstElement *pay;
+  GstHarness *h;
+  GstPad *srcpad;
+
+  pay = g_object_new (GST_TYPE_RTP_DUMMY_AUDIO_PAY, "max-ptime",
+      20 * GST_MSECOND, NULL);
+  h = gst_harness_new_with_element (pay, "sink", "src");
+  gst_object_unref (pay);
+
+  n_lists = 0;
+  srcpad = gst_element_get_static_pad (h->element, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST, count_lists,
+      NULL, NULL);
+  gst_object_unref (srcpad);
+
+  gst_harness_set_src_caps_str (h, "audio/x-raw");
+
+  return h;
+}
+
+static GstBuffer *
+create_input (gsize size, GstClockTime pts)
+{
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gsize i;
+
+  buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_WRITE));
+  for (i = 0; i < size; i++)
+    map.data[i] = i & 0xff;
+  gst_buffer_unmap (buffer, &map);
+  GST_BUFFER_PTS (buffer) = pts;
+
+  return buffer;
+}
+
+static void
+validate_packet (GstBuffer * buffer, GstClockTime pts, guint32 rtptime,
+    gsize payload_len)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), pts);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), rtptime);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), payload_len);
+  gst_rtp_buffer_unmap (&rtp);
+}
+
+/* an input buffer covering several packets is split into packets that
+ * share its memory and are pushed as a single buffer list */
+GST_START_TEST (rtp_base_audio_payload_split_buffer)
+{
+  GstHarness *h;
+  GstBuffer *input, *buffer;
+  GstMapInfo in_map, map;
+  guint32 rtptime = 0;
+  guint i;
+
+  h = create_harness ();
+
+  input = create_input (3 * PACKET_SIZE, 0);
+  fail_unless (gst_buffer_map (input, &in_map, GST_MAP_READ));
+  fail_unless_equals_int (gst_harness_push (h, gst_buffer_ref (input)),
+      GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), 3);
+  fail_unless_equals_int (n_lists, 1);
+
+  for (i = 0; i < 3; i++) {
+    buffer = gst_harness_pull (h);
+    if (i == 0) {
+      GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+      fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+      rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+      gst_rtp_buffer_unmap (&rtp);
+    }
+    validate_packet (buffer, i * 20 * GST_MSECOND, rtptime + i * PACKET_SIZE,
+        PACKET_SIZE);
+
+    /* the payload was not copied */
+    fail_unless_equals_int (gst_buffer_n_memory (buffer), 2);
+    fail_unless (gst_memory_map (gst_buffer_peek_memory (buffer, 1), &map,
+            GST_MAP_READ));
+    fail_unless (map.data == in_map.data + i * PACKET_SIZE);
+    gst_memory_unmap (gst_buffer_peek_memory (buffer, 1), &map);
+
+    gst_buffer_unref (buffer);
+  }
+
+  gst_buffer_unmap (input, &in_map);
+  gst_buffer_unref (input);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* the part of an input buffer that does not fill a packet is completed by
+ * the next buffer, keeping the timestamps continuous */
+GST_START_TEST (rtp_base_audio_payload_split_buffer_remainder)
+{
+  GstHarness *h;
+  GstBuffer *buffer;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint32 rtptime;
+  guint i;
+
+  h = create_harness ();
+  /* keep what is less than a packet in the adapter */
+  g_object_set (h->element, "min-ptime", (gint64) 20 * GST_MSECOND, NULL);
+
+  fail_unless_equals_int (gst_harness_push (h,
+          create_input (3 * PACKET_SIZE + 20, 0)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 3);
+
+  buffer = gst_harness_pull (h);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+  for (i = 1; i < 3; i++) {
+    buffer = gst_harness_pull (h);
+    validate_packet (buffer, i * 20 * GST_MSECOND, rtptime + i * PACKET_SIZE,
+        PACKET_SIZE);
+    gst_buffer_unref (buffer);
+  }
+
+  fail_unless_equals_int (gst_harness_push (h,
+          create_input (PACKET_SIZE - 20, 62500 * GST_USECOND)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 4);
+
+  buffer = gst_harness_pull (h);
+  validate_packet (buffer, 60 * GST_MSECOND, rtptime + 3 * PACKET_SIZE,
+      PACKET_SIZE);
+  gst_buffer_unref (buffer);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* disabling buffer-list disables frame-lists too, the packets are then pushed
+ * one by one */
+GST_START_TEST (rtp_base_audio_payload_no_buffer_list)
+{
+  GstHarness *h;
+  gboolean frame_lists, buffer_list;
+
+  h = create_harness ();
+
+  /* both default to enabled */
+  g_object_get (h->element, "buffer-list", &buffer_list, NULL);
+  fail_unless (buffer_list);
+
+  g_object_set (h->element, "buffer-list", TRUE, NULL);
+  g_object_get (h->element, "frame-lists", &frame_lists, NULL);
+  fail_unless (frame_lists);
+
+  g_object_set (h->element, "buffer-list", FALSE, NULL);
+  g_object_get (h->element, "frame-lists", &frame_lists, NULL);
+  fail_if (frame_lists);
+
+  fail_unless_equals_int (gst_harness_push (h,
+          create_input (3 * PACKET_SIZE, 0)), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 3);
+  fail_unless_equals_int (n_lists, 0);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtp_baseaudiopayload_suite (void)
+{
+  Suite *s = suite_create ("rtp_base_audio_payload_test");
+  TCase *tc_chain = tcase_create ("payloading tests");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, rtp_base_audio_payload_split_buffer);
+  tcase_add_test (tc_chain, rtp_base_audio_payload_split_buffer_remainder);
+  tcase_add_test (tc_chain, rtp_base_audio_payload_no_buffer_list);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtp_baseaudiopayload)
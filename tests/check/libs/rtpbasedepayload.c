@@ -196,6 +196,95 @@ gst_rtp_dummy_depay_set_caps (GstRTPBaseDepayload * filter, GstCaps * caps)
   return TRUE;
 }
 
+/* GstRtpDummyListDepay */
+
+typedef struct _GstRtpDummyListDepay GstRtpDummyListDepay;
+typedef struct _GstRtpDummyListDepayClass GstRtpDummyListDepayClass;
+
+struct _GstRtpDummyListDepay
+{
+  GstRtpDummyDepay depayload;
+
+  guint num_lists;
+  /* output one buffer for all packets with the same RTP timestamp */
+  gboolean merge_frames;
+};
+
+struct _GstRtpDummyListDepayClass
+{
+  GstRtpDummyDepayClass parent_class;
+};
+
+GType gst_rtp_dummy_list_depay_get_type (void);
+
+G_DEFINE_TYPE (GstRtpDummyListDepay, gst_rtp_dummy_list_depay,
+    GST_TYPE_RTP_DUMMY_DEPAY);
+
+static GstBufferList *
+gst_rtp_dummy_list_depay_process_list (GstRTPBaseDepayload * depayload,
+    GstBufferList * list)
+{
+  GstRtpDummyListDepay *self = (GstRtpDummyListDepay *) depayload;
+  GstBufferList *out_list;
+  guint i, len;
+
+  GstBuffer *frame = NULL;
+  guint32 frame_rtptime = 0;
+
+  self->num_lists++;
+
+  len = gst_buffer_list_length (list);
+  out_list = gst_buffer_list_new_sized (len);
+  for (i = 0; i < len; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *buf = gst_buffer_list_get (list, i);
+    GstBuffer *outbuf;
+    guint32 rtptime;
+
+    gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+    outbuf = gst_rtp_buffer_get_payload_buffer (&rtp);
+    rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+
+    if (self->merge_frames) {
+      if (frame && rtptime == frame_rtptime) {
+        frame = gst_buffer_append (frame, outbuf);
+        continue;
+      }
+      if (frame)
+        gst_buffer_list_add (out_list, frame);
+      frame = outbuf;
+      frame_rtptime = rtptime;
+      continue;
+    }
+
+    if (GST_BUFFER_IS_DISCONT (buf))
+      GST_BUFFER_FLAG_SET (outbuf, GST_BUFFER_FLAG_DISCONT);
+    gst_buffer_list_add (out_list, outbuf);
+  }
+  if (frame)
+    gst_buffer_list_add (out_list, frame);
+  gst_buffer_list_unref (list);
+
+  return out_list;
+}
+
+static void
+gst_rtp_dummy_list_depay_class_init (GstRtpDummyListDepayClass * klass)
+{
+  GstRTPBaseDepayloadClass *gstrtpbasedepayload_class;
+
+  gstrtpbasedepayload_class = GST_RTP_BASE_DEPAYLOAD_CLASS (klass);
+
+  gstrtpbasedepayload_class->process_rtp_packet_list =
+      gst_rtp_dummy_list_depay_process_list;
+}
+
+static void
+gst_rtp_dummy_list_depay_init (GstRtpDummyListDepay * depay)
+{
+}
+
 /* Helper functions and global state */
 
 static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
@@ -1877,6 +1966,103 @@ GST_START_TEST (rtp_base_depayload_hdr_ext_caps_change)
 
 GST_END_TEST;
 
+/* a depayloader implementing process_rtp_packet_list gets whole buffer
+ * lists to process at once, after the base class has dropped duplicate
+ * packets and flagged seqnum gaps. the output is pushed as a single list. */
+GST_START_TEST (rtp_base_depayload_process_list)
+{
+  GstHarness *h;
+  GstRtpDummyListDepay *depay;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  const guint16 seqs[] = { 1000, 1001, 1001, 1002, 1004 };
+  guint i;
+
+  depay = g_object_new (gst_rtp_dummy_list_depay_get_type (), NULL);
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (depay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (seqs); i++) {
+    buffer = gst_rtp_buffer_new_allocate (4, 0, 0);
+    rtp_buffer_set (buffer, "seq", seqs[i], "ssrc", 0x11, NULL);
+    GST_BUFFER_PTS (buffer) = 0;
+    gst_buffer_list_add (list, buffer);
+  }
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad, list), GST_FLOW_OK);
+
+  fail_unless_equals_int (depay->num_lists, 1);
+
+  /* the duplicate of 1001 is dropped */
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 4);
+  for (i = 0; i < 4; i++) {
+    buffer = gst_harness_pull (h);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 4);
+    /* the gap before 1004 is flagged by the subclass, the base class flags
+     * the first buffer of the list */
+    fail_unless_equals_int (GST_BUFFER_IS_DISCONT (buffer), i == 0 || i == 3);
+    gst_buffer_unref (buffer);
+  }
+
+  g_object_unref (depay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* when the output of a list spans several RTP timestamps, the first output
+ * buffer gets the timestamps of the first packet and is marked DISCONT when
+ * any packet of the list was. */
+GST_START_TEST (rtp_base_depayload_process_list_frames)
+{
+  GstHarness *h;
+  GstRtpDummyListDepay *depay;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  const guint16 seqs[] = { 2000, 2001, 2003, 2004 };
+  const guint32 rtptimes[] = { 4200, 4200, 8400, 8400 };
+  guint i;
+
+  depay = g_object_new (gst_rtp_dummy_list_depay_get_type (), NULL);
+  depay->merge_frames = TRUE;
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (depay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < G_N_ELEMENTS (seqs); i++) {
+    buffer = gst_rtp_buffer_new_allocate (4, 0, 0);
+    rtp_buffer_set (buffer, "seq", seqs[i], "ssrc", 0x11,
+        "rtptime", (guint64) rtptimes[i], NULL);
+    GST_BUFFER_PTS (buffer) = (rtptimes[i] / DEFAULT_CLOCK_RATE) * GST_MSECOND;
+    GST_BUFFER_DTS (buffer) = GST_BUFFER_PTS (buffer);
+    GST_BUFFER_DURATION (buffer) = (i + 1) * GST_MSECOND;
+    gst_buffer_list_add (list, buffer);
+  }
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad, list), GST_FLOW_OK);
+
+  fail_unless_equals_int (depay->num_lists, 1);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 2);
+
+  /* the gap before 2003 marks the start of the output DISCONT */
+  buffer = gst_harness_pull (h);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 8);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), 100 * GST_MSECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DTS (buffer), 100 * GST_MSECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buffer), GST_MSECOND);
+  fail_unless (GST_BUFFER_IS_DISCONT (buffer));
+  gst_buffer_unref (buffer);
+
+  buffer = gst_harness_pull (h);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 8);
+  fail_if (GST_BUFFER_IS_DISCONT (buffer));
+  gst_buffer_unref (buffer);
+
+  g_object_unref (depay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtp_basepayloading_suite (void)
 {
@@ -1922,6 +2108,9 @@ rtp_basepayloading_suite (void)
   tcase_add_test (tc_chain, rtp_base_depayload_caps_request_ignored);
   tcase_add_test (tc_chain, rtp_base_depayload_hdr_ext_caps_change);
 
+  tcase_add_test (tc_chain, rtp_base_depayload_process_list);
+  tcase_add_test (tc_chain, rtp_base_depayload_process_list_frames);
+
   return s;
 }
 
@@ -50,6 +50,11 @@ typedef struct _GstRtpDummyPayClass GstRtpDummyPayClass;
 struct _GstRtpDummyPay
 {
   GstRTPBasePayload payload;
+
+  /* when set, each input buffer is payloaded into n_packets packets and
+   * event is pushed after the first one */
+  guint n_packets;
+  GstEvent *event;
 };
 
 struct _GstRtpDummyPayClass
@@ -76,12 +81,24 @@ GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS ("application/x-rtp"));
 
+static void
+gst_rtp_dummy_pay_finalize (GObject * object)
+{
+  GstRtpDummyPay *pay = GST_RTP_DUMMY_PAY (object);
+
+  gst_clear_event (&pay->event);
+
+  G_OBJECT_CLASS (gst_rtp_dummy_pay_parent_class)->finalize (object);
+}
+
 static void
 gst_rtp_dummy_pay_class_init (GstRtpDummyPayClass * klass)
 {
+  GObjectClass *gobject_class;
   GstElementClass *gstelement_class;
   GstRTPBasePayloadClass *gstrtpbasepayload_class;
 
+  gobject_class = G_OBJECT_CLASS (klass);
   gstelement_class = GST_ELEMENT_CLASS (klass);
   gstrtpbasepayload_class = GST_RTP_BASE_PAYLOAD_CLASS (klass);
 
@@ -90,6 +107,8 @@ gst_rtp_dummy_pay_class_init (GstRtpDummyPayClass * klass)
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_rtp_dummy_pay_src_template);
 
+  gobject_class->finalize = gst_rtp_dummy_pay_finalize;
+
   gstrtpbasepayload_class->handle_buffer = gst_rtp_dummy_pay_handle_buffer;
 }
 
@@ -106,6 +125,31 @@ rtp_dummy_pay_new (void)
   return g_object_new (GST_TYPE_RTP_DUMMY_PAY, NULL);
 }
 
+static GstFlowReturn
+gst_rtp_dummy_pay_push_packets (GstRtpDummyPay * self, GstBuffer * buffer)
+{
+  GstRTPBasePayload *pay = GST_RTP_BASE_PAYLOAD (self);
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i;
+
+  for (i = 0; i < self->n_packets && ret == GST_FLOW_OK; i++) {
+    GstBuffer *paybuffer;
+
+    paybuffer = gst_rtp_base_payload_allocate_output_buffer (pay, 1, 0, 0);
+    GST_BUFFER_PTS (paybuffer) = GST_BUFFER_PTS (buffer) + i * GST_SECOND;
+
+    ret = gst_rtp_base_payload_push (pay, paybuffer);
+
+    if (i == 0 && self->event)
+      gst_pad_push_event (GST_RTP_BASE_PAYLOAD_SRCPAD (pay),
+          gst_event_ref (self->event));
+  }
+
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_rtp_dummy_pay_handle_buffer (GstRTPBasePayload * pay, GstBuffer * buffer)
 {
@@ -123,6 +167,9 @@ gst_rtp_dummy_pay_handle_buffer (GstRTPBasePayload * pay, GstBuffer * buffer)
     }
   }
 
+  if (GST_RTP_DUMMY_PAY (pay)->n_packets > 0)
+    return gst_rtp_dummy_pay_push_packets (GST_RTP_DUMMY_PAY (pay), buffer);
+
   paybuffer =
       gst_rtp_base_payload_allocate_output_buffer (GST_RTP_BASE_PAYLOAD (pay),
       0, 0, 0);
@@ -2126,6 +2173,62 @@ GST_START_TEST (rtp_base_payload_multiple_exts)
 
 GST_END_TEST;
 
+GST_START_TEST (rtp_base_payload_add_extension_while_playing)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstRTPHeaderExtension *ext1, *ext2;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  gpointer ext_data;
+  guint ext_size;
+
+  pay = rtp_dummy_pay_new ();
+  ext1 = rtp_dummy_hdr_ext_new ();
+  gst_rtp_header_extension_set_id (ext1, 1);
+  ext2 = rtp_dummy_hdr_ext_new ();
+  gst_rtp_header_extension_set_id (ext2, 2);
+  g_signal_emit_by_name (pay, "add-extension", ext1);
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0,
+          &ext_data, &ext_size));
+  fail_if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 2, 0,
+          &ext_data, &ext_size));
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  /* the new extension is picked up by the next packet */
+  g_signal_emit_by_name (pay, "add-extension", ext2);
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0,
+          &ext_data, &ext_size));
+  fail_unless_equals_int (((guint8 *) ext_data)[0], TEST_DATA_BYTE);
+  fail_unless (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 2, 0,
+          &ext_data, &ext_size));
+  fail_unless_equals_int (((guint8 *) ext_data)[0], TEST_DATA_BYTE);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  fail_unless_equals_int (GST_RTP_DUMMY_HDR_EXT (ext1)->write_count, 2);
+  fail_unless_equals_int (GST_RTP_DUMMY_HDR_EXT (ext2)->write_count, 1);
+
+  gst_object_unref (ext1);
+  gst_object_unref (ext2);
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static GstStaticPadTemplate sinktmpl_with_extmap_str =
 GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
@@ -2147,6 +2250,56 @@ request_extension (GstRTPBasePayload * depayload, guint ext_id,
   return NULL;
 }
 
+/* changing the id of an extension that was already used is picked up by the
+ * next packet */
+GST_START_TEST (rtp_base_payload_extension_id_changed)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstRTPHeaderExtension *ext;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  gpointer ext_data;
+  guint ext_size;
+
+  pay = rtp_dummy_pay_new ();
+  ext = rtp_dummy_hdr_ext_new ();
+  gst_rtp_header_extension_set_id (ext, 1);
+  g_signal_emit_by_name (pay, "add-extension", ext);
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0,
+          &ext_data, &ext_size));
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  /* ids above 14 need the two byte header */
+  gst_rtp_header_extension_set_id (ext, 20);
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0,
+          &ext_data, &ext_size));
+  fail_unless (gst_rtp_buffer_get_extension_twobytes_header (&rtp, NULL, 20,
+          0, &ext_data, &ext_size));
+  fail_unless_equals_int (ext_size, 1);
+  fail_unless_equals_int (((guint8 *) ext_data)[0], TEST_DATA_BYTE);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  gst_object_unref (ext);
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (rtp_base_payload_caps_request)
 {
   GstRTPHeaderExtension *ext;
@@ -2261,6 +2414,347 @@ GST_START_TEST (rtp_base_payload_extensions_in_output_caps)
 }
 
 GST_END_TEST;
+
+/* the RTP header of each packet lives in its own memory taken from a pool in
+ * the payloader, which is recycled once the packet is released downstream.
+ * the payload memory is appended to the header without copying. */
+GST_START_TEST (rtp_base_payload_pooled_header)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstBuffer *buffer, *first, *wrapped;
+  GstMemory *mem;
+  GstMapInfo map;
+  gboolean frame_lists;
+  const guint8 data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+
+  pay = rtp_dummy_pay_new ();
+  g_object_get (pay, "frame-lists", &frame_lists, NULL);
+  fail_unless (frame_lists);
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  buffer = gst_buffer_new_memdup (data, sizeof (data));
+  first = gst_harness_push_and_pull (h, buffer);
+  fail_unless (first->pool != NULL);
+  fail_unless_equals_int (gst_buffer_n_memory (first), 2);
+  fail_unless_equals_int (gst_buffer_get_size (first), 12 + sizeof (data));
+  validate_buffer1 (first, "csrc-count", 0, NULL);
+
+  gst_buffer_map (first, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data + 12, data, sizeof (data)) == 0);
+  gst_buffer_unmap (first, &map);
+
+  /* once released the header buffer goes back to the pool and is reused */
+  gst_buffer_unref (first);
+  buffer = gst_buffer_new_memdup (data, sizeof (data));
+  buffer = gst_harness_push_and_pull (h, buffer);
+  fail_unless (buffer == first);
+  fail_unless_equals_int (gst_buffer_n_memory (buffer), 2);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 12 + sizeof (data));
+
+  /* wrapping a region of a buffer shares its memory */
+  wrapped = gst_rtp_base_payload_wrap_output_buffer (GST_RTP_BASE_PAYLOAD
+      (pay), buffer, 12 + 2, 3, 1);
+  fail_unless (wrapped != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (wrapped), 12 + 4 + 3);
+  validate_buffer1 (wrapped, "csrc-count", 1, NULL);
+  mem = gst_buffer_peek_memory (buffer, 1);
+  fail_unless (gst_buffer_peek_memory (wrapped, 1)->parent ==
+      (mem->parent ? mem->parent : mem));
+
+  gst_buffer_map (wrapped, &map, GST_MAP_READ);
+  fail_unless (memcmp (map.data + 16, data + 2, 3) == 0);
+  gst_buffer_unmap (wrapped, &map);
+
+  gst_buffer_unref (wrapped);
+  gst_buffer_unref (buffer);
+
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* buffer lists longer than the number of headers the payloader updates at
+ * once should get sequential seqnums, the same timestamp and header
+ * extensions on all packets. */
+GST_START_TEST (rtp_base_payload_large_buffer_list)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstRTPHeaderExtension *ext;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  guint32 ssrc, rtptime = 0;
+  guint16 seq;
+  gpointer ext_data;
+  guint ext_size;
+  guint i, n_packets = 100;
+
+  pay = rtp_dummy_pay_new ();
+  ext = rtp_dummy_hdr_ext_new ();
+  GST_RTP_DUMMY_HDR_EXT (ext)->supported_flags =
+      GST_RTP_HEADER_EXTENSION_ONE_BYTE;
+  gst_rtp_header_extension_set_id (ext, 1);
+  g_signal_emit_by_name (pay, "add-extension", ext);
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  seq = gst_rtp_buffer_get_seq (&rtp);
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < n_packets; i++) {
+    buffer = gst_rtp_base_payload_allocate_output_buffer (GST_RTP_BASE_PAYLOAD
+        (pay), 10, 0, 0);
+    if (i == 0)
+      GST_BUFFER_PTS (buffer) = 1 * GST_SECOND;
+    gst_buffer_list_add (list, buffer);
+  }
+  fail_unless_equals_int (gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD
+          (pay), list), GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_harness_buffers_received (h), n_packets + 1);
+  for (i = 0; i < n_packets; i++) {
+    buffer = gst_harness_pull (h);
+    fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp),
+        (guint16) (seq + 1 + i));
+    fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), ssrc);
+    fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), 96);
+    if (i == 0)
+      rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+    fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), rtptime);
+    fail_unless (gst_rtp_buffer_get_extension_onebyte_header (&rtp, 1, 0,
+            &ext_data, &ext_size));
+    fail_unless_equals_int (ext_size, 1);
+    fail_unless_equals_int (((guint8 *) ext_data)[0], TEST_DATA_BYTE);
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (buffer);
+  }
+
+  fail_unless_equals_int (GST_RTP_DUMMY_HDR_EXT (ext)->write_count,
+      n_packets + 1);
+
+  gst_object_unref (ext);
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* a packet of a buffer list whose header extensions can't be written keeps
+ * its seqnum, the packets after it are left alone and the next push continues
+ * right after it, without reusing seqnums. */
+GST_START_TEST (rtp_base_payload_buffer_list_invalid_packet)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstRTPHeaderExtension *ext;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  guint8 byte;
+  guint16 seq;
+  guint i;
+
+  pay = rtp_dummy_pay_new ();
+  ext = rtp_dummy_hdr_ext_new ();
+  gst_rtp_header_extension_set_id (ext, 1);
+  g_signal_emit_by_name (pay, "add-extension", ext);
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  seq = gst_rtp_buffer_get_seq (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++) {
+    buffer = gst_rtp_base_payload_allocate_output_buffer (GST_RTP_BASE_PAYLOAD
+        (pay), 10, 0, 0);
+    if (i == 1) {
+      /* padding longer than the packet, the packet can't be mapped */
+      byte = 0xa0;
+      gst_buffer_fill (buffer, 0, &byte, 1);
+      byte = 0xff;
+      gst_buffer_fill (buffer, gst_buffer_get_size (buffer) - 1, &byte, 1);
+    }
+    gst_buffer_list_add (list, buffer);
+  }
+  gst_rtp_base_payload_push_list (GST_RTP_BASE_PAYLOAD (pay), list);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 4);
+
+  buffer = gst_harness_pull (h);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), (guint16) (seq + 1));
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  buffer = gst_harness_pull (h);
+  gst_buffer_extract (buffer, 2, &byte, 1);
+  fail_unless_equals_int (byte, (guint8) ((seq + 2) >> 8));
+  gst_buffer_extract (buffer, 3, &byte, 1);
+  fail_unless_equals_int (byte, (guint8) (seq + 2));
+  gst_buffer_unref (buffer);
+
+  gst_buffer_unref (gst_harness_pull (h));
+
+  buffer = gst_harness_push_and_pull (h, gst_rtp_buffer_new_allocate (0, 0,
+          0));
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), (guint16) (seq + 3));
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buffer);
+
+  gst_object_unref (ext);
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_lists_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  guint *n_lists = user_data;
+
+  *n_lists += 1;
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* all packets the subclass pushes for one input buffer are pushed downstream
+ * as a single buffer list, with sequential seqnums and timestamps */
+GST_START_TEST (rtp_base_payload_frame_list)
+{
+  GstHarness *h;
+  GstRtpDummyPay *pay;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint32 rtptime = 0;
+  guint16 seq = 0;
+  guint i, n_lists = 0;
+
+  pay = rtp_dummy_pay_new ();
+  pay->n_packets = 4;
+
+  h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+  gst_pad_add_probe (GST_RTP_BASE_PAYLOAD_SRCPAD (pay),
+      GST_PAD_PROBE_TYPE_BUFFER_LIST, count_lists_probe, &n_lists, NULL);
+
+  buffer = gst_buffer_new_allocate (NULL, 1, NULL);
+  GST_BUFFER_PTS (buffer) = 1 * GST_SECOND;
+  fail_unless_equals_int (gst_harness_push (h, buffer), GST_FLOW_OK);
+
+  fail_unless_equals_int (n_lists, 1);
+  fail_unless_equals_int (gst_harness_buffers_received (h), 4);
+  for (i = 0; i < 4; i++) {
+    buffer = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), (1 + i) * GST_SECOND);
+    fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+    if (i == 0) {
+      seq = gst_rtp_buffer_get_seq (&rtp);
+      rtptime = gst_rtp_buffer_get_timestamp (&rtp);
+    }
+    fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), (guint16) (seq + i));
+    fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp),
+        rtptime + i * DEFAULT_CLOCK_RATE);
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (buffer);
+  }
+
+  g_object_unref (pay);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+record_order_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GString *order = user_data;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER)
+    g_string_append_c (order, 'B');
+  else if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    g_string_append_c (order, 'L');
+  else if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_CUSTOM_DOWNSTREAM
+      || GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+      GST_EVENT_CUSTOM_DOWNSTREAM_STICKY)
+    g_string_append_c (order, 'E');
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* serialized events the subclass pushes while packets of the frame are
+ * collected are pushed after the packets preceding them */
+GST_START_TEST (rtp_base_payload_frame_list_event_order)
+{
+  GstEventType types[] = { GST_EVENT_CUSTOM_DOWNSTREAM,
+    GST_EVENT_CUSTOM_DOWNSTREAM_STICKY
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (types); i++) {
+    GstHarness *h;
+    GstRtpDummyPay *pay;
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *buffer;
+    GString *order;
+    guint16 seq = 0;
+    guint j;
+
+    pay = rtp_dummy_pay_new ();
+    pay->n_packets = 4;
+    pay->event = gst_event_new_custom (types[i],
+        gst_structure_new_empty ("test-event"));
+
+    h = gst_harness_new_with_element (GST_ELEMENT_CAST (pay), "sink", "src");
+    gst_harness_set_src_caps_str (h, "application/x-rtp");
+    order = g_string_new (NULL);
+    gst_pad_add_probe (h->sinkpad, GST_PAD_PROBE_TYPE_DATA_DOWNSTREAM,
+        record_order_probe, order, NULL);
+
+    fail_unless_equals_int (gst_harness_push (h,
+            gst_buffer_new_allocate (NULL, 1, NULL)), GST_FLOW_OK);
+    fail_unless_equals_string (order->str, "BEL");
+
+    fail_unless_equals_int (gst_harness_buffers_received (h), 4);
+    for (j = 0; j < 4; j++) {
+      buffer = gst_harness_pull (h);
+      fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp));
+      if (j == 0)
+        seq = gst_rtp_buffer_get_seq (&rtp);
+      fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp),
+          (guint16) (seq + j));
+      gst_rtp_buffer_unmap (&rtp);
+      gst_buffer_unref (buffer);
+    }
+
+    g_string_free (order, TRUE);
+    g_object_unref (pay);
+    gst_harness_teardown (h);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 rtp_basepayloading_suite (void)
 {
@@ -2307,10 +2801,18 @@ rtp_basepayloading_suite (void)
   tcase_add_test (tc_chain, rtp_base_payload_two_byte_hdr_ext);
   tcase_add_test (tc_chain, rtp_base_payload_clear_extensions);
   tcase_add_test (tc_chain, rtp_base_payload_multiple_exts);
+  tcase_add_test (tc_chain, rtp_base_payload_add_extension_while_playing);
+  tcase_add_test (tc_chain, rtp_base_payload_extension_id_changed);
   tcase_add_test (tc_chain, rtp_base_payload_caps_request);
   tcase_add_test (tc_chain, rtp_base_payload_caps_request_ignored);
   tcase_add_test (tc_chain, rtp_base_payload_extensions_in_output_caps);
 
+  tcase_add_test (tc_chain, rtp_base_payload_pooled_header);
+  tcase_add_test (tc_chain, rtp_base_payload_large_buffer_list);
+  tcase_add_test (tc_chain, rtp_base_payload_buffer_list_invalid_packet);
+  tcase_add_test (tc_chain, rtp_base_payload_frame_list);
+  tcase_add_test (tc_chain, rtp_base_payload_frame_list_event_order);
+
   return s;
 }
 
@@ -95,6 +95,98 @@ GST_START_TEST (test_rtp_source_meta_set_get_max_sources)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtp_packet_view_meta)
+{
+  GstBuffer *buffer;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPPacketView view;
+
+  buffer = gst_rtp_buffer_new_allocate (16, 0, 2);
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_marker (&rtp, TRUE);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, 0xfedc);
+  gst_rtp_buffer_set_timestamp (&rtp, 0x12345678);
+  gst_rtp_buffer_set_ssrc (&rtp, 0x87654321);
+  gst_rtp_buffer_unmap (&rtp);
+
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_RTP_PACKET_VIEW_META_API_TYPE) == NULL);
+
+  /* first access parses and caches the header */
+  fail_unless (gst_buffer_get_rtp_packet_view (buffer, &view));
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_RTP_PACKET_VIEW_META_API_TYPE) != NULL);
+  fail_unless_equals_int (view.version, 2);
+  fail_unless (!view.padding);
+  fail_unless (!view.extension);
+  fail_unless_equals_int (view.csrc_count, 2);
+  fail_unless (view.marker);
+  fail_unless_equals_int (view.payload_type, 96);
+  fail_unless_equals_int (view.seq, 0xfedc);
+  fail_unless_equals_uint64 (view.timestamp, 0x12345678);
+  fail_unless_equals_uint64 (view.ssrc, 0x87654321);
+  fail_unless_equals_int (view.header_len, 12 + 2 * 4);
+
+  /* later accesses use the cache */
+  view.seq = 0;
+  fail_unless (gst_buffer_get_rtp_packet_view (buffer, &view));
+  fail_unless_equals_int (view.seq, 0xfedc);
+
+  /* a writable map invalidates it */
+  fail_unless (gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_seq (&rtp, 0x0102);
+  gst_rtp_buffer_unmap (&rtp);
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_RTP_PACKET_VIEW_META_API_TYPE) == NULL);
+  fail_unless (gst_buffer_get_rtp_packet_view (buffer, &view));
+  fail_unless_equals_int (view.seq, 0x0102);
+
+  /* nothing is cached on buffers that are not writable */
+  gst_buffer_unref (buffer);
+  buffer = gst_rtp_buffer_new_allocate (16, 0, 0);
+  gst_buffer_ref (buffer);
+  fail_unless (gst_buffer_get_rtp_packet_view (buffer, &view));
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_RTP_PACKET_VIEW_META_API_TYPE) == NULL);
+  gst_buffer_unref (buffer);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtp_packet_view_parse_invalid)
+{
+  GstBuffer *buffer;
+  GstRTPPacketView view;
+  guint8 rtcp[] = { 0x80, 200, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00
+  };
+  guint8 short_csrc[] = { 0x82, 96, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02
+  };
+
+  /* RTCP */
+  buffer = gst_buffer_new_memdup (rtcp, sizeof (rtcp));
+  fail_if (gst_rtp_packet_view_parse (buffer, &view));
+  gst_buffer_unref (buffer);
+
+  /* CSRC list not complete */
+  buffer = gst_buffer_new_memdup (short_csrc, sizeof (short_csrc));
+  fail_if (gst_rtp_packet_view_parse (buffer, &view));
+  fail_if (gst_buffer_get_rtp_packet_view (buffer, &view));
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_RTP_PACKET_VIEW_META_API_TYPE) == NULL);
+  gst_buffer_unref (buffer);
+
+  /* too short */
+  buffer = gst_buffer_new_memdup (short_csrc, 8);
+  fail_if (gst_rtp_packet_view_parse (buffer, &view));
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtp_meta_suite (void)
 {
@@ -105,6 +197,10 @@ rtp_meta_suite (void)
   tcase_add_test (tc_chain, test_rtp_source_meta_set_get_sources);
   tcase_add_test (tc_chain, test_rtp_source_meta_set_get_max_sources);
 
+  suite_add_tcase (s, (tc_chain = tcase_create ("GstRTPPacketViewMeta")));
+  tcase_add_test (tc_chain, test_rtp_packet_view_meta);
+  tcase_add_test (tc_chain, test_rtp_packet_view_parse_invalid);
+
   return s;
 }
 
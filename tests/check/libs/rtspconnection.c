@@ -774,6 +774,8 @@ GST_START_TEST (test_rtspconnection_backlog)
   GstRTSPResult res = GST_RTSP_OK;
   guint num_queued;
   guint num_sent;
+  gsize backlog_bytes;
+  guint backlog_messages;
 
   create_connection (&conn1, &conn2);
   sock = g_socket_connection_get_socket (conn1);
@@ -809,6 +811,12 @@ GST_START_TEST (test_rtspconnection_backlog)
   fail_unless (res == GST_RTSP_ENOMEM);
   fail_unless (num_queued > 0);
 
+  /* the backlog is full */
+  gst_rtsp_watch_get_send_backlog_level (watch, &backlog_bytes,
+      &backlog_messages);
+  fail_unless (backlog_bytes >= 1024);
+  fail_unless_equals_int (backlog_messages, num_queued);
+
   istream = g_io_stream_get_input_stream (G_IO_STREAM (conn2));
   fail_unless (istream != NULL);
 
@@ -830,6 +838,88 @@ GST_START_TEST (test_rtspconnection_backlog)
     num_sent--;
   }
 
+  /* everything was written, the backlog is empty again */
+  gst_rtsp_watch_get_send_backlog_level (watch, &backlog_bytes,
+      &backlog_messages);
+  fail_unless_equals_int (backlog_bytes, 0);
+  fail_unless_equals_int (backlog_messages, 0);
+
+  g_source_destroy ((GSource *) watch);
+  fail_unless (gst_rtsp_connection_close (rtsp_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_conn) == GST_RTSP_OK);
+  g_object_unref (conn1);
+  g_object_unref (conn2);
+}
+
+GST_END_TEST;
+
+/* sending more messages than fit into a single write writes the first ones
+ * directly and only queues the remaining ones */
+GST_START_TEST (test_rtspconnection_send_many_messages)
+{
+  GSocketConnection *conn1 = NULL;
+  GSocketConnection *conn2 = NULL;
+  GSocket *sock;
+  GstRTSPConnection *rtsp_conn = NULL;
+  GstRTSPWatch *watch;
+  GInputStream *istream;
+  GstRTSPMessage messages[600];
+  guint8 *recv;
+  gsize count, backlog_bytes;
+  guint i, backlog_messages;
+
+  create_connection (&conn1, &conn2);
+  sock = g_socket_connection_get_socket (conn1);
+  fail_unless (sock != NULL);
+
+  fail_unless (gst_rtsp_connection_create_from_socket (sock, "127.0.0.1",
+          4444, NULL, &rtsp_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_conn != NULL);
+
+  watch = gst_rtsp_watch_new (rtsp_conn, &watch_funcs, NULL, NULL);
+  fail_unless (watch != NULL);
+  fail_unless (gst_rtsp_watch_attach (watch, NULL) > 0);
+  g_source_unref ((GSource *) watch);
+
+  /* each message needs two vectors, for the interleaved header and the
+   * body */
+  for (i = 0; i < G_N_ELEMENTS (messages); i++) {
+    fail_unless (gst_rtsp_message_init_data (&messages[i], 0) == GST_RTSP_OK);
+    fail_unless (gst_rtsp_message_take_body_buffer (&messages[i],
+            gst_buffer_new_wrapped (g_malloc0 (4), 4)) == GST_RTSP_OK);
+  }
+
+  message_sent_count = 0;
+  fail_unless (gst_rtsp_watch_send_messages (watch, messages,
+          G_N_ELEMENTS (messages), NULL) == GST_RTSP_OK);
+  for (i = 0; i < G_N_ELEMENTS (messages); i++)
+    gst_rtsp_message_unset (&messages[i]);
+
+  /* 512 messages fill the 1024 vectors of a write, the others are queued */
+  gst_rtsp_watch_get_send_backlog_level (watch, &backlog_bytes,
+      &backlog_messages);
+  fail_unless_equals_int (backlog_messages, 1);
+  fail_unless_equals_int (backlog_bytes, (G_N_ELEMENTS (messages) - 512) * 8);
+
+  while (message_sent_count == 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  gst_rtsp_watch_get_send_backlog_level (watch, &backlog_bytes,
+      &backlog_messages);
+  fail_unless_equals_int (backlog_bytes, 0);
+  fail_unless_equals_int (backlog_messages, 0);
+
+  istream = g_io_stream_get_input_stream (G_IO_STREAM (conn2));
+  fail_unless (istream != NULL);
+
+  recv = g_malloc (G_N_ELEMENTS (messages) * 8);
+  fail_unless (g_input_stream_read_all (istream, recv,
+          G_N_ELEMENTS (messages) * 8, &count, NULL, NULL));
+  fail_unless_equals_int (count, G_N_ELEMENTS (messages) * 8);
+  for (i = 0; i < G_N_ELEMENTS (messages); i++)
+    fail_unless_equals_int (recv[i * 8], '$');
+  g_free (recv);
+
   g_source_destroy ((GSource *) watch);
   fail_unless (gst_rtsp_connection_close (rtsp_conn) == GST_RTSP_OK);
   fail_unless (gst_rtsp_connection_free (rtsp_conn) == GST_RTSP_OK);
@@ -928,6 +1018,91 @@ GST_START_TEST (test_rtspconnection_send_receive_content_length)
 
 GST_END_TEST;
 
+/* several messages arriving at once are received one after the other, the
+ * ones that were already read are reported as readable by poll */
+GST_START_TEST (test_rtspconnection_receive_pipelined)
+{
+  GSocketConnection *input_conn = NULL;
+  GSocketConnection *output_conn = NULL;
+  GOutputStream *ostream;
+  GstRTSPConnection *rtsp_input_conn;
+  GstRTSPMessage *msg;
+  GstRTSPEvent event;
+  const gchar *request1 =
+      "OPTIONS rtsp://example.org RTSP/1.0\r\n" "CSeq: 1\r\n\r\n";
+  const gchar *request2 =
+      "OPTIONS rtsp://example.org RTSP/1.0\r\n" "CSeq: 2\r\n\r\n";
+  const guint8 data_header[] = { '$', 1, 0, 4 };
+  gchar *recv_str;
+  guint8 *recv_body;
+  guint recv_body_len;
+  gsize size;
+
+  create_connection (&input_conn, &output_conn);
+  ostream = g_io_stream_get_output_stream (G_IO_STREAM (output_conn));
+
+  fail_unless (gst_rtsp_connection_create_from_socket
+      (g_socket_connection_get_socket (input_conn), "127.0.0.1", 4444, NULL,
+          &rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (rtsp_input_conn != NULL);
+
+  /* request, data message, request in one write */
+  {
+    GByteArray *array = g_byte_array_new ();
+
+    g_byte_array_append (array, (guint8 *) request1, strlen (request1));
+    g_byte_array_append (array, data_header, sizeof (data_header));
+    g_byte_array_append (array, (guint8 *) "abcd", 4);
+    g_byte_array_append (array, (guint8 *) request2, strlen (request2));
+
+    fail_unless (g_output_stream_write_all (ostream, array->data, array->len,
+            &size, NULL, NULL));
+    fail_unless_equals_int (size, array->len);
+    g_byte_array_unref (array);
+  }
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_CSEQ, &recv_str,
+          0) == GST_RTSP_OK);
+  fail_unless_equals_string (recv_str, "1");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_connection_poll_usec (rtsp_input_conn,
+          GST_RTSP_EV_READ, &event, G_USEC_PER_SEC) == GST_RTSP_OK);
+  fail_unless (event & GST_RTSP_EV_READ);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_DATA);
+  fail_unless (gst_rtsp_message_get_body (msg, &recv_body,
+          &recv_body_len) == GST_RTSP_OK);
+  /* RTSPConnection adds an extra byte for the trailing '\0' */
+  fail_unless_equals_int (recv_body_len, 5);
+  fail_unless_equals_string ((gchar *) recv_body, "abcd");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_message_new (&msg) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_receive (rtsp_input_conn, msg, NULL) ==
+      GST_RTSP_OK);
+  fail_unless (gst_rtsp_message_get_type (msg) == GST_RTSP_MESSAGE_REQUEST);
+  fail_unless (gst_rtsp_message_get_header (msg, GST_RTSP_HDR_CSEQ, &recv_str,
+          0) == GST_RTSP_OK);
+  fail_unless_equals_string (recv_str, "2");
+  fail_unless (gst_rtsp_message_free (msg) == GST_RTSP_OK);
+
+  fail_unless (gst_rtsp_connection_close (rtsp_input_conn) == GST_RTSP_OK);
+  fail_unless (gst_rtsp_connection_free (rtsp_input_conn) == GST_RTSP_OK);
+
+  g_object_unref (input_conn);
+  g_object_unref (output_conn);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtspconnection_suite (void)
 {
@@ -942,8 +1117,10 @@ rtspconnection_suite (void)
   tcase_add_test (tc_chain, test_rtspconnection_connect);
   tcase_add_test (tc_chain, test_rtspconnection_poll);
   tcase_add_test (tc_chain, test_rtspconnection_backlog);
+  tcase_add_test (tc_chain, test_rtspconnection_send_many_messages);
   tcase_add_test (tc_chain, test_rtspconnection_ip);
   tcase_add_test (tc_chain, test_rtspconnection_send_receive_content_length);
+  tcase_add_test (tc_chain, test_rtspconnection_receive_pipelined);
 
   return s;
 }
@@ -0,0 +1,769 @@
+/* GStreamer RTP payloading/depayloading benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures the per-packet cost of the RTP hot paths: mapping packets,
+ * writing and reading header extensions and pushing packets through
+ * GstRTPBasePayload and GstRTPBaseDepayload, either one by one or as
+ * buffer lists. Every run is printed as one CSV line:
+ *
+ *   benchmark,extensions,packets_per_buffer,packets,ns_per_packet,
+ *   packets_per_sec
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/gst.h>
+#include <gst/rtp/rtp.h>
+
+#define DEFAULT_NUM_PACKETS 100000
+
+#define PAYLOAD_SIZE 1000
+#define MAX_PACKETS_PER_BUFFER 64
+#define CLOCK_RATE 90000
+#define PACKET_DURATION (GST_SECOND / 1000)
+
+#define BENCH_HDR_EXT_URI "urn:gstreamer:benchmark:rtp-hdrext"
+#define BENCH_HDR_EXT_SIZE 2
+
+static const guint n_exts_values[] = { 0, 1, 4, 8 };
+static const guint packets_per_buffer_values[] =
+    { 1, 4, 16, MAX_PACKETS_PER_BUFFER };
+
+/* BenchHdrExt: writes and reads a fixed amount of data */
+
+typedef struct _BenchHdrExt BenchHdrExt;
+typedef struct _BenchHdrExtClass BenchHdrExtClass;
+
+struct _BenchHdrExt
+{
+  GstRTPHeaderExtension parent;
+};
+
+struct _BenchHdrExtClass
+{
+  GstRTPHeaderExtensionClass parent_class;
+};
+
+GType bench_hdr_ext_get_type (void);
+
+G_DEFINE_TYPE (BenchHdrExt, bench_hdr_ext, GST_TYPE_RTP_HEADER_EXTENSION);
+
+static GstRTPHeaderExtensionFlags
+bench_hdr_ext_get_supported_flags (GstRTPHeaderExtension * ext)
+{
+  return GST_RTP_HEADER_EXTENSION_ONE_BYTE | GST_RTP_HEADER_EXTENSION_TWO_BYTE;
+}
+
+static gsize
+bench_hdr_ext_get_max_size (GstRTPHeaderExtension * ext,
+    const GstBuffer * input_meta)
+{
+  return BENCH_HDR_EXT_SIZE;
+}
+
+static gssize
+bench_hdr_ext_write (GstRTPHeaderExtension * ext,
+    const GstBuffer * input_meta, GstRTPHeaderExtensionFlags write_flags,
+    GstBuffer * output, guint8 * data, gsize size)
+{
+  if (size < BENCH_HDR_EXT_SIZE)
+    return -1;
+
+  data[0] = gst_rtp_header_extension_get_id (ext);
+  data[1] = 0xa5;
+
+  return BENCH_HDR_EXT_SIZE;
+}
+
+static gboolean
+bench_hdr_ext_read (GstRTPHeaderExtension * ext,
+    GstRTPHeaderExtensionFlags read_flags, const guint8 * data, gsize size,
+    GstBuffer * buffer)
+{
+  return size >= BENCH_HDR_EXT_SIZE && data[1] == 0xa5;
+}
+
+static void
+bench_hdr_ext_class_init (BenchHdrExtClass * klass)
+{
+  GstRTPHeaderExtensionClass *hdrext_class =
+      GST_RTP_HEADER_EXTENSION_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  hdrext_class->get_supported_flags = bench_hdr_ext_get_supported_flags;
+  hdrext_class->get_max_size = bench_hdr_ext_get_max_size;
+  hdrext_class->write = bench_hdr_ext_write;
+  hdrext_class->read = bench_hdr_ext_read;
+
+  gst_element_class_set_static_metadata (element_class,
+      "Benchmark RTP Header Extension", GST_RTP_HDREXT_ELEMENT_CLASS,
+      "Benchmark RTP Header Extension", "GStreamer maintainers");
+  gst_rtp_header_extension_class_set_uri (hdrext_class, BENCH_HDR_EXT_URI);
+}
+
+static void
+bench_hdr_ext_init (BenchHdrExt * ext)
+{
+}
+
+/* BenchPay: packetizes its input in PAYLOAD_SIZE chunks and pushes them one
+ * by one or as a single buffer list */
+
+typedef enum
+{
+  /* one push per packet, sent downstream one by one */
+  PAYLOAD_PUSH,
+  /* one push per packet, collected into a list by frame-lists */
+  PAYLOAD_PUSH_FRAME_LISTS,
+  /* one push of a list per input buffer */
+  PAYLOAD_PUSH_LIST,
+} PayloadMode;
+
+static const gchar *payload_mode_names[] = {
+  "payload-push", "payload-push-frame-lists", "payload-push-list"
+};
+
+typedef struct _BenchPay BenchPay;
+typedef struct _BenchPayClass BenchPayClass;
+
+struct _BenchPay
+{
+  GstRTPBasePayload parent;
+
+  gboolean use_list;
+};
+
+struct _BenchPayClass
+{
+  GstRTPBasePayloadClass parent_class;
+};
+
+GType bench_pay_get_type (void);
+
+G_DEFINE_TYPE (BenchPay, bench_pay, GST_TYPE_RTP_BASE_PAYLOAD);
+
+static GstStaticPadTemplate bench_pay_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate bench_pay_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static gboolean
+bench_pay_set_caps (GstRTPBasePayload * pay, GstCaps * caps)
+{
+  return gst_rtp_base_payload_set_outcaps (pay, NULL);
+}
+
+static GstFlowReturn
+bench_pay_handle_buffer (GstRTPBasePayload * pay, GstBuffer * buffer)
+{
+  BenchPay *self = (BenchPay *) pay;
+  GstBufferList *list = NULL;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gsize offset, size;
+
+  size = gst_buffer_get_size (buffer);
+  if (self->use_list)
+    list = gst_buffer_list_new_sized ((size + PAYLOAD_SIZE - 1) / PAYLOAD_SIZE);
+
+  for (offset = 0; offset < size && ret == GST_FLOW_OK;
+      offset += PAYLOAD_SIZE) {
+    GstBuffer *outbuf, *payload;
+
+    outbuf = gst_rtp_base_payload_allocate_output_buffer (pay, 0, 0, 0);
+    payload = gst_buffer_copy_region (buffer, GST_BUFFER_COPY_MEMORY, offset,
+        MIN (PAYLOAD_SIZE, size - offset));
+    outbuf = gst_buffer_append (outbuf, payload);
+    GST_BUFFER_PTS (outbuf) = GST_BUFFER_PTS (buffer);
+
+    if (list)
+      gst_buffer_list_add (list, outbuf);
+    else
+      ret = gst_rtp_base_payload_push (pay, outbuf);
+  }
+
+  if (list)
+    ret = gst_rtp_base_payload_push_list (pay, list);
+
+  gst_buffer_unref (buffer);
+
+  return ret;
+}
+
+static void
+bench_pay_class_init (BenchPayClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstRTPBasePayloadClass *pay_class = GST_RTP_BASE_PAYLOAD_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_pay_sink_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_pay_src_template);
+  gst_element_class_set_static_metadata (element_class,
+      "Benchmark RTP Payloader", "Codec/Payloader/Network/RTP",
+      "Benchmark RTP Payloader", "GStreamer maintainers");
+
+  pay_class->set_caps = bench_pay_set_caps;
+  pay_class->handle_buffer = bench_pay_handle_buffer;
+}
+
+static void
+bench_pay_init (BenchPay * pay)
+{
+  gst_rtp_base_payload_set_options (GST_RTP_BASE_PAYLOAD (pay), "video",
+      TRUE, "BENCH", CLOCK_RATE);
+}
+
+/* BenchDepay: outputs the payload of each packet, for single packets and for
+ * whole buffer lists */
+
+typedef struct _BenchDepay BenchDepay;
+typedef struct _BenchDepayClass BenchDepayClass;
+
+struct _BenchDepay
+{
+  GstRTPBaseDepayload parent;
+};
+
+struct _BenchDepayClass
+{
+  GstRTPBaseDepayloadClass parent_class;
+};
+
+GType bench_depay_get_type (void);
+
+G_DEFINE_TYPE (BenchDepay, bench_depay, GST_TYPE_RTP_BASE_DEPAYLOAD);
+
+static GstStaticPadTemplate bench_depay_sink_template =
+GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate bench_depay_src_template =
+GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static gboolean
+bench_depay_set_caps (GstRTPBaseDepayload * depay, GstCaps * caps)
+{
+  GstCaps *srccaps;
+  gboolean res;
+
+  srccaps = gst_caps_new_empty_simple ("application/x-bench");
+  res = gst_pad_set_caps (depay->srcpad, srccaps);
+  gst_caps_unref (srccaps);
+
+  return res;
+}
+
+static GstBuffer *
+bench_depay_process_rtp_packet (GstRTPBaseDepayload * depay,
+    GstRTPBuffer * rtp)
+{
+  return gst_rtp_buffer_get_payload_buffer (rtp);
+}
+
+static GstBufferList *
+bench_depay_process_rtp_packet_list (GstRTPBaseDepayload * depay,
+    GstBufferList * list)
+{
+  GstBufferList *out_list;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  out_list = gst_buffer_list_new_sized (len);
+  for (i = 0; i < len; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    if (!gst_rtp_buffer_map (gst_buffer_list_get (list, i), GST_MAP_READ, &rtp))
+      continue;
+    gst_buffer_list_add (out_list, gst_rtp_buffer_get_payload_buffer (&rtp));
+    gst_rtp_buffer_unmap (&rtp);
+  }
+  gst_buffer_list_unref (list);
+
+  return out_list;
+}
+
+static void
+bench_depay_class_init (BenchDepayClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstRTPBaseDepayloadClass *depay_class = GST_RTP_BASE_DEPAYLOAD_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_depay_sink_template);
+  gst_element_class_add_static_pad_template (element_class,
+      &bench_depay_src_template);
+  gst_element_class_set_static_metadata (element_class,
+      "Benchmark RTP Depayloader", "Codec/Depayloader/Network/RTP",
+      "Benchmark RTP Depayloader", "GStreamer maintainers");
+
+  depay_class->set_caps = bench_depay_set_caps;
+  depay_class->process_rtp_packet = bench_depay_process_rtp_packet;
+  depay_class->process_rtp_packet_list = bench_depay_process_rtp_packet_list;
+}
+
+static void
+bench_depay_init (BenchDepay * depay)
+{
+}
+
+/* helpers */
+
+typedef struct
+{
+  GstElement *element;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+} BenchElement;
+
+static guint n_received;
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  n_received++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  n_received += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static void
+bench_element_start (BenchElement * bench, GstElement * element,
+    const gchar * caps_str)
+{
+  GstPad *pad;
+  GstCaps *caps;
+  GstSegment segment;
+
+  bench->element = element;
+
+  bench->srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  bench->sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (bench->sinkpad, sink_chain);
+  gst_pad_set_chain_list_function (bench->sinkpad, sink_chain_list);
+  gst_pad_set_event_function (bench->sinkpad, sink_event);
+  gst_pad_set_active (bench->srcpad, TRUE);
+  gst_pad_set_active (bench->sinkpad, TRUE);
+
+  pad = gst_element_get_static_pad (element, "sink");
+  gst_pad_link (bench->srcpad, pad);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (element, "src");
+  gst_pad_link (pad, bench->sinkpad);
+  gst_object_unref (pad);
+
+  gst_element_set_state (element, GST_STATE_PLAYING);
+
+  gst_pad_push_event (bench->srcpad, gst_event_new_stream_start ("bench"));
+  caps = gst_caps_from_string (caps_str);
+  gst_pad_push_event (bench->srcpad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (bench->srcpad, gst_event_new_segment (&segment));
+
+  n_received = 0;
+}
+
+static void
+bench_element_stop (BenchElement * bench)
+{
+  gst_element_set_state (bench->element, GST_STATE_NULL);
+  gst_object_unref (bench->element);
+  gst_object_unref (bench->srcpad);
+  gst_object_unref (bench->sinkpad);
+}
+
+static void
+add_extensions (GstElement * element, guint n_exts)
+{
+  guint i;
+
+  for (i = 0; i < n_exts; i++) {
+    GstRTPHeaderExtension *ext = g_object_new (bench_hdr_ext_get_type (), NULL);
+
+    gst_rtp_header_extension_set_id (ext, i + 1);
+    g_signal_emit_by_name (element, "add-extension", ext);
+    gst_object_unref (ext);
+  }
+}
+
+/* creates a packet with @n_exts one-byte header extensions with ids starting
+ * from 1 and a payload sharing the start of @payload */
+static GstBuffer *
+create_packet (guint16 seqnum, guint n_exts, GstMemory * payload)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  guint8 data[BENCH_HDR_EXT_SIZE] = { 0, 0xa5 };
+  guint i;
+
+  buffer = gst_rtp_buffer_new_allocate (0, 0, 0);
+  gst_rtp_buffer_map (buffer, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, seqnum * (CLOCK_RATE / 1000));
+  gst_rtp_buffer_set_ssrc (&rtp, 0x12345678);
+  for (i = 0; i < n_exts; i++) {
+    data[0] = i + 1;
+    gst_rtp_buffer_add_extension_onebyte_header (&rtp, i + 1, data,
+        sizeof (data));
+  }
+  gst_rtp_buffer_unmap (&rtp);
+
+  gst_buffer_append_memory (buffer,
+      gst_memory_share (payload, 0, PAYLOAD_SIZE));
+  GST_BUFFER_PTS (buffer) = seqnum * PACKET_DURATION;
+
+  return buffer;
+}
+
+static void
+report (const gchar * name, guint n_exts, guint packets_per_buffer,
+    guint n_packets, GstClockTime elapsed)
+{
+  gdouble ns_per_packet = (gdouble) elapsed / n_packets;
+
+  g_print ("%s,%u,%u,%u,%.1f,%.0f\n", name, n_exts, packets_per_buffer,
+      n_packets, ns_per_packet,
+      ns_per_packet > 0 ? GST_SECOND / ns_per_packet : 0);
+}
+
+static void
+check_received (const gchar * name, guint expected)
+{
+  if (n_received != expected)
+    g_printerr ("%s: received %u packets, expected %u\n", name, n_received,
+        expected);
+}
+
+/* benchmarks */
+
+static void
+benchmark_rtp_buffer_map (guint n_packets, guint n_exts, GstMemory * payload)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buffer;
+  GstClockTime start;
+  guint32 sum = 0;
+  guint i;
+
+  buffer = create_packet (0, n_exts, payload);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++) {
+    gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp);
+    sum += gst_rtp_buffer_get_seq (&rtp);
+    sum += gst_rtp_buffer_get_payload_len (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+  report ("rtp-buffer-map", n_exts, 1, n_packets,
+      gst_util_get_timestamp () - start);
+
+  if (sum != n_packets * PAYLOAD_SIZE)
+    g_printerr ("rtp-buffer-map: unexpected packet contents\n");
+
+  gst_buffer_unref (buffer);
+}
+
+static void
+benchmark_hdrext_write (guint n_packets, guint n_exts)
+{
+  GstRTPHeaderExtension **exts;
+  GstBuffer *input, *output;
+  guint8 data[16 * (BENCH_HDR_EXT_SIZE + 1)];
+  GstClockTime start;
+  guint i, j;
+
+  exts = g_new (GstRTPHeaderExtension *, n_exts);
+  for (j = 0; j < n_exts; j++) {
+    exts[j] = g_object_new (bench_hdr_ext_get_type (), NULL);
+    gst_rtp_header_extension_set_id (exts[j], j + 1);
+  }
+  input = gst_buffer_new ();
+  output = gst_buffer_new ();
+
+  /* one-byte header layout, as done by the payloader */
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++) {
+    gsize offset = 0;
+
+    for (j = 0; j < n_exts; j++) {
+      gssize written;
+
+      written = gst_rtp_header_extension_write (exts[j], input,
+          GST_RTP_HEADER_EXTENSION_ONE_BYTE, output, &data[offset + 1],
+          sizeof (data) - offset - 1);
+      if (written <= 0)
+        break;
+      data[offset] = ((j + 1) << 4) | (written - 1);
+      offset += written + 1;
+    }
+  }
+  report ("hdrext-write", n_exts, 1, n_packets,
+      gst_util_get_timestamp () - start);
+
+  gst_buffer_unref (input);
+  gst_buffer_unref (output);
+  for (j = 0; j < n_exts; j++)
+    gst_object_unref (exts[j]);
+  g_free (exts);
+}
+
+static void
+benchmark_hdrext_read (guint n_packets, guint n_exts, GstMemory * payload)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPHeaderExtension **exts;
+  GstBuffer *buffer, *output;
+  GstClockTime start;
+  guint n_read = 0;
+  guint i, j;
+
+  exts = g_new (GstRTPHeaderExtension *, n_exts);
+  for (j = 0; j < n_exts; j++) {
+    exts[j] = g_object_new (bench_hdr_ext_get_type (), NULL);
+    gst_rtp_header_extension_set_id (exts[j], j + 1);
+  }
+  buffer = create_packet (0, n_exts, payload);
+  output = gst_buffer_new ();
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_packets; i++) {
+    gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp);
+    for (j = 0; j < n_exts; j++) {
+      gpointer data;
+      guint size;
+
+      if (gst_rtp_buffer_get_extension_onebyte_header (&rtp, j + 1, 0, &data,
+              &size)
+          && gst_rtp_header_extension_read (exts[j],
+              GST_RTP_HEADER_EXTENSION_ONE_BYTE, data, size, output))
+        n_read++;
+    }
+    gst_rtp_buffer_unmap (&rtp);
+  }
+  report ("hdrext-read", n_exts, 1, n_packets,
+      gst_util_get_timestamp () - start);
+
+  if (n_read != n_packets * n_exts)
+    g_printerr ("hdrext-read: read %u extensions, expected %u\n", n_read,
+        n_packets * n_exts);
+
+  gst_buffer_unref (buffer);
+  gst_buffer_unref (output);
+  for (j = 0; j < n_exts; j++)
+    gst_object_unref (exts[j]);
+  g_free (exts);
+}
+
+static void
+benchmark_payload (guint n_packets, guint n_exts, guint packets_per_buffer,
+    PayloadMode mode, GstMemory * payload)
+{
+  const gchar *name = payload_mode_names[mode];
+  BenchElement bench;
+  GstElement *pay;
+  GstBuffer **inputs;
+  GstClockTime start;
+  guint n_buffers, i;
+
+  pay = g_object_new (bench_pay_get_type (), "frame-lists",
+      mode == PAYLOAD_PUSH_FRAME_LISTS, NULL);
+  ((BenchPay *) pay)->use_list = mode == PAYLOAD_PUSH_LIST;
+  add_extensions (pay, n_exts);
+  bench_element_start (&bench, pay, "application/x-bench");
+
+  n_buffers = n_packets / packets_per_buffer;
+  inputs = g_new (GstBuffer *, n_buffers);
+  for (i = 0; i < n_buffers; i++) {
+    inputs[i] = gst_buffer_new ();
+    gst_buffer_append_memory (inputs[i], gst_memory_share (payload, 0,
+            packets_per_buffer * PAYLOAD_SIZE));
+    GST_BUFFER_PTS (inputs[i]) = i * packets_per_buffer * PACKET_DURATION;
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_buffers; i++)
+    gst_pad_push (bench.srcpad, inputs[i]);
+  report (name, n_exts, packets_per_buffer, n_buffers * packets_per_buffer,
+      gst_util_get_timestamp () - start);
+
+  check_received (name, n_buffers * packets_per_buffer);
+
+  g_free (inputs);
+  bench_element_stop (&bench);
+}
+
+static void
+benchmark_depayload (guint n_packets, guint n_exts, guint packets_per_buffer,
+    gboolean use_list, GstMemory * payload)
+{
+  const gchar *name = use_list ? "depayload-chain-list" : "depayload-chain";
+  BenchElement bench;
+  GstElement *depay;
+  gpointer *inputs;
+  GstClockTime start;
+  guint n_inputs, i, j;
+
+  depay = g_object_new (bench_depay_get_type (), NULL);
+  add_extensions (depay, n_exts);
+  bench_element_start (&bench, depay, "application/x-rtp, "
+      "media=(string)video, clock-rate=(int)90000, "
+      "encoding-name=(string)BENCH, payload=(int)96");
+
+  if (!use_list)
+    packets_per_buffer = 1;
+
+  n_inputs = n_packets / packets_per_buffer;
+  inputs = g_new (gpointer, n_inputs);
+  for (i = 0; i < n_inputs; i++) {
+    if (use_list) {
+      GstBufferList *list = gst_buffer_list_new_sized (packets_per_buffer);
+
+      for (j = 0; j < packets_per_buffer; j++)
+        gst_buffer_list_add (list,
+            create_packet (i * packets_per_buffer + j, n_exts, payload));
+      inputs[i] = list;
+    } else {
+      inputs[i] = create_packet (i, n_exts, payload);
+    }
+  }
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_inputs; i++) {
+    if (use_list)
+      gst_pad_push_list (bench.srcpad, inputs[i]);
+    else
+      gst_pad_push (bench.srcpad, inputs[i]);
+  }
+  report (name, n_exts, packets_per_buffer, n_inputs * packets_per_buffer,
+      gst_util_get_timestamp () - start);
+
+  check_received (name, n_inputs * packets_per_buffer);
+
+  g_free (inputs);
+  bench_element_stop (&bench);
+}
+
+static gboolean
+should_run (const gchar * filter, const gchar * name)
+{
+  return filter == NULL || strstr (name, filter) != NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *ctx;
+  GError *err = NULL;
+  GstMemory *payload;
+  gint num_packets = DEFAULT_NUM_PACKETS;
+  gchar *filter = NULL;
+  guint e, p;
+  GOptionEntry options[] = {
+    {"packets", 'n', 0, G_OPTION_ARG_INT, &num_packets,
+        "Number of packets per run", NULL},
+    {"benchmark", 'b', 0, G_OPTION_ARG_STRING, &filter,
+        "Only run benchmarks whose name contains this string", NULL},
+    {NULL}
+  };
+
+  ctx = g_option_context_new ("");
+  g_option_context_add_main_entries (ctx, options, NULL);
+  g_option_context_add_group (ctx, gst_init_get_option_group ());
+  if (!g_option_context_parse (ctx, &argc, &argv, &err)) {
+    g_print ("Error initializing: %s\n", GST_STR_NULL (err->message));
+    g_option_context_free (ctx);
+    g_clear_error (&err);
+    return 1;
+  }
+  g_option_context_free (ctx);
+
+  if (num_packets < MAX_PACKETS_PER_BUFFER) {
+    g_printerr ("Need at least %u packets per run\n", MAX_PACKETS_PER_BUFFER);
+    return 1;
+  }
+
+  payload = gst_allocator_alloc (NULL,
+      MAX_PACKETS_PER_BUFFER * PAYLOAD_SIZE, NULL);
+
+  g_print ("benchmark,extensions,packets_per_buffer,packets,"
+      "ns_per_packet,packets_per_sec\n");
+
+  for (e = 0; e < G_N_ELEMENTS (n_exts_values); e++) {
+    guint n_exts = n_exts_values[e];
+
+    if (should_run (filter, "rtp-buffer-map"))
+      benchmark_rtp_buffer_map (num_packets, n_exts, payload);
+    if (should_run (filter, "hdrext-write"))
+      benchmark_hdrext_write (num_packets, n_exts);
+    if (should_run (filter, "hdrext-read"))
+      benchmark_hdrext_read (num_packets, n_exts, payload);
+    if (should_run (filter, "depayload-chain"))
+      benchmark_depayload (num_packets, n_exts, 1, FALSE, payload);
+
+    for (p = 0; p < G_N_ELEMENTS (packets_per_buffer_values); p++) {
+      guint packets_per_buffer = packets_per_buffer_values[p];
+      PayloadMode mode;
+
+      for (mode = PAYLOAD_PUSH; mode <= PAYLOAD_PUSH_LIST; mode++) {
+        if (should_run (filter, payload_mode_names[mode]))
+          benchmark_payload (num_packets, n_exts, packets_per_buffer, mode,
+              payload);
+      }
+      if (should_run (filter, "depayload-chain-list"))
+        benchmark_depayload (num_packets, n_exts, packets_per_buffer, TRUE,
+            payload);
+    }
+  }
+
+  gst_memory_unref (payload);
+  g_free (filter);
+
+  return 0;
+}